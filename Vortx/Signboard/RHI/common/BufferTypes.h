@@ -9,7 +9,8 @@ enum class BufferUsage {
 	Uniform				= 1 << 2,
 	Storage				= 1 << 3,
 	Vertex				= 1 << 4,
-	Index				= 1 << 5
+	Index				= 1 << 5,
+	Indirect			= 1 << 6
 };
 
 using BufferUsageFlags = Flags<BufferUsage>;
@@ -18,4 +19,12 @@ struct BufferDesc {
 	uint64_t size;
 	BufferUsageFlags usageFlags{};
 	MemoryPropertyFlags memoryFlags{};
+	MemoryLifetime lifetime = MemoryLifetime::Persistent;
+	uint32_t frameIndex = 0;
+};
+
+struct BufferCopyRegion {
+	uint64_t srcOffset = 0;
+	uint64_t dstOffset = 0;
+	uint64_t size = 0;
 };
@@ -6,9 +6,11 @@
 enum class DescriptorType {
 	CombinedImageSampler,
 	UniformBuffer,
+	UniformBufferDynamic,
 	StorageBuffer,
 	SampledImage,
-	TextureSampler
+	TextureSampler,
+	StorageImage
 };
 
 enum class DescriptorBindingBit : uint32_t {
@@ -11,6 +11,21 @@ enum class MemoryProperty {
 
 using MemoryPropertyFlags = Flags<MemoryProperty>;
 
+enum class MemoryLifetime {
+	Persistent,
+	Transient
+};
+
+enum class SemaphoreType {
+	Binary,
+	Timeline
+};
+
+enum class CommandBufferLevel {
+	Primary,
+	Secondary
+};
+
 enum class ShaderStageBit {
 	VertexBit = 1 << 0,
 	GeometryBit = 1 << 1,
@@ -30,7 +45,31 @@ enum class PipelineStage {
 	EarlyDepthTest = 1 << 5,
 	LateDepthTest = 1 << 6,
 	ColorAttachmentOutput = 1 << 7,
-	BottomOfPipe = 1 << 8
+	BottomOfPipe = 1 << 8,
+	ComputeShader = 1 << 9,
+	DrawIndirect = 1 << 10,
+	Host = 1 << 11,
+	AllCommands = 1 << 12
+};
+
+using PipelineStageFlags = Flags<PipelineStage>;
+
+enum class ResourceAccess {
+	None = 0,
+	IndirectCommandRead = 1 << 0,
+	IndexRead = 1 << 1,
+	VertexAttributeRead = 1 << 2,
+	UniformRead = 1 << 3,
+	ShaderRead = 1 << 4,
+	ShaderWrite = 1 << 5,
+	ColorAttachmentRead = 1 << 6,
+	ColorAttachmentWrite = 1 << 7,
+	DepthStencilRead = 1 << 8,
+	DepthStencilWrite = 1 << 9,
+	TransferRead = 1 << 10,
+	TransferWrite = 1 << 11,
+	HostRead = 1 << 12,
+	HostWrite = 1 << 13
 };
 
-using PipelineStageFlags = Flags<PipelineStage>;
\ No newline at end of file
+using ResourceAccessFlags = Flags<ResourceAccess>;
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "base/Flag_type.h"
+#include "DeviceTypes.h"
 
 struct ImageExtent2D {
 	uint32_t width;
@@ -12,7 +13,8 @@ enum class ImageFormat {
 	BGRA8,
 	RGBA16F,
 	Depth24Stencil8,
-	Depth32F
+	Depth32F,
+	R32F
 };
 
 enum class ImageLayout {
@@ -22,13 +24,15 @@ enum class ImageLayout {
 	ShaderReadOnly,
 	ColorAttachment,
 	DepthStencilAttachment,
-	Present
+	Present,
+	General
 };
 
 enum class ImageUsage {
 	ColorAttachment			= 1 << 0,
 	DepthAttachment			= 1 << 1,
-	Sampled					= 1 << 2
+	Sampled					= 1 << 2,
+	Storage					= 1 << 3
 };
 
 using ImageUsageFlags = Flags<ImageUsage>;
@@ -38,4 +42,9 @@ struct ImageDesc {
 	uint32_t height;
 	ImageUsageFlags usage = ImageUsage::ColorAttachment;
 	ImageFormat format = ImageFormat::RGBA8;
+	uint32_t mipLevels = 1;
+	MemoryLifetime lifetime = MemoryLifetime::Persistent;
+	uint32_t frameIndex = 0;
+	// no memory is allocated, it is bound later with VulkanImage::bindMemory
+	bool deferMemory = false;
 };
\ No newline at end of file
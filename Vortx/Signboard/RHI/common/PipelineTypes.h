@@ -27,6 +27,15 @@ enum class PipelineType {
 	Compute
 };
 
+// the independently compiled parts of a graphics pipeline under VK_EXT_graphics_pipeline_library
+enum class PipelineLibraryPart {
+	VertexInput,
+	PreRasterization,
+	FragmentShader,
+	FragmentOutput
+};
+constexpr uint32_t PIPELINE_LIBRARY_PART_COUNT = 4;
+
 enum class RasterSamples {
 	Raster_Samples_1,
 	Raster_Samples_2,
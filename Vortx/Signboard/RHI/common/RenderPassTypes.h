@@ -15,10 +15,14 @@ enum class StoreOp {
 	DontCare
 };
 
+// Undefined as the final layout keeps the attachment in its attachment layout. a pass that loads has to name
+// the layout the previous pass left the image in
 struct AttachmentDesc {
 	ImageFormat format;
 	LoadOp load;
 	StoreOp store;
+	ImageLayout initialLayout = ImageLayout::Undefined;
+	ImageLayout finalLayout = ImageLayout::Undefined;
 };
 
 struct RenderPassDesc {
@@ -27,3 +31,10 @@ struct RenderPassDesc {
 	AttachmentDesc depthAttachment;
 };
 
+// one value for every color attachment and one for depth, only used by attachments that clear
+struct ClearValue {
+	float color[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+	float depth = 1.0f;
+	uint32_t stencil = 0;
+};
+
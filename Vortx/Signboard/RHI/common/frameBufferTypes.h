@@ -6,8 +6,8 @@
 class VulkanImage;
 
 struct FrameBufferDesc {
-	std::vector<VulkanImage*> colorAttachments;
-	VulkanImage* depthAttachment = nullptr;
+	std::vector<const VulkanImage*> colorAttachments;
+	const VulkanImage* depthAttachment = nullptr;
 
 	uint32_t width;
 	uint32_t height;
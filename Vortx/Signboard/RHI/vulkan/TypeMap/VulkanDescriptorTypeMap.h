@@ -7,8 +7,11 @@ VkDescriptorType toVkDescriptorType(DescriptorType type) {
 	switch (type) {
 	case DescriptorType::CombinedImageSampler:	return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 	case DescriptorType::UniformBuffer:			return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	case DescriptorType::UniformBufferDynamic:	return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+	case DescriptorType::StorageBuffer:			return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
 	case DescriptorType::SampledImage:			return VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
 	case DescriptorType::TextureSampler:		return VK_DESCRIPTOR_TYPE_SAMPLER;
+	case DescriptorType::StorageImage:			return VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
 	}
 }
 
@@ -33,7 +33,11 @@ VkPipelineStageFlags toVkPipelineStage(PipelineStageFlags stage) {
 		{PipelineStage::EarlyDepthTest,			VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT},
 		{PipelineStage::LateDepthTest,			VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT},
 		{PipelineStage::ColorAttachmentOutput,	VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT},
-		{PipelineStage::BottomOfPipe,			VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT}
+		{PipelineStage::BottomOfPipe,			VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT},
+		{PipelineStage::ComputeShader,			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT},
+		{PipelineStage::DrawIndirect,			VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT},
+		{PipelineStage::Host,					VK_PIPELINE_STAGE_HOST_BIT},
+		{PipelineStage::AllCommands,			VK_PIPELINE_STAGE_ALL_COMMANDS_BIT}
 	};
 
 	VkPipelineStageFlags flags = 0;
@@ -41,5 +45,33 @@ VkPipelineStageFlags toVkPipelineStage(PipelineStageFlags stage) {
 		if (stage.has(mapping.stageBit))
 			flags |= mapping.vk;
 
+	return flags;
+}
+
+VkAccessFlags toVkAccessFlags(ResourceAccessFlags access) {
+	struct Map { ResourceAccess accessBit; VkAccessFlagBits vk; };
+
+	static constexpr Map table[] = {
+		{ResourceAccess::IndirectCommandRead,	VK_ACCESS_INDIRECT_COMMAND_READ_BIT},
+		{ResourceAccess::IndexRead,				VK_ACCESS_INDEX_READ_BIT},
+		{ResourceAccess::VertexAttributeRead,	VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT},
+		{ResourceAccess::UniformRead,			VK_ACCESS_UNIFORM_READ_BIT},
+		{ResourceAccess::ShaderRead,			VK_ACCESS_SHADER_READ_BIT},
+		{ResourceAccess::ShaderWrite,			VK_ACCESS_SHADER_WRITE_BIT},
+		{ResourceAccess::ColorAttachmentRead,	VK_ACCESS_COLOR_ATTACHMENT_READ_BIT},
+		{ResourceAccess::ColorAttachmentWrite,	VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT},
+		{ResourceAccess::DepthStencilRead,		VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT},
+		{ResourceAccess::DepthStencilWrite,		VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT},
+		{ResourceAccess::TransferRead,			VK_ACCESS_TRANSFER_READ_BIT},
+		{ResourceAccess::TransferWrite,			VK_ACCESS_TRANSFER_WRITE_BIT},
+		{ResourceAccess::HostRead,				VK_ACCESS_HOST_READ_BIT},
+		{ResourceAccess::HostWrite,				VK_ACCESS_HOST_WRITE_BIT}
+	};
+
+	VkAccessFlags flags = 0;
+	for (auto& mapping : table)
+		if (access.has(mapping.accessBit))
+			flags |= mapping.vk;
+
 	return flags;
 }
\ No newline at end of file
@@ -12,6 +12,7 @@ VkFormat toVkFormat(ImageFormat format) {
 	case ImageFormat::RGBA16F:					return VK_FORMAT_R16G16B16A16_SFLOAT;
 	case ImageFormat::Depth24Stencil8:			return VK_FORMAT_D24_UNORM_S8_UINT;
 	case ImageFormat::Depth32F:					return VK_FORMAT_D32_SFLOAT;
+	case ImageFormat::R32F:						return VK_FORMAT_R32_SFLOAT;
 	default:									return VK_FORMAT_UNDEFINED;
 	}
 }
@@ -44,6 +45,7 @@ VkImageLayout toVkImageLayout(ImageLayout layout) {
 	case ImageLayout::ColorAttachment:			return VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 	case ImageLayout::DepthStencilAttachment:	return VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 	case ImageLayout::Present:					return VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	case ImageLayout::General:					return VK_IMAGE_LAYOUT_GENERAL;
 	default:									return VK_IMAGE_LAYOUT_UNDEFINED;
 	}
 }
@@ -54,7 +56,8 @@ VkImageUsageFlags toVkImageUsageFlags(ImageUsageFlags usage) {
 	static constexpr Map table[] = {
 		{ImageUsage::ColorAttachment,			VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT},
 		{ImageUsage::DepthAttachment,			VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT},
-		{ImageUsage::Sampled,					VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT}
+		{ImageUsage::Sampled,					VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT},
+		{ImageUsage::Storage,					VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT}
 	};
 
 	VkImageUsageFlags flags = 0;
@@ -13,15 +13,14 @@ VulkanBuffer::VulkanBuffer(VulkanDevice& device, const BufferDesc& desc)
 	usage = desc.usageFlags;
 
 	createBuffer(usage);
-	allocateMemory(memoryProperties);
-	bindMemory();
+	allocateMemory(memoryProperties, desc.lifetime, desc.frameIndex);
 }
 
 VulkanBuffer::VulkanBuffer(VulkanBuffer&& other) noexcept
-	: device(other.device), buffer(other.buffer), memory(other.memory), mapped(other.mapped), size(other.size), memoryProperties(other.memoryProperties), usage(other.usage)
+	: device(other.device), buffer(other.buffer), allocation(other.allocation), mapped(other.mapped), size(other.size), memoryProperties(other.memoryProperties), usage(other.usage)
 {
 	other.buffer = VK_NULL_HANDLE;
-	other.memory = VK_NULL_HANDLE;
+	other.allocation = MemoryAllocation{};
 	other.mapped = nullptr;
 }
 
@@ -31,15 +30,16 @@ VulkanBuffer& VulkanBuffer::operator=(VulkanBuffer&& other) noexcept {
 
 	destroy();
 	buffer = other.buffer;
-	memory = other.memory;
+	allocation = other.allocation;
 	mapped = other.mapped;
 	size = other.size;
 	memoryProperties = other.memoryProperties;
 	usage = other.usage;
 
 	other.buffer = VK_NULL_HANDLE;
-	other.memory = VK_NULL_HANDLE;
+	other.allocation = MemoryAllocation{};
 	other.mapped = nullptr;
+	return *this;
 }
 
 VulkanBuffer::~VulkanBuffer() {
@@ -52,14 +52,17 @@ void VulkanBuffer::destroy() {
 	if (mapped)
 		unmap();
 
-	vkDestroyBuffer(vkDevice, buffer, nullptr);
-	vkFreeMemory(vkDevice, memory, nullptr);
+	if (buffer) {
+		vkDestroyBuffer(vkDevice, buffer, nullptr);
+		buffer = VK_NULL_HANDLE;
+	}
+	device.getAllocator().free(allocation);
 }
 
 void* VulkanBuffer::map() {
 	if (memoryProperties.has(MemoryProperty::HostVisible)) {
 		if (!mapped) {
-			vkMapMemory(device.getDevice(), memory, 0, size, 0, &mapped);
+			mapped = allocation.mapped;
 		}
 		return mapped;
 	}
@@ -67,10 +70,8 @@ void* VulkanBuffer::map() {
 }
 
 void VulkanBuffer::unmap(){
-	if (mapped) {
-		vkUnmapMemory(device.getDevice(), memory);
-		mapped = nullptr;
-	}
+	// block memory stays persistently mapped by the allocator
+	mapped = nullptr;
 }
 
 void VulkanBuffer::upload(const void* data, uint64_t dataSize, uint64_t offset = 0){
@@ -84,13 +85,7 @@ void VulkanBuffer::upload(const void* data, uint64_t dataSize, uint64_t offset =
 	std::memcpy(static_cast<uint8_t*>(dst) + offset, data, dataSize);
 
 	if (!memoryProperties.has(MemoryProperty::HostCoherent)) {
-		VkMappedMemoryRange ranges{};
-		ranges.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-		ranges.memory = memory;
-		ranges.offset = offset;
-		ranges.size = dataSize;
-
-		vkFlushMappedMemoryRanges(device.getDevice(), 1, &ranges);
+		device.getAllocator().flush(allocation, offset, dataSize);
 	}
 }
 
@@ -119,22 +114,6 @@ void VulkanBuffer::createBuffer(BufferUsageFlags usage) {
 	}
 }
 
-void VulkanBuffer::allocateMemory(MemoryPropertyFlags memoryProperties) {
-	VkDevice vkDevice = device.getDevice();
-
-	VkMemoryRequirements memReq{};
-	vkGetBufferMemoryRequirements(vkDevice, buffer, &memReq);
-
-	VkMemoryAllocateInfo allocInfo{};
-	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	allocInfo.allocationSize = memReq.size;
-	allocInfo.memoryTypeIndex = device.findMemoryType(memReq.memoryTypeBits, toVkMemoryPropertyFlags(memoryProperties));
-
-	if (vkAllocateMemory(vkDevice, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
-		throw std::runtime_error("failed to allocate memory to a buffer");
-	}
-}
-
-void VulkanBuffer::bindMemory() {
-	vkBindBufferMemory(device.getDevice(), buffer, memory, 0);
+void VulkanBuffer::allocateMemory(MemoryPropertyFlags memoryProperties, MemoryLifetime lifetime, uint32_t frameIndex) {
+	allocation = device.getAllocator().allocateBuffer(buffer, memoryProperties, lifetime, frameIndex);
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include "Common/VulkanFwd.h"
 #include "Signboard/RHI/common/BufferTypes.h"
 
+#include "VulkanMemoryAllocator.h"
+
 class VulkanDevice;
 class VulkanCommandBuffer;
 
@@ -27,17 +29,17 @@ public:
 
 	VkBuffer getHandle() const { return buffer; }
 	uint64_t getSize() const { return size; }
+	const MemoryAllocation& getAllocation() const { return allocation; }
 
 private:
 	void createBuffer(BufferUsageFlags usage);
-	void allocateMemory(MemoryPropertyFlags memoryProperty);
-	void bindMemory();
+	void allocateMemory(MemoryPropertyFlags memoryProperty, MemoryLifetime lifetime, uint32_t frameIndex);
 
 private:
 	VulkanDevice& device;
 
-	VkBuffer buffer;
-	VkDeviceMemory memory;
+	VkBuffer buffer = nullptr;
+	MemoryAllocation allocation;
 
 	void* mapped = nullptr;
 	uint64_t size;
@@ -1,26 +1,38 @@
 #include "VulkanCommandBuffer.h"
 
 #include "Common/VulkanCommon.h"
+#include "TypeMap/VulkanDeviceTypeMap.h"
+#include "TypeMap/VulkanDescriptorTypeMap.h"
+#include "TypeMap/VulkanImageTypeMap.h"
 #include "VulkanSemaphore.h"
 
 #include "VulkanDevice.h"
 #include "VulkanCommandPool.h"
 #include "VulkanBuffer.h"
+#include "VulkanImage.h"
+#include "VulkanPipeline.h"
+#include "VulkanPipelineLayout.h"
+#include "VulkanDescriptorSet.h"
+#include "VulkanRenderPass.h"
+#include "VulkanFrameBuffer.h"
 
 
-VulkanCommandBuffer::VulkanCommandBuffer(VulkanDevice& device, VulkanCommandPool& commandPool)
+VulkanCommandBuffer::VulkanCommandBuffer(VulkanDevice& device, VulkanCommandPool& commandPool, CommandBufferLevel level)
 	: device(device), commandPool(commandPool)
 {
 	VkCommandBufferAllocateInfo allocInfo{};
 	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
 	allocInfo.commandPool = commandPool.getHandle();
-	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocInfo.level = level == CommandBufferLevel::Secondary ? VK_COMMAND_BUFFER_LEVEL_SECONDARY : VK_COMMAND_BUFFER_LEVEL_PRIMARY;
 	allocInfo.commandBufferCount = 1;
 
 	if (vkAllocateCommandBuffers(device.getDevice(), &allocInfo, &commandBuffer) != VK_SUCCESS) {
 		throw std::runtime_error("failed to allocate command buffer!");
 	}
 
+	if (level == CommandBufferLevel::Secondary)
+		return;
+
 	VkFenceCreateInfo fenceInfo{};
 	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
 	fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
@@ -57,26 +69,59 @@ void VulkanCommandBuffer::begin() {
 	}
 }
 
+void VulkanCommandBuffer::beginSecondary(VkRenderPass renderPass, uint32_t subpass, VkFramebuffer framebuffer) {
+	VkCommandBufferInheritanceInfo inheritance{};
+	inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+	inheritance.renderPass = renderPass;
+	inheritance.subpass = subpass;
+	inheritance.framebuffer = framebuffer;
+
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+	beginInfo.pInheritanceInfo = &inheritance;
+
+	if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+		throw std::runtime_error("failed to begin command buffer!");
+	}
+}
+
+void VulkanCommandBuffer::executeCommands(const VkCommandBuffer* secondaries, uint32_t count) {
+	if (count)
+		vkCmdExecuteCommands(commandBuffer, count, secondaries);
+}
+
 void VulkanCommandBuffer::end() {
 	if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
 		throw std::runtime_error("failed to end command buffer!");
 	}
 }
 
-void VulkanCommandBuffer::submit(VulkanSemaphore& waitSemaphore, VulkanSemaphore& signalSemaphore) {
-	VkSemaphore wait_S = waitSemaphore.get();
+void VulkanCommandBuffer::submit(VulkanSemaphore& waitSemaphore, VulkanSemaphore& signalSemaphore, const VulkanSemaphore* timeline, uint64_t timelineWaitValue) {
+	VkSemaphore wait_S[2] = { waitSemaphore.get(), timeline ? timeline->get() : VK_NULL_HANDLE };
 	VkSemaphore signal_S = signalSemaphore.get();
 
-	VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	// uploads are consumed anywhere in the frame, the timeline wait has to cover every stage
+	VkPipelineStageFlags waitStages[2] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT };
+	uint64_t waitValues[2] = { 0, timelineWaitValue };
+	uint64_t signalValue = 0;
+
+	VkTimelineSemaphoreSubmitInfo timelineInfo{};
+	timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+	timelineInfo.waitSemaphoreValueCount = 2;
+	timelineInfo.pWaitSemaphoreValues = waitValues;
+	timelineInfo.signalSemaphoreValueCount = 1;
+	timelineInfo.pSignalSemaphoreValues = &signalValue;
 
 	VkSubmitInfo submitInfo{};
 	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.pNext = timeline ? &timelineInfo : nullptr;
 	submitInfo.commandBufferCount = 1;
 	submitInfo.pCommandBuffers = &commandBuffer;
 	
-	submitInfo.waitSemaphoreCount = 1;
-	submitInfo.pWaitSemaphores = &wait_S;
-	submitInfo.pWaitDstStageMask = &waitStage;
+	submitInfo.waitSemaphoreCount = timeline ? 2 : 1;
+	submitInfo.pWaitSemaphores = wait_S;
+	submitInfo.pWaitDstStageMask = waitStages;
 
 	submitInfo.signalSemaphoreCount = 1;
 	submitInfo.pSignalSemaphores = &signal_S;
@@ -86,6 +131,108 @@ void VulkanCommandBuffer::submit(VulkanSemaphore& waitSemaphore, VulkanSemaphore
 	}
 }
 
+void VulkanCommandBuffer::submit(VkQueue queue, const VulkanSemaphore& timeline, uint64_t signalValue) {
+	VkSemaphore signal_S = timeline.get();
+
+	VkTimelineSemaphoreSubmitInfo timelineInfo{};
+	timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+	timelineInfo.signalSemaphoreValueCount = 1;
+	timelineInfo.pSignalSemaphoreValues = &signalValue;
+
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.pNext = &timelineInfo;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &commandBuffer;
+
+	submitInfo.signalSemaphoreCount = 1;
+	submitInfo.pSignalSemaphores = &signal_S;
+
+	if (vkQueueSubmit(queue, 1, &submitInfo, fence) != VK_SUCCESS) {
+		throw std::runtime_error("failed to submit command buffer");
+	}
+}
+
+void VulkanCommandBuffer::submit(VkQueue queue, const SemaphoreSubmit* waits, uint32_t waitCount, const SemaphoreSubmit* signals, uint32_t signalCount) {
+	std::vector<VkSemaphore> wait_S(waitCount);
+	std::vector<VkPipelineStageFlags> waitStages(waitCount);
+	std::vector<uint64_t> waitValues(waitCount);
+	for (uint32_t i = 0; i < waitCount; i++) {
+		wait_S[i] = waits[i].semaphore->get();
+		waitStages[i] = toVkPipelineStage(waits[i].stages);
+		waitValues[i] = waits[i].value;
+	}
+
+	std::vector<VkSemaphore> signal_S(signalCount);
+	std::vector<uint64_t> signalValues(signalCount);
+	for (uint32_t i = 0; i < signalCount; i++) {
+		signal_S[i] = signals[i].semaphore->get();
+		signalValues[i] = signals[i].value;
+	}
+
+	VkTimelineSemaphoreSubmitInfo timelineInfo{};
+	timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+	timelineInfo.waitSemaphoreValueCount = waitCount;
+	timelineInfo.pWaitSemaphoreValues = waitValues.data();
+	timelineInfo.signalSemaphoreValueCount = signalCount;
+	timelineInfo.pSignalSemaphoreValues = signalValues.data();
+
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.pNext = &timelineInfo;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &commandBuffer;
+
+	submitInfo.waitSemaphoreCount = waitCount;
+	submitInfo.pWaitSemaphores = wait_S.data();
+	submitInfo.pWaitDstStageMask = waitStages.data();
+
+	submitInfo.signalSemaphoreCount = signalCount;
+	submitInfo.pSignalSemaphores = signal_S.data();
+
+	if (vkQueueSubmit(queue, 1, &submitInfo, fence) != VK_SUCCESS) {
+		throw std::runtime_error("failed to submit command buffer");
+	}
+}
+
+void VulkanCommandBuffer::beginRenderPass(const VulkanRenderPass& renderPass, const VulkanFrameBuffer& frameBuffer, const ClearValue& clear) {
+	std::vector<VkClearValue> clearValues(renderPass.getColorAttachmentCount() + (renderPass.hasDepthAttachment() ? 1 : 0));
+	for (uint32_t i = 0; i < renderPass.getColorAttachmentCount(); i++)
+		clearValues[i].color = { { clear.color[0], clear.color[1], clear.color[2], clear.color[3] } };
+	if (renderPass.hasDepthAttachment())
+		clearValues.back().depthStencil = { clear.depth, clear.stencil };
+
+	VkRenderPassBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+	beginInfo.renderPass = renderPass.getHandle();
+	beginInfo.framebuffer = frameBuffer.getHandle();
+	beginInfo.renderArea.offset = { 0, 0 };
+	beginInfo.renderArea.extent = { frameBuffer.getWidth(), frameBuffer.getHeight() };
+	beginInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
+	beginInfo.pClearValues = clearValues.data();
+
+	vkCmdBeginRenderPass(commandBuffer, &beginInfo, VK_SUBPASS_CONTENTS_INLINE);
+}
+
+void VulkanCommandBuffer::endRenderPass() {
+	vkCmdEndRenderPass(commandBuffer);
+}
+
+void VulkanCommandBuffer::setViewport(uint32_t width, uint32_t height) {
+	VkViewport viewport{};
+	viewport.width = static_cast<float>(width);
+	viewport.height = static_cast<float>(height);
+	viewport.minDepth = 0.0f;
+	viewport.maxDepth = 1.0f;
+	vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+}
+
+void VulkanCommandBuffer::setScissor(uint32_t width, uint32_t height) {
+	VkRect2D scissor{};
+	scissor.extent = { width, height };
+	vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+}
+
 void VulkanCommandBuffer::bindVertexBuffer(const VulkanBuffer& buffer) {
 	VkBuffer buffers[] = { buffer.getHandle() };
 	VkDeviceSize offsets[] = { 0 };
@@ -96,6 +243,152 @@ void VulkanCommandBuffer::bindIndexBuffer(const VulkanBuffer& buffer){
 	vkCmdBindIndexBuffer(commandBuffer, buffer.getHandle(), 0, VK_INDEX_TYPE_UINT32);
 }
 
-void VulkanCommandBuffer::drawIndexed(uint32_t indexCount){
-	vkCmdDrawIndexed(commandBuffer, indexCount, 1, 0, 0, 0);
+void VulkanCommandBuffer::drawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance){
+	vkCmdDrawIndexed(commandBuffer, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+}
+
+static VkPipelineBindPoint toVkBindPoint(PipelineType type) {
+	return type == PipelineType::Compute ? VK_PIPELINE_BIND_POINT_COMPUTE : VK_PIPELINE_BIND_POINT_GRAPHICS;
+}
+
+void VulkanCommandBuffer::bindPipeline(const VulkanPipeline& pipeline, PipelineType type) {
+	vkCmdBindPipeline(commandBuffer, toVkBindPoint(type), pipeline.getHandle());
+}
+
+void VulkanCommandBuffer::bindDescriptorSet(PipelineType type, const VulkanPipelineLayout& layout, uint32_t setIndex, const VulkanDescriptorSet& set) {
+	VkDescriptorSet handle = set.getHandle();
+	vkCmdBindDescriptorSets(commandBuffer, toVkBindPoint(type), layout.getHandle(), setIndex, 1, &handle, 0, nullptr);
+}
+
+void VulkanCommandBuffer::bindDescriptorSet(PipelineType type, const VulkanPipelineLayout& layout, uint32_t setIndex, const VulkanDescriptorSet& set, const uint32_t* dynamicOffsets, uint32_t dynamicOffsetCount) {
+	VkDescriptorSet handle = set.getHandle();
+	vkCmdBindDescriptorSets(commandBuffer, toVkBindPoint(type), layout.getHandle(), setIndex, 1, &handle, dynamicOffsetCount, dynamicOffsets);
+}
+
+void VulkanCommandBuffer::pushConstants(const VulkanPipelineLayout& layout, ShaderStageFlags stages, uint32_t offset, uint32_t size, const void* data) {
+	vkCmdPushConstants(commandBuffer, layout.getHandle(), toVkShaderStageFlags(stages), offset, size, data);
+}
+
+void VulkanCommandBuffer::dispatch(uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ) {
+	vkCmdDispatch(commandBuffer, groupsX, groupsY, groupsZ);
+}
+
+void VulkanCommandBuffer::copyBuffer(const VulkanBuffer& src, const VulkanBuffer& dst, const BufferCopyRegion* regions, uint32_t regionCount) {
+	std::vector<VkBufferCopy> copies(regionCount);
+	for (uint32_t i = 0; i < regionCount; i++) {
+		copies[i].srcOffset = regions[i].srcOffset;
+		copies[i].dstOffset = regions[i].dstOffset;
+		copies[i].size = regions[i].size;
+	}
+
+	vkCmdCopyBuffer(commandBuffer, src.getHandle(), dst.getHandle(), regionCount, copies.data());
+}
+
+void VulkanCommandBuffer::fillBuffer(const VulkanBuffer& buffer, uint64_t offset, uint64_t size, uint32_t value) {
+	vkCmdFillBuffer(commandBuffer, buffer.getHandle(), offset, size, value);
+}
+
+void VulkanCommandBuffer::memoryBarrier(PipelineStageFlags srcStage, ResourceAccessFlags srcAccess, PipelineStageFlags dstStage, ResourceAccessFlags dstAccess) {
+	VkMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	barrier.srcAccessMask = toVkAccessFlags(srcAccess);
+	barrier.dstAccessMask = toVkAccessFlags(dstAccess);
+
+	vkCmdPipelineBarrier(commandBuffer, toVkPipelineStage(srcStage), toVkPipelineStage(dstStage), 0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+void VulkanCommandBuffer::bufferBarrier(const VulkanBuffer& buffer, PipelineStageFlags srcStage, ResourceAccessFlags srcAccess, PipelineStageFlags dstStage, ResourceAccessFlags dstAccess) {
+	VkBufferMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	barrier.srcAccessMask = toVkAccessFlags(srcAccess);
+	barrier.dstAccessMask = toVkAccessFlags(dstAccess);
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.buffer = buffer.getHandle();
+	barrier.offset = 0;
+	barrier.size = VK_WHOLE_SIZE;
+
+	vkCmdPipelineBarrier(commandBuffer, toVkPipelineStage(srcStage), toVkPipelineStage(dstStage), 0, 0, nullptr, 1, &barrier, 0, nullptr);
+}
+
+void VulkanCommandBuffer::bufferBarriers(const BufferBarrier* barriers, uint32_t barrierCount, PipelineStageFlags srcStage, PipelineStageFlags dstStage) {
+	if (barrierCount == 0)
+		return;
+
+	std::vector<VkBufferMemoryBarrier> vkBarriers(barrierCount);
+	for (uint32_t i = 0; i < barrierCount; i++) {
+		VkBufferMemoryBarrier& barrier = vkBarriers[i];
+		barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		barrier.srcAccessMask = toVkAccessFlags(barriers[i].srcAccess);
+		barrier.dstAccessMask = toVkAccessFlags(barriers[i].dstAccess);
+		barrier.srcQueueFamilyIndex = barriers[i].srcQueueFamily == UINT32_MAX ? VK_QUEUE_FAMILY_IGNORED : barriers[i].srcQueueFamily;
+		barrier.dstQueueFamilyIndex = barriers[i].dstQueueFamily == UINT32_MAX ? VK_QUEUE_FAMILY_IGNORED : barriers[i].dstQueueFamily;
+		barrier.buffer = barriers[i].buffer->getHandle();
+		barrier.offset = barriers[i].offset;
+		barrier.size = barriers[i].size;
+	}
+
+	vkCmdPipelineBarrier(commandBuffer, toVkPipelineStage(srcStage), toVkPipelineStage(dstStage), 0, 0, nullptr, barrierCount, vkBarriers.data(), 0, nullptr);
+}
+
+void VulkanCommandBuffer::pipelineBarrier(PipelineStageFlags srcStage, ResourceAccessFlags srcAccess, PipelineStageFlags dstStage, ResourceAccessFlags dstAccess, const ImageBarrier* images, uint32_t imageCount, const BufferBarrier* buffers, uint32_t bufferCount) {
+	VkMemoryBarrier memory{};
+	memory.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	memory.srcAccessMask = toVkAccessFlags(srcAccess);
+	memory.dstAccessMask = toVkAccessFlags(dstAccess);
+
+	uint32_t memoryCount = memory.srcAccessMask || memory.dstAccessMask ? 1 : 0;
+
+	std::vector<VkImageMemoryBarrier> vkImages(imageCount);
+	for (uint32_t i = 0; i < imageCount; i++) {
+		const ImageBarrier& src = images[i];
+		ImageFormat format = src.image->getFormat();
+
+		VkImageMemoryBarrier& barrier = vkImages[i];
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.srcAccessMask = toVkAccessFlags(src.srcAccess);
+		barrier.dstAccessMask = toVkAccessFlags(src.dstAccess);
+		barrier.oldLayout = toVkImageLayout(src.oldLayout);
+		barrier.newLayout = toVkImageLayout(src.newLayout);
+		barrier.srcQueueFamilyIndex = src.srcQueueFamily == UINT32_MAX ? VK_QUEUE_FAMILY_IGNORED : src.srcQueueFamily;
+		barrier.dstQueueFamilyIndex = src.dstQueueFamily == UINT32_MAX ? VK_QUEUE_FAMILY_IGNORED : src.dstQueueFamily;
+		barrier.image = src.image->getImage();
+
+		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		if (hasDepthComponent(format)) {
+			barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+			if (hasStencilComponent(format))
+				barrier.subresourceRange.aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
+		}
+		barrier.subresourceRange.baseMipLevel = 0;
+		barrier.subresourceRange.levelCount = src.image->getMipLevels();
+		barrier.subresourceRange.baseArrayLayer = 0;
+		barrier.subresourceRange.layerCount = 1;
+	}
+
+	std::vector<VkBufferMemoryBarrier> vkBuffers(bufferCount);
+	for (uint32_t i = 0; i < bufferCount; i++) {
+		VkBufferMemoryBarrier& barrier = vkBuffers[i];
+		barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		barrier.srcAccessMask = toVkAccessFlags(buffers[i].srcAccess);
+		barrier.dstAccessMask = toVkAccessFlags(buffers[i].dstAccess);
+		barrier.srcQueueFamilyIndex = buffers[i].srcQueueFamily == UINT32_MAX ? VK_QUEUE_FAMILY_IGNORED : buffers[i].srcQueueFamily;
+		barrier.dstQueueFamilyIndex = buffers[i].dstQueueFamily == UINT32_MAX ? VK_QUEUE_FAMILY_IGNORED : buffers[i].dstQueueFamily;
+		barrier.buffer = buffers[i].buffer->getHandle();
+		barrier.offset = buffers[i].offset;
+		barrier.size = buffers[i].size;
+	}
+
+	if (!memoryCount && !imageCount && !bufferCount)
+		return;
+
+	vkCmdPipelineBarrier(commandBuffer, toVkPipelineStage(srcStage), toVkPipelineStage(dstStage), 0, memoryCount, &memory, bufferCount, vkBuffers.data(), imageCount, vkImages.data());
+}
+
+void VulkanCommandBuffer::drawIndexedIndirect(const VulkanBuffer& buffer, uint64_t offset, uint32_t drawCount, uint32_t stride) {
+	vkCmdDrawIndexedIndirect(commandBuffer, buffer.getHandle(), offset, drawCount, stride);
+}
+
+void VulkanCommandBuffer::drawIndexedIndirectCount(const VulkanBuffer& buffer, uint64_t offset, const VulkanBuffer& countBuffer, uint64_t countOffset, uint32_t maxDrawCount, uint32_t stride) {
+	vkCmdDrawIndexedIndirectCount(commandBuffer, buffer.getHandle(), offset, countBuffer.getHandle(), countOffset, maxDrawCount, stride);
 }
\ No newline at end of file
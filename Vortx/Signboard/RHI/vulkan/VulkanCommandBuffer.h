@@ -1,25 +1,98 @@
 #pragma once
 
 #include "Common/VulkanFwd.h"
+#include "Signboard/RHI/common/PipelineTypes.h"
+#include "Signboard/RHI/common/BufferTypes.h"
+#include "Signboard/RHI/common/DeviceTypes.h"
+#include "Signboard/RHI/common/ImageTypes.h"
+#include "Signboard/RHI/common/RenderPassTypes.h"
 
 class VulkanDevice;
 class VulkanCommandPool;
 class VulkanBuffer;
+class VulkanImage;
 class VulkanSemaphore;
+class VulkanPipeline;
+class VulkanPipelineLayout;
+class VulkanDescriptorSet;
+class VulkanRenderPass;
+class VulkanFrameBuffer;
+
+struct BufferBarrier {
+	const VulkanBuffer* buffer = nullptr;
+	uint64_t offset = 0;
+	uint64_t size = 0;
+
+	ResourceAccessFlags srcAccess{};
+	ResourceAccessFlags dstAccess{};
+
+	uint32_t srcQueueFamily = UINT32_MAX;
+	uint32_t dstQueueFamily = UINT32_MAX;
+};
+
+struct ImageBarrier {
+	const VulkanImage* image = nullptr;
+
+	ImageLayout oldLayout = ImageLayout::Undefined;
+	ImageLayout newLayout = ImageLayout::Undefined;
+
+	ResourceAccessFlags srcAccess{};
+	ResourceAccessFlags dstAccess{};
+
+	uint32_t srcQueueFamily = UINT32_MAX;
+	uint32_t dstQueueFamily = UINT32_MAX;
+};
+
+// binary semaphores ignore the value, stages only apply to waits
+struct SemaphoreSubmit {
+	const VulkanSemaphore* semaphore = nullptr;
+	uint64_t value = 0;
+	PipelineStageFlags stages{};
+};
 
 class VulkanCommandBuffer {
 public:
-	VulkanCommandBuffer(VulkanDevice& device, VulkanCommandPool& commandPool);
+	VulkanCommandBuffer(VulkanDevice& device, VulkanCommandPool& commandPool, CommandBufferLevel level = CommandBufferLevel::Primary);
 	~VulkanCommandBuffer();
 
 	void begin();
 	void end();
 
-	void submit(VulkanSemaphore& waitSemaphore, VulkanSemaphore& signalSemaphore);
+	// secondary buffers continue the given render pass subpass, they carry no fence and are never submitted directly
+	void beginSecondary(VkRenderPass renderPass, uint32_t subpass, VkFramebuffer framebuffer);
+	void executeCommands(const VkCommandBuffer* secondaries, uint32_t count);
+
+	void submit(VulkanSemaphore& waitSemaphore, VulkanSemaphore& signalSemaphore, const VulkanSemaphore* timeline = nullptr, uint64_t timelineWaitValue = 0);
+	void submit(VkQueue queue, const VulkanSemaphore& timeline, uint64_t signalValue);
+	void submit(VkQueue queue, const SemaphoreSubmit* waits, uint32_t waitCount, const SemaphoreSubmit* signals, uint32_t signalCount);
+
+	// inline contents, the whole framebuffer is the render area
+	void beginRenderPass(const VulkanRenderPass& renderPass, const VulkanFrameBuffer& frameBuffer, const ClearValue& clear = ClearValue{});
+	void endRenderPass();
+	void setViewport(uint32_t width, uint32_t height);
+	void setScissor(uint32_t width, uint32_t height);
 
 	void bindVertexBuffer(const VulkanBuffer& buffer);
 	void bindIndexBuffer(const VulkanBuffer& buffer);
-	void drawIndexed(uint32_t indexCount);
+	void drawIndexed(uint32_t indexCount, uint32_t instanceCount = 1, uint32_t firstIndex = 0, int32_t vertexOffset = 0, uint32_t firstInstance = 0);
+
+	void bindPipeline(const VulkanPipeline& pipeline, PipelineType type);
+	void bindDescriptorSet(PipelineType type, const VulkanPipelineLayout& layout, uint32_t setIndex, const VulkanDescriptorSet& set);
+	void bindDescriptorSet(PipelineType type, const VulkanPipelineLayout& layout, uint32_t setIndex, const VulkanDescriptorSet& set, const uint32_t* dynamicOffsets, uint32_t dynamicOffsetCount);
+	void pushConstants(const VulkanPipelineLayout& layout, ShaderStageFlags stages, uint32_t offset, uint32_t size, const void* data);
+
+	void dispatch(uint32_t groupsX, uint32_t groupsY = 1, uint32_t groupsZ = 1);
+	void copyBuffer(const VulkanBuffer& src, const VulkanBuffer& dst, const BufferCopyRegion* regions, uint32_t regionCount);
+	void fillBuffer(const VulkanBuffer& buffer, uint64_t offset, uint64_t size, uint32_t value);
+	void memoryBarrier(PipelineStageFlags srcStage, ResourceAccessFlags srcAccess, PipelineStageFlags dstStage, ResourceAccessFlags dstAccess);
+	void bufferBarrier(const VulkanBuffer& buffer, PipelineStageFlags srcStage, ResourceAccessFlags srcAccess, PipelineStageFlags dstStage, ResourceAccessFlags dstAccess);
+	void bufferBarriers(const BufferBarrier* barriers, uint32_t barrierCount, PipelineStageFlags srcStage, PipelineStageFlags dstStage);
+
+	// one global memory dependency plus the image transitions and buffer ownership transfers, all in a single vkCmdPipelineBarrier
+	void pipelineBarrier(PipelineStageFlags srcStage, ResourceAccessFlags srcAccess, PipelineStageFlags dstStage, ResourceAccessFlags dstAccess, const ImageBarrier* images, uint32_t imageCount, const BufferBarrier* buffers = nullptr, uint32_t bufferCount = 0);
+
+	void drawIndexedIndirect(const VulkanBuffer& buffer, uint64_t offset, uint32_t drawCount, uint32_t stride);
+	void drawIndexedIndirectCount(const VulkanBuffer& buffer, uint64_t offset, const VulkanBuffer& countBuffer, uint64_t countOffset, uint32_t maxDrawCount, uint32_t stride);
 
 	VkCommandBuffer getHandle() const { return commandBuffer; }
 
@@ -4,11 +4,14 @@
 #include "VulkanDevice.h"
 
 VulkanCommandPool::VulkanCommandPool(VulkanDevice& device)
+	: VulkanCommandPool(device, device.getGraphicsQueueFamily()) {}
+
+VulkanCommandPool::VulkanCommandPool(VulkanDevice& device, uint32_t queueFamily)
 	: device(device)
 {
 	VkCommandPoolCreateInfo createInfo{};
 	createInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-	createInfo.queueFamilyIndex = device.getGraphicsQueueFamily();
+	createInfo.queueFamilyIndex = queueFamily;
 	createInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
 
 	if (vkCreateCommandPool(device.getDevice(), &createInfo, nullptr, &commandPool) != VK_SUCCESS) {
@@ -16,6 +19,12 @@ VulkanCommandPool::VulkanCommandPool(VulkanDevice& device)
 	}
 }
 
+void VulkanCommandPool::reset() {
+	if (vkResetCommandPool(device.getDevice(), commandPool, 0) != VK_SUCCESS) {
+		throw std::runtime_error("failed to reset command pool!");
+	}
+}
+
 VulkanCommandPool::~VulkanCommandPool() {
 	if (commandPool) {
 		vkDestroyCommandPool(device.getDevice(), commandPool, nullptr);
@@ -7,8 +7,12 @@ class VulkanDevice;
 class VulkanCommandPool {
 public:
 	explicit VulkanCommandPool(VulkanDevice& device);
+	VulkanCommandPool(VulkanDevice& device, uint32_t queueFamily);
 	~VulkanCommandPool();
 
+	// returns every buffer allocated from the pool to the initial state, none of them may be pending
+	void reset();
+
 	VkCommandPool getHandle() const { return commandPool; }
 
 private:
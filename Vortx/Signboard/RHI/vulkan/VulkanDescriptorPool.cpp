@@ -16,6 +16,7 @@ VulkanDescriptorPool::VulkanDescriptorPool(VulkanDevice& device, const Descripto
 		VkDescriptorPoolSize poolSize{};
 		poolSize.type = toVkDescriptorType(s.type);
 		poolSize.descriptorCount = s.count;
+		sizes.push_back(poolSize);
 	}
 
 	VkDescriptorPoolCreateInfo createInfo{};
@@ -9,18 +9,43 @@
 #include "VulkanImage.h"
 #include "VulkanSampler.h"
 
+#include <deque>
+
 struct VulkanDescriptorWriter::Impl {
 	std::vector<VkWriteDescriptorSet> writes;
-	std::vector<VkDescriptorBufferInfo> bufferInfos;
-	std::vector<VkDescriptorImageInfo> imageInfos;
+	std::deque<VkDescriptorBufferInfo> bufferInfos;
+	std::deque<VkDescriptorImageInfo> imageInfos;
 };
 
+VulkanDescriptorWriter::VulkanDescriptorWriter(VulkanDevice& device)
+	: device(device), impl(new Impl{})
+{
+}
+
 VulkanDescriptorWriter::VulkanDescriptorWriter(VulkanDevice& device, const VulkanDescriptorSet& descriptorSet)
-	: device(device), descriptorSet(descriptorSet)
+	: device(device), impl(new Impl{})
 {
 	if (!descriptorSet.isValid()) {
+		delete impl;
 		throw std::runtime_error("cannot write an invalid descriptor set!");
 	}
+	this->descriptorSet = &descriptorSet;
+}
+
+VulkanDescriptorWriter::~VulkanDescriptorWriter() {
+	delete impl;
+}
+
+VulkanDescriptorWriter& VulkanDescriptorWriter::target(const VulkanDescriptorSet& set) {
+	if (!set.isValid())
+		throw std::runtime_error("cannot write an invalid descriptor set!");
+
+	descriptorSet = &set;
+	return *this;
+}
+
+uint32_t VulkanDescriptorWriter::getWriteCount() const {
+	return static_cast<uint32_t>(impl->writes.size());
 }
 
 VulkanDescriptorWriter& VulkanDescriptorWriter::writeCombinedImageSampler(uint32_t binding, const VulkanImage* image) {
@@ -35,7 +60,32 @@ VulkanDescriptorWriter& VulkanDescriptorWriter::writeCombinedImageSampler(uint32
 
 	VkWriteDescriptorSet write{};
 	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	write.dstSet = descriptorSet;
+	write.dstSet = *descriptorSet;
+	write.dstBinding = binding;
+	write.dstArrayElement = 0;
+	write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	write.descriptorCount = 1;
+	write.pImageInfo = &impl->imageInfos.back();
+
+	impl->writes.push_back(write);
+
+	return *this;
+}
+
+VulkanDescriptorWriter& VulkanDescriptorWriter::writeCombinedImageSampler(uint32_t binding, const VulkanImage* image, const VulkanSampler* sampler, ImageLayout layout, uint32_t mipLevel) {
+	VkDescriptorImageInfo imageInfo{};
+	if (image) {
+		imageInfo.imageLayout = toVkImageLayout(layout);
+		imageInfo.imageView = image->getMipView(mipLevel);
+	}
+	if (sampler)
+		imageInfo.sampler = sampler->getHandle();
+
+	impl->imageInfos.push_back(imageInfo);
+
+	VkWriteDescriptorSet write{};
+	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write.dstSet = *descriptorSet;
 	write.dstBinding = binding;
 	write.dstArrayElement = 0;
 	write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
@@ -47,6 +97,29 @@ VulkanDescriptorWriter& VulkanDescriptorWriter::writeCombinedImageSampler(uint32
 	return *this;
 }
 
+VulkanDescriptorWriter& VulkanDescriptorWriter::writeStorageImage(uint32_t binding, const VulkanImage* image, uint32_t mipLevel) {
+	VkDescriptorImageInfo imageInfo{};
+	if (image) {
+		imageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+		imageInfo.imageView = image->getMipView(mipLevel);
+	}
+
+	impl->imageInfos.push_back(imageInfo);
+
+	VkWriteDescriptorSet write{};
+	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write.dstSet = *descriptorSet;
+	write.dstBinding = binding;
+	write.dstArrayElement = 0;
+	write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+	write.descriptorCount = 1;
+	write.pImageInfo = &impl->imageInfos.back();
+
+	impl->writes.push_back(write);
+
+	return *this;
+}
+
 VulkanDescriptorWriter& VulkanDescriptorWriter::writeUniformBuffer(uint32_t binding, const VulkanBuffer* buffer, uint64_t range = VK_WHOLE_SIZE, uint64_t offset = 0) {
 	VkDescriptorBufferInfo bufferInfo{};
 	if (buffer) {
@@ -59,7 +132,7 @@ VulkanDescriptorWriter& VulkanDescriptorWriter::writeUniformBuffer(uint32_t bind
 
 	VkWriteDescriptorSet write{};
 	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	write.dstSet = descriptorSet;
+	write.dstSet = *descriptorSet;
 	write.dstBinding = binding;
 	write.dstArrayElement = 0;
 	write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
@@ -71,6 +144,30 @@ VulkanDescriptorWriter& VulkanDescriptorWriter::writeUniformBuffer(uint32_t bind
 	return *this;
 }
 
+VulkanDescriptorWriter& VulkanDescriptorWriter::writeUniformBufferDynamic(uint32_t binding, const VulkanBuffer* buffer, uint64_t range) {
+	VkDescriptorBufferInfo bufferInfo{};
+	if (buffer) {
+		bufferInfo.buffer = buffer->getHandle();
+		bufferInfo.offset = 0;
+		bufferInfo.range = range;
+	}
+
+	impl->bufferInfos.push_back(bufferInfo);
+
+	VkWriteDescriptorSet write{};
+	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write.dstSet = *descriptorSet;
+	write.dstBinding = binding;
+	write.dstArrayElement = 0;
+	write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+	write.descriptorCount = 1;
+	write.pBufferInfo = &impl->bufferInfos.back();
+
+	impl->writes.push_back(write);
+
+	return *this;
+}
+
 VulkanDescriptorWriter& VulkanDescriptorWriter::writeStorageBuffer(uint32_t binding, const VulkanBuffer* buffer, uint64_t range = VK_WHOLE_SIZE, uint64_t offset = 0) {
 	VkDescriptorBufferInfo bufferInfo{};
 	if (buffer) {
@@ -83,7 +180,7 @@ VulkanDescriptorWriter& VulkanDescriptorWriter::writeStorageBuffer(uint32_t bind
 
 	VkWriteDescriptorSet write{};
 	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	write.dstSet = descriptorSet;
+	write.dstSet = *descriptorSet;
 	write.dstBinding = binding;
 	write.dstArrayElement = 0;
 	write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;;
@@ -107,7 +204,7 @@ VulkanDescriptorWriter& VulkanDescriptorWriter::writeSampledImage(uint32_t bindi
 
 	VkWriteDescriptorSet write{};
 	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	write.dstSet = descriptorSet;
+	write.dstSet = *descriptorSet;
 	write.dstBinding = binding;
 	write.dstArrayElement = arrayIndex;
 	write.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
@@ -129,7 +226,7 @@ VulkanDescriptorWriter& VulkanDescriptorWriter::writeSampler(uint32_t binding, u
 
 	VkWriteDescriptorSet write{};
 	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	write.dstSet = descriptorSet;
+	write.dstSet = *descriptorSet;
 	write.dstBinding = binding;
 	write.dstArrayElement = arrayIndex;
 	write.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
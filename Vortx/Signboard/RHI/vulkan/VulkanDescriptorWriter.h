@@ -2,6 +2,7 @@
 
 #include "Common/VulkanFwd.h"
 #include "renderSystem/RHI/common/DescriptorTypes.h"
+#include "renderSystem/RHI/common/ImageTypes.h"
 
 #include <vector>
 
@@ -13,20 +14,33 @@ class VulkanSampler;
 
 class VulkanDescriptorWriter {
 public:
+	explicit VulkanDescriptorWriter(VulkanDevice& device);
 	VulkanDescriptorWriter(VulkanDevice& device, const VulkanDescriptorSet& set);
+	~VulkanDescriptorWriter();
+
+	VulkanDescriptorWriter(const VulkanDescriptorWriter&) = delete;
+	VulkanDescriptorWriter& operator=(const VulkanDescriptorWriter&) = delete;
+
+	// following writes go to this set, one commit can span several sets
+	VulkanDescriptorWriter& target(const VulkanDescriptorSet& set);
 
 	VulkanDescriptorWriter& writeCombinedImageSampler(uint32_t binding, const VulkanImage* image);
+	VulkanDescriptorWriter& writeCombinedImageSampler(uint32_t binding, const VulkanImage* image, const VulkanSampler* sampler, ImageLayout layout, uint32_t mipLevel = 0);
+	VulkanDescriptorWriter& writeStorageImage(uint32_t binding, const VulkanImage* image, uint32_t mipLevel = 0);
 	VulkanDescriptorWriter& writeUniformBuffer(uint32_t binding, const VulkanBuffer* buffer, uint64_t range, uint64_t offset = 0);
+	// the final offset is supplied as a dynamic offset when the set is bound
+	VulkanDescriptorWriter& writeUniformBufferDynamic(uint32_t binding, const VulkanBuffer* buffer, uint64_t range);
 	VulkanDescriptorWriter& writeStorageBuffer(uint32_t binding, const VulkanBuffer* buffer, uint64_t range, uint64_t offset = 0);
 	VulkanDescriptorWriter& writeSampledImage(uint32_t binding, uint32_t index, const VulkanImage* image);
 	VulkanDescriptorWriter& writeSampler(uint32_t binding, uint32_t index, const VulkanSampler* sampler);
 
+	uint32_t getWriteCount() const;
 	void commit();
 
 private:
 	VulkanDevice& device;
 
-	const VulkanDescriptorSet& descriptorSet;
+	const VulkanDescriptorSet* descriptorSet = nullptr;
 
 	struct Impl;
 	Impl* impl;
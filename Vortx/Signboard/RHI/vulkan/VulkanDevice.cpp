@@ -3,9 +3,19 @@
 #include "Common/VulkanCommon.h"
 #include "TypeMap/VulkanDeviceTypeMap.h"
 
+#include "VulkanMemoryAllocator.h"
+
 #include <GLFW/glfw3.h>
 #include <vector>
 #include <cstring>
+#include <algorithm>
+
+static bool hasExtension(const std::vector<VkExtensionProperties>& extensions, const char* name) {
+	for (const VkExtensionProperties& extension : extensions)
+		if (std::strcmp(extension.extensionName, name) == 0)
+			return true;
+	return false;
+}
 
 VulkanDevice::VulkanDevice(VkInstance instance, GLFWwindow* window)
 	: instance(instance)
@@ -13,6 +23,8 @@ VulkanDevice::VulkanDevice(VkInstance instance, GLFWwindow* window)
 	createSurface(window);
 	pickPhysicalDevice();
 	createLogicalDevice();
+
+	allocator = std::make_unique<VulkanMemoryAllocator>(*this);
 }
 
 VulkanDevice::~VulkanDevice() {
@@ -20,8 +32,11 @@ VulkanDevice::~VulkanDevice() {
 }
 
 void VulkanDevice::shutdown() {
+	allocator.reset();
+
 	if (device) {
 		vkDestroyDevice(device, nullptr);
+		device = nullptr;
 	}
 }
 
@@ -76,25 +91,59 @@ void VulkanDevice::accquireQueueFamilies(VkPhysicalDevice device) {
 	std::vector<VkQueueFamilyProperties> families(queueFamilyCount);
 	vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, families.data());
 
+	uint32_t transferOnlyFamily = UINT32_MAX;
+	uint32_t nonGraphicsTransferFamily = UINT32_MAX;
+	uint32_t computeOnlyFamily = UINT32_MAX;
+
 	for (uint32_t i = 0; i < queueFamilyCount; i++) {
-		if (families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+		VkQueueFlags flags = families[i].queueFlags;
+
+		if ((flags & VK_QUEUE_GRAPHICS_BIT) && graphicsQueueFamily == UINT32_MAX) {
 			graphicsQueueFamily = i;
 		}
 
 		VkBool32  presentSupported = VK_FALSE;
-		vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface, &presentSupported);
-		if (presentSupported) {
+		vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupported);
+		if (presentSupported && presentQueueFamily == UINT32_MAX) {
 			presentQueueFamily = i;
 		}
+
+		// dedicated DMA queues advertise transfer without graphics or compute
+		if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & VK_QUEUE_GRAPHICS_BIT)) {
+			if (!(flags & VK_QUEUE_COMPUTE_BIT) && transferOnlyFamily == UINT32_MAX)
+				transferOnlyFamily = i;
+			else if (nonGraphicsTransferFamily == UINT32_MAX)
+				nonGraphicsTransferFamily = i;
+		}
+
+		// async compute queues advertise compute without graphics
+		if ((flags & VK_QUEUE_COMPUTE_BIT) && !(flags & VK_QUEUE_GRAPHICS_BIT) && computeOnlyFamily == UINT32_MAX)
+			computeOnlyFamily = i;
+	}
+
+	if (graphicsQueueFamily == UINT32_MAX) {
+		throw std::runtime_error("failed to find graphics queue family!");
 	}
-	throw std::runtime_error("failed to find graphics queue family!");
+
+	if (transferOnlyFamily != UINT32_MAX)
+		transferQueueFamily = transferOnlyFamily;
+	else if (nonGraphicsTransferFamily != UINT32_MAX)
+		transferQueueFamily = nonGraphicsTransferFamily;
+	else
+		transferQueueFamily = graphicsQueueFamily;
+
+	computeQueueFamily = computeOnlyFamily != UINT32_MAX ? computeOnlyFamily : graphicsQueueFamily;
 }
 
 void VulkanDevice::createLogicalDevice() {
 	float priority = 1.0f;
 
 	std::vector<VkDeviceQueueCreateInfo> queueInfos;
-	std::vector<uint32_t> uniqueFamilies = { graphicsQueueFamily, presentQueueFamily };
+	std::vector<uint32_t> uniqueFamilies = { graphicsQueueFamily };
+	for (uint32_t family : { presentQueueFamily, transferQueueFamily, computeQueueFamily }) {
+		if (std::find(uniqueFamilies.begin(), uniqueFamilies.end(), family) == uniqueFamilies.end())
+			uniqueFamilies.push_back(family);
+	}
 
 	for (uint32_t family : uniqueFamilies) {
 		VkDeviceQueueCreateInfo queueInfo{};
@@ -105,13 +154,71 @@ void VulkanDevice::createLogicalDevice() {
 		queueInfos.push_back(queueInfo);
 	}
 
-	VkPhysicalDeviceFeatures features{};
+	uint32_t extensionCount = 0;
+	vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
+	std::vector<VkExtensionProperties> available(extensionCount);
+	vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, available.data());
+
+	bool pipelineLibraryAvailable = hasExtension(available, VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME) && hasExtension(available, VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+
+	VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT supportedLibrary{};
+	supportedLibrary.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+
+	VkPhysicalDeviceVulkan12Features supported12{};
+	supported12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+	supported12.pNext = pipelineLibraryAvailable ? &supportedLibrary : nullptr;
+
+	VkPhysicalDeviceFeatures2 supported{};
+	supported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	supported.pNext = &supported12;
+	vkGetPhysicalDeviceFeatures2(physicalDevice, &supported);
+
+	multiDrawIndirectSupported = supported.features.multiDrawIndirect && supported.features.drawIndirectFirstInstance;
+	drawIndirectCountSupported = multiDrawIndirectSupported && supported12.drawIndirectCount;
+	pipelineLibrarySupported = pipelineLibraryAvailable && supportedLibrary.graphicsPipelineLibrary;
+
+	VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT libraryProperties{};
+	libraryProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_PROPERTIES_EXT;
+
+	VkPhysicalDeviceProperties2 properties2{};
+	properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	properties2.pNext = pipelineLibrarySupported ? &libraryProperties : nullptr;
+	vkGetPhysicalDeviceProperties2(physicalDevice, &properties2);
+
+	const VkPhysicalDeviceProperties& properties = properties2.properties;
+	minUniformBufferOffsetAlignment = std::max<uint64_t>(properties.limits.minUniformBufferOffsetAlignment, 1);
+	maxUniformBufferRange = properties.limits.maxUniformBufferRange;
+	pipelineLibraryFastLinking = pipelineLibrarySupported && libraryProperties.graphicsPipelineLibraryFastLinking;
+
+	std::vector<const char*> extensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+	if (pipelineLibrarySupported) {
+		extensions.push_back(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+		extensions.push_back(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+	}
+
+	VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT libraryFeatures{};
+	libraryFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+	libraryFeatures.graphicsPipelineLibrary = VK_TRUE;
+
+	VkPhysicalDeviceVulkan12Features features12{};
+	features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+	features12.drawIndirectCount = drawIndirectCountSupported ? VK_TRUE : VK_FALSE;
+	features12.timelineSemaphore = VK_TRUE;
+	features12.pNext = pipelineLibrarySupported ? &libraryFeatures : nullptr;
+
+	VkPhysicalDeviceFeatures2 features{};
+	features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	features.pNext = &features12;
+	features.features.multiDrawIndirect = multiDrawIndirectSupported ? VK_TRUE : VK_FALSE;
+	features.features.drawIndirectFirstInstance = multiDrawIndirectSupported ? VK_TRUE : VK_FALSE;
 
 	VkDeviceCreateInfo createInfo{};
 	createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+	createInfo.pNext = &features;
 	createInfo.pQueueCreateInfos = queueInfos.data();
 	createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueInfos.size());
-	createInfo.pEnabledFeatures = &features;
+	createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+	createInfo.ppEnabledExtensionNames = extensions.data();
 
 	if (vkCreateDevice(physicalDevice, &createInfo, nullptr, &device) != VK_SUCCESS) {
 		throw std::runtime_error("failed to create logical device!");
@@ -119,6 +226,8 @@ void VulkanDevice::createLogicalDevice() {
 
 	vkGetDeviceQueue(device, graphicsQueueFamily, 0, &graphicsQueue);
 	vkGetDeviceQueue(device, presentQueueFamily, 0, &presentQueue);
+	vkGetDeviceQueue(device, transferQueueFamily, 0, &transferQueue);
+	vkGetDeviceQueue(device, computeQueueFamily, 0, &computeQueue);
 }
 
 uint32_t VulkanDevice::findMemoryType(uint32_t typeFilter, MemoryPropertyFlags properties) const {
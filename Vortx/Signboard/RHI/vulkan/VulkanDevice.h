@@ -4,8 +4,10 @@
 #include "renderSystem/RHI/common/DeviceTypes.h"
 
 #include <vector>
+#include <memory>
 
 struct GLFWwindow;
+class VulkanMemoryAllocator;
 
 class VulkanDevice {
 public:
@@ -21,11 +23,30 @@ public:
 	uint32_t getGraphicsQueueFamily() const { return graphicsQueueFamily; }
 	VkQueue getPresentQueue() const { return presentQueue; }
 	uint32_t getPresentQueueFamily() const { return presentQueueFamily; }
+	VkQueue getTransferQueue() const { return transferQueue; }
+	uint32_t getTransferQueueFamily() const { return transferQueueFamily; }
+	VkQueue getComputeQueue() const { return computeQueue; }
+	uint32_t getComputeQueueFamily() const { return computeQueueFamily; }
+
+	bool hasDedicatedTransferQueue() const { return transferQueueFamily != graphicsQueueFamily; }
+	bool hasAsyncComputeQueue() const { return computeQueueFamily != graphicsQueueFamily; }
 
 	VkSurfaceKHR getSurface() const { return surface; }
 
+	bool supportsDrawIndirectCount() const { return drawIndirectCountSupported; }
+	bool supportsMultiDrawIndirect() const { return multiDrawIndirectSupported; }
+
+	// VK_EXT_graphics_pipeline_library, fast linking tells whether an unoptimised link is cheap enough for draw time
+	bool supportsPipelineLibrary() const { return pipelineLibrarySupported; }
+	bool supportsPipelineLibraryFastLinking() const { return pipelineLibraryFastLinking; }
+
+	uint64_t getMinUniformBufferOffsetAlignment() const { return minUniformBufferOffsetAlignment; }
+	uint32_t getMaxUniformBufferRange() const { return maxUniformBufferRange; }
+
 	uint32_t findMemoryType(uint32_t typeFilter, MemoryPropertyFlags properties) const;
 
+	VulkanMemoryAllocator& getAllocator() { return *allocator; }
+
 	void waitIdle();
 
 private:
@@ -48,4 +69,20 @@ private:
 
 	VkQueue presentQueue = nullptr;
 	uint32_t presentQueueFamily = UINT32_MAX;
+
+	VkQueue transferQueue = nullptr;
+	uint32_t transferQueueFamily = UINT32_MAX;
+
+	VkQueue computeQueue = nullptr;
+	uint32_t computeQueueFamily = UINT32_MAX;
+
+	bool drawIndirectCountSupported = false;
+	bool multiDrawIndirectSupported = false;
+	bool pipelineLibrarySupported = false;
+	bool pipelineLibraryFastLinking = false;
+
+	uint64_t minUniformBufferOffsetAlignment = 256;
+	uint32_t maxUniformBufferRange = 16384;
+
+	std::unique_ptr<VulkanMemoryAllocator> allocator;
 };
\ No newline at end of file
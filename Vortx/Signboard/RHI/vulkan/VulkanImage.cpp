@@ -8,7 +8,7 @@
 #include "VulkanBuffer.h"
 
 VkImageAspectFlags chooseAspectMask(ImageFormat format, ImageLayout layout) {
-	if (layout == ImageLayout::DepthStencilAttachment) {
+	if (layout == ImageLayout::DepthStencilAttachment || hasDepthComponent(format)) {
 		VkImageAspectFlags aspect = VK_IMAGE_ASPECT_DEPTH_BIT;
 		if (hasStencilComponent(format)) {
 			aspect |= VK_IMAGE_ASPECT_STENCIL_BIT;
@@ -32,6 +32,42 @@ void getAccessFlags(ImageLayout oldLayout, ImageLayout newLayout, VkAccessFlags&
 	else if (oldLayout == ImageLayout::Undefined && newLayout == ImageLayout::ColorAttachment) {
 		dstAccess = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
 	}
+	else if (oldLayout == ImageLayout::Undefined && newLayout == ImageLayout::General) {
+		dstAccess = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	}
+	else if (oldLayout == ImageLayout::DepthStencilAttachment && newLayout == ImageLayout::ShaderReadOnly) {
+		srcAccess = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		dstAccess = VK_ACCESS_SHADER_READ_BIT;
+	}
+	else if (oldLayout == ImageLayout::ShaderReadOnly && newLayout == ImageLayout::DepthStencilAttachment) {
+		srcAccess = VK_ACCESS_SHADER_READ_BIT;
+		dstAccess = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	}
+}
+
+// the accesses the given stages can perform. a transition recorded on a compute queue keeps only what its compute
+// stages can name, the attachment side is covered by the barrier or queue transfer that orders the pass
+VkAccessFlags accessForStages(VkPipelineStageFlags stages) {
+	if (stages & VK_PIPELINE_STAGE_ALL_COMMANDS_BIT)
+		return ~VkAccessFlags(0);
+
+	VkAccessFlags access = 0;
+	if (stages & VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT)
+		access |= VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+	if (stages & VK_PIPELINE_STAGE_VERTEX_INPUT_BIT)
+		access |= VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+	if (stages & (VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT))
+		access |= VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	if (stages & (VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT))
+		access |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	if (stages & VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT)
+		access |= VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	if (stages & VK_PIPELINE_STAGE_TRANSFER_BIT)
+		access |= VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+	if (stages & VK_PIPELINE_STAGE_HOST_BIT)
+		access |= VK_ACCESS_HOST_READ_BIT | VK_ACCESS_HOST_WRITE_BIT;
+
+	return access;
 }
 
 VulkanImage::VulkanImage(VulkanDevice& device, const ImageDesc& desc, VulkanSampler* sampler = nullptr)
@@ -40,9 +76,13 @@ VulkanImage::VulkanImage(VulkanDevice& device, const ImageDesc& desc, VulkanSamp
 {
 	format = desc.format;
 	extent = { desc.width, desc.height };
+	mipLevels = desc.mipLevels ? desc.mipLevels : 1;
 
 	createImage(extent, desc.usage);
-	allocateMemory();
+	if (desc.deferMemory)
+		return;
+
+	allocateMemory(desc.lifetime, desc.frameIndex);
 	createImageView();
 }
 
@@ -53,13 +93,15 @@ VulkanImage::VulkanImage(VkImage image, ImageFormat format, ImageLayout layout)
 }
 
 VulkanImage::VulkanImage(VulkanImage&& other) noexcept
-	: device(other.device), image(other.image), memory(other.memory), imageView(other.imageView)
+	: device(other.device), image(other.image), allocation(other.allocation), imageView(other.imageView), mipViews(std::move(other.mipViews))
 {
 	format = other.format;
 	layout = other.layout;
+	extent = other.extent;
+	mipLevels = other.mipLevels;
 
 	other.image = VK_NULL_HANDLE;
-	other.memory = VK_NULL_HANDLE;
+	other.allocation = MemoryAllocation{};
 	other.imageView = VK_NULL_HANDLE;
 }
 
@@ -71,14 +113,18 @@ VulkanImage& VulkanImage::operator=(VulkanImage&& other) noexcept {
 
 	device = other.device;
 	image = other.image;
-	memory = other.memory;
+	allocation = other.allocation;
 	imageView = other.imageView;
+	mipViews = std::move(other.mipViews);
 	format = other.format;
 	layout = other.layout;
+	extent = other.extent;
+	mipLevels = other.mipLevels;
 
 	other.image = nullptr;
-	other.memory = nullptr;
+	other.allocation = MemoryAllocation{};
 	other.imageView = nullptr;
+	return *this;
 }
 
 
@@ -89,35 +135,52 @@ VulkanImage::~VulkanImage() {
 void VulkanImage::destroy() {
 	VkDevice vkDevice = device.getDevice();
 
+	for (VkImageView view : mipViews) {
+		vkDestroyImageView(vkDevice, view, nullptr);
+	}
+	mipViews.clear();
+
 	if (imageView) {
 		vkDestroyImageView(vkDevice, imageView, nullptr);
 	}
 	if (image) {
 		vkDestroyImage(vkDevice, image, nullptr);
 	}
-	if (memory) {
-		vkFreeMemory(vkDevice, memory, nullptr);
-	}
+	device.getAllocator().free(allocation);
 }
 
-void VulkanImage::copyFromBuffer(VulkanCommandBuffer& cmd, const VulkanBuffer& src) {
+void VulkanImage::copyFromBuffer(VulkanCommandBuffer& cmd, const VulkanBuffer& src, uint64_t srcOffset, uint32_t firstRow, uint32_t rowCount) {
 	if (layout != ImageLayout::TransferDst)
 		transitionLayout(cmd, ImageLayout::TransferDst, PipelineStage::TopOfPipe, PipelineStage::Transfer);
 
 	VkBufferImageCopy region{};
-	region.bufferOffset = 0;
+	region.bufferOffset = srcOffset;
 	region.bufferRowLength = 0;
 	region.bufferImageHeight = 0;
 	region.imageSubresource.aspectMask = chooseAspectMask(format, layout);
 	region.imageSubresource.mipLevel = 0;
 	region.imageSubresource.baseArrayLayer = 0;
 	region.imageSubresource.layerCount = 1;
-	region.imageOffset = { 0,0,0 };
-	region.imageExtent = { extent.width, extent.height, 1 };
+	region.imageOffset = { 0, static_cast<int32_t>(firstRow), 0 };
+	region.imageExtent = { extent.width, rowCount ? rowCount : extent.height - firstRow, 1 };
 
 	vkCmdCopyBufferToImage(cmd.getHandle(), src.getHandle(), image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
 }
 
+MemoryRequirements VulkanImage::getMemoryRequirements() const {
+	VkMemoryRequirements memReq{};
+	vkGetImageMemoryRequirements(device.getDevice(), image, &memReq);
+
+	return MemoryRequirements{ memReq.size, memReq.alignment, memReq.memoryTypeBits };
+}
+
+void VulkanImage::bindMemory(const MemoryAllocation& memory, uint64_t offset) {
+	if (vkBindImageMemory(device.getDevice(), image, memory.memory, memory.offset + offset) != VK_SUCCESS) {
+		throw std::runtime_error("failed to bind image memory!");
+	}
+	createImageView();
+}
+
 void VulkanImage::assignSampler(VulkanSampler* s) {
 	sampler = s;
 }
@@ -140,7 +203,7 @@ void VulkanImage::transitionLayout(VulkanCommandBuffer& cmd, ImageLayout newLayo
 	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
 
 	barrier.subresourceRange.baseMipLevel = 0;
-	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.levelCount = mipLevels;
 	barrier.subresourceRange.baseArrayLayer = 0;
 	barrier.subresourceRange.layerCount = 1;
 
@@ -149,12 +212,61 @@ void VulkanImage::transitionLayout(VulkanCommandBuffer& cmd, ImageLayout newLayo
 	barrier.srcAccessMask = 0;
 	barrier.dstAccessMask = 0;
 	getAccessFlags(layout, newLayout, barrier.srcAccessMask, barrier.dstAccessMask);
+	barrier.srcAccessMask &= accessForStages(toVkPipelineStage(srcStage));
+	barrier.dstAccessMask &= accessForStages(toVkPipelineStage(dstStage));
 
 	vkCmdPipelineBarrier(cmd.getHandle(), toVkPipelineStage(srcStage), toVkPipelineStage(dstStage), 0, 0, nullptr, 0, nullptr, 1, &barrier);
 
 	layout = newLayout;
 }
 
+void VulkanImage::releaseOwnership(VulkanCommandBuffer& cmd, ImageLayout newLayout, uint32_t srcQueueFamily, uint32_t dstQueueFamily, PipelineStageFlags srcStage) {
+	VkImageMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.oldLayout = toVkImageLayout(layout);
+	barrier.newLayout = toVkImageLayout(newLayout);
+	barrier.image = image;
+
+	barrier.srcQueueFamilyIndex = srcQueueFamily;
+	barrier.dstQueueFamilyIndex = dstQueueFamily;
+
+	barrier.subresourceRange.baseMipLevel = 0;
+	barrier.subresourceRange.levelCount = mipLevels;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = 1;
+	barrier.subresourceRange.aspectMask = chooseAspectMask(format, newLayout);
+
+	// the destination access is ignored on a release, the acquiring queue supplies it
+	VkAccessFlags dstAccess = 0;
+	getAccessFlags(layout, newLayout, barrier.srcAccessMask, dstAccess);
+
+	vkCmdPipelineBarrier(cmd.getHandle(), toVkPipelineStage(srcStage), VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+	layout = newLayout;
+}
+
+void VulkanImage::acquireOwnership(VulkanCommandBuffer& cmd, ImageLayout oldLayout, uint32_t srcQueueFamily, uint32_t dstQueueFamily, PipelineStageFlags dstStage) {
+	VkImageMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.oldLayout = toVkImageLayout(oldLayout);
+	barrier.newLayout = toVkImageLayout(layout);
+	barrier.image = image;
+
+	barrier.srcQueueFamilyIndex = srcQueueFamily;
+	barrier.dstQueueFamilyIndex = dstQueueFamily;
+
+	barrier.subresourceRange.baseMipLevel = 0;
+	barrier.subresourceRange.levelCount = mipLevels;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = 1;
+	barrier.subresourceRange.aspectMask = chooseAspectMask(format, layout);
+
+	VkAccessFlags srcAccess = 0;
+	getAccessFlags(oldLayout, layout, srcAccess, barrier.dstAccessMask);
+
+	vkCmdPipelineBarrier(cmd.getHandle(), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, toVkPipelineStage(dstStage), 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
 void VulkanImage::createImage(ImageExtent2D extent, ImageUsageFlags usage) {
 
 	VkImageCreateInfo imageInfo{};
@@ -163,7 +275,7 @@ void VulkanImage::createImage(ImageExtent2D extent, ImageUsageFlags usage) {
 	imageInfo.extent.width = extent.width;
 	imageInfo.extent.height = extent.height;
 	imageInfo.extent.depth = 1;
-	imageInfo.mipLevels = 1;
+	imageInfo.mipLevels = mipLevels;
 	imageInfo.arrayLayers = 1;
 	imageInfo.format = toVkFormat(format);
 	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
@@ -177,25 +289,21 @@ void VulkanImage::createImage(ImageExtent2D extent, ImageUsageFlags usage) {
 	}
 }
 
-void VulkanImage::allocateMemory() {
-	VkDevice vkDevice = device.getDevice();
-
-	VkMemoryRequirements memReq;
-	vkGetImageMemoryRequirements(vkDevice, image, &memReq);
+void VulkanImage::allocateMemory(MemoryLifetime lifetime, uint32_t frameIndex) {
+	allocation = device.getAllocator().allocateImage(image, MemoryProperty::DeviceLocal, lifetime, frameIndex);
+}
 
-	VkMemoryAllocateInfo allocInfo{};
-	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	allocInfo.allocationSize = memReq.size;
-	allocInfo.memoryTypeIndex = device.findMemoryType(memReq.memoryTypeBits, MemoryProperty::DeviceLocal);
+void VulkanImage::createImageView() {
+	imageView = createView(0, mipLevels);
 
-	if (vkAllocateMemory(vkDevice, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
-		throw std::runtime_error("failed to allocate memory to an image!");
+	if (mipLevels > 1) {
+		mipViews.resize(mipLevels);
+		for (uint32_t level = 0; level < mipLevels; level++)
+			mipViews[level] = createView(level, 1);
 	}
-
-	vkBindImageMemory(vkDevice, image, memory, 0);
 }
 
-void VulkanImage::createImageView() {
+VkImageView VulkanImage::createView(uint32_t baseMip, uint32_t levelCount) {
 	VkImageAspectFlags aspect{};
 
 	aspect = chooseAspectMask(format, layout);
@@ -206,12 +314,14 @@ void VulkanImage::createImageView() {
 	viewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
 	viewCreateInfo.format = toVkFormat(format);
 	viewCreateInfo.subresourceRange.aspectMask = aspect;
-	viewCreateInfo.subresourceRange.baseMipLevel = 0;
-	viewCreateInfo.subresourceRange.levelCount = 1;
+	viewCreateInfo.subresourceRange.baseMipLevel = baseMip;
+	viewCreateInfo.subresourceRange.levelCount = levelCount;
 	viewCreateInfo.subresourceRange.baseArrayLayer = 0;
 	viewCreateInfo.subresourceRange.layerCount = 1;
 
-	if (vkCreateImageView(device.getDevice(), &viewCreateInfo, nullptr, &imageView) != VK_SUCCESS) {
+	VkImageView view = nullptr;
+	if (vkCreateImageView(device.getDevice(), &viewCreateInfo, nullptr, &view) != VK_SUCCESS) {
 		throw std::runtime_error("failed to create an image's view!");
 	}
+	return view;
 }
\ No newline at end of file
@@ -3,6 +3,10 @@
 #include "Common/VulkanFwd.h"
 #include "Signboard/RHI/common/ImageTypes.h"
 
+#include "VulkanMemoryAllocator.h"
+
+#include <vector>
+
 class VulkanDevice;
 class VulkanCommandBuffer;
 class VulkanSampler;
@@ -24,20 +28,34 @@ public:
 
 	VkImage getImage() const { return image; }
 	VkImageView getView() const { return imageView; }
+	VkImageView getMipView(uint32_t level) const { return mipViews.empty() ? imageView : mipViews[level]; }
 	VkSampler getSampler() const;
 
 	ImageFormat getFormat() const { return format; }
 	ImageLayout getLayout() const { return layout; }
+	ImageExtent2D getExtent() const { return extent; }
+	uint32_t getMipLevels() const { return mipLevels; }
+
+	void copyFromBuffer(VulkanCommandBuffer& cmd, const VulkanBuffer& src, uint64_t srcOffset = 0, uint32_t firstRow = 0, uint32_t rowCount = 0);
 
-	void copyFromBuffer(VulkanCommandBuffer& cmd, const VulkanBuffer& src);
+	// deferred images are bound into memory owned by the caller, which may alias it with other images
+	MemoryRequirements getMemoryRequirements() const;
+	void bindMemory(const MemoryAllocation& memory, uint64_t offset);
+
+	// for barriers recorded outside transitionLayout
+	void setLayout(ImageLayout newLayout) { layout = newLayout; }
 
 	void assignSampler(VulkanSampler* sampler);
 	void transitionLayout(VulkanCommandBuffer& commandBuffer, ImageLayout newLayout, PipelineStageFlags srcStage, PipelineStageFlags dstStage);
 
+	void releaseOwnership(VulkanCommandBuffer& cmd, ImageLayout newLayout, uint32_t srcQueueFamily, uint32_t dstQueueFamily, PipelineStageFlags srcStage);
+	void acquireOwnership(VulkanCommandBuffer& cmd, ImageLayout oldLayout, uint32_t srcQueueFamily, uint32_t dstQueueFamily, PipelineStageFlags dstStage);
+
 private:
 	void createImage(ImageExtent2D extent, ImageUsageFlags usage);
 	void createImageView();
-	void allocateMemory();
+	VkImageView createView(uint32_t baseMip, uint32_t levelCount);
+	void allocateMemory(MemoryLifetime lifetime, uint32_t frameIndex);
 
 private:
 	VulkanDevice& device;
@@ -47,9 +65,11 @@ private:
 	ImageFormat format = ImageFormat::RGBA8;
 	ImageLayout layout = ImageLayout::Undefined;
 	ImageExtent2D extent;
+	uint32_t mipLevels = 1;
 
 	VkImage image = nullptr;
-	VkDeviceMemory memory = nullptr;
+	MemoryAllocation allocation;
 	VkImageView imageView = nullptr;
+	std::vector<VkImageView> mipViews;
 
 };
\ No newline at end of file
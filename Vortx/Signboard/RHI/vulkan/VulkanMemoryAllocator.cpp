@@ -0,0 +1,570 @@
+#include "VulkanMemoryAllocator.h"
+
+#include "Common/VulkanCommon.h"
+
+#include "VulkanDevice.h"
+
+#include <algorithm>
+
+static constexpr uint32_t NONE = UINT32_MAX;
+
+// TLSF size classes: GRANULE-sized linear classes below SMALL_SIZE, then 32 subdivisions per power of two
+static constexpr uint64_t GRANULE = 256;
+static constexpr uint32_t SL_LOG2 = 5;
+static constexpr uint32_t SL_COUNT = 1u << SL_LOG2;
+static constexpr uint32_t FL_SHIFT = SL_LOG2 + 8;
+static constexpr uint32_t FL_COUNT = 32;
+static constexpr uint64_t SMALL_SIZE = 1ull << FL_SHIFT;
+
+static uint64_t alignUp(uint64_t value, uint64_t alignment) {
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+static uint32_t highestBit(uint64_t value) {
+	uint32_t bit = 0;
+	while (value >>= 1) bit++;
+	return bit;
+}
+
+static uint32_t lowestBit(uint32_t value) {
+	uint32_t bit = 0;
+	while (!(value & 1u)) {
+		value >>= 1;
+		bit++;
+	}
+	return bit;
+}
+
+static void mapping(uint64_t size, uint32_t& fl, uint32_t& sl) {
+	if (size < SMALL_SIZE) {
+		fl = 0;
+		sl = static_cast<uint32_t>(size / GRANULE);
+		return;
+	}
+
+	uint32_t bit = highestBit(size);
+	sl = static_cast<uint32_t>(size >> (bit - SL_LOG2)) ^ SL_COUNT;
+	fl = bit - FL_SHIFT + 1;
+}
+
+struct VulkanMemoryAllocator::Block {
+	struct Node {
+		uint64_t offset = 0;
+		uint64_t size = 0;
+		uint32_t prevPhysical = NONE;
+		uint32_t nextPhysical = NONE;
+		uint32_t prevFree = NONE;
+		uint32_t nextFree = NONE;
+		bool free = false;
+	};
+
+	VkDeviceMemory memory = nullptr;
+	uint64_t size = 0;
+	void* mapped = nullptr;
+
+	uint64_t usedBytes = 0;
+	uint32_t allocationCount = 0;
+
+	std::vector<Node> nodes;
+	std::vector<uint32_t> unusedNodes;
+
+	uint32_t flBitmap = 0;
+	uint32_t slBitmap[FL_COUNT] = {};
+	uint32_t heads[FL_COUNT][SL_COUNT];
+
+	Block(VkDeviceMemory memory, uint64_t size, void* mapped)
+		: memory(memory), size(size), mapped(mapped)
+	{
+		for (uint32_t fl = 0; fl < FL_COUNT; fl++)
+			for (uint32_t sl = 0; sl < SL_COUNT; sl++)
+				heads[fl][sl] = NONE;
+
+		Node whole;
+		whole.size = size;
+		whole.free = true;
+		nodes.push_back(whole);
+		insertFree(0);
+	}
+
+	uint32_t newNode() {
+		if (!unusedNodes.empty()) {
+			uint32_t index = unusedNodes.back();
+			unusedNodes.pop_back();
+			nodes[index] = Node{};
+			return index;
+		}
+		nodes.push_back(Node{});
+		return static_cast<uint32_t>(nodes.size() - 1);
+	}
+
+	void insertFree(uint32_t index) {
+		uint32_t fl, sl;
+		mapping(nodes[index].size, fl, sl);
+
+		Node& node = nodes[index];
+		node.free = true;
+		node.prevFree = NONE;
+		node.nextFree = heads[fl][sl];
+		if (node.nextFree != NONE)
+			nodes[node.nextFree].prevFree = index;
+
+		heads[fl][sl] = index;
+		flBitmap |= 1u << fl;
+		slBitmap[fl] |= 1u << sl;
+	}
+
+	void removeFree(uint32_t index) {
+		uint32_t fl, sl;
+		mapping(nodes[index].size, fl, sl);
+
+		Node& node = nodes[index];
+		if (node.prevFree != NONE) nodes[node.prevFree].nextFree = node.nextFree;
+		else heads[fl][sl] = node.nextFree;
+		if (node.nextFree != NONE) nodes[node.nextFree].prevFree = node.prevFree;
+
+		node.prevFree = NONE;
+		node.nextFree = NONE;
+		node.free = false;
+
+		if (heads[fl][sl] == NONE) {
+			slBitmap[fl] &= ~(1u << sl);
+			if (!slBitmap[fl])
+				flBitmap &= ~(1u << fl);
+		}
+	}
+
+	uint32_t findFree(uint64_t request) const {
+		if (request >= SMALL_SIZE)
+			request += (1ull << (highestBit(request) - SL_LOG2)) - 1;
+
+		uint32_t fl, sl;
+		mapping(request, fl, sl);
+		if (fl >= FL_COUNT)
+			return NONE;
+
+		uint32_t slMap = slBitmap[fl] & (~0u << sl);
+		if (!slMap) {
+			uint32_t flMap = fl + 1 < FL_COUNT ? flBitmap & (~0u << (fl + 1)) : 0;
+			if (!flMap)
+				return NONE;
+
+			fl = lowestBit(flMap);
+			slMap = slBitmap[fl];
+		}
+		return heads[fl][lowestBit(slMap)];
+	}
+
+	uint32_t allocate(uint64_t request, uint64_t alignment) {
+		request = alignUp(request, GRANULE);
+		alignment = std::max(alignment, GRANULE);
+
+		uint32_t index = findFree(request + alignment - GRANULE);
+		if (index == NONE)
+			return NONE;
+
+		removeFree(index);
+
+		uint64_t aligned = alignUp(nodes[index].offset, alignment);
+		uint64_t padding = aligned - nodes[index].offset;
+		if (padding) {
+			uint32_t front = newNode();
+			nodes[front].offset = nodes[index].offset;
+			nodes[front].size = padding;
+			nodes[front].prevPhysical = nodes[index].prevPhysical;
+			nodes[front].nextPhysical = index;
+			if (nodes[front].prevPhysical != NONE)
+				nodes[nodes[front].prevPhysical].nextPhysical = front;
+
+			nodes[index].prevPhysical = front;
+			nodes[index].offset = aligned;
+			nodes[index].size -= padding;
+			insertFree(front);
+		}
+
+		if (nodes[index].size > request) {
+			uint32_t back = newNode();
+			nodes[back].offset = nodes[index].offset + request;
+			nodes[back].size = nodes[index].size - request;
+			nodes[back].prevPhysical = index;
+			nodes[back].nextPhysical = nodes[index].nextPhysical;
+			if (nodes[back].nextPhysical != NONE)
+				nodes[nodes[back].nextPhysical].prevPhysical = back;
+
+			nodes[index].nextPhysical = back;
+			nodes[index].size = request;
+			insertFree(back);
+		}
+
+		usedBytes += nodes[index].size;
+		allocationCount++;
+		return index;
+	}
+
+	void release(uint32_t index) {
+		usedBytes -= nodes[index].size;
+		allocationCount--;
+
+		uint32_t prev = nodes[index].prevPhysical;
+		if (prev != NONE && nodes[prev].free) {
+			removeFree(prev);
+			nodes[prev].size += nodes[index].size;
+			nodes[prev].nextPhysical = nodes[index].nextPhysical;
+			if (nodes[prev].nextPhysical != NONE)
+				nodes[nodes[prev].nextPhysical].prevPhysical = prev;
+
+			unusedNodes.push_back(index);
+			index = prev;
+		}
+
+		uint32_t next = nodes[index].nextPhysical;
+		if (next != NONE && nodes[next].free) {
+			removeFree(next);
+			nodes[index].size += nodes[next].size;
+			nodes[index].nextPhysical = nodes[next].nextPhysical;
+			if (nodes[index].nextPhysical != NONE)
+				nodes[nodes[index].nextPhysical].prevPhysical = index;
+
+			unusedNodes.push_back(next);
+		}
+
+		insertFree(index);
+	}
+};
+
+struct VulkanMemoryAllocator::LinearBlock {
+	VkDeviceMemory memory = nullptr;
+	uint64_t size = 0;
+	void* mapped = nullptr;
+
+	uint64_t offset = 0;
+};
+
+VulkanMemoryAllocator::VulkanMemoryAllocator(VulkanDevice& device)
+	: device(device)
+{
+	VkPhysicalDeviceMemoryProperties memProps;
+	vkGetPhysicalDeviceMemoryProperties(device.getPhysicalDevice(), &memProps);
+
+	VkPhysicalDeviceProperties props;
+	vkGetPhysicalDeviceProperties(device.getPhysicalDevice(), &props);
+
+	bufferImageGranularity = std::max<uint64_t>(props.limits.bufferImageGranularity, 1);
+	nonCoherentAtomSize = std::max<uint64_t>(props.limits.nonCoherentAtomSize, 1);
+
+	memoryTypeCount = memProps.memoryTypeCount;
+	memoryHeapCount = memProps.memoryHeapCount;
+
+	for (uint32_t i = 0; i < memoryTypeCount; i++) {
+		typeFlags.push_back(memProps.memoryTypes[i].propertyFlags);
+		typeHeaps.push_back(memProps.memoryTypes[i].heapIndex);
+	}
+	for (uint32_t i = 0; i < memoryHeapCount; i++) {
+		heapFlags.push_back(memProps.memoryHeaps[i].flags);
+		heapSizes.push_back(memProps.memoryHeaps[i].size);
+	}
+
+	blocks.resize(memoryTypeCount);
+	linearBlocks.resize(memoryTypeCount);
+	typeStats.resize(memoryTypeCount);
+}
+
+VulkanMemoryAllocator::~VulkanMemoryAllocator() {
+	VkDevice vkDevice = device.getDevice();
+
+	for (auto& typeBlocks : blocks)
+		for (auto& block : typeBlocks)
+			if (block) vkFreeMemory(vkDevice, block->memory, nullptr);
+
+	for (auto& frames : linearBlocks)
+		for (auto& frameBlocks : frames)
+			for (auto& block : frameBlocks)
+				vkFreeMemory(vkDevice, block->memory, nullptr);
+}
+
+MemoryAllocation VulkanMemoryAllocator::allocateBuffer(VkBuffer buffer, MemoryPropertyFlags properties, MemoryLifetime lifetime, uint32_t frameIndex) {
+	VkDevice vkDevice = device.getDevice();
+
+	VkMemoryRequirements memReq{};
+	vkGetBufferMemoryRequirements(vkDevice, buffer, &memReq);
+
+	MemoryAllocation allocation = allocate({ memReq.size, memReq.alignment, memReq.memoryTypeBits, properties, AllocationKind::Buffer, lifetime, frameIndex });
+
+	if (vkBindBufferMemory(vkDevice, buffer, allocation.memory, allocation.offset) != VK_SUCCESS) {
+		free(allocation);
+		throw std::runtime_error("failed to bind buffer memory!");
+	}
+	return allocation;
+}
+
+MemoryAllocation VulkanMemoryAllocator::allocateImage(VkImage image, MemoryPropertyFlags properties, MemoryLifetime lifetime, uint32_t frameIndex) {
+	VkDevice vkDevice = device.getDevice();
+
+	VkMemoryRequirements memReq{};
+	vkGetImageMemoryRequirements(vkDevice, image, &memReq);
+
+	MemoryAllocation allocation = allocate({ memReq.size, memReq.alignment, memReq.memoryTypeBits, properties, AllocationKind::Image, lifetime, frameIndex });
+
+	if (vkBindImageMemory(vkDevice, image, allocation.memory, allocation.offset) != VK_SUCCESS) {
+		free(allocation);
+		throw std::runtime_error("failed to bind image memory!");
+	}
+	return allocation;
+}
+
+MemoryAllocation VulkanMemoryAllocator::allocateImageMemory(const MemoryRequirements& requirements, MemoryPropertyFlags properties) {
+	return allocate({ requirements.size, requirements.alignment, requirements.memoryTypeBits, properties, AllocationKind::Image, MemoryLifetime::Persistent, 0 });
+}
+
+MemoryAllocation VulkanMemoryAllocator::allocate(Request request) {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	uint32_t memoryType = device.findMemoryType(request.memoryTypeBits, request.properties);
+
+	// images only ever occupy whole granularity pages, so they never share a page with a buffer
+	if (request.kind == AllocationKind::Image && bufferImageGranularity > 1) {
+		request.alignment = std::max(request.alignment, bufferImageGranularity);
+		request.size = alignUp(request.size, bufferImageGranularity);
+	}
+
+	if (request.lifetime == MemoryLifetime::Transient)
+		return allocateLinear(request, memoryType);
+
+	uint64_t blockSize = preferredBlockSize(memoryType);
+	if (request.size > blockSize / 2)
+		return allocateDedicated(request, memoryType);
+
+	auto& typeBlocks = blocks[memoryType];
+
+	uint32_t blockIndex = NONE;
+	uint32_t node = NONE;
+	for (uint32_t i = 0; i < typeBlocks.size() && node == NONE; i++) {
+		if (!typeBlocks[i]) continue;
+
+		node = typeBlocks[i]->allocate(request.size, request.alignment);
+		blockIndex = i;
+	}
+
+	if (node == NONE) {
+		void* mapped = nullptr;
+		VkDeviceMemory memory = allocateDeviceMemory(blockSize, memoryType, &mapped);
+
+		auto it = std::find(typeBlocks.begin(), typeBlocks.end(), nullptr);
+		blockIndex = static_cast<uint32_t>(it - typeBlocks.begin());
+		if (it == typeBlocks.end()) typeBlocks.push_back(std::make_unique<Block>(memory, blockSize, mapped));
+		else *it = std::make_unique<Block>(memory, blockSize, mapped);
+
+		typeStats[memoryType].blockCount++;
+
+		node = typeBlocks[blockIndex]->allocate(request.size, request.alignment);
+		if (node == NONE)
+			throw std::runtime_error("failed to sub-allocate device memory!");
+	}
+
+	Block& block = *typeBlocks[blockIndex];
+
+	MemoryAllocation allocation;
+	allocation.memory = block.memory;
+	allocation.offset = block.nodes[node].offset;
+	allocation.size = block.nodes[node].size;
+	allocation.memorySize = block.size;
+	allocation.mapped = block.mapped ? static_cast<uint8_t*>(block.mapped) + allocation.offset : nullptr;
+	allocation.memoryType = memoryType;
+	allocation.block = blockIndex;
+	allocation.node = node;
+
+	typeStats[memoryType].usedBytes += allocation.size;
+	typeStats[memoryType].allocationCount++;
+
+	return allocation;
+}
+
+MemoryAllocation VulkanMemoryAllocator::allocateDedicated(const Request& request, uint32_t memoryType) {
+	MemoryAllocation allocation;
+	allocation.memory = allocateDeviceMemory(request.size, memoryType, &allocation.mapped);
+	allocation.size = request.size;
+	allocation.memorySize = request.size;
+	allocation.memoryType = memoryType;
+	allocation.dedicated = true;
+
+	typeStats[memoryType].usedBytes += allocation.size;
+	typeStats[memoryType].allocationCount++;
+	typeStats[memoryType].dedicatedCount++;
+
+	return allocation;
+}
+
+MemoryAllocation VulkanMemoryAllocator::allocateLinear(const Request& request, uint32_t memoryType) {
+	auto& frames = linearBlocks[memoryType];
+	if (frames.size() <= request.frameIndex)
+		frames.resize(request.frameIndex + 1);
+
+	auto& frameBlocks = frames[request.frameIndex];
+
+	uint32_t blockIndex = NONE;
+	uint64_t offset = 0;
+	for (uint32_t i = 0; i < frameBlocks.size(); i++) {
+		offset = alignUp(frameBlocks[i]->offset, request.alignment);
+		if (offset + request.size <= frameBlocks[i]->size) {
+			blockIndex = i;
+			break;
+		}
+	}
+
+	if (blockIndex == NONE) {
+		auto block = std::make_unique<LinearBlock>();
+		block->size = std::max(TRANSIENT_BLOCK_SIZE, alignUp(request.size, GRANULE));
+		block->memory = allocateDeviceMemory(block->size, memoryType, &block->mapped);
+
+		frameBlocks.push_back(std::move(block));
+		typeStats[memoryType].blockCount++;
+
+		blockIndex = static_cast<uint32_t>(frameBlocks.size() - 1);
+		offset = 0;
+	}
+
+	LinearBlock& block = *frameBlocks[blockIndex];
+	block.offset = offset + request.size;
+
+	MemoryAllocation allocation;
+	allocation.memory = block.memory;
+	allocation.offset = offset;
+	allocation.size = request.size;
+	allocation.memorySize = block.size;
+	allocation.mapped = block.mapped ? static_cast<uint8_t*>(block.mapped) + offset : nullptr;
+	allocation.memoryType = memoryType;
+	allocation.block = blockIndex;
+	allocation.lifetime = MemoryLifetime::Transient;
+
+	typeStats[memoryType].transientBytes += request.size;
+
+	return allocation;
+}
+
+void VulkanMemoryAllocator::free(MemoryAllocation& allocation) {
+	if (!allocation.memory)
+		return;
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	TypeStats& stats = typeStats[allocation.memoryType];
+
+	if (allocation.dedicated) {
+		freeDeviceMemory(allocation.memory, allocation.size, allocation.memoryType);
+		stats.usedBytes -= allocation.size;
+		stats.allocationCount--;
+		stats.dedicatedCount--;
+	}
+	else if (allocation.lifetime == MemoryLifetime::Persistent) {
+		auto& typeBlocks = blocks[allocation.memoryType];
+		Block& block = *typeBlocks[allocation.block];
+
+		block.release(allocation.node);
+		stats.usedBytes -= allocation.size;
+		stats.allocationCount--;
+
+		// keep one empty block per memory type around so steady-state churn does not hit the driver
+		size_t liveBlocks = std::count_if(typeBlocks.begin(), typeBlocks.end(), [](const std::unique_ptr<Block>& b) { return b != nullptr; });
+		if (block.allocationCount == 0 && liveBlocks > 1) {
+			freeDeviceMemory(block.memory, block.size, allocation.memoryType);
+			typeBlocks[allocation.block].reset();
+			stats.blockCount--;
+		}
+	}
+	// transient allocations are reclaimed wholesale by resetTransient
+
+	allocation = MemoryAllocation{};
+}
+
+void VulkanMemoryAllocator::resetTransient(uint32_t frameIndex) {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	for (uint32_t type = 0; type < memoryTypeCount; type++) {
+		auto& frames = linearBlocks[type];
+		if (frames.size() <= frameIndex)
+			continue;
+
+		for (auto& block : frames[frameIndex]) {
+			typeStats[type].transientBytes -= std::min(typeStats[type].transientBytes, block->offset);
+			block->offset = 0;
+		}
+	}
+}
+
+void VulkanMemoryAllocator::flush(const MemoryAllocation& allocation, uint64_t offset, uint64_t size) {
+	if (!allocation.memory || (typeFlags[allocation.memoryType] & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+		return;
+
+	uint64_t begin = allocation.offset + offset;
+	uint64_t end = alignUp(begin + size, nonCoherentAtomSize);
+
+	VkMappedMemoryRange range{};
+	range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+	range.memory = allocation.memory;
+	range.offset = begin / nonCoherentAtomSize * nonCoherentAtomSize;
+	range.size = end >= allocation.memorySize ? VK_WHOLE_SIZE : end - range.offset;
+
+	vkFlushMappedMemoryRanges(device.getDevice(), 1, &range);
+}
+
+std::vector<MemoryHeapStats> VulkanMemoryAllocator::getHeapStats() {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	std::vector<MemoryHeapStats> heaps(memoryHeapCount);
+	for (uint32_t i = 0; i < memoryHeapCount; i++) {
+		heaps[i].heapSize = heapSizes[i];
+		heaps[i].deviceLocal = (heapFlags[i] & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+	}
+
+	for (uint32_t type = 0; type < memoryTypeCount; type++) {
+		MemoryHeapStats& heap = heaps[typeHeaps[type]];
+		const TypeStats& stats = typeStats[type];
+
+		heap.reservedBytes += stats.reservedBytes;
+		heap.usedBytes += stats.usedBytes;
+		heap.transientBytes += stats.transientBytes;
+		heap.blockCount += stats.blockCount;
+		heap.allocationCount += stats.allocationCount;
+		heap.dedicatedCount += stats.dedicatedCount;
+	}
+	return heaps;
+}
+
+uint64_t VulkanMemoryAllocator::preferredBlockSize(uint32_t memoryType) const {
+	uint64_t blockSize = (typeFlags[memoryType] & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) ? HOST_BLOCK_SIZE : DEVICE_BLOCK_SIZE;
+	uint64_t heapLimit = alignUp(heapSizes[typeHeaps[memoryType]] / 8, GRANULE);
+	return std::max(std::min(blockSize, heapLimit), GRANULE);
+}
+
+VkDeviceMemory VulkanMemoryAllocator::allocateDeviceMemory(uint64_t size, uint32_t memoryType, void** mapped) {
+	VkDevice vkDevice = device.getDevice();
+
+	VkMemoryAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocInfo.allocationSize = size;
+	allocInfo.memoryTypeIndex = memoryType;
+
+	VkDeviceMemory memory = nullptr;
+	if (vkAllocateMemory(vkDevice, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+		throw std::runtime_error("failed to allocate device memory!");
+	}
+
+	*mapped = nullptr;
+	if (typeFlags[memoryType] & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+		if (vkMapMemory(vkDevice, memory, 0, VK_WHOLE_SIZE, 0, mapped) != VK_SUCCESS) {
+			vkFreeMemory(vkDevice, memory, nullptr);
+			throw std::runtime_error("failed to map device memory!");
+		}
+	}
+
+	typeStats[memoryType].reservedBytes += size;
+	deviceAllocationCount++;
+
+	return memory;
+}
+
+void VulkanMemoryAllocator::freeDeviceMemory(VkDeviceMemory memory, uint64_t size, uint32_t memoryType) {
+	vkFreeMemory(device.getDevice(), memory, nullptr);
+
+	typeStats[memoryType].reservedBytes -= size;
+	deviceAllocationCount--;
+}
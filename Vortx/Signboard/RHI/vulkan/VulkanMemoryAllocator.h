@@ -0,0 +1,129 @@
+#pragma once
+
+#include "Common/VulkanFwd.h"
+#include "Signboard/RHI/common/DeviceTypes.h"
+
+#include <vector>
+#include <memory>
+#include <mutex>
+
+class VulkanDevice;
+
+enum class AllocationKind {
+	Buffer,
+	Image
+};
+
+struct MemoryAllocation {
+	VkDeviceMemory memory = nullptr;
+	uint64_t offset = 0;
+	uint64_t size = 0;
+	uint64_t memorySize = 0;
+	void* mapped = nullptr;
+
+	uint32_t memoryType = UINT32_MAX;
+	uint32_t block = UINT32_MAX;
+	uint32_t node = UINT32_MAX;
+
+	MemoryLifetime lifetime = MemoryLifetime::Persistent;
+	bool dedicated = false;
+};
+
+struct MemoryRequirements {
+	uint64_t size = 0;
+	uint64_t alignment = 1;
+	uint32_t memoryTypeBits = UINT32_MAX;
+};
+
+struct MemoryHeapStats {
+	uint64_t heapSize = 0;
+	uint64_t reservedBytes = 0;
+	uint64_t usedBytes = 0;
+	uint64_t transientBytes = 0;
+
+	uint32_t blockCount = 0;
+	uint32_t allocationCount = 0;
+	uint32_t dedicatedCount = 0;
+
+	bool deviceLocal = false;
+};
+
+class VulkanMemoryAllocator {
+public:
+	static constexpr uint64_t DEVICE_BLOCK_SIZE = 64ull << 20;
+	static constexpr uint64_t HOST_BLOCK_SIZE = 16ull << 20;
+	static constexpr uint64_t TRANSIENT_BLOCK_SIZE = 8ull << 20;
+
+	VulkanMemoryAllocator(VulkanDevice& device);
+	~VulkanMemoryAllocator();
+
+	VulkanMemoryAllocator(const VulkanMemoryAllocator&) = delete;
+	VulkanMemoryAllocator& operator=(const VulkanMemoryAllocator&) = delete;
+
+	MemoryAllocation allocateBuffer(VkBuffer buffer, MemoryPropertyFlags properties, MemoryLifetime lifetime = MemoryLifetime::Persistent, uint32_t frameIndex = 0);
+	MemoryAllocation allocateImage(VkImage image, MemoryPropertyFlags properties, MemoryLifetime lifetime = MemoryLifetime::Persistent, uint32_t frameIndex = 0);
+
+	// unbound image memory, the caller binds one or more images into it (aliasing)
+	MemoryAllocation allocateImageMemory(const MemoryRequirements& requirements, MemoryPropertyFlags properties);
+
+	void free(MemoryAllocation& allocation);
+	void resetTransient(uint32_t frameIndex);
+
+	void flush(const MemoryAllocation& allocation, uint64_t offset, uint64_t size);
+
+	std::vector<MemoryHeapStats> getHeapStats();
+	uint32_t getDeviceAllocationCount() const { return deviceAllocationCount; }
+
+private:
+	struct Request {
+		uint64_t size;
+		uint64_t alignment;
+		uint32_t memoryTypeBits;
+		MemoryPropertyFlags properties;
+		AllocationKind kind;
+		MemoryLifetime lifetime;
+		uint32_t frameIndex;
+	};
+
+	struct Block;
+	struct LinearBlock;
+
+	struct TypeStats {
+		uint64_t reservedBytes = 0;
+		uint64_t usedBytes = 0;
+		uint64_t transientBytes = 0;
+		uint32_t blockCount = 0;
+		uint32_t allocationCount = 0;
+		uint32_t dedicatedCount = 0;
+	};
+
+	MemoryAllocation allocate(Request request);
+	MemoryAllocation allocateDedicated(const Request& request, uint32_t memoryType);
+	MemoryAllocation allocateLinear(const Request& request, uint32_t memoryType);
+
+	uint64_t preferredBlockSize(uint32_t memoryType) const;
+
+	VkDeviceMemory allocateDeviceMemory(uint64_t size, uint32_t memoryType, void** mapped);
+	void freeDeviceMemory(VkDeviceMemory memory, uint64_t size, uint32_t memoryType);
+
+private:
+	VulkanDevice& device;
+
+	uint32_t memoryTypeCount = 0;
+	uint32_t memoryHeapCount = 0;
+	std::vector<uint32_t> typeFlags;
+	std::vector<uint32_t> typeHeaps;
+	std::vector<uint32_t> heapFlags;
+	std::vector<uint64_t> heapSizes;
+
+	uint64_t bufferImageGranularity = 1;
+	uint64_t nonCoherentAtomSize = 1;
+
+	std::vector<std::vector<std::unique_ptr<Block>>> blocks;
+	std::vector<std::vector<std::vector<std::unique_ptr<LinearBlock>>>> linearBlocks;
+	std::vector<TypeStats> typeStats;
+
+	uint32_t deviceAllocationCount = 0;
+
+	std::mutex mutex;
+};
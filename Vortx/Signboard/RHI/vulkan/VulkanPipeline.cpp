@@ -5,20 +5,108 @@
 #include "VulkanPipelineCache.h"
 #include "VulkanPipelineLayout.h"
 #include "VulkanRenderPass.h"
+#include "VulkanShaderModule.h"
 
-#include <fstream>
-
+// every fixed function state of a graphics pipeline, filled once from the desc. monolithic builds use all of it,
+// library parts only the state their part covers
 struct VulkanPipeline::Impl {
 	std::vector<VkVertexInputAttributeDescription> vertexAttributes;
 	std::vector<VkVertexInputBindingDescription> vertexBindings;
 
 	std::vector<VkPipelineShaderStageCreateInfo> shaderStages;
+	std::vector<VkDynamicState> dynamicStates;
 
+	VkPipelineVertexInputStateCreateInfo vertexInput{};
+	VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+	VkPipelineViewportStateCreateInfo viewport{};
+	VkPipelineDynamicStateCreateInfo dynamic{};
 	VkPipelineRasterizationStateCreateInfo raster{};
+	VkPipelineMultisampleStateCreateInfo multisample{};
 	VkPipelineDepthStencilStateCreateInfo depth{};
 	VkPipelineColorBlendAttachmentState blend{};
+	VkPipelineColorBlendStateCreateInfo colorBlend{};
+
+	void describe(const PipelineDesc& desc, const std::vector<const VulkanShaderModule*>& modules);
 };
 
+void VulkanPipeline::Impl::describe(const PipelineDesc& desc, const std::vector<const VulkanShaderModule*>& modules) {
+	for (const VertexBindingDesc& binding : desc.vertexLayout.bindings)
+		vertexBindings.push_back(toVkVertexInputBindingDescription(binding));
+
+	for (const VertexAttributeDesc& attribute : desc.vertexLayout.attributes)
+		vertexAttributes.push_back(toVkVertexInputAttributeDescription(attribute, 0));
+
+	for (size_t i = 0; i < desc.shaders.size(); i++) {
+		VkPipelineShaderStageCreateInfo stage{};
+		stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		stage.stage = toVkShaderStageFlagBits(desc.shaders[i].stage);
+		stage.module = modules[i]->getHandle();
+		stage.pName = "main";
+
+		shaderStages.push_back(stage);
+	}
+
+	vertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+	vertexInput.vertexBindingDescriptionCount = static_cast<uint32_t>(vertexBindings.size());
+	vertexInput.pVertexBindingDescriptions = vertexBindings.data();
+	vertexInput.vertexAttributeDescriptionCount = static_cast<uint32_t>(vertexAttributes.size());
+	vertexInput.pVertexAttributeDescriptions = vertexAttributes.data();
+
+	inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+	inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+	inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+	viewport.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+	viewport.viewportCount = 1;
+	viewport.scissorCount = 1;
+
+	dynamicStates = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+
+	dynamic.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+	dynamic.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+	dynamic.pDynamicStates = dynamicStates.data();
+
+	raster.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+	raster.depthClampEnable = VK_FALSE;
+	raster.rasterizerDiscardEnable = VK_FALSE;
+	raster.polygonMode = VK_POLYGON_MODE_FILL;
+	raster.lineWidth = 1.0f;
+	raster.cullMode = VK_CULL_MODE_BACK_BIT;
+	raster.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+	raster.depthBiasEnable = VK_FALSE;
+
+	multisample.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+	multisample.sampleShadingEnable = VK_TRUE;
+	multisample.rasterizationSamples = toVkSampleCountFlagBits(desc.samples);
+	multisample.minSampleShading = 1.0f;
+
+	depth.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+	depth.depthTestEnable = desc.raster.depthTest ? VK_TRUE : VK_FALSE;
+	depth.depthWriteEnable = desc.raster.depthWrite ? VK_TRUE : VK_FALSE;
+	depth.depthCompareOp = VK_COMPARE_OP_LESS;
+	depth.depthBoundsTestEnable = VK_FALSE;
+	depth.stencilTestEnable = VK_FALSE;
+
+	blend.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+	if (desc.blend.enable) {
+		blend.blendEnable = VK_TRUE;
+		blend.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+		blend.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+		blend.colorBlendOp = VK_BLEND_OP_ADD;
+		blend.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+		blend.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+		blend.alphaBlendOp = VK_BLEND_OP_ADD;
+	}
+	else {
+		blend.blendEnable = VK_FALSE;
+	}
+
+	colorBlend.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+	colorBlend.logicOpEnable = VK_FALSE;
+	colorBlend.attachmentCount = 1;
+	colorBlend.pAttachments = &blend;
+}
+
 VulkanPipeline::VulkanPipeline(VulkanDevice& device, VulkanPipelineCache& cache)
 	: device(device), cache(cache), impl(new Impl{}) { }
 
@@ -47,179 +135,168 @@ VulkanPipeline::~VulkanPipeline() {
 	delete impl;
 }
 
-void VulkanPipeline::build(const VulkanRenderPass& renderPass, const VulkanPipelineLayout& layout, const PipelineDesc& desc) {
+void VulkanPipeline::build(const VulkanRenderPass& renderPass, const VulkanPipelineLayout& layout, const PipelineDesc& desc, const std::vector<const VulkanShaderModule*>& modules) {
 	if (desc.shaders.empty())
 		throw std::runtime_error("pipeline must have atleast one shader!");
 
-	if (desc.type == PipelineType::Compute)
-		if (desc.shaders.size() != 1 || desc.shaders[0].stage != ShaderStageBit::ComputeBit)
-			throw std::runtime_error("compute pipeline must have exactly one compute shader!");
+	if (modules.size() != desc.shaders.size())
+		throw std::runtime_error("pipeline needs one shader module per shader!");
+
+	if (desc.type == PipelineType::Compute) {
+		buildCompute(layout, desc, *modules[0]);
+		return;
+	}
+
+	if (built)
+		throw std::runtime_error("pipeline has already been built!");
+
+	impl->describe(desc, modules);
+
+	VkGraphicsPipelineCreateInfo info{};
+	info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+
+	info.stageCount = static_cast<uint32_t>(impl->shaderStages.size());
+	info.pStages = impl->shaderStages.data();
+
+	info.layout = layout.getHandle();
+	info.renderPass = renderPass.getHandle();
+	info.subpass = 0;
+
+	info.pVertexInputState = &impl->vertexInput;
+	info.pInputAssemblyState = &impl->inputAssembly;
+	info.pViewportState = &impl->viewport;
+	info.pRasterizationState = &impl->raster;
+	info.pMultisampleState = &impl->multisample;
+	info.pDepthStencilState = &impl->depth;
+	info.pColorBlendState = &impl->colorBlend;
+	info.pDynamicState = &impl->dynamic;
+
+	if (vkCreateGraphicsPipelines(device.getDevice(), cache.getHandle(), 1, &info, nullptr, &pipeline) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create graphics pipelien!");
+	}
+
+	built = true;
+}
+
+void VulkanPipeline::buildLibrary(PipelineLibraryPart part, const VulkanRenderPass& renderPass, const VulkanPipelineLayout& layout, const PipelineDesc& desc, const std::vector<const VulkanShaderModule*>& modules) {
+	if (desc.type != PipelineType::Graphics)
+		throw std::runtime_error("only graphics pipelines can be split into libraries!");
+
+	if (modules.size() != desc.shaders.size())
+		throw std::runtime_error("pipeline needs one shader module per shader!");
 
 	if (built)
 		throw std::runtime_error("pipeline has already been built!");
 
-	std::vector<VkShaderModule> shaderModules;
-
-	if (desc.type == PipelineType::Graphics) {
-		for (const VertexBindingDesc& binding : desc.vertexLayout.bindings)
-			impl->vertexBindings.push_back(toVkVertexInputBindingDescription(binding));
-
-		for (const VertexAttributeDesc& attribute : desc.vertexLayout.attributes)
-			impl->vertexAttributes.push_back(toVkVertexInputAttributeDescription(attribute, 0));
-
-		for (const ShaderDesc& shader : desc.shaders) {
-			auto spirv = readSPIRV(shader.path);
-			VkShaderModule module = createShaderModule(device.getDevice(), spirv);
-
-			shaderModules.push_back(module);
-
-			VkPipelineShaderStageCreateInfo stage{};
-			stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-			stage.stage = toVkShaderStageFlagBits(shader.stage);
-			stage.module = module;
-			stage.pName = "main";
-
-			impl->shaderStages.push_back(stage);
-		}
-
-		VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
-		vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-		vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(impl->vertexBindings.size());
-		vertexInputInfo.pVertexBindingDescriptions = impl->vertexBindings.data();
-		vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(impl->vertexAttributes.size());
-		vertexInputInfo.pVertexAttributeDescriptions = impl->vertexAttributes.data();
-
-		VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
-		inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-		inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-		inputAssembly.primitiveRestartEnable = VK_FALSE;
-
-		VkPipelineViewportStateCreateInfo viewportState{};
-		viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-		viewportState.viewportCount = 1;
-		viewportState.scissorCount = 1;
-
-		std::vector<VkDynamicState> dynamicStates = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
-
-		VkPipelineDynamicStateCreateInfo dynamicState{};
-		dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-		dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
-		dynamicState.pDynamicStates = dynamicStates.data();
-
-		VkPipelineRasterizationStateCreateInfo rasterizer{};
-		rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-		rasterizer.depthClampEnable = VK_FALSE;
-		rasterizer.rasterizerDiscardEnable = VK_FALSE;
-		rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
-		rasterizer.lineWidth = 1.0f;
-		rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
-		rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
-		rasterizer.depthBiasEnable = VK_FALSE;
-
-		VkPipelineMultisampleStateCreateInfo multisampling{};
-		multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-		multisampling.sampleShadingEnable = VK_TRUE;
-		multisampling.rasterizationSamples = toVkSampleCountFlagBits(desc.samples);
-		multisampling.minSampleShading = 1.0f;
-
-		VkPipelineDepthStencilStateCreateInfo depthStencil{};
-		depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-		depthStencil.depthTestEnable = desc.raster.depthTest ? VK_TRUE : VK_FALSE;
-		depthStencil.depthWriteEnable = desc.raster.depthWrite ? VK_TRUE : VK_FALSE;
-		depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
-		depthStencil.depthBoundsTestEnable = VK_FALSE;
-		depthStencil.stencilTestEnable = VK_FALSE;
-
-		VkPipelineColorBlendAttachmentState colorBlendAttachment{};
-		colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-		if (desc.blend.enable) {
-			colorBlendAttachment.blendEnable = VK_TRUE;
-			colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
-			colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
-			colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
-			colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-			colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-			colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
-		}
-		else {
-			colorBlendAttachment.blendEnable = VK_FALSE;
-		}
-
-		VkPipelineColorBlendStateCreateInfo colorBlending{};
-		colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-		colorBlending.logicOpEnable = VK_FALSE;
-		colorBlending.attachmentCount = 1;
-		colorBlending.pAttachments = &colorBlendAttachment;
-
-		VkGraphicsPipelineCreateInfo info{};
-		info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-
-		info.stageCount = static_cast<uint32_t>(impl->shaderStages.size());
-		info.pStages = impl->shaderStages.data();
+	impl->describe(desc, modules);
+
+	VkGraphicsPipelineLibraryCreateInfoEXT libraryInfo{};
+	libraryInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT;
+
+	// retained link time information lets the background link optimise across the parts
+	VkGraphicsPipelineCreateInfo info{};
+	info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	info.pNext = &libraryInfo;
+	info.flags = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+
+	// each part only takes the state the extension assigns to it, the shader parts keep just their own stages
+	std::vector<VkPipelineShaderStageCreateInfo> stages;
+	switch (part) {
+	case PipelineLibraryPart::VertexInput:
+		libraryInfo.flags = VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT;
+		info.pVertexInputState = &impl->vertexInput;
+		info.pInputAssemblyState = &impl->inputAssembly;
+		break;
+
+	case PipelineLibraryPart::PreRasterization:
+		libraryInfo.flags = VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT;
+		for (const VkPipelineShaderStageCreateInfo& stage : impl->shaderStages)
+			if (stage.stage != VK_SHADER_STAGE_FRAGMENT_BIT)
+				stages.push_back(stage);
 
 		info.layout = layout.getHandle();
 		info.renderPass = renderPass.getHandle();
-		info.subpass = 0;
-
-		info.pVertexInputState = &vertexInputInfo;
-		info.pInputAssemblyState = &inputAssembly;
-		info.pViewportState = &viewportState;
-		info.pRasterizationState = &rasterizer;
-		info.pMultisampleState = &multisampling;
-		info.pDepthStencilState = &depthStencil;
-		info.pColorBlendState = &colorBlending;
-		info.pDynamicState = &dynamicState;
-
-		if (vkCreateGraphicsPipelines(device.getDevice(), cache.getHandle(), 1, &info, nullptr, &pipeline) != VK_SUCCESS) {
-			throw std::runtime_error("failed to create graphics pipelien!");
-		}
-	}
+		info.pViewportState = &impl->viewport;
+		info.pRasterizationState = &impl->raster;
+		info.pDynamicState = &impl->dynamic;
+		break;
 
-	if (desc.type == PipelineType::Compute) {
-		VkComputePipelineCreateInfo createInfo{};
-		createInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
-		createInfo.stage = impl->shaderStages[0];
-		createInfo.layout = layout.getHandle();
-
-		if (vkCreateComputePipelines(device.getDevice(), cache.getHandle(), 1, &createInfo, nullptr, &pipeline) != VK_SUCCESS) {
-			throw std::runtime_error("failed to create compute pipeline!");
-		}
+	case PipelineLibraryPart::FragmentShader:
+		libraryInfo.flags = VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT;
+		for (const VkPipelineShaderStageCreateInfo& stage : impl->shaderStages)
+			if (stage.stage == VK_SHADER_STAGE_FRAGMENT_BIT)
+				stages.push_back(stage);
+
+		info.layout = layout.getHandle();
+		info.renderPass = renderPass.getHandle();
+		info.pMultisampleState = &impl->multisample;
+		info.pDepthStencilState = &impl->depth;
+		break;
+
+	case PipelineLibraryPart::FragmentOutput:
+		libraryInfo.flags = VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT;
+		info.renderPass = renderPass.getHandle();
+		info.pMultisampleState = &impl->multisample;
+		info.pColorBlendState = &impl->colorBlend;
+		break;
 	}
 
-	for (VkShaderModule module : shaderModules) {
-		vkDestroyShaderModule(device.getDevice(), module, nullptr);
+	info.stageCount = static_cast<uint32_t>(stages.size());
+	info.pStages = stages.data();
+	info.subpass = 0;
+
+	if (vkCreateGraphicsPipelines(device.getDevice(), cache.getHandle(), 1, &info, nullptr, &pipeline) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create graphics pipeline library!");
 	}
 
 	built = true;
 }
 
-VkShaderModule createShaderModule(VkDevice device ,const std::vector<uint32_t>& spirv) {
-	VkShaderModuleCreateInfo createInfo{};
-	createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-	createInfo.codeSize = spirv.size() * sizeof(uint32_t);
-	createInfo.pCode = spirv.data();
+void VulkanPipeline::link(const VulkanPipelineLayout& layout, const std::vector<const VulkanPipeline*>& libraries, bool optimize) {
+	if (built)
+		throw std::runtime_error("pipeline has already been built!");
+
+	std::vector<VkPipeline> handles;
+	for (const VulkanPipeline* library : libraries)
+		handles.push_back(library->getHandle());
 
-	VkShaderModule shaderModule;
-	if (vkCreateShaderModule(device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
-		throw std::runtime_error("failed to create shader module!");
+	VkPipelineLibraryCreateInfoKHR libraryInfo{};
+	libraryInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR;
+	libraryInfo.libraryCount = static_cast<uint32_t>(handles.size());
+	libraryInfo.pLibraries = handles.data();
+
+	// without the optimisation flag the driver only stitches the compiled parts together
+	VkGraphicsPipelineCreateInfo info{};
+	info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	info.pNext = &libraryInfo;
+	info.flags = optimize ? VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT : 0;
+	info.layout = layout.getHandle();
+
+	if (vkCreateGraphicsPipelines(device.getDevice(), cache.getHandle(), 1, &info, nullptr, &pipeline) != VK_SUCCESS) {
+		throw std::runtime_error("failed to link graphics pipeline!");
 	}
-	return shaderModule;
+
+	built = true;
 }
 
-std::vector<uint32_t> readSPIRV(const std::string& path) {
-	std::ifstream file(path, std::ios::ate | std::ios::binary);
-	if (!file.is_open()) {
-		throw std::runtime_error("failed to open file!" + path);
-	}
+void VulkanPipeline::buildCompute(const VulkanPipelineLayout& layout, const PipelineDesc& desc, const VulkanShaderModule& module) {
+	if (desc.type != PipelineType::Compute || desc.shaders.size() != 1 || desc.shaders[0].stage != ShaderStageBit::ComputeBit)
+		throw std::runtime_error("compute pipeline must have exactly one compute shader!");
+
+	if (built)
+		throw std::runtime_error("pipeline has already been built!");
 
-	size_t size = static_cast<size_t>(file.tellg());
-	if (size % 4 != 0)
-		throw std::runtime_error("SPIR-V file size is not a mutiple of 4: " + path);
+	VkComputePipelineCreateInfo createInfo{};
+	createInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	createInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	createInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	createInfo.stage.module = module.getHandle();
+	createInfo.stage.pName = "main";
+	createInfo.layout = layout.getHandle();
 
-	std::vector<uint32_t> buffer(size / 4);
-	file.seekg(0);
-	file.read(reinterpret_cast<char*>(buffer.data()), size);
-	file.close();
+	VkResult result = vkCreateComputePipelines(device.getDevice(), cache.getHandle(), 1, &createInfo, nullptr, &pipeline);
+	if (result != VK_SUCCESS)
+		throw std::runtime_error("failed to create compute pipeline!");
 
-	return buffer;
+	built = true;
 }
\ No newline at end of file
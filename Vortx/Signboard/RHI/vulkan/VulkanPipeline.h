@@ -9,6 +9,7 @@ class VulkanDevice;
 class VulkanPipelineCache;
 class VulkanPipelineLayout;
 class VulkanRenderPass;
+class VulkanShaderModule;
 
 class VulkanPipeline {
 public:
@@ -22,7 +23,14 @@ public:
 
 	~VulkanPipeline();
 
-	void build(const VulkanRenderPass& renderPass, const VulkanPipelineLayout& layout, const PipelineDesc& desc);
+	// modules holds one module per desc.shaders entry, they only have to live until the build returns
+	void build(const VulkanRenderPass& renderPass, const VulkanPipelineLayout& layout, const PipelineDesc& desc, const std::vector<const VulkanShaderModule*>& modules);
+	void buildCompute(const VulkanPipelineLayout& layout, const PipelineDesc& desc, const VulkanShaderModule& module);
+
+	// VK_EXT_graphics_pipeline_library, one part of a graphics pipeline built as a library, and a complete
+	// pipeline linked from one library per part. an unoptimised link is fast enough for draw time
+	void buildLibrary(PipelineLibraryPart part, const VulkanRenderPass& renderPass, const VulkanPipelineLayout& layout, const PipelineDesc& desc, const std::vector<const VulkanShaderModule*>& modules);
+	void link(const VulkanPipelineLayout& layout, const std::vector<const VulkanPipeline*>& libraries, bool optimize);
 
 	VkPipeline getHandle() const { return pipeline; }
 
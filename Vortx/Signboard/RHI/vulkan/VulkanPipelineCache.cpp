@@ -4,65 +4,153 @@
 #include "VulkanDevice.h"
 
 #include <fstream>
+#include <filesystem>
+#include <cstring>
+#include <string>
+
+static void writeBinaryFile(const std::string& path, const std::vector<uint8_t>& data) {
+	std::ofstream file(path, std::ios::binary | std::ios::out | std::ios::trunc);
+	if (!file)
+		throw std::runtime_error("failed to open file for saving pipeline cache!");
+
+	file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+	file.flush();
+
+	if (!file)
+		throw std::runtime_error("failed to write file for saving pipeline cache!");
+}
+
+static bool readBinaryFile(const char* path, std::vector<uint8_t>& data) {
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file)
+		return false;
+
+	const std::streamsize size = file.tellg();
+	if (size <= 0)
+		return false;
+
+	data.resize(static_cast<size_t>(size));
+
+	file.seekg(0, std::ios::beg);
+	file.read(reinterpret_cast<char*>(data.data()), size);
+
+	return static_cast<bool>(file);
+}
 
 VulkanPipelineCache::VulkanPipelineCache(VulkanDevice& device)
 	: device(device)
 {
 	VkPipelineCacheCreateInfo info{VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO};
 
-	vkCreatePipelineCache(device.getDevice(), &info, nullptr, &cache);
+	if (vkCreatePipelineCache(device.getDevice(), &info, nullptr, &cache) != VK_SUCCESS)
+		throw std::runtime_error("failed to create pipeline cache!");
 }
 
-void VulkanPipelineCache::saveToDisk(const char* path) {
+VulkanPipelineCache::VulkanPipelineCache(VulkanDevice& device, const std::vector<uint8_t>& data)
+	: device(device)
+{
+	VkPipelineCacheCreateInfo info{VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO};
+	info.initialDataSize = data.size();
+	info.pInitialData = data.data();
+
+	if (vkCreatePipelineCache(device.getDevice(), &info, nullptr, &cache) != VK_SUCCESS)
+		throw std::runtime_error("failed to create pipeline cache!");
+}
+
+VulkanPipelineCache::~VulkanPipelineCache() {
+	if (cache)
+		vkDestroyPipelineCache(device.getDevice(), cache, nullptr);
+}
+
+size_t VulkanPipelineCache::saveToDisk(const char* path) {
+	return writeToDisk(path, getData());
+}
+
+size_t VulkanPipelineCache::writeToDisk(const char* path, const std::vector<uint8_t>& data) {
+	std::string temp = std::string(path) + ".tmp";
+	std::error_code error;
+
+	// a failed write leaves a partial file, it goes so the next save starts clean
+	try {
+		writeBinaryFile(temp, data);
+	}
+	catch (const std::runtime_error&) {
+		std::filesystem::remove(temp, error);
+		throw;
+	}
+
+	// rename replaces the old file in one step, readers see either the old cache or the new one
+	std::filesystem::rename(temp, path, error);
+	if (error) {
+		std::filesystem::remove(temp, error);
+		throw std::runtime_error("failed to replace pipeline cache file!");
+	}
+
+	return data.size();
+}
+
+std::vector<uint8_t> VulkanPipelineCache::getData() const {
 	size_t size = 0;
-	vkGetPipelineCacheData(device.getDevice(), cache, &size, nullptr);
+	if (vkGetPipelineCacheData(device.getDevice(), cache, &size, nullptr) != VK_SUCCESS)
+		throw std::runtime_error("failed to query pipeline cache size!");
 
+	// builds on other threads may grow the cache between the two calls, what fits is still a valid cache
 	std::vector<uint8_t> data(size);
-	vkGetPipelineCacheData(device.getDevice(), cache, &size, data.data());
+	VkResult result = vkGetPipelineCacheData(device.getDevice(), cache, &size, data.data());
+	if (result != VK_SUCCESS && result != VK_INCOMPLETE)
+		throw std::runtime_error("failed to read pipeline cache data!");
+	data.resize(size);
 
-	writeBinaryFile(path, data);
+	return data;
 }
 
-void VulkanPipelineCache::loadFromDisk(const char* path) {
-	auto data = readBinaryFile(path);
-	VkPipelineCacheCreateInfo info{VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO};
+bool VulkanPipelineCache::loadFromDisk(const char* path) {
+	std::vector<uint8_t> data;
+	if (!readBinaryFile(path, data) || !isCompatible(data))
+		return false;
 
+	VkPipelineCacheCreateInfo info{VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO};
 	info.initialDataSize = data.size();
 	info.pInitialData = data.data();
 
-	vkCreatePipelineCache(device.getDevice(), &info, nullptr, &cache);
-}
-
-inline void writeBinaryFile(const char* path, const std::vector<uint8_t>& data) {
-	std::ofstream file(path, std::ios::binary | std::ios::out);
-	if (!file)
-		throw std::runtime_error("failed to open file for saving pipeline cache!");
+	VkPipelineCache loaded = VK_NULL_HANDLE;
+	if (vkCreatePipelineCache(device.getDevice(), &info, nullptr, &loaded) != VK_SUCCESS)
+		return false;
 
-	file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+	VkResult result = vkMergePipelineCaches(device.getDevice(), cache, 1, &loaded);
+	vkDestroyPipelineCache(device.getDevice(), loaded, nullptr);
 
-	if (!file)
-		throw std::runtime_error("failed to write file for saving pipeline cache!");
+	return result == VK_SUCCESS;
 }
 
-inline std::vector<uint8_t> readBinaryFile(const char* path) {
-	std::ifstream file(path, std::ios::binary | std::ios::ate);
-	if (!file)
-		throw std::runtime_error("Failed to open file for reading");
+void VulkanPipelineCache::merge(const std::vector<const VulkanPipelineCache*>& sources) {
+	std::vector<VkPipelineCache> handles;
+	for (const VulkanPipelineCache* source : sources)
+		if (source && source != this)
+			handles.push_back(source->getHandle());
 
-	const std::streamsize size = file.tellg();
-	if (size <= 0)
-		return {};
+	if (handles.empty())
+		return;
 
-	std::vector<uint8_t> data(static_cast<size_t>(size));
+	if (vkMergePipelineCaches(device.getDevice(), cache, static_cast<uint32_t>(handles.size()), handles.data()) != VK_SUCCESS)
+		throw std::runtime_error("failed to merge pipeline caches!");
+}
 
-	file.seekg(0, std::ios::beg);
-	file.read(
-		reinterpret_cast<char*>(data.data()),
-		size
-	);
+bool VulkanPipelineCache::isCompatible(const std::vector<uint8_t>& data) const {
+	VkPipelineCacheHeaderVersionOne header{};
+	if (data.size() < sizeof(header))
+		return false;
 
-	if (!file)
-		throw std::runtime_error("Failed to read binary file");
+	std::memcpy(&header, data.data(), sizeof(header));
 
-	return data;
+	VkPhysicalDeviceProperties properties{};
+	vkGetPhysicalDeviceProperties(device.getPhysicalDevice(), &properties);
+
+	// data from another driver build or device is at best ignored and at worst crashes the driver
+	return header.headerSize >= sizeof(header) &&
+		header.headerSize <= data.size() &&
+		header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+		header.vendorID == properties.vendorID &&
+		header.deviceID == properties.deviceID &&
+		std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
 }
\ No newline at end of file
@@ -3,19 +3,40 @@
 #include "Common/VulkanFwd.h"
 
 #include <memory>
+#include <vector>
 
 class VulkanDevice;
 
+// the handle is created once and never replaced, loading and merging fold data into it. builds on other threads
+// can therefore hold on to the cache while it is being saved or merged into
 class VulkanPipelineCache {
 public:
 	VulkanPipelineCache(VulkanDevice& device);
+
+	// seeded with data taken from a cache of this device, e.g. a snapshot merged on another thread
+	VulkanPipelineCache(VulkanDevice& device, const std::vector<uint8_t>& data);
 	~VulkanPipelineCache();
 
-	void saveToDisk(const char* path);
-	void loadFromDisk(const char* path);
+	VulkanPipelineCache(const VulkanPipelineCache&) = delete;
+	VulkanPipelineCache& operator=(const VulkanPipelineCache&) = delete;
+
+	// writes to a temporary file next to path and renames it over path, a crash mid-write never leaves a
+	// truncated cache behind. returns the bytes written
+	size_t saveToDisk(const char* path);
+	static size_t writeToDisk(const char* path, const std::vector<uint8_t>& data);
+
+	std::vector<uint8_t> getData() const;
+
+	// false when the file is missing or was written by another driver or device, the cache then stays as it was
+	bool loadFromDisk(const char* path);
+
+	void merge(const std::vector<const VulkanPipelineCache*>& sources);
 
 	VkPipelineCache getHandle() const { return cache; }
 
+private:
+	bool isCompatible(const std::vector<uint8_t>& data) const;
+
 private:
 	VulkanDevice& device;
 
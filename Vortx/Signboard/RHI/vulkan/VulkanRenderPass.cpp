@@ -3,6 +3,8 @@
 #include "TypeMap/VulkanRenderPassTypeMap.h"
 #include "VulkanDevice.h"
 
+#include <array>
+
 struct VulkanRenderPass::Impl {
 	std::vector<VkAttachmentDescription> attachments;
 	std::vector<VkAttachmentReference> colorRefs;
@@ -19,8 +21,8 @@ VulkanRenderPass::VulkanRenderPass(VulkanDevice& device, const RenderPassDesc& d
 		attachment.samples = VK_SAMPLE_COUNT_1_BIT;
 		attachment.loadOp = toVkAttachmentLoadOp(att.load);
 		attachment.storeOp = toVkAttachmentStoreOp(att.store);
-		attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		attachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		attachment.initialLayout = toVkImageLayout(att.initialLayout);
+		attachment.finalLayout = att.finalLayout == ImageLayout::Undefined ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : toVkImageLayout(att.finalLayout);
 
 		impl->attachments.push_back(attachment);
 
@@ -37,8 +39,8 @@ VulkanRenderPass::VulkanRenderPass(VulkanDevice& device, const RenderPassDesc& d
 		attachment.samples = VK_SAMPLE_COUNT_1_BIT;
 		attachment.loadOp = toVkAttachmentLoadOp(desc.depthAttachment.load);
 		attachment.storeOp = toVkAttachmentStoreOp(desc.depthAttachment.store);
-		attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		attachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		attachment.initialLayout = toVkImageLayout(desc.depthAttachment.initialLayout);
+		attachment.finalLayout = desc.depthAttachment.finalLayout == ImageLayout::Undefined ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : toVkImageLayout(desc.depthAttachment.finalLayout);
 
 		impl->attachments.push_back(attachment);
 
@@ -54,18 +56,49 @@ VulkanRenderPass::VulkanRenderPass(VulkanDevice& device, const RenderPassDesc& d
 	subpass.pColorAttachments = impl->colorRefs.data();
 	subpass.pDepthStencilAttachment = impl->hasDepth ? &impl->depthRef : nullptr;
 
+	// attachment writes of the pass before and after, e.g. the swapchain acquire wait at color output or a
+	// second pass loading what this one stored
+	VkPipelineStageFlags attachmentStages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+	VkAccessFlags attachmentWrites = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	VkAccessFlags attachmentAccess = attachmentWrites | VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+
+	std::array<VkSubpassDependency, 2> dependencies{};
+	dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+	dependencies[0].dstSubpass = 0;
+	dependencies[0].srcStageMask = attachmentStages;
+	dependencies[0].srcAccessMask = attachmentWrites;
+	dependencies[0].dstStageMask = attachmentStages;
+	dependencies[0].dstAccessMask = attachmentAccess;
+
+	dependencies[1].srcSubpass = 0;
+	dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+	dependencies[1].srcStageMask = attachmentStages;
+	dependencies[1].srcAccessMask = attachmentWrites;
+	dependencies[1].dstStageMask = attachmentStages;
+	dependencies[1].dstAccessMask = attachmentAccess;
+
 	VkRenderPassCreateInfo createInfo{};
 	createInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
 	createInfo.attachmentCount = static_cast<uint32_t>(impl->attachments.size());
 	createInfo.pAttachments = impl->attachments.data();
 	createInfo.subpassCount = 1;
 	createInfo.pSubpasses = &subpass;
+	createInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
+	createInfo.pDependencies = dependencies.data();
 
 	if (vkCreateRenderPass(device.getDevice(), &createInfo, nullptr, &renderPass) != VK_SUCCESS) {
 		throw std::runtime_error("failed to create render pass!");
 	}
 }
 
+uint32_t VulkanRenderPass::getColorAttachmentCount() const {
+	return static_cast<uint32_t>(impl->colorRefs.size());
+}
+
+bool VulkanRenderPass::hasDepthAttachment() const {
+	return impl->hasDepth;
+}
+
 VulkanRenderPass::~VulkanRenderPass() {
 	if (renderPass)
 		vkDestroyRenderPass(device.getDevice(), renderPass, nullptr);
@@ -19,6 +19,10 @@ public:
 
 	VkRenderPass getHandle() const { return renderPass; }
 
+	// color attachments come first in the framebuffer, depth follows them
+	uint32_t getColorAttachmentCount() const;
+	bool hasDepthAttachment() const;
+
 private:
 	struct Impl;
 	Impl* impl;
@@ -3,11 +3,17 @@
 #include "Common/VulkanCommon.h"
 #include "VulkanDevice.h"
 
-VulkanSemaphore::VulkanSemaphore(VulkanDevice& device)
-	: device(device)
+VulkanSemaphore::VulkanSemaphore(VulkanDevice& device, SemaphoreType type, uint64_t initialValue)
+	: device(device), type(type)
 {
+	VkSemaphoreTypeCreateInfo typeInfo{};
+	typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+	typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+	typeInfo.initialValue = initialValue;
+
 	VkSemaphoreCreateInfo createinfo{};
 	createinfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	createinfo.pNext = type == SemaphoreType::Timeline ? &typeInfo : nullptr;
 	createinfo.flags = 0;
 
 	vkCreateSemaphore(device.getDevice(), &createinfo, nullptr, &semaphore);
@@ -16,4 +22,24 @@ VulkanSemaphore::VulkanSemaphore(VulkanDevice& device)
 VulkanSemaphore::~VulkanSemaphore() {
 	if (semaphore)
 		vkDestroySemaphore(device.getDevice(), semaphore, nullptr);
+}
+
+uint64_t VulkanSemaphore::getCounterValue() const {
+	uint64_t value = 0;
+	if (vkGetSemaphoreCounterValue(device.getDevice(), semaphore, &value) != VK_SUCCESS) {
+		throw std::runtime_error("failed to read timeline semaphore value!");
+	}
+	return value;
+}
+
+void VulkanSemaphore::wait(uint64_t value) const {
+	VkSemaphoreWaitInfo waitInfo{};
+	waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+	waitInfo.semaphoreCount = 1;
+	waitInfo.pSemaphores = &semaphore;
+	waitInfo.pValues = &value;
+
+	if (vkWaitSemaphores(device.getDevice(), &waitInfo, UINT64_MAX) != VK_SUCCESS) {
+		throw std::runtime_error("failed to wait on timeline semaphore!");
+	}
 }
\ No newline at end of file
@@ -1,18 +1,24 @@
 #pragma once
 
 #include "Common/VulkanFwd.h"
+#include "Signboard/RHI/common/DeviceTypes.h"
 
 class VulkanDevice;
 
 class VulkanSemaphore {
 public:
-	VulkanSemaphore(VulkanDevice& device);
+	VulkanSemaphore(VulkanDevice& device, SemaphoreType type = SemaphoreType::Binary, uint64_t initialValue = 0);
 	~VulkanSemaphore();
 
 	VkSemaphore get() const { return semaphore; }
+	SemaphoreType getType() const { return type; }
+
+	uint64_t getCounterValue() const;
+	void wait(uint64_t value) const;
 
 private:
 	VulkanDevice& device;
 
 	VkSemaphore semaphore = nullptr;
+	SemaphoreType type;
 };
\ No newline at end of file
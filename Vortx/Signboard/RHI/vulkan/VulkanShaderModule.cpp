@@ -0,0 +1,42 @@
+#include "VulkanShaderModule.h"
+
+#include "VulkanDevice.h"
+
+VulkanShaderModule::VulkanShaderModule(VulkanDevice& device, const uint32_t* code, size_t wordCount)
+	: device(device)
+{
+	VkShaderModuleCreateInfo createInfo{};
+	createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+	createInfo.codeSize = wordCount * sizeof(uint32_t);
+	createInfo.pCode = code;
+
+	if (vkCreateShaderModule(device.getDevice(), &createInfo, nullptr, &module) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create shader module!");
+	}
+}
+
+VulkanShaderModule::VulkanShaderModule(VulkanShaderModule&& other) noexcept
+	: device(other.device), module(other.module)
+{
+	other.module = VK_NULL_HANDLE;
+}
+
+VulkanShaderModule& VulkanShaderModule::operator=(VulkanShaderModule&& other) noexcept {
+	if (this == &other)
+		return *this;
+
+	if (module)
+		vkDestroyShaderModule(device.getDevice(), module, nullptr);
+
+	module = other.module;
+	other.module = VK_NULL_HANDLE;
+
+	return *this;
+}
+
+VulkanShaderModule::~VulkanShaderModule() {
+	if (module) {
+		vkDestroyShaderModule(device.getDevice(), module, nullptr);
+		module = nullptr;
+	}
+}
\ No newline at end of file
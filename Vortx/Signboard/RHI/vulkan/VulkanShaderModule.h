@@ -0,0 +1,27 @@
+#pragma once
+
+#include "Common/VulkanFwd.h"
+
+#include <cstddef>
+
+class VulkanDevice;
+
+class VulkanShaderModule {
+public:
+	VulkanShaderModule(VulkanDevice& device, const uint32_t* code, size_t wordCount);
+
+	VulkanShaderModule(const VulkanShaderModule&) = delete;
+	VulkanShaderModule& operator=(const VulkanShaderModule&) = delete;
+
+	VulkanShaderModule(VulkanShaderModule&&) noexcept;
+	VulkanShaderModule& operator=(VulkanShaderModule&&) noexcept;
+
+	~VulkanShaderModule();
+
+	VkShaderModule getHandle() const { return module; }
+
+private:
+	VulkanDevice& device;
+
+	VkShaderModule module = nullptr;
+};
\ No newline at end of file
@@ -0,0 +1,226 @@
+#include "ChunkQuadtree.h"
+
+#include "core/resource.h"
+
+#include <algorithm>
+
+static int floorDiv(int a, int b) {
+	return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+int32_t ChunkQuadtree::allocNode(const glm::ivec2& origin, int size) {
+	int32_t index;
+	if (!freeNodes.empty()) {
+		index = freeNodes.back();
+		freeNodes.pop_back();
+		nodes[index] = Node{};
+	} else {
+		index = static_cast<int32_t>(nodes.size());
+		nodes.emplace_back();
+	}
+
+	nodes[index].origin = origin;
+	nodes[index].size = size;
+
+	if (size == LEAF_SIZE) {
+		int32_t leaf;
+		if (!freeLeaves.empty()) {
+			leaf = freeLeaves.back();
+			freeLeaves.pop_back();
+		} else {
+			leaf = static_cast<int32_t>(leaves.size());
+			leaves.emplace_back();
+		}
+		leaves[leaf].bounds.clear();
+		leaves[leaf].positions.clear();
+		nodes[index].leaf = leaf;
+	}
+
+	return index;
+}
+
+void ChunkQuadtree::freeNode(int32_t node) {
+	for (int32_t child : nodes[node].children)
+		if (child >= 0) freeNode(child);
+
+	if (nodes[node].leaf >= 0)
+		freeLeaves.push_back(nodes[node].leaf);
+
+	freeNodes.push_back(node);
+}
+
+bool ChunkQuadtree::contains(const Node& node, const glm::ivec2& c) const {
+	return c.x >= node.origin.x && c.x < node.origin.x + node.size &&
+		c.y >= node.origin.y && c.y < node.origin.y + node.size;
+}
+
+int ChunkQuadtree::quadrant(const Node& node, const glm::ivec2& c) const {
+	int half = node.size / 2;
+	return (c.x >= node.origin.x + half ? 1 : 0) + (c.y >= node.origin.y + half ? 2 : 0);
+}
+
+AABB ChunkQuadtree::nodeBounds(const Node& node) const {
+	return AABB{
+		{ static_cast<float>(node.origin.x * CHUNK_SIZE), 0.0f, static_cast<float>(node.origin.y * CHUNK_SIZE) },
+		{ static_cast<float>((node.origin.x + node.size) * CHUNK_SIZE), node.maxY, static_cast<float>((node.origin.y + node.size) * CHUNK_SIZE) }
+	};
+}
+
+void ChunkQuadtree::grow(const glm::ivec2& c) {
+	Node old = nodes[root];
+
+	glm::ivec2 origin = old.origin;
+	int q = 0;
+	if (c.x < old.origin.x) { origin.x -= old.size; q += 1; }
+	if (c.y < old.origin.y) { origin.y -= old.size; q += 2; }
+
+	int32_t newRoot = allocNode(origin, old.size * 2);
+	nodes[newRoot].children[q] = root;
+	nodes[newRoot].count = old.count;
+	nodes[newRoot].maxY = old.maxY;
+
+	root = newRoot;
+}
+
+void ChunkQuadtree::insert(const glm::ivec3& chunkPos, const AABB& bounds) {
+	glm::ivec2 c(chunkPos.x, chunkPos.z);
+
+	if (root < 0)
+		root = allocNode(glm::ivec2(floorDiv(c.x, LEAF_SIZE) * LEAF_SIZE, floorDiv(c.y, LEAF_SIZE) * LEAF_SIZE), LEAF_SIZE);
+
+	while (!contains(nodes[root], c))
+		grow(c);
+
+	int32_t n = root;
+	while (true) {
+		nodes[n].count++;
+		nodes[n].maxY = std::max(nodes[n].maxY, bounds.max.y);
+
+		if (nodes[n].leaf >= 0) {
+			Leaf& leaf = leaves[nodes[n].leaf];
+			leaf.bounds.push(bounds);
+			leaf.positions.push_back(chunkPos);
+			return;
+		}
+
+		int q = quadrant(nodes[n], c);
+		if (nodes[n].children[q] < 0) {
+			int half = nodes[n].size / 2;
+			glm::ivec2 origin = nodes[n].origin + glm::ivec2((q & 1) ? half : 0, (q & 2) ? half : 0);
+			int32_t child = allocNode(origin, half);
+			nodes[n].children[q] = child;
+		}
+		n = nodes[n].children[q];
+	}
+}
+
+void ChunkQuadtree::remove(const glm::ivec3& chunkPos) {
+	glm::ivec2 c(chunkPos.x, chunkPos.z);
+	if (root < 0 || !contains(nodes[root], c))
+		return;
+
+	int32_t path[32];
+	int depth = 0;
+
+	int32_t n = root;
+	while (n >= 0 && nodes[n].leaf < 0) {
+		path[depth++] = n;
+		n = nodes[n].children[quadrant(nodes[n], c)];
+	}
+	if (n < 0)
+		return;
+
+	Leaf& leaf = leaves[nodes[n].leaf];
+	auto it = std::find_if(leaf.positions.begin(), leaf.positions.end(), [&](const glm::ivec3& p) {
+		return p.x == chunkPos.x && p.y == chunkPos.y && p.z == chunkPos.z;
+	});
+	if (it == leaf.positions.end())
+		return;
+
+	uint32_t entry = static_cast<uint32_t>(it - leaf.positions.begin());
+	leaf.bounds.swapRemove(entry);
+	*it = leaf.positions.back();
+	leaf.positions.pop_back();
+
+	path[depth++] = n;
+
+	for (int i = depth - 1; i >= 0; i--) {
+		int32_t node = path[i];
+		if (--nodes[node].count > 0) continue;
+
+		nodes[node].maxY = 0.0f;
+		if (i == 0) {
+			freeNode(node);
+			root = -1;
+		} else {
+			int32_t parent = path[i - 1];
+			nodes[parent].children[quadrant(nodes[parent], c)] = -1;
+			freeNode(node);
+		}
+	}
+}
+
+void ChunkQuadtree::clear() {
+	root = -1;
+	nodes.clear();
+	leaves.clear();
+	freeNodes.clear();
+	freeLeaves.clear();
+}
+
+void ChunkQuadtree::query(const Frustum& frustum, std::vector<glm::ivec3>& visible, CullingStats& stats) const {
+	if (root < 0)
+		return;
+
+	stats.chunksTested += nodes[root].count;
+	visit(root, frustum, false, visible, stats);
+}
+
+void ChunkQuadtree::visit(int32_t n, const Frustum& frustum, bool fullyInside, std::vector<glm::ivec3>& visible, CullingStats& stats) const {
+	const Node& node = nodes[n];
+	stats.nodesVisited++;
+
+	if (!fullyInside) {
+		FrustumTest result = frustum.test(nodeBounds(node));
+		if (result == FrustumTest::Outside) {
+			stats.chunksFrustumCulled += node.count;
+			return;
+		}
+		fullyInside = result == FrustumTest::Inside;
+	}
+
+	if (fullyInside) {
+		appendAll(n, visible);
+		return;
+	}
+
+	if (node.leaf >= 0) {
+		const Leaf& leaf = leaves[node.leaf];
+
+		uint8_t mask[LEAF_SIZE * LEAF_SIZE];
+		uint32_t count = leaf.bounds.size();
+		frustum.testBounds(leaf.bounds, 0, count, mask);
+
+		for (uint32_t i = 0; i < count; i++) {
+			if (mask[i]) visible.push_back(leaf.positions[i]);
+			else stats.chunksFrustumCulled++;
+		}
+		return;
+	}
+
+	for (int32_t child : node.children)
+		if (child >= 0) visit(child, frustum, false, visible, stats);
+}
+
+void ChunkQuadtree::appendAll(int32_t n, std::vector<glm::ivec3>& visible) const {
+	const Node& node = nodes[n];
+
+	if (node.leaf >= 0) {
+		const Leaf& leaf = leaves[node.leaf];
+		visible.insert(visible.end(), leaf.positions.begin(), leaf.positions.end());
+		return;
+	}
+
+	for (int32_t child : node.children)
+		if (child >= 0) appendAll(child, visible);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Frustum.h"
+#include "core/dataDef/Bounds.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cstdint>
+
+class ChunkQuadtree {
+public:
+	static constexpr int LEAF_SIZE = 4;
+
+	void insert(const glm::ivec3& chunkPos, const AABB& bounds);
+	void remove(const glm::ivec3& chunkPos);
+	void clear();
+
+	uint32_t size() const { return root < 0 ? 0 : nodes[root].count; }
+
+	void query(const Frustum& frustum, std::vector<glm::ivec3>& visible, CullingStats& stats) const;
+
+private:
+	struct Node {
+		glm::ivec2 origin;
+		int size = 0;
+		float maxY = 0.0f;
+		uint32_t count = 0;
+		int32_t children[4] = { -1, -1, -1, -1 };
+		int32_t leaf = -1;
+	};
+
+	struct Leaf {
+		BoundsSoA bounds;
+		std::vector<glm::ivec3> positions;
+	};
+
+	int32_t allocNode(const glm::ivec2& origin, int size);
+	void freeNode(int32_t node);
+
+	bool contains(const Node& node, const glm::ivec2& c) const;
+	int quadrant(const Node& node, const glm::ivec2& c) const;
+	AABB nodeBounds(const Node& node) const;
+
+	void grow(const glm::ivec2& c);
+	void visit(int32_t node, const Frustum& frustum, bool fullyInside, std::vector<glm::ivec3>& visible, CullingStats& stats) const;
+	void appendAll(int32_t node, std::vector<glm::ivec3>& visible) const;
+
+private:
+	int32_t root = -1;
+
+	std::vector<Node> nodes;
+	std::vector<Leaf> leaves;
+
+	std::vector<int32_t> freeNodes;
+	std::vector<int32_t> freeLeaves;
+};
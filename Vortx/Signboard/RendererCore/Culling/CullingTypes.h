@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+
+enum class FrustumTest {
+	Outside,
+	Intersect,
+	Inside
+};
+
+struct CullingStats {
+	uint32_t objectsTested = 0;
+	uint32_t objectsVisible = 0;
+	uint32_t objectsFrustumCulled = 0;
+	uint32_t objectsOcclusionCulled = 0;
+
+	uint32_t chunksTested = 0;
+	uint32_t chunksVisible = 0;
+	uint32_t chunksFrustumCulled = 0;
+	uint32_t chunksOcclusionCulled = 0;
+
+	uint32_t nodesVisited = 0;
+
+	float cullMs = 0.0f;
+};
@@ -0,0 +1,100 @@
+#include "Frustum.h"
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define FRUSTUM_SSE
+#include <xmmintrin.h>
+#endif
+
+Frustum::Frustum(const glm::mat4& view, const glm::mat4& proj)
+	: Frustum(proj * view) {}
+
+Frustum::Frustum(const glm::mat4& m) {
+	auto row = [&](int i) { return glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]); };
+
+	glm::vec4 r0 = row(0), r1 = row(1), r2 = row(2), r3 = row(3);
+
+	planes[0] = r3 + r0;
+	planes[1] = r3 - r0;
+	planes[2] = r3 + r1;
+	planes[3] = r3 - r1;
+	planes[4] = r2;
+	planes[5] = r3 - r2;
+
+	for (auto& p : planes)
+		p = p / glm::length(glm::vec3(p));
+}
+
+FrustumTest Frustum::test(const AABB& box) const {
+	FrustumTest result = FrustumTest::Inside;
+
+	for (const auto& p : planes) {
+		glm::vec3 positive{
+			p.x > 0.0f ? box.max.x : box.min.x,
+			p.y > 0.0f ? box.max.y : box.min.y,
+			p.z > 0.0f ? box.max.z : box.min.z
+		};
+		if (glm::dot(glm::vec3(p), positive) + p.w < 0.0f)
+			return FrustumTest::Outside;
+
+		glm::vec3 negative{
+			p.x > 0.0f ? box.min.x : box.max.x,
+			p.y > 0.0f ? box.min.y : box.max.y,
+			p.z > 0.0f ? box.min.z : box.max.z
+		};
+		if (glm::dot(glm::vec3(p), negative) + p.w < 0.0f)
+			result = FrustumTest::Intersect;
+	}
+
+	return result;
+}
+
+uint32_t Frustum::testBounds(const BoundsSoA& bounds, uint32_t first, uint32_t count, uint8_t* visible) const {
+	const float* xs[6];
+	const float* ys[6];
+	const float* zs[6];
+	for (int p = 0; p < 6; p++) {
+		xs[p] = planes[p].x > 0.0f ? bounds.maxX.data() : bounds.minX.data();
+		ys[p] = planes[p].y > 0.0f ? bounds.maxY.data() : bounds.minY.data();
+		zs[p] = planes[p].z > 0.0f ? bounds.maxZ.data() : bounds.minZ.data();
+	}
+
+	uint32_t visibleCount = 0;
+	uint32_t i = first;
+	const uint32_t end = first + count;
+
+#ifdef FRUSTUM_SSE
+	const __m128 zero = _mm_setzero_ps();
+
+	for (; i + 4 <= end; i += 4) {
+		__m128 inside = _mm_cmpeq_ps(zero, zero);
+
+		for (int p = 0; p < 6; p++) {
+			__m128 d = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes[p].x), _mm_loadu_ps(xs[p] + i)), _mm_mul_ps(_mm_set1_ps(planes[p].y), _mm_loadu_ps(ys[p] + i))),
+				_mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes[p].z), _mm_loadu_ps(zs[p] + i)), _mm_set1_ps(planes[p].w)));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(d, zero));
+		}
+
+		int mask = _mm_movemask_ps(inside);
+		for (uint32_t lane = 0; lane < 4; lane++) {
+			uint8_t v = static_cast<uint8_t>((mask >> lane) & 1);
+			visible[i - first + lane] = v;
+			visibleCount += v;
+		}
+	}
+#endif
+
+	for (; i < end; i++) {
+		uint8_t v = 1;
+		for (int p = 0; p < 6; p++) {
+			if (planes[p].x * xs[p][i] + planes[p].y * ys[p][i] + planes[p].z * zs[p][i] + planes[p].w < 0.0f) {
+				v = 0;
+				break;
+			}
+		}
+		visible[i - first] = v;
+		visibleCount += v;
+	}
+
+	return visibleCount;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "CullingTypes.h"
+#include "core/dataDef/Bounds.h"
+
+#include <glm/glm.hpp>
+
+struct Frustum {
+	glm::vec4 planes[6];
+
+	Frustum() = default;
+	explicit Frustum(const glm::mat4& viewProj);
+	Frustum(const glm::mat4& view, const glm::mat4& proj);
+
+	FrustumTest test(const AABB& box) const;
+	uint32_t testBounds(const BoundsSoA& bounds, uint32_t first, uint32_t count, uint8_t* visible) const;
+};
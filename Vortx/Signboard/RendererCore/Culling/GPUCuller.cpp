@@ -0,0 +1,398 @@
+#include "GPUCuller.h"
+
+#include "Signboard/RHI/vulkan/VulkanDevice.h"
+#include "Signboard/RHI/vulkan/VulkanCommandBuffer.h"
+#include "Signboard/RHI/vulkan/VulkanDescriptorWriter.h"
+#include "Signboard/RHI/vulkan/VulkanPipeline.h"
+
+#include "Signboard/resources/resourceSystems/PipelineSystem.h"
+#include "Signboard/resources/resourceSystems/MeshSystem.h"
+#include "Signboard/resources/resourceSystems/DeletionQueue.h"
+#include "Signboard/resources/resourceSystems/primitive/Mesh.h"
+#include "Signboard/resources/scene/ObjectSystem.h"
+
+#include "Signboard/RendererCore/RenderGraph/HiZPass/HiZPass.h"
+
+#include <algorithm>
+#include <cstring>
+
+static DescriptorPoolDesc makePoolDesc(uint32_t frameCount) {
+	DescriptorPoolDesc desc{};
+	desc.maxSets = frameCount;
+	desc.poolSizes.push_back({ DescriptorType::StorageBuffer, 6 * frameCount });
+	desc.poolSizes.push_back({ DescriptorType::UniformBuffer, frameCount });
+	desc.poolSizes.push_back({ DescriptorType::CombinedImageSampler, frameCount });
+
+	return desc;
+}
+
+GPUCuller::GPUCuller(VulkanDevice& device, PipelineSystem& pipelines, DeletionQueue& deletions, uint32_t frameCount)
+	: device(device), pipelines(pipelines), deletions(deletions), setLayout(device, makeSetLayoutDesc()), descriptorPool(device, makePoolDesc(frameCount)), pipelineLayout(device, VulkanPipelineLayoutDesc{}), pipeline(INVALID_PIPELINE)
+{
+	pipelineLayout.addDescriptorSetLayout(setLayout);
+	pipelineLayout.addPushConstantRange({ ShaderStageBit::ComputeBit, 0, sizeof(uint32_t) });
+	pipelineLayout.build();
+
+	drawCountSupported = device.supportsDrawIndirectCount();
+	multiDrawSupported = device.supportsMultiDrawIndirect();
+
+	frames.resize(frameCount);
+	for (FrameResources& frame : frames) {
+		frame.set = descriptorPool.allocate(setLayout, nullptr);
+
+		BufferDesc uniformDesc{};
+		uniformDesc.size = sizeof(GPUCullUniforms);
+		uniformDesc.usageFlags = BufferUsage::Uniform;
+		uniformDesc.memoryFlags.set(MemoryProperty::HostVisible, MemoryProperty::HostCoherent);
+
+		BufferDesc statsDesc{};
+		statsDesc.size = sizeof(GPUCullStats);
+		statsDesc.usageFlags.set(BufferUsage::Storage, BufferUsage::TransferDestination);
+		statsDesc.memoryFlags.set(MemoryProperty::HostVisible, MemoryProperty::HostCoherent);
+
+		frame.uniforms = std::make_unique<VulkanBuffer>(device, uniformDesc);
+		frame.stats = std::make_unique<VulkanBuffer>(device, statsDesc);
+	}
+}
+
+PipelineManifestEntry GPUCuller::getPipelineEntry() {
+	PipelineManifestEntry entry{};
+	entry.layout = &pipelineLayout;
+	entry.desc.type = PipelineType::Compute;
+	entry.desc.shaders.push_back({ ShaderStageBit::ComputeBit, "shaders/cull_objects.comp.spv" });
+
+	return entry;
+}
+
+GPUCuller::~GPUCuller() {
+	pipelines.destroy(pipeline);
+}
+
+DescriptorSetLayoutDesc GPUCuller::makeSetLayoutDesc() const {
+	DescriptorSetLayoutDesc desc{};
+	for (uint32_t binding = 0; binding < 4; binding++)
+		desc.bindings.push_back({ binding, DescriptorType::StorageBuffer, 1, ShaderStageBit::ComputeBit });
+
+	desc.bindings.push_back({ 4, DescriptorType::UniformBuffer, 1, ShaderStageBit::ComputeBit });
+	desc.bindings.push_back({ 5, DescriptorType::StorageBuffer, 1, ShaderStageBit::ComputeBit });
+	desc.bindings.push_back({ 6, DescriptorType::StorageBuffer, 1, ShaderStageBit::ComputeBit });
+	desc.bindings.push_back({ 7, DescriptorType::CombinedImageSampler, 1, ShaderStageBit::ComputeBit });
+
+	return desc;
+}
+
+void GPUCuller::reserve(FrameResources& frame, uint32_t itemsNeeded, uint32_t meshesNeeded) {
+	bool dirty = frame.bufferVersion != bufferVersion;
+
+	if (itemsNeeded > frame.itemCapacity || !frame.items) {
+		uint32_t capacity = std::max(std::max(itemsNeeded, frame.itemCapacity * 2), GROUP_SIZE);
+
+		BufferDesc itemDesc{};
+		itemDesc.size = sizeof(GPUCullItem) * capacity;
+		itemDesc.usageFlags = BufferUsage::Storage;
+		itemDesc.memoryFlags.set(MemoryProperty::HostVisible, MemoryProperty::HostCoherent);
+
+		frame.items = std::make_unique<VulkanBuffer>(device, itemDesc);
+		frame.itemCapacity = capacity;
+		dirty = true;
+	}
+
+	if (meshesNeeded > frame.meshCapacity || !frame.meshInfo) {
+		uint32_t capacity = std::max(std::max(meshesNeeded, frame.meshCapacity * 2), 16u);
+
+		BufferDesc meshDesc{};
+		meshDesc.size = sizeof(GPUMeshInfo) * capacity;
+		meshDesc.usageFlags = BufferUsage::Storage;
+		meshDesc.memoryFlags.set(MemoryProperty::HostVisible, MemoryProperty::HostCoherent);
+
+		frame.meshInfo = std::make_unique<VulkanBuffer>(device, meshDesc);
+		frame.meshCapacity = capacity;
+		dirty = true;
+	}
+
+	if (dirty)
+		writeDescriptors(frame);
+
+	if (hiz && frame.hizVersion != hiz->getVersion())
+		writeHiZDescriptor(frame);
+}
+
+void GPUCuller::reserveVisibility(uint32_t objects) {
+	if (objects <= visibilityCapacity && visibility)
+		return;
+
+	// frames in flight still cull against the old buffer, it goes once they have retired
+	retire(visibility);
+
+	uint32_t capacity = std::max(std::max(objects, visibilityCapacity * 2), GROUP_SIZE);
+
+	BufferDesc desc{};
+	desc.size = sizeof(uint32_t) * capacity;
+	desc.usageFlags.set(BufferUsage::Storage, BufferUsage::TransferDestination);
+	desc.memoryFlags = MemoryProperty::DeviceLocal;
+
+	visibility = std::make_unique<VulkanBuffer>(device, desc);
+	visibilityCapacity = capacity;
+	bufferVersion++;
+	visibilityCleared = false;
+}
+
+void GPUCuller::reserveOutputs(uint32_t itemsNeeded, uint32_t meshesNeeded) {
+	// both phases write their own half, the late one starts at the capacity
+	if (itemsNeeded > commandCapacity || !commands) {
+		retire(commands);
+
+		uint32_t capacity = std::max(std::max(itemsNeeded, commandCapacity * 2), GROUP_SIZE);
+
+		BufferDesc desc{};
+		desc.size = sizeof(GPUDrawCommand) * capacity * 2;
+		desc.usageFlags.set(BufferUsage::Storage, BufferUsage::Indirect);
+		desc.memoryFlags = MemoryProperty::DeviceLocal;
+
+		commands = std::make_unique<VulkanBuffer>(device, desc);
+		commandCapacity = capacity;
+		bufferVersion++;
+	}
+
+	if (meshesNeeded > countCapacity || !counts) {
+		retire(counts);
+
+		uint32_t capacity = std::max(std::max(meshesNeeded, countCapacity * 2), 16u);
+
+		BufferDesc desc{};
+		desc.size = sizeof(uint32_t) * capacity * 2;
+		desc.usageFlags.set(BufferUsage::Storage, BufferUsage::Indirect, BufferUsage::TransferDestination);
+		desc.memoryFlags = MemoryProperty::DeviceLocal;
+
+		counts = std::make_unique<VulkanBuffer>(device, desc);
+		countCapacity = capacity;
+		bufferVersion++;
+	}
+}
+
+void GPUCuller::retire(std::unique_ptr<VulkanBuffer>& buffer) {
+	if (!buffer)
+		return;
+
+	std::shared_ptr<VulkanBuffer> retired = std::move(buffer);
+	deletions.retire([retired]() mutable { retired.reset(); });
+}
+
+void GPUCuller::writeDescriptors(FrameResources& frame) {
+	VulkanDescriptorWriter writer(device, frame.set);
+
+	writer.writeStorageBuffer(0, frame.items.get(), frame.items->getSize());
+	writer.writeStorageBuffer(1, frame.meshInfo.get(), frame.meshInfo->getSize());
+	writer.writeStorageBuffer(2, commands.get(), commands->getSize());
+	writer.writeStorageBuffer(3, counts.get(), counts->getSize());
+	writer.writeUniformBuffer(4, frame.uniforms.get(), frame.uniforms->getSize());
+	writer.writeStorageBuffer(5, visibility.get(), visibility->getSize());
+	writer.writeStorageBuffer(6, frame.stats.get(), frame.stats->getSize());
+	writer.commit();
+
+	frame.bufferVersion = bufferVersion;
+}
+
+void GPUCuller::writeHiZDescriptor(FrameResources& frame) {
+	VulkanDescriptorWriter writer(device, frame.set);
+
+	writer.writeCombinedImageSampler(7, &hiz->getPyramid(), &hiz->getSampler(), ImageLayout::General);
+	writer.commit();
+
+	frame.hizVersion = hiz->getVersion();
+}
+
+void GPUCuller::readStats(FrameResources& frame) {
+	if (!frame.statsPending)
+		return;
+
+	std::memcpy(&stats, frame.stats->map(), sizeof(GPUCullStats));
+	frame.statsPending = false;
+}
+
+void GPUCuller::prepare(uint32_t frameIndex, const ObjectSystem& objects, const MeshSystem& meshes, const glm::mat4& viewProj, const Frustum& frustum) {
+	FrameResources& frame = frames[frameIndex];
+	readStats(frame);
+
+	uint32_t meshCount = meshes.getSlotCount();
+	slotCount = objects.getSlotCount();
+
+	bucketOffsets.assign(meshCount + 1, 0);
+	for (uint32_t i = 0; i < slotCount; i++) {
+		if (!objects.isAlive(i)) continue;
+
+		uint32_t mesh = objects.getMeshIndex(i);
+		if (mesh < meshCount && meshes.getByIndex(mesh))
+			bucketOffsets[mesh + 1]++;
+	}
+
+	for (uint32_t m = 0; m < meshCount; m++)
+		bucketOffsets[m + 1] += bucketOffsets[m];
+
+	itemCount = bucketOffsets[meshCount];
+
+	// with every mesh in the geometry arena one bind covers all draws, so the buckets collapse into one range
+	mergedDraws = meshes.allArenaResident();
+
+	meshInfo.assign(meshCount, GPUMeshInfo{});
+	buckets.clear();
+	for (uint32_t m = 0; m < meshCount; m++) {
+		const Mesh* mesh = meshes.getByIndex(m);
+		if (!mesh) continue;
+
+		uint32_t drawBase = mergedDraws && drawCountSupported ? 0 : bucketOffsets[m];
+		uint32_t countSlot = mergedDraws ? 0 : m;
+		meshInfo[m] = GPUMeshInfo{ mesh->getIndexCount(), mesh->getFirstIndex(), mesh->getVertexOffset(), drawBase, countSlot };
+
+		uint32_t drawCount = bucketOffsets[m + 1] - bucketOffsets[m];
+		if (drawCount)
+			buckets.push_back(Bucket{ m, bucketOffsets[m], drawCount });
+	}
+
+	items.resize(itemCount);
+	const BoundsSoA& bounds = objects.getWorldBounds();
+	for (uint32_t i = 0; i < slotCount; i++) {
+		if (!objects.isAlive(i)) continue;
+
+		uint32_t mesh = objects.getMeshIndex(i);
+		if (mesh >= meshCount || !meshes.getByIndex(mesh)) continue;
+
+		AABB box = bounds.get(i);
+		items[bucketOffsets[mesh]++] = GPUCullItem{ box.center(), mesh, box.extent(), i };
+	}
+
+	reserveVisibility(slotCount);
+	reserveOutputs(itemCount, meshCount);
+	reserve(frame, itemCount, meshCount);
+
+	if (itemCount)
+		frame.items->upload(items.data(), sizeof(GPUCullItem) * itemCount);
+	if (meshCount)
+		frame.meshInfo->upload(meshInfo.data(), sizeof(GPUMeshInfo) * meshCount);
+
+	bool hizReady = hiz && hiz->hasDepthSource();
+	ImageExtent2D hizExtent = hizReady ? hiz->getPyramid().getExtent() : ImageExtent2D{ 1, 1 };
+
+	uniforms.viewProj = viewProj;
+	std::copy(std::begin(frustum.planes), std::end(frustum.planes), uniforms.planes);
+	uniforms.hizSize = glm::vec2(hizExtent.width, hizExtent.height);
+	uniforms.hizLevels = hizReady ? hiz->getPyramid().getMipLevels() : 1;
+	uniforms.hizEnabled = hizReady ? 1u : 0u;
+	uniforms.itemCount = itemCount;
+	uniforms.compact = drawCountSupported ? 1u : 0u;
+	uniforms.commandStride = commandCapacity;
+	uniforms.countStride = countCapacity;
+	uniforms.visibilityCount = visibilityCapacity;
+
+	frame.uniforms->upload(&uniforms, sizeof(GPUCullUniforms));
+}
+
+void GPUCuller::clear(VulkanCommandBuffer& cmd, uint32_t frameIndex) {
+	FrameResources& frame = frames[frameIndex];
+
+	cmd.fillBuffer(*counts, 0, counts->getSize(), 0);
+	cmd.fillBuffer(*frame.stats, 0, frame.stats->getSize(), 0);
+	if (!visibilityCleared) {
+		cmd.fillBuffer(*visibility, 0, visibility->getSize(), 0);
+		visibilityCleared = true;
+	}
+}
+
+void GPUCuller::dispatch(VulkanCommandBuffer& cmd, uint32_t frameIndex, CullPhase phase) {
+	FrameResources& frame = frames[frameIndex];
+
+	// the pyramid is first read before hi-z has built it, its layout is the pass's own to set up
+	if (phase == CullPhase::Early && hiz)
+		hiz->prepareLayout(cmd);
+
+	if (itemCount) {
+		uint32_t phaseIndex = static_cast<uint32_t>(phase);
+
+		cmd.bindPipeline(pipelines.get(pipeline), PipelineType::Compute);
+		cmd.bindDescriptorSet(PipelineType::Compute, pipelineLayout, 0, frame.set);
+		cmd.pushConstants(pipelineLayout, ShaderStageBit::ComputeBit, 0, sizeof(uint32_t), &phaseIndex);
+		cmd.dispatch((itemCount + GROUP_SIZE - 1) / GROUP_SIZE);
+	}
+
+	// the indirect reads are declared by the drawing passes, the graph places that barrier. it does not model the
+	// host, so the stats readback keeps its own
+	if (phase == CullPhase::Late) {
+		cmd.bufferBarrier(*frame.stats, PipelineStage::ComputeShader, ResourceAccess::ShaderWrite, PipelineStage::Host, ResourceAccess::HostRead);
+		frame.statsPending = true;
+	}
+}
+
+void GPUCuller::draw(VulkanCommandBuffer& cmd, uint32_t frameIndex, const MeshSystem& meshes, CullPhase phase) const {
+	uint64_t commandBase = phase == CullPhase::Late ? commandCapacity : 0;
+	uint64_t countBase = phase == CullPhase::Late ? countCapacity : 0;
+
+	if (mergedDraws) {
+		if (!itemCount)
+			return;
+
+		meshes.getArena()->bind(cmd);
+
+		uint64_t offset = sizeof(GPUDrawCommand) * commandBase;
+		if (drawCountSupported)
+			cmd.drawIndexedIndirectCount(*commands, offset, *counts, sizeof(uint32_t) * countBase, itemCount, sizeof(GPUDrawCommand));
+		else if (multiDrawSupported)
+			cmd.drawIndexedIndirect(*commands, offset, itemCount, sizeof(GPUDrawCommand));
+		else
+			for (uint32_t i = 0; i < itemCount; i++)
+				cmd.drawIndexedIndirect(*commands, offset + sizeof(GPUDrawCommand) * i, 1, sizeof(GPUDrawCommand));
+		return;
+	}
+
+	for (const Bucket& bucket : buckets) {
+		meshes.getByIndex(bucket.meshIndex)->bind(cmd);
+
+		uint64_t offset = sizeof(GPUDrawCommand) * (commandBase + bucket.drawBase);
+		if (drawCountSupported)
+			cmd.drawIndexedIndirectCount(*commands, offset, *counts, sizeof(uint32_t) * (countBase + bucket.meshIndex), bucket.drawCount, sizeof(GPUDrawCommand));
+		else if (multiDrawSupported)
+			cmd.drawIndexedIndirect(*commands, offset, bucket.drawCount, sizeof(GPUDrawCommand));
+		else
+			for (uint32_t i = 0; i < bucket.drawCount; i++)
+				cmd.drawIndexedIndirect(*commands, offset + sizeof(GPUDrawCommand) * i, 1, sizeof(GPUDrawCommand));
+	}
+}
+
+void GPUCuller::addCullToGraph(RenderGraph& graph, const uint32_t& frameIndex, CullPhase phase) {
+	// the early phase starts from zeroed counts and stats, cleared in a pass of their own so the graph orders the
+	// clears against this frame's culling and the last frame's draws
+	if (phase == CullPhase::Early) {
+		Pass& clearPass = graph.addPass({ "GPUCullClear" });
+		clearPass.computeCapable = true;
+		declareCullState(clearPass, PipelineStage::Transfer, ResourceAccess::TransferWrite);
+		clearPass.execute = [this, &frameIndex](VulkanCommandBuffer& cmd) { clear(cmd, frameIndex); };
+	}
+
+	Pass& pass = graph.addPass({ phase == CullPhase::Early ? "GPUCullEarly" : "GPUCullLate" });
+	pass.computeCapable = true;
+
+	// the early phase tests against the pyramid the last frame built
+	if (hiz)
+		pass.imageAccess.push_back({ &hiz->getPyramid(), PipelineStage::ComputeShader, ResourceAccess::ShaderRead });
+
+	ResourceAccessFlags shaderReadWrite;
+	shaderReadWrite.set(ResourceAccess::ShaderRead, ResourceAccess::ShaderWrite);
+
+	declareCullState(pass, PipelineStage::ComputeShader, shaderReadWrite);
+	pass.bufferAccess.push_back({ commands.get(), PipelineStage::ComputeShader, ResourceAccess::ShaderWrite });
+
+	pass.execute = [this, &frameIndex, phase](VulkanCommandBuffer& cmd) { dispatch(cmd, frameIndex, phase); };
+}
+
+void GPUCuller::declareCullState(Pass& pass, PipelineStageFlags stages, ResourceAccessFlags access) const {
+	pass.bufferAccess.push_back({ counts.get(), stages, access });
+	pass.bufferAccess.push_back({ visibility.get(), stages, access });
+
+	// the graph is compiled once for every frame in flight, so each frame's stats are named
+	for (const FrameResources& frame : frames)
+		pass.bufferAccess.push_back({ frame.stats.get(), stages, access });
+}
+
+void GPUCuller::declareDraws(Pass& pass) const {
+	pass.bufferAccess.push_back({ commands.get(), PipelineStage::DrawIndirect, ResourceAccess::IndirectCommandRead });
+	pass.bufferAccess.push_back({ counts.get(), PipelineStage::DrawIndirect, ResourceAccess::IndirectCommandRead });
+}
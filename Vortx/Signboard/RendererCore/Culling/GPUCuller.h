@@ -0,0 +1,188 @@
+#pragma once
+
+#include "Frustum.h"
+
+#include "Signboard/RHI/vulkan/VulkanBuffer.h"
+#include "Signboard/RHI/vulkan/VulkanDescriptorLayout.h"
+#include "Signboard/RHI/vulkan/VulkanDescriptorPool.h"
+#include "Signboard/RHI/vulkan/VulkanDescriptorSet.h"
+#include "Signboard/RHI/vulkan/VulkanPipelineLayout.h"
+
+#include "Signboard/resources/common/PipelineSystemTypes.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <memory>
+
+class VulkanDevice;
+class VulkanCommandBuffer;
+class PipelineSystem;
+class DeletionQueue;
+class ObjectSystem;
+class MeshSystem;
+class HiZPass;
+class RenderGraph;
+struct Pass;
+struct PipelineManifestEntry;
+
+struct GPUCullItem {
+	glm::vec3 center;
+	uint32_t meshIndex;
+	glm::vec3 extent;
+	uint32_t objectIndex;
+};
+
+struct GPUMeshInfo {
+	uint32_t indexCount;
+	uint32_t firstIndex;
+	int32_t vertexOffset;
+	uint32_t drawBase;
+	uint32_t countSlot;
+};
+
+struct GPUDrawCommand {
+	uint32_t indexCount;
+	uint32_t instanceCount;
+	uint32_t firstIndex;
+	int32_t vertexOffset;
+	uint32_t firstInstance;
+};
+
+struct GPUCullUniforms {
+	alignas(16) glm::mat4 viewProj;
+	alignas(16) glm::vec4 planes[6];
+	alignas(8) glm::vec2 hizSize;
+	uint32_t hizLevels;
+	uint32_t hizEnabled;
+	uint32_t itemCount;
+	uint32_t compact;
+	uint32_t commandStride;
+	uint32_t countStride;
+	uint32_t visibilityCount;
+};
+
+struct GPUCullStats {
+	uint32_t frustumCulled = 0;
+	uint32_t earlyDrawn = 0;
+	uint32_t lateDrawn = 0;
+	uint32_t occluded = 0;
+};
+
+enum class CullPhase : uint32_t {
+	Early = 0,
+	Late = 1
+};
+
+class GPUCuller {
+public:
+	static constexpr uint32_t GROUP_SIZE = 64;
+
+	GPUCuller(VulkanDevice& device, PipelineSystem& pipelines, DeletionQueue& deletions, uint32_t frameCount);
+	~GPUCuller();
+
+	GPUCuller(const GPUCuller&) = delete;
+	GPUCuller& operator=(const GPUCuller&) = delete;
+
+	void setHiZ(HiZPass* pass) { hiz = pass; }
+
+	// the culling pipeline is prewarmed with the renderer's manifest, nothing dispatches before it is set
+	PipelineManifestEntry getPipelineEntry();
+	void setPipeline(PipelineHandle handle) { pipeline = handle; }
+
+	void prepare(uint32_t frameIndex, const ObjectSystem& objects, const MeshSystem& meshes, const glm::mat4& viewProj, const Frustum& frustum);
+	void dispatch(VulkanCommandBuffer& cmd, uint32_t frameIndex, CullPhase phase);
+	void draw(VulkanCommandBuffer& cmd, uint32_t frameIndex, const MeshSystem& meshes, CullPhase phase) const;
+
+	void addCullToGraph(RenderGraph& graph, const uint32_t& frameIndex, CullPhase phase);
+
+	// the indirect reads of a pass that calls draw, so the graph orders it after the culling dispatch
+	void declareDraws(Pass& pass) const;
+
+	// bumped whenever a buffer the graph passes name is replaced, the graph has to be rebuilt then
+	uint32_t getBufferVersion() const { return bufferVersion; }
+
+	bool usesDrawCount() const { return drawCountSupported; }
+
+	uint32_t getItemCount() const { return itemCount; }
+	uint32_t getDrawCallCount() const { return mergedDraws ? (itemCount ? 1u : 0u) : static_cast<uint32_t>(buckets.size()); }
+	const GPUCullStats& getStats() const { return stats; }
+
+private:
+	struct Bucket {
+		uint32_t meshIndex;
+		uint32_t drawBase;
+		uint32_t drawCount;
+	};
+
+	// host written inputs and the stats readback, one set per frame in flight
+	struct FrameResources {
+		std::unique_ptr<VulkanBuffer> items;
+		std::unique_ptr<VulkanBuffer> meshInfo;
+		std::unique_ptr<VulkanBuffer> uniforms;
+		std::unique_ptr<VulkanBuffer> stats;
+
+		VulkanDescriptorSet set;
+
+		uint32_t itemCapacity = 0;
+		uint32_t meshCapacity = 0;
+
+		uint32_t bufferVersion = UINT32_MAX;
+		uint32_t hizVersion = UINT32_MAX;
+
+		bool statsPending = false;
+	};
+
+	void clear(VulkanCommandBuffer& cmd, uint32_t frameIndex);
+	void declareCullState(Pass& pass, PipelineStageFlags stages, ResourceAccessFlags access) const;
+
+	void reserve(FrameResources& frame, uint32_t items, uint32_t meshes);
+	void reserveVisibility(uint32_t objects);
+	void reserveOutputs(uint32_t items, uint32_t meshes);
+	void retire(std::unique_ptr<VulkanBuffer>& buffer);
+	void writeDescriptors(FrameResources& frame);
+	void writeHiZDescriptor(FrameResources& frame);
+	void readStats(FrameResources& frame);
+
+	DescriptorSetLayoutDesc makeSetLayoutDesc() const;
+
+private:
+	VulkanDevice& device;
+	PipelineSystem& pipelines;
+	DeletionQueue& deletions;
+
+	VulkanDescriptorSetLayout setLayout;
+	VulkanDescriptorPool descriptorPool;
+	VulkanPipelineLayout pipelineLayout;
+	PipelineHandle pipeline;
+
+	HiZPass* hiz = nullptr;
+
+	bool drawCountSupported = false;
+	bool multiDrawSupported = false;
+
+	std::vector<FrameResources> frames;
+
+	// only ever touched by the device, so one copy serves every frame and the graph orders the frames' accesses
+	std::unique_ptr<VulkanBuffer> visibility;
+	std::unique_ptr<VulkanBuffer> commands;
+	std::unique_ptr<VulkanBuffer> counts;
+	uint32_t visibilityCapacity = 0;
+	uint32_t commandCapacity = 0;
+	uint32_t countCapacity = 0;
+	uint32_t bufferVersion = 0;
+	bool visibilityCleared = false;
+
+	std::vector<GPUCullItem> items;
+	std::vector<GPUMeshInfo> meshInfo;
+	std::vector<Bucket> buckets;
+	std::vector<uint32_t> bucketOffsets;
+
+	uint32_t itemCount = 0;
+	uint32_t slotCount = 0;
+
+	bool mergedDraws = false;
+
+	GPUCullUniforms uniforms{};
+	GPUCullStats stats;
+};
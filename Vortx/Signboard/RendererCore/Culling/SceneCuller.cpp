@@ -0,0 +1,78 @@
+#include "SceneCuller.h"
+#include "SoftwareOcclusion.h"
+
+#include "Signboard/resources/scene/ObjectSystem.h"
+#include "entityHandlers/world.h"
+
+#include <chrono>
+
+void SceneCuller::beginFrame(const glm::mat4& view, const glm::mat4& proj) {
+	frustum = Frustum(view, proj);
+	viewProj = proj * view;
+	stats = {};
+}
+
+void SceneCuller::rasterizeOccluders(World& world) {
+	if (!occlusion) return;
+
+	occlusion->beginFrame(viewProj);
+	world.gatherOccluders(*occlusion);
+	occlusion->rasterize();
+}
+
+void SceneCuller::cullObjects(const ObjectSystem& objects, std::vector<ObjectHandle>& drawList) {
+	auto start = std::chrono::high_resolution_clock::now();
+
+	const BoundsSoA& bounds = objects.getWorldBounds();
+	uint32_t count = objects.getSlotCount();
+
+	visibility.resize(count);
+	frustum.testBounds(bounds, 0, count, visibility.data());
+
+	drawList.clear();
+	occlusionBounds.clear();
+
+	for (uint32_t i = 0; i < count; i++) {
+		if (!objects.isAlive(i)) continue;
+		stats.objectsTested++;
+
+		if (!visibility[i]) {
+			stats.objectsFrustumCulled++;
+			continue;
+		}
+
+		drawList.push_back(objects.getHandle(i));
+		if (occlusion) occlusionBounds.push_back(bounds.get(i));
+	}
+
+	if (occlusion && !drawList.empty()) {
+		occlusionVisibility.resize(drawList.size());
+		occlusion->testVisibility(occlusionBounds.data(), static_cast<uint32_t>(occlusionBounds.size()), occlusionVisibility.data());
+
+		size_t kept = 0;
+		for (size_t i = 0; i < drawList.size(); i++)
+			if (occlusionVisibility[i]) drawList[kept++] = drawList[i];
+
+		stats.objectsOcclusionCulled += static_cast<uint32_t>(drawList.size() - kept);
+		drawList.resize(kept);
+	}
+
+	stats.objectsVisible = static_cast<uint32_t>(drawList.size());
+	stats.cullMs += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void SceneCuller::cullChunks(World& world, std::vector<glm::ivec3>& visibleChunks) {
+	auto start = std::chrono::high_resolution_clock::now();
+
+	visibleChunks.clear();
+	world.cullChunks(frustum, visibleChunks, stats);
+
+	if (occlusion) {
+		size_t before = visibleChunks.size();
+		world.cullOccludedChunks(*occlusion, visibleChunks);
+		stats.chunksOcclusionCulled += static_cast<uint32_t>(before - visibleChunks.size());
+	}
+
+	stats.chunksVisible = static_cast<uint32_t>(visibleChunks.size());
+	stats.cullMs += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Frustum.h"
+#include "CullingTypes.h"
+
+#include "Signboard/resources/common/ObjectSystemTypes.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+class ObjectSystem;
+class World;
+class SoftwareOcclusionCuller;
+
+class SceneCuller {
+public:
+	void beginFrame(const glm::mat4& view, const glm::mat4& proj);
+	void setOcclusionCuller(SoftwareOcclusionCuller* culler) { occlusion = culler; }
+
+	// fills the occlusion depth buffer with the world's occluders, after beginFrame and before any cull
+	void rasterizeOccluders(World& world);
+
+	void cullObjects(const ObjectSystem& objects, std::vector<ObjectHandle>& drawList);
+	void cullChunks(World& world, std::vector<glm::ivec3>& visibleChunks);
+
+	const Frustum& getFrustum() const { return frustum; }
+	const CullingStats& getStats() const { return stats; }
+
+private:
+	Frustum frustum;
+	glm::mat4 viewProj{ 1.0f };
+	CullingStats stats;
+
+	SoftwareOcclusionCuller* occlusion = nullptr;
+
+	std::vector<uint8_t> visibility;
+	std::vector<AABB> occlusionBounds;
+	std::vector<uint8_t> occlusionVisibility;
+};
@@ -0,0 +1,375 @@
+#include "SoftwareOcclusion.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+static constexpr uint32_t TILE_PIXELS = SoftwareOcclusionCuller::TILE_WIDTH * SoftwareOcclusionCuller::TILE_HEIGHT;
+
+static float elapsedMs(std::chrono::high_resolution_clock::time_point start) {
+	return std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+SoftwareOcclusionCuller::SoftwareOcclusionCuller(uint32_t width, uint32_t height, uint32_t workerCount)
+	: tilesX((width + TILE_WIDTH - 1) / TILE_WIDTH), tilesY((height + TILE_HEIGHT - 1) / TILE_HEIGHT)
+{
+	this->width = tilesX * TILE_WIDTH;
+	this->height = tilesY * TILE_HEIGHT;
+
+	depth.assign(static_cast<size_t>(tilesX) * tilesY * TILE_PIXELS, 1.0f);
+	tileMaxDepth.assign(static_cast<size_t>(tilesX) * tilesY, 1.0f);
+	tileBins.resize(static_cast<size_t>(tilesX) * tilesY);
+
+	if (workerCount == 0) {
+		uint32_t hw = std::thread::hardware_concurrency();
+		workerCount = std::min(3u, hw > 1 ? hw - 1 : 0u);
+	}
+
+	for (uint32_t i = 0; i < workerCount; i++)
+		workers.emplace_back(&SoftwareOcclusionCuller::workerLoop, this);
+}
+
+SoftwareOcclusionCuller::~SoftwareOcclusionCuller() {
+	{
+		std::lock_guard<std::mutex> lock(workMutex);
+		shuttingDown = true;
+	}
+	workReady.notify_all();
+
+	for (auto& worker : workers)
+		if (worker.joinable()) worker.join();
+}
+
+void SoftwareOcclusionCuller::beginFrame(const glm::mat4& viewProjection) {
+	viewProj = viewProjection;
+
+	triangles.clear();
+	for (auto& bin : tileBins)
+		bin.clear();
+
+	stats = {};
+}
+
+void SoftwareOcclusionCuller::addOccluder(const glm::vec3* vertices, const uint32_t* indices, uint32_t indexCount, const glm::mat4& model) {
+	glm::mat4 mvp = viewProj * model;
+
+	for (uint32_t i = 0; i + 2 < indexCount; i += 3) {
+		glm::vec4 a = mvp * glm::vec4(vertices[indices[i + 0]], 1.0f);
+		glm::vec4 b = mvp * glm::vec4(vertices[indices[i + 1]], 1.0f);
+		glm::vec4 c = mvp * glm::vec4(vertices[indices[i + 2]], 1.0f);
+
+		addClipTriangle(a, b, c);
+	}
+}
+
+void SoftwareOcclusionCuller::addOccluderBox(const AABB& box) {
+	const glm::vec3 corners[8] = {
+		{ box.min.x, box.min.y, box.min.z },
+		{ box.max.x, box.min.y, box.min.z },
+		{ box.max.x, box.max.y, box.min.z },
+		{ box.min.x, box.max.y, box.min.z },
+		{ box.min.x, box.min.y, box.max.z },
+		{ box.max.x, box.min.y, box.max.z },
+		{ box.max.x, box.max.y, box.max.z },
+		{ box.min.x, box.max.y, box.max.z }
+	};
+
+	static const uint32_t boxIndices[36] = {
+		0, 1, 2, 2, 3, 0,
+		5, 4, 7, 7, 6, 5,
+		4, 0, 3, 3, 7, 4,
+		1, 5, 6, 6, 2, 1,
+		3, 2, 6, 6, 7, 3,
+		4, 5, 1, 1, 0, 4
+	};
+
+	addOccluder(corners, boxIndices, 36);
+}
+
+void SoftwareOcclusionCuller::addClipTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c) {
+	stats.occluderTriangles++;
+
+	const glm::vec4 in[3] = { a, b, c };
+	bool inside[3] = { a.z >= 0.0f, b.z >= 0.0f, c.z >= 0.0f };
+
+	if (inside[0] && inside[1] && inside[2]) {
+		binTriangle(a, b, c);
+		return;
+	}
+	if (!inside[0] && !inside[1] && !inside[2])
+		return;
+
+	glm::vec4 poly[4];
+	uint32_t count = 0;
+
+	for (uint32_t i = 0; i < 3; i++) {
+		const glm::vec4& cur = in[i];
+		const glm::vec4& next = in[(i + 1) % 3];
+
+		if (inside[i])
+			poly[count++] = cur;
+
+		if (inside[i] != inside[(i + 1) % 3]) {
+			float t = cur.z / (cur.z - next.z);
+			poly[count++] = cur + (next - cur) * t;
+		}
+	}
+
+	binTriangle(poly[0], poly[1], poly[2]);
+	if (count == 4)
+		binTriangle(poly[0], poly[2], poly[3]);
+}
+
+void SoftwareOcclusionCuller::binTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c) {
+	const glm::vec4* v[3] = { &a, &b, &c };
+
+	ScreenTriangle tri{};
+	for (uint32_t i = 0; i < 3; i++) {
+		float w = std::max(v[i]->w, 1e-6f);
+		tri.x[i] = (v[i]->x / w * 0.5f + 0.5f) * width;
+		tri.y[i] = (v[i]->y / w * 0.5f + 0.5f) * height;
+		tri.z[i] = v[i]->z / w;
+	}
+
+	float area = (tri.x[1] - tri.x[0]) * (tri.y[2] - tri.y[0]) - (tri.x[2] - tri.x[0]) * (tri.y[1] - tri.y[0]);
+	if (std::abs(area) < 1e-6f)
+		return;
+
+	if (area < 0.0f) {
+		std::swap(tri.x[1], tri.x[2]);
+		std::swap(tri.y[1], tri.y[2]);
+		std::swap(tri.z[1], tri.z[2]);
+	}
+
+	float minX = std::min({ tri.x[0], tri.x[1], tri.x[2] });
+	float maxX = std::max({ tri.x[0], tri.x[1], tri.x[2] });
+	float minY = std::min({ tri.y[0], tri.y[1], tri.y[2] });
+	float maxY = std::max({ tri.y[0], tri.y[1], tri.y[2] });
+
+	if (maxX < 0.0f || maxY < 0.0f || minX >= width || minY >= height)
+		return;
+
+	tri.minX = std::max(0, static_cast<int>(std::floor(minX)));
+	tri.minY = std::max(0, static_cast<int>(std::floor(minY)));
+	tri.maxX = std::min(static_cast<int>(width) - 1, static_cast<int>(std::floor(maxX)));
+	tri.maxY = std::min(static_cast<int>(height) - 1, static_cast<int>(std::floor(maxY)));
+
+	uint32_t index = static_cast<uint32_t>(triangles.size());
+	triangles.push_back(tri);
+	stats.rasterizedTriangles++;
+
+	for (int ty = tri.minY / static_cast<int>(TILE_HEIGHT); ty <= tri.maxY / static_cast<int>(TILE_HEIGHT); ty++)
+		for (int tx = tri.minX / static_cast<int>(TILE_WIDTH); tx <= tri.maxX / static_cast<int>(TILE_WIDTH); tx++)
+			tileBins[ty * tilesX + tx].push_back(index);
+}
+
+void SoftwareOcclusionCuller::rasterize() {
+	auto start = std::chrono::high_resolution_clock::now();
+
+	nextTile = 0;
+
+	if (workers.empty()) {
+		runTiles();
+	}
+	else {
+		{
+			std::lock_guard<std::mutex> lock(workMutex);
+			workersBusy = static_cast<uint32_t>(workers.size());
+			++workGeneration;
+		}
+		workReady.notify_all();
+
+		runTiles();
+
+		std::unique_lock<std::mutex> lock(workMutex);
+		workDone.wait(lock, [&] { return workersBusy == 0; });
+	}
+
+	stats.rasterizeMs = elapsedMs(start);
+}
+
+void SoftwareOcclusionCuller::runTiles() {
+	uint32_t tileCount = tilesX * tilesY;
+	for (uint32_t tile = nextTile.fetch_add(1); tile < tileCount; tile = nextTile.fetch_add(1))
+		rasterizeTile(tile);
+}
+
+void SoftwareOcclusionCuller::workerLoop() {
+	uint64_t seenGeneration = 0;
+
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(workMutex);
+			workReady.wait(lock, [&] { return shuttingDown || workGeneration != seenGeneration; });
+			if (shuttingDown) return;
+			seenGeneration = workGeneration;
+		}
+
+		runTiles();
+
+		std::lock_guard<std::mutex> lock(workMutex);
+		if (--workersBusy == 0)
+			workDone.notify_one();
+	}
+}
+
+void SoftwareOcclusionCuller::rasterizeTile(uint32_t tile) {
+	const int tileMinX = static_cast<int>((tile % tilesX) * TILE_WIDTH);
+	const int tileMinY = static_cast<int>((tile / tilesX) * TILE_HEIGHT);
+	const int tileMaxX = tileMinX + static_cast<int>(TILE_WIDTH) - 1;
+	const int tileMaxY = tileMinY + static_cast<int>(TILE_HEIGHT) - 1;
+
+	float* tileDepth = depth.data() + static_cast<size_t>(tile) * TILE_PIXELS;
+	std::fill(tileDepth, tileDepth + TILE_PIXELS, 1.0f);
+
+	for (uint32_t triIndex : tileBins[tile]) {
+		const ScreenTriangle& tri = triangles[triIndex];
+
+		int minX = std::max(tileMinX, tri.minX);
+		int maxX = std::min(tileMaxX, tri.maxX);
+		int minY = std::max(tileMinY, tri.minY);
+		int maxY = std::min(tileMaxY, tri.maxY);
+		if (minX > maxX || minY > maxY) continue;
+
+		float A[3], B[3], C[3];
+		for (uint32_t e = 0; e < 3; e++) {
+			uint32_t n = (e + 1) % 3;
+			A[e] = tri.y[e] - tri.y[n];
+			B[e] = tri.x[n] - tri.x[e];
+			C[e] = -(A[e] * tri.x[e] + B[e] * tri.y[e]);
+		}
+
+		float area = C[0] + C[1] + C[2];
+		float dzdx = ((tri.z[1] - tri.z[0]) * (tri.y[2] - tri.y[0]) - (tri.z[2] - tri.z[0]) * (tri.y[1] - tri.y[0])) / area;
+		float dzdy = ((tri.z[2] - tri.z[0]) * (tri.x[1] - tri.x[0]) - (tri.z[1] - tri.z[0]) * (tri.x[2] - tri.x[0])) / area;
+		float zC = tri.z[0] - dzdx * tri.x[0] - dzdy * tri.y[0];
+
+		for (int y = minY; y <= maxY; y++) {
+			float py = y + 0.5f;
+			float* row = tileDepth + (y - tileMinY) * TILE_WIDTH;
+
+			float rowE0 = B[0] * py + C[0];
+			float rowE1 = B[1] * py + C[1];
+			float rowE2 = B[2] * py + C[2];
+			float rowZ = dzdy * py + zC;
+
+#if defined(__AVX2__)
+			const __m256 laneOffsets = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+			const __m256 zero = _mm256_setzero_ps();
+
+			for (int bx = (minX - tileMinX) & ~7; bx <= maxX - tileMinX; bx += 8) {
+				__m256 px = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(tileMinX + bx)), laneOffsets);
+
+				__m256 e0 = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(A[0]), px), _mm256_set1_ps(rowE0));
+				__m256 e1 = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(A[1]), px), _mm256_set1_ps(rowE1));
+				__m256 e2 = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(A[2]), px), _mm256_set1_ps(rowE2));
+
+				__m256 mask = _mm256_and_ps(
+					_mm256_and_ps(_mm256_cmp_ps(e0, zero, _CMP_GE_OQ), _mm256_cmp_ps(e1, zero, _CMP_GE_OQ)),
+					_mm256_cmp_ps(e2, zero, _CMP_GE_OQ));
+				if (_mm256_testz_ps(mask, mask)) continue;
+
+				__m256 z = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(dzdx), px), _mm256_set1_ps(rowZ));
+
+				__m256 old = _mm256_loadu_ps(row + bx);
+				__m256 nearest = _mm256_min_ps(old, z);
+				_mm256_storeu_ps(row + bx, _mm256_blendv_ps(old, nearest, mask));
+			}
+#else
+			for (int x = minX; x <= maxX; x++) {
+				float px = x + 0.5f;
+				if (A[0] * px + rowE0 < 0.0f || A[1] * px + rowE1 < 0.0f || A[2] * px + rowE2 < 0.0f)
+					continue;
+
+				float& d = row[x - tileMinX];
+				d = std::min(d, dzdx * px + rowZ);
+			}
+#endif
+		}
+	}
+
+	tileMaxDepth[tile] = *std::max_element(tileDepth, tileDepth + TILE_PIXELS);
+}
+
+bool SoftwareOcclusionCuller::isVisible(const AABB& box) const {
+	float minX = static_cast<float>(width), minY = static_cast<float>(height), minZ = 1.0f;
+	float maxX = 0.0f, maxY = 0.0f;
+
+	for (uint32_t i = 0; i < 8; i++) {
+		glm::vec3 corner{
+			(i & 1) ? box.max.x : box.min.x,
+			(i & 2) ? box.max.y : box.min.y,
+			(i & 4) ? box.max.z : box.min.z
+		};
+
+		glm::vec4 clip = viewProj * glm::vec4(corner, 1.0f);
+		if (clip.z < 0.0f || clip.w <= 1e-6f)
+			return true;
+
+		float sx = (clip.x / clip.w * 0.5f + 0.5f) * width;
+		float sy = (clip.y / clip.w * 0.5f + 0.5f) * height;
+
+		minX = std::min(minX, sx);
+		maxX = std::max(maxX, sx);
+		minY = std::min(minY, sy);
+		maxY = std::max(maxY, sy);
+		minZ = std::min(minZ, clip.z / clip.w);
+	}
+
+	int x0 = std::max(0, static_cast<int>(std::floor(minX)));
+	int y0 = std::max(0, static_cast<int>(std::floor(minY)));
+	int x1 = std::min(static_cast<int>(width) - 1, static_cast<int>(std::floor(maxX)));
+	int y1 = std::min(static_cast<int>(height) - 1, static_cast<int>(std::floor(maxY)));
+	if (x0 > x1 || y0 > y1)
+		return true;
+
+	for (int ty = y0 / static_cast<int>(TILE_HEIGHT); ty <= y1 / static_cast<int>(TILE_HEIGHT); ty++) {
+		for (int tx = x0 / static_cast<int>(TILE_WIDTH); tx <= x1 / static_cast<int>(TILE_WIDTH); tx++) {
+			uint32_t tile = ty * tilesX + tx;
+			if (minZ > tileMaxDepth[tile]) continue;
+
+			const int tileMinX = tx * static_cast<int>(TILE_WIDTH);
+			const int tileMinY = ty * static_cast<int>(TILE_HEIGHT);
+			const float* tileDepth = depth.data() + static_cast<size_t>(tile) * TILE_PIXELS;
+
+			int sx0 = std::max(x0, tileMinX), sx1 = std::min(x1, tileMinX + static_cast<int>(TILE_WIDTH) - 1);
+			int sy0 = std::max(y0, tileMinY), sy1 = std::min(y1, tileMinY + static_cast<int>(TILE_HEIGHT) - 1);
+
+			for (int y = sy0; y <= sy1; y++) {
+				const float* row = tileDepth + (y - tileMinY) * TILE_WIDTH;
+				for (int x = sx0; x <= sx1; x++)
+					if (minZ <= row[x - tileMinX]) return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+uint32_t SoftwareOcclusionCuller::testVisibility(const AABB* boxes, uint32_t count, uint8_t* visible) {
+	auto start = std::chrono::high_resolution_clock::now();
+
+	uint32_t visibleCount = 0;
+	for (uint32_t i = 0; i < count; i++) {
+		visible[i] = isVisible(boxes[i]) ? 1 : 0;
+		visibleCount += visible[i];
+	}
+
+	stats.tested += count;
+	stats.culled += count - visibleCount;
+	stats.testMs += elapsedMs(start);
+
+	return visibleCount;
+}
+
+float SoftwareOcclusionCuller::readDepth(uint32_t x, uint32_t y) const {
+	if (x >= width || y >= height)
+		return 1.0f;
+
+	uint32_t tile = (y / TILE_HEIGHT) * tilesX + (x / TILE_WIDTH);
+	return depth[static_cast<size_t>(tile) * TILE_PIXELS + (y % TILE_HEIGHT) * TILE_WIDTH + (x % TILE_WIDTH)];
+}
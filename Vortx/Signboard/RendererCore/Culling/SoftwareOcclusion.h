@@ -0,0 +1,95 @@
+#pragma once
+
+#include "core/dataDef/Bounds.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+
+struct OcclusionStats {
+	uint32_t occluderTriangles = 0;
+	uint32_t rasterizedTriangles = 0;
+
+	uint32_t tested = 0;
+	uint32_t culled = 0;
+
+	float rasterizeMs = 0.0f;
+	float testMs = 0.0f;
+
+	float culledPercent() const { return tested ? (100.0f * culled) / tested : 0.0f; }
+	float totalMs() const { return rasterizeMs + testMs; }
+};
+
+class SoftwareOcclusionCuller {
+public:
+	static constexpr uint32_t TILE_WIDTH = 32;
+	static constexpr uint32_t TILE_HEIGHT = 16;
+
+	explicit SoftwareOcclusionCuller(uint32_t width = 320, uint32_t height = 192, uint32_t workerCount = 0);
+	~SoftwareOcclusionCuller();
+
+	SoftwareOcclusionCuller(const SoftwareOcclusionCuller&) = delete;
+	SoftwareOcclusionCuller& operator=(const SoftwareOcclusionCuller&) = delete;
+
+	void beginFrame(const glm::mat4& viewProj);
+
+	void addOccluder(const glm::vec3* vertices, const uint32_t* indices, uint32_t indexCount, const glm::mat4& model = glm::mat4(1.0f));
+	void addOccluderBox(const AABB& box);
+
+	void rasterize();
+
+	bool isVisible(const AABB& box) const;
+	uint32_t testVisibility(const AABB* boxes, uint32_t count, uint8_t* visible);
+
+	float readDepth(uint32_t x, uint32_t y) const;
+
+	uint32_t getWidth() const { return width; }
+	uint32_t getHeight() const { return height; }
+	const OcclusionStats& getStats() const { return stats; }
+
+private:
+	struct ScreenTriangle {
+		float x[3];
+		float y[3];
+		float z[3];
+		int minX, minY, maxX, maxY;
+	};
+
+	void addClipTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c);
+	void binTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c);
+
+	void runTiles();
+	void rasterizeTile(uint32_t tile);
+	void workerLoop();
+
+private:
+	uint32_t width;
+	uint32_t height;
+	uint32_t tilesX;
+	uint32_t tilesY;
+
+	glm::mat4 viewProj{ 1.0f };
+
+	std::vector<float> depth;
+	std::vector<float> tileMaxDepth;
+
+	std::vector<ScreenTriangle> triangles;
+	std::vector<std::vector<uint32_t>> tileBins;
+
+	std::vector<std::thread> workers;
+	std::mutex workMutex;
+	std::condition_variable workReady;
+	std::condition_variable workDone;
+	uint64_t workGeneration = 0;
+	uint32_t workersBusy = 0;
+	bool shuttingDown = false;
+
+	std::atomic<uint32_t> nextTile{ 0 };
+
+	OcclusionStats stats;
+};
@@ -1,18 +1,34 @@
 #include "ForwardPass.h"
 
+#include "Signboard/RHI/vulkan/VulkanDevice.h"
+#include "Signboard/RHI/vulkan/VulkanBuffer.h"
+#include "core/dataDef/VertexLayout.h"
+
 #include <array>
-#include <unordered_map>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+static constexpr uint32_t MIN_INSTANCE_CAPACITY = 256;
+
+void ForwardPass::init(VulkanDevice& deviceRef, RenderSystemView& systems, VkRenderPass renderPass, uint32_t framesInFlight) {
 
-void ForwardPass::init(VkDevice deviceRef, RenderSystemView& systems, VkRenderPass renderPass) {
+    vulkanDevice = &deviceRef;
+    device = deviceRef.getDevice();
 
-    device = deviceRef;
+    createDescriptorSetLayout(device, systems.viewStateLayout);
+    createPipelineLayout(device);
+    createInstanceFrames(framesInFlight);
 
-    createDescriptorSetLayout(deviceRef);
-    createPipelineLayout(deviceRef);
+    recorder = std::make_unique<ParallelRecorder>(deviceRef, framesInFlight);
+
+    auto attributes = VertexLayout::attributes();
 
     PipelineDescription desc{};
     desc.vertShaderPath = "shaders/forward.vert.spv";
     desc.fragShaderPath = "shaders/forward.frag.spv";
+    desc.vertexInput.bindings = { VertexLayout::binding() };
+    desc.vertexInput.attributes.assign(attributes.begin(), attributes.end());
     desc.depthTest = true;
     desc.depthWrite = true;
     desc.blending = false;
@@ -21,53 +37,70 @@ void ForwardPass::init(VkDevice deviceRef, RenderSystemView& systems, VkRenderPa
 }
 
 ForwardPass::~ForwardPass() {
+    recorder.reset();
+    instanceFrames.clear();
+    vkDestroyDescriptorPool(device, instancePool, nullptr);
+
     vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
-    vkDestroyDescriptorSetLayout(device, descriptorLayouts.globalLayout, nullptr);
     vkDestroyDescriptorSetLayout(device, descriptorLayouts.materialLayout, nullptr);
     vkDestroyDescriptorSetLayout(device, descriptorLayouts.objectLayout, nullptr);
 }
 
 void ForwardPass::build(RenderSystemView& systems, const DrawList& list) {
-    batches.clear();
-    batches.reserve(list.items.size());
+    auto start = std::chrono::steady_clock::now();
 
-    std::unordered_map<BatchKey, size_t, BatchKeyHash> batchMap;
+    draws.clear();
+    drawKeys.clear();
+    pipelineRemap.reset();
+    materialRemap.reset();
+    meshRemap.reset();
 
     for (auto& id : list.items) {
         const RenderObject* obj = systems.objects.get(id);
         if (!obj) continue;
 
         Material* mat = systems.materials.getMaterial(obj->material);
-        if (!mat) continue;
-
-        Pipeline* pipe = &systems.pipelines.get(mat->pipeline);
-        Mesh* mesh = systems.meshes.get(obj->mesh);
-        if (!pipe || !mesh) continue;
+        if (!mat || !systems.meshes.get(obj->mesh)) continue;
 
-        BatchKey key{
-            mat->pipeline,
-            obj->material
-        };
+        glm::vec3 toObject = obj->params.position - systems.viewPosition;
+        uint16_t depth = DrawKey::quantizeDepth(glm::dot(toObject, toObject));
 
-        size_t batchIndex;
+        uint64_t key = DrawKey::pack(pipelineRemap.remap(mat->pipeline), materialRemap.remap(obj->material), meshRemap.remap(obj->mesh), depth);
+        drawKeys.push_back({ key, static_cast<uint32_t>(draws.size()) });
+        draws.push_back({ mat->pipeline, obj->material, obj->mesh, obj->id.index });
+    }
 
-        auto it = batchMap.find(key);
-        if (it == batchMap.end()) {
-            batchIndex = batches.size();
-            batchMap.emplace(key, batchIndex);
+    buildStats.sortPasses = radixSort(drawKeys, sortScratch);
 
-            ForwardBatch batch{};
-            batch.pipeline = pipe;
-            batch.material = mat;
-            batch.draws = {};
-            batches.push_back(batch);
-        }
-        else {
-            batchIndex = it->second;
+    batches.clear();
+    instanceObjects.resize(drawKeys.size());
+
+    // one batch per run of equal handles, the lookups happen once per batch rather than per draw. runs compare
+    // the handles rather than the key bits, so draws whose indices saturated never share a batch wrongly
+    for (uint32_t i = 0; i < drawKeys.size(); i++) {
+        const ForwardDraw& draw = draws[drawKeys[i].value];
+        instanceObjects[i] = draw.object;
+
+        if (i > 0) {
+            const ForwardDraw& previous = draws[drawKeys[i - 1].value];
+            if (draw.pipeline == previous.pipeline && draw.material == previous.material && draw.mesh == previous.mesh) {
+                batches.back().instanceCount++;
+                continue;
+            }
         }
 
-        batches[batchIndex].draws.push_back({ mesh, id});
+        ForwardBatch batch{};
+        batch.pipeline = &systems.pipelines.get(draw.pipeline);
+        batch.material = systems.materials.getMaterial(draw.material);
+        batch.mesh = systems.meshes.get(draw.mesh);
+        batch.firstInstance = i;
+        batch.instanceCount = 1;
+        batches.push_back(batch);
     }
+
+    buildStats.drawCount = static_cast<uint32_t>(drawKeys.size());
+    buildStats.batchCount = static_cast<uint32_t>(batches.size());
+    buildStats.buildMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
 }
 
 void ForwardPass::record(VkCommandBuffer cmd, RenderSystemView& systems, const PassContext& pass, uint32_t currentFrame) {
@@ -86,8 +119,27 @@ void ForwardPass::record(VkCommandBuffer cmd, RenderSystemView& systems, const P
     beginInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
     beginInfo.pClearValues = clearValues.data();
 
-    vkCmdBeginRenderPass(cmd, &beginInfo, VK_SUBPASS_CONTENTS_INLINE);
+    if (batches.empty()) {
+        vkCmdBeginRenderPass(cmd, &beginInfo, VK_SUBPASS_CONTENTS_INLINE);
+        vkCmdEndRenderPass(cmd);
+        return;
+    }
+
+    // the instance buffer is written once on this thread before any secondary reads its set
+    InstanceFrame& instances = uploadInstances(systems, currentFrame);
+
+    const std::vector<VkCommandBuffer>& secondaries = recorder->record(currentFrame, static_cast<uint32_t>(batches.size()), pass.renderPass, 0, pass.framebuffer,
+        [&](VkCommandBuffer secondary, uint32_t begin, uint32_t end) {
+            recordBatches(secondary, pass, systems.viewStateSet, systems.viewStateOffset, instances.objectSet, begin, end);
+        });
 
+    vkCmdBeginRenderPass(cmd, &beginInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+    vkCmdExecuteCommands(cmd, static_cast<uint32_t>(secondaries.size()), secondaries.data());
+    vkCmdEndRenderPass(cmd);
+}
+
+void ForwardPass::recordBatches(VkCommandBuffer cmd, const PassContext& pass, VkDescriptorSet viewStateSet, uint32_t viewStateOffset, VkDescriptorSet objectSet, uint32_t begin, uint32_t end) {
+    // secondaries inherit no state, each one sets up everything its range needs
     VkViewport viewport{};
     viewport.x = 0.0f;
     viewport.y = 0.0f;
@@ -102,55 +154,101 @@ void ForwardPass::record(VkCommandBuffer cmd, RenderSystemView& systems, const P
     scissor.extent = pass.extent;
     vkCmdSetScissor(cmd, 0, 1, &scissor);
 
-    for (auto& batch : batches) {
-        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, batch.pipeline->pipeline);
+    // the object set is shared by every batch, only state that actually changes is rebound
+    Pipeline* lastPipeline = nullptr;
+    Material* lastMaterial = nullptr;
+    Mesh* lastMesh = nullptr;
 
-        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, batch.pipeline->layout, 0, 1, &pass.globalSet, 0, nullptr);
+    for (uint32_t i = begin; i < end; i++) {
+        const ForwardBatch& batch = batches[i];
 
-        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, batch.pipeline->layout, 2, 1, &batch.material->descriptors[passID], 0, nullptr);
+        if (batch.pipeline != lastPipeline) {
+            vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, batch.pipeline->pipeline);
 
-        Mesh* lastMesh = nullptr;
-        for (auto& draw : batch.draws) {
-            if (draw.mesh != lastMesh) {
-                draw.mesh->bind(cmd);
-                lastMesh = draw.mesh;
+            if (!lastPipeline || batch.pipeline->layout != lastPipeline->layout) {
+                vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, batch.pipeline->layout, 0, 1, &viewStateSet, 1, &viewStateOffset);
+                vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, batch.pipeline->layout, 1, 1, &objectSet, 0, nullptr);
+                lastMaterial = nullptr;
             }
-            const RenderObject* obj = systems.objects.get(draw.objectID);
-            auto& allocation = obj->objectDescriptors.at(passID)[currentFrame];
-            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, batch.pipeline->layout, 1, 1, &allocation.descriptorSet, 0, nullptr);
-            draw.mesh->draw(cmd);
+            lastPipeline = batch.pipeline;
+        }
+
+        if (batch.material != lastMaterial) {
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, batch.pipeline->layout, 2, 1, &batch.material->descriptors[passID], 0, nullptr);
+            lastMaterial = batch.material;
         }
+
+        if (batch.mesh != lastMesh) {
+            batch.mesh->bind(cmd);
+            lastMesh = batch.mesh;
+        }
+
+        // firstInstance offsets gl_InstanceIndex into this batch's run of instanceObjects
+        vkCmdDrawIndexed(cmd, batch.mesh->getIndexCount(), batch.instanceCount, batch.mesh->getFirstIndex(), batch.mesh->getVertexOffset(), batch.firstInstance);
     }
-    vkCmdEndRenderPass(cmd);
 }
 
-void ForwardPass::createDescriptorSetLayout(VkDevice device) {
-    VkDescriptorSetLayoutBinding global_UBO{};
-    global_UBO.binding = 0;
-    global_UBO.descriptorCount = 1;
-    global_UBO.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    global_UBO.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-    global_UBO.pImmutableSamplers = nullptr;
+ForwardPass::InstanceFrame& ForwardPass::uploadInstances(RenderSystemView& systems, uint32_t currentFrame) {
+    InstanceFrame& frame = instanceFrames.at(currentFrame);
+
+    uint32_t count = static_cast<uint32_t>(instanceObjects.size());
+
+    // this frame's fence has been waited on, so its buffer and set are free to replace
+    if (count > frame.capacity) {
+        frame.capacity = std::max({ count, frame.capacity * 2, MIN_INSTANCE_CAPACITY });
+
+        BufferDesc desc{};
+        desc.size = sizeof(uint32_t) * frame.capacity;
+        desc.usageFlags = BufferUsage::Storage;
+        desc.memoryFlags.set(MemoryProperty::HostVisible, MemoryProperty::HostCoherent);
+
+        frame.buffer = std::make_unique<VulkanBuffer>(*vulkanDevice, desc);
+        frame.mapped = static_cast<uint32_t*>(frame.buffer->map());
+
+        std::array<VkDescriptorBufferInfo, 2> bufferInfos{};
+        bufferInfos[0].buffer = systems.objects.getObjectBuffer().getHandle();
+        bufferInfos[0].offset = 0;
+        bufferInfos[0].range = VK_WHOLE_SIZE;
+        bufferInfos[1].buffer = frame.buffer->getHandle();
+        bufferInfos[1].offset = 0;
+        bufferInfos[1].range = VK_WHOLE_SIZE;
+
+        std::array<VkWriteDescriptorSet, 2> writes{};
+        for (uint32_t i = 0; i < writes.size(); i++) {
+            writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[i].dstSet = frame.objectSet;
+            writes[i].dstBinding = i;
+            writes[i].descriptorCount = 1;
+            writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[i].pBufferInfo = &bufferInfos[i];
+        }
+
+        vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+    }
 
-    std::array<VkDescriptorSetLayoutBinding, 1> globalSetBindings = { global_UBO };
+    std::memcpy(frame.mapped, instanceObjects.data(), sizeof(uint32_t) * count);
+    return frame;
+}
 
-    VkDescriptorSetLayoutCreateInfo globalSetLayoutInfo{};
-    globalSetLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-    globalSetLayoutInfo.bindingCount = static_cast<uint32_t>(globalSetBindings.size());
-    globalSetLayoutInfo.pBindings = globalSetBindings.data();
+void ForwardPass::createDescriptorSetLayout(VkDevice device, VkDescriptorSetLayout viewStateLayout) {
+    // set 0 is the shared view state, owned by the resource api rather than by the pass
+    descriptorLayouts.globalLayout = viewStateLayout;
 
-    if (vkCreateDescriptorSetLayout(device, &globalSetLayoutInfo, nullptr, &descriptorLayouts.globalLayout) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create descriptor set layout!");
-    }
+    VkDescriptorSetLayoutBinding object_SSBO{};
+    object_SSBO.binding = 0;
+    object_SSBO.descriptorCount = 1;
+    object_SSBO.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    object_SSBO.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    object_SSBO.pImmutableSamplers = nullptr;
 
-    VkDescriptorSetLayoutBinding object_UBO;
-    object_UBO.binding = 0;
-    object_UBO.descriptorCount = 1;
-    object_UBO.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    object_UBO.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-    object_UBO.pImmutableSamplers = nullptr;
+    VkDescriptorSetLayoutBinding instance_SSBO{};
+    instance_SSBO.binding = 1;
+    instance_SSBO.descriptorCount = 1;
+    instance_SSBO.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    instance_SSBO.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    instance_SSBO.pImmutableSamplers = nullptr;
 
-    std::array<VkDescriptorSetLayoutBinding, 1> objectSetBindings = { object_UBO };
+    std::array<VkDescriptorSetLayoutBinding, 2> objectSetBindings = { object_SSBO, instance_SSBO };
 
     VkDescriptorSetLayoutCreateInfo objectSetLayoutInfo{};
     objectSetLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
@@ -187,6 +285,39 @@ void ForwardPass::createDescriptorSetLayout(VkDevice device) {
     }
 }
 
+void ForwardPass::createInstanceFrames(uint32_t framesInFlight) {
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = 2 * framesInFlight;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = framesInFlight;
+
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &instancePool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create descriptor pool!");
+    }
+
+    std::vector<VkDescriptorSetLayout> layouts(framesInFlight, descriptorLayouts.objectLayout);
+    std::vector<VkDescriptorSet> sets(framesInFlight);
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = instancePool;
+    allocInfo.descriptorSetCount = framesInFlight;
+    allocInfo.pSetLayouts = layouts.data();
+
+    if (vkAllocateDescriptorSets(device, &allocInfo, sets.data()) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate descriptor sets!");
+    }
+
+    instanceFrames.resize(framesInFlight);
+    for (uint32_t i = 0; i < framesInFlight; i++)
+        instanceFrames[i].objectSet = sets[i];
+}
+
 void ForwardPass::createPipelineLayout(VkDevice device) {
     /*VkPushConstantRange pushConstantsRange{};
     pushConstantsRange.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
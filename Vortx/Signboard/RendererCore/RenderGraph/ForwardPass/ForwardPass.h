@@ -2,32 +2,89 @@
 
 #include "RenderPassBase.h"
 #include "batch.h"
+#include "Signboard/RendererCore/RenderGraph/common/RadixSort.h"
+#include "Signboard/RendererCore/RenderGraph/common/ParallelRecorder.h"
 
-struct ForwardDraw {
-    Mesh* mesh;
-    ObjectID objectID;
-};
+#include <memory>
+
+class VulkanDevice;
+class VulkanBuffer;
 
+// one instanced draw, its instances are a contiguous run of the per-frame instance buffer
 struct ForwardBatch {
     Pipeline* pipeline;
     Material* material;
-    std::vector <ForwardDraw> draws;
+    Mesh* mesh;
+
+    uint32_t firstInstance;
+    uint32_t instanceCount;
+};
+
+struct ForwardBuildStats {
+    uint32_t drawCount = 0;
+    uint32_t batchCount = 0;
+    uint32_t sortPasses = 0;
+    float buildMs = 0.0f;
 };
 
 class ForwardPass : public RenderPassBase {
 public:
-    void init(VkDevice device, RenderSystemView& systemView, VkRenderPass renderPass);
+    void init(VulkanDevice& device, RenderSystemView& systemView, VkRenderPass renderPass, uint32_t framesInFlight);
     ~ForwardPass();
 
     void build(RenderSystemView& systemView, const DrawList& list) override;
     void record(VkCommandBuffer cmd, RenderSystemView& systems, const PassContext& pass, uint32_t currentFrame) override;
 
+    const ForwardBuildStats& getBuildStats() const { return buildStats; }
+    const RecordingStats& getRecordingStats() const { return recorder->getStats(); }
+
 private:
+    struct InstanceFrame {
+        std::unique_ptr<VulkanBuffer> buffer;
+        uint32_t* mapped = nullptr;
+        uint32_t capacity = 0;
+
+        VkDescriptorSet objectSet = VK_NULL_HANDLE;
+    };
+
+    VulkanDevice* vulkanDevice = nullptr;
     VkDevice device;
     std::vector<ForwardBatch> batches;
 
+    // the handles behind each draw, sort entries carry an index into it
+    struct ForwardDraw {
+        uint32_t pipeline;
+        uint32_t material;
+        uint32_t mesh;
+        uint32_t object;
+    };
+
+    // sorted draw keys, batches are ranges over them. all of these keep their capacity across builds
+    std::vector<ForwardDraw> draws;
+    std::vector<SortEntry> drawKeys;
+    std::vector<SortEntry> sortScratch;
+
+    DenseRemap pipelineRemap;
+    DenseRemap materialRemap;
+    DenseRemap meshRemap;
+
+    // object slot of every instance, the vertex shader reads objects[instanceObjects[gl_InstanceIndex]]
+    std::vector<uint32_t> instanceObjects;
+
+    ForwardBuildStats buildStats;
+
+    VkDescriptorPool instancePool = VK_NULL_HANDLE;
+    std::vector<InstanceFrame> instanceFrames;
+
+    // batches are split across threads into secondaries executed inside the pass
+    std::unique_ptr<ParallelRecorder> recorder;
+
 private:
-    void createDescriptorSetLayout(VkDevice device);
+    void createDescriptorSetLayout(VkDevice device, VkDescriptorSetLayout viewStateLayout);
     void createPipelineLayout(VkDevice device);
+    void createInstanceFrames(uint32_t framesInFlight);
+
+    InstanceFrame& uploadInstances(RenderSystemView& systems, uint32_t currentFrame);
+    void recordBatches(VkCommandBuffer cmd, const PassContext& pass, VkDescriptorSet viewStateSet, uint32_t viewStateOffset, VkDescriptorSet objectSet, uint32_t begin, uint32_t end);
 
 };
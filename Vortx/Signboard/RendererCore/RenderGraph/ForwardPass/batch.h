@@ -1,22 +1,70 @@
 #pragma once
 
 #include <cstdint>
-#include <cstddef>
-#include <functional>
+#include <cstring>
+#include <vector>
+#include <algorithm>
 
-struct BatchKey {
-	uint32_t pipeline;
-	uint32_t material;
+// packed 64 bit draw sort key, high to low: pipeline | material | mesh | depth.
+// a key is only compared within one pass's build, so the state fields hold dense per-build indices rather than
+// handles, see DenseRemap. sorting groups draws by state first, draws that share everything above depth
+// collapse into one instanced draw and their instances come out front to back.
+struct DrawKey {
+	static constexpr uint32_t PIPELINE_BITS = 16;
+	static constexpr uint32_t MATERIAL_BITS = 16;
+	static constexpr uint32_t MESH_BITS = 16;
+	static constexpr uint32_t DEPTH_BITS = 16;
 
-	bool operator==(const BatchKey& other) const {
-		return pipeline == other.pipeline && material == other.material;
+	static constexpr uint32_t FIELD_MAX = (1u << 16) - 1;
+
+	static constexpr uint32_t MESH_SHIFT = DEPTH_BITS;
+	static constexpr uint32_t MATERIAL_SHIFT = MESH_SHIFT + MESH_BITS;
+	static constexpr uint32_t PIPELINE_SHIFT = MATERIAL_SHIFT + MATERIAL_BITS;
+
+	static uint64_t pack(uint32_t pipeline, uint32_t material, uint32_t mesh, uint16_t depth) {
+		return (static_cast<uint64_t>(pipeline & FIELD_MAX) << PIPELINE_SHIFT)
+			| (static_cast<uint64_t>(material & FIELD_MAX) << MATERIAL_SHIFT)
+			| (static_cast<uint64_t>(mesh & FIELD_MAX) << MESH_SHIFT)
+			| depth;
 	}
+
+	// non-negative float bits order like the values, the top 16 keep the exponent and 7 mantissa bits
+	static uint16_t quantizeDepth(float distanceSq) {
+		uint32_t bits;
+		std::memcpy(&bits, &distanceSq, sizeof(bits));
+		return distanceSq > 0.0f ? static_cast<uint16_t>(bits >> 16) : 0;
+	}
+
 };
 
-struct BatchKeyHash {
-	size_t operator()(const BatchKey& k) const noexcept {
-		size_t h1 = std::hash<uint32_t>{}(k.pipeline);
-		size_t h2 = std::hash<uint32_t>{}(k.material);
-		return h1 ^ (h2 << 1);
+// numbers the handles one build meets in order of first use, so any handle value fits a key field. a build
+// with more distinct handles than a field holds saturates the rest into the last index: those draws still batch
+// on their real handles, they only sort less tightly. stamps make reset O(1), the tables keep their capacity.
+struct DenseRemap {
+	std::vector<uint32_t> stamps;
+	std::vector<uint32_t> indices;
+	uint32_t epoch = 0;
+	uint32_t count = 0;
+
+	void reset() {
+		if (++epoch == 0) {
+			std::fill(stamps.begin(), stamps.end(), 0u);
+			epoch = 1;
+		}
+		count = 0;
+	}
+
+	uint32_t remap(uint32_t handle) {
+		if (handle >= stamps.size()) {
+			stamps.resize(handle + 1, 0u);
+			indices.resize(handle + 1);
+		}
+
+		if (stamps[handle] != epoch) {
+			stamps[handle] = epoch;
+			indices[handle] = count++;
+		}
+
+		return std::min(indices[handle], DrawKey::FIELD_MAX);
 	}
 };
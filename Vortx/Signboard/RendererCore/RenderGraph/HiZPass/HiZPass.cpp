@@ -0,0 +1,163 @@
+#include "HiZPass.h"
+
+#include "Signboard/RHI/vulkan/VulkanDevice.h"
+#include "Signboard/RHI/vulkan/VulkanCommandBuffer.h"
+#include "Signboard/RHI/vulkan/VulkanDescriptorWriter.h"
+#include "Signboard/RHI/vulkan/VulkanPipeline.h"
+
+#include "Signboard/resources/resourceSystems/PipelineSystem.h"
+#include "Signboard/resources/resourceSystems/DeletionQueue.h"
+
+#include <algorithm>
+
+static DescriptorPoolDesc makePoolDesc() {
+	DescriptorPoolDesc desc{};
+	desc.maxSets = HiZPass::MAX_LEVELS;
+	desc.poolSizes.push_back({ DescriptorType::CombinedImageSampler, HiZPass::MAX_LEVELS });
+	desc.poolSizes.push_back({ DescriptorType::StorageImage, HiZPass::MAX_LEVELS });
+
+	return desc;
+}
+
+static SamplerDesc makeSamplerDesc() {
+	SamplerDesc desc{};
+	desc.magFilter = Filter::Nearest;
+	desc.minFilter = Filter::Nearest;
+	desc.addressU = SamplerAddressMode::ClampEdge;
+	desc.addressV = SamplerAddressMode::ClampEdge;
+	desc.addressW = SamplerAddressMode::ClampEdge;
+	desc.anisotropyEnable = false;
+
+	return desc;
+}
+
+HiZPass::HiZPass(VulkanDevice& device, PipelineSystem& pipelines, DeletionQueue& deletions)
+	: device(device), pipelines(pipelines), deletions(deletions), setLayout(device, makeSetLayoutDesc()), descriptorPool(std::make_unique<VulkanDescriptorPool>(device, makePoolDesc())), pipelineLayout(device, VulkanPipelineLayoutDesc{}), pipeline(INVALID_PIPELINE), sampler(device, makeSamplerDesc())
+{
+	pipelineLayout.addDescriptorSetLayout(setLayout);
+	pipelineLayout.addPushConstantRange({ ShaderStageBit::ComputeBit, 0, sizeof(uint32_t) });
+	pipelineLayout.build();
+
+	createPyramid(1, 1);
+}
+
+PipelineManifestEntry HiZPass::getPipelineEntry() {
+	PipelineManifestEntry entry{};
+	entry.layout = &pipelineLayout;
+	entry.desc.type = PipelineType::Compute;
+	entry.desc.shaders.push_back({ ShaderStageBit::ComputeBit, "shaders/hiz_build.comp.spv" });
+
+	return entry;
+}
+
+HiZPass::~HiZPass() {
+	pipelines.destroy(pipeline);
+}
+
+DescriptorSetLayoutDesc HiZPass::makeSetLayoutDesc() const {
+	DescriptorSetLayoutDesc desc{};
+	desc.bindings.push_back({ 0, DescriptorType::CombinedImageSampler, 1, ShaderStageBit::ComputeBit });
+	desc.bindings.push_back({ 1, DescriptorType::StorageImage, 1, ShaderStageBit::ComputeBit });
+
+	return desc;
+}
+
+void HiZPass::createPyramid(uint32_t width, uint32_t height) {
+	uint32_t levels = 1;
+	while (levels < MAX_LEVELS && (width >> levels) > 0 && (height >> levels) > 0)
+		levels++;
+
+	ImageDesc desc{};
+	desc.width = width;
+	desc.height = height;
+	desc.format = ImageFormat::R32F;
+	desc.usage = ImageUsage::Storage;
+	desc.mipLevels = levels;
+
+	// frames in flight may still sample the old pyramid, it goes once they have retired
+	if (pyramid) {
+		std::shared_ptr<VulkanImage> retired = std::move(pyramid);
+		deletions.retire([retired]() mutable { retired.reset(); });
+	}
+
+	pyramid = std::make_unique<VulkanImage>(device, desc);
+	version++;
+}
+
+void HiZPass::setDepthSource(VulkanImage& depthImage) {
+	depth = &depthImage;
+
+	ImageExtent2D extent = depth->getExtent();
+	createPyramid(extent.width, extent.height);
+	writeLevelSets();
+}
+
+void HiZPass::writeLevelSets() {
+	// the old sets may still be bound by frames in flight, so their pool is retired with them instead of reset
+	if (!levelSets.empty()) {
+		std::shared_ptr<VulkanDescriptorPool> retired = std::move(descriptorPool);
+		deletions.retire([retired]() mutable { retired.reset(); });
+		descriptorPool = std::make_unique<VulkanDescriptorPool>(device, makePoolDesc());
+	}
+	levelSets.clear();
+
+	for (uint32_t level = 0; level < pyramid->getMipLevels(); level++) {
+		levelSets.push_back(descriptorPool->allocate(setLayout, nullptr));
+
+		VulkanDescriptorWriter writer(device, levelSets.back());
+		if (level == 0)
+			writer.writeCombinedImageSampler(0, depth, &sampler, ImageLayout::ShaderReadOnly, 0);
+		else
+			writer.writeCombinedImageSampler(0, pyramid.get(), &sampler, ImageLayout::General, level - 1);
+		writer.writeStorageImage(1, pyramid.get(), level);
+		writer.commit();
+	}
+}
+
+void HiZPass::prepareLayout(VulkanCommandBuffer& cmd) {
+	if (pyramid->getLayout() != ImageLayout::General)
+		pyramid->transitionLayout(cmd, ImageLayout::General, PipelineStage::TopOfPipe, PipelineStage::ComputeShader);
+}
+
+void HiZPass::record(VulkanCommandBuffer& cmd) {
+	if (!depth)
+		return;
+
+	// the graph's barrier or queue transfer before this pass already ordered it after the depth writes, so the
+	// transitions only name compute stages and stay valid on the async compute queue
+	prepareLayout(cmd);
+	depth->transitionLayout(cmd, ImageLayout::ShaderReadOnly, PipelineStage::ComputeShader, PipelineStage::ComputeShader);
+
+	cmd.bindPipeline(pipelines.get(pipeline), PipelineType::Compute);
+
+	ImageExtent2D extent = pyramid->getExtent();
+	for (uint32_t level = 0; level < pyramid->getMipLevels(); level++) {
+		uint32_t width = std::max(extent.width >> level, 1u);
+		uint32_t height = std::max(extent.height >> level, 1u);
+
+		cmd.bindDescriptorSet(PipelineType::Compute, pipelineLayout, 0, levelSets[level]);
+		cmd.pushConstants(pipelineLayout, ShaderStageBit::ComputeBit, 0, sizeof(uint32_t), &level);
+		cmd.dispatch((width + GROUP_SIZE - 1) / GROUP_SIZE, (height + GROUP_SIZE - 1) / GROUP_SIZE);
+
+		// each level reads the one before it inside this pass, the graph only sees the pass as a whole
+		cmd.memoryBarrier(PipelineStage::ComputeShader, ResourceAccess::ShaderWrite, PipelineStage::ComputeShader, ResourceAccess::ShaderRead);
+	}
+
+	// the late forward pass's depth tests are ordered after this by the graph
+	depth->transitionLayout(cmd, ImageLayout::DepthStencilAttachment, PipelineStage::ComputeShader, PipelineStage::ComputeShader);
+}
+
+void HiZPass::addToGraph(RenderGraph& graph) {
+	Pass& pass = graph.addPass({ "HiZBuild" });
+	pass.computeCapable = true;
+
+	// every level after the first is downsampled from the one before it
+	ResourceAccessFlags pyramidAccess;
+	pyramidAccess.set(ResourceAccess::ShaderRead, ResourceAccess::ShaderWrite);
+
+	if (depth)
+		pass.imageAccess.push_back({ depth, PipelineStage::ComputeShader, ResourceAccess::ShaderRead });
+	pass.imageAccess.push_back({ pyramid.get(), PipelineStage::ComputeShader, pyramidAccess });
+
+	pass.execute = [this](VulkanCommandBuffer& cmd) { record(cmd); };
+}
\ No newline at end of file
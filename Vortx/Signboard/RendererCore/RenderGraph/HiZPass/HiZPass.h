@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Signboard/RendererCore/RenderGraph/RenderGraph.h"
+
+#include "Signboard/RHI/vulkan/VulkanImage.h"
+#include "Signboard/RHI/vulkan/VulkanSampler.h"
+#include "Signboard/RHI/vulkan/VulkanDescriptorLayout.h"
+#include "Signboard/RHI/vulkan/VulkanDescriptorPool.h"
+#include "Signboard/RHI/vulkan/VulkanDescriptorSet.h"
+#include "Signboard/RHI/vulkan/VulkanPipelineLayout.h"
+
+#include "Signboard/resources/common/PipelineSystemTypes.h"
+
+#include <vector>
+#include <memory>
+
+class VulkanDevice;
+class VulkanCommandBuffer;
+class PipelineSystem;
+class DeletionQueue;
+struct PipelineManifestEntry;
+
+class HiZPass {
+public:
+	static constexpr uint32_t MAX_LEVELS = 16;
+	static constexpr uint32_t GROUP_SIZE = 8;
+
+	HiZPass(VulkanDevice& device, PipelineSystem& pipelines, DeletionQueue& deletions);
+	~HiZPass();
+
+	HiZPass(const HiZPass&) = delete;
+	HiZPass& operator=(const HiZPass&) = delete;
+
+	void setDepthSource(VulkanImage& depth);
+
+	// the build pipeline is prewarmed with the renderer's manifest, nothing records before it is set
+	PipelineManifestEntry getPipelineEntry();
+	void setPipeline(PipelineHandle handle) { pipeline = handle; }
+
+	void prepareLayout(VulkanCommandBuffer& cmd);
+	void record(VulkanCommandBuffer& cmd);
+	void addToGraph(RenderGraph& graph);
+
+	bool hasDepthSource() const { return depth != nullptr; }
+
+	const VulkanImage& getPyramid() const { return *pyramid; }
+	const VulkanSampler& getSampler() const { return sampler; }
+	uint32_t getVersion() const { return version; }
+
+private:
+	void createPyramid(uint32_t width, uint32_t height);
+	void writeLevelSets();
+
+	DescriptorSetLayoutDesc makeSetLayoutDesc() const;
+
+private:
+	VulkanDevice& device;
+	PipelineSystem& pipelines;
+	DeletionQueue& deletions;
+
+	VulkanDescriptorSetLayout setLayout;
+	std::unique_ptr<VulkanDescriptorPool> descriptorPool;
+	VulkanPipelineLayout pipelineLayout;
+	PipelineHandle pipeline;
+
+	VulkanSampler sampler;
+
+	std::unique_ptr<VulkanImage> pyramid;
+	std::vector<VulkanDescriptorSet> levelSets;
+
+	VulkanImage* depth = nullptr;
+	uint32_t version = 0;
+};
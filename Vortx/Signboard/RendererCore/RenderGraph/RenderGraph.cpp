@@ -0,0 +1,772 @@
+#include "RenderGraph.h"
+
+#include "Signboard/RHI/vulkan/VulkanDevice.h"
+#include "Signboard/RHI/vulkan/VulkanImage.h"
+#include "Signboard/RHI/vulkan/VulkanBuffer.h"
+#include "Signboard/RHI/vulkan/VulkanCommandPool.h"
+#include "Signboard/RHI/vulkan/VulkanSemaphore.h"
+
+#include "Signboard/resources/resourceSystems/DeletionQueue.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+static ResourceAccessFlags writeAccessMask() {
+	ResourceAccessFlags mask;
+	mask.set(ResourceAccess::ShaderWrite, ResourceAccess::ColorAttachmentWrite, ResourceAccess::DepthStencilWrite, ResourceAccess::TransferWrite, ResourceAccess::HostWrite);
+	return mask;
+}
+
+static bool isWrite(ResourceAccessFlags access) {
+	return (access & writeAccessMask()).raw() != 0;
+}
+
+static bool isRead(ResourceAccessFlags access) {
+	return (access & ~writeAccessMask()).raw() != 0 || access.raw() == 0;
+}
+
+template<typename FlagsT>
+static bool covers(FlagsT set, FlagsT flags) {
+	return (set & flags).raw() == flags.raw();
+}
+
+static ImageLayout layoutFor(ResourceAccessFlags access) {
+	if (access.has(ResourceAccess::DepthStencilWrite) || access.has(ResourceAccess::DepthStencilRead))
+		return ImageLayout::DepthStencilAttachment;
+	if (access.has(ResourceAccess::ColorAttachmentWrite) || access.has(ResourceAccess::ColorAttachmentRead))
+		return ImageLayout::ColorAttachment;
+	if (access.has(ResourceAccess::ShaderWrite))
+		return ImageLayout::General;
+	if (access.has(ResourceAccess::ShaderRead))
+		return ImageLayout::ShaderReadOnly;
+	if (access.has(ResourceAccess::TransferWrite))
+		return ImageLayout::TransferDst;
+	if (access.has(ResourceAccess::TransferRead))
+		return ImageLayout::TransferSrc;
+	return ImageLayout::General;
+}
+
+RenderGraph::TransientStorage::TransientStorage(VulkanDevice& device)
+	: device(device)
+{
+}
+
+RenderGraph::TransientStorage::~TransientStorage() {
+	// images go before the memory they are bound to
+	images.clear();
+	for (MemoryAllocation& allocation : memory)
+		device.getAllocator().free(allocation);
+}
+
+RenderGraph::RenderGraph(VulkanDevice& device, uint32_t frameCount)
+	: device(device)
+{
+	asyncCompute = device.hasAsyncComputeQueue();
+	frameValues.resize(frameCount);
+	for (auto& frames : frameCommands)
+		frames.resize(frameCount);
+}
+
+RenderGraph::~RenderGraph() = default;
+
+Pass& RenderGraph::addPass(const GraphPassDesc& desc) {
+	compiled = false;
+
+	passes.emplace_back();
+	passes.back().name = desc.name;
+
+	return passes.back();
+}
+
+TransientImage RenderGraph::createImage(const TransientImageDesc& desc) {
+	compiled = false;
+
+	transientDescs.push_back(desc);
+	return TransientImage{ static_cast<uint32_t>(transientDescs.size() - 1) };
+}
+
+VulkanImage& RenderGraph::getImage(TransientImage image) {
+	if (!storage || image.index >= storage->images.size() || !storage->images[image.index])
+		throw std::runtime_error("render graph transient image is not allocated!");
+
+	return *storage->images[image.index];
+}
+
+void RenderGraph::compile() {
+	for (const Pass& pass : passes) {
+		if (!pass.execute)
+			throw std::runtime_error("render graph pass has no execute callback: " + pass.name);
+	}
+
+	stats = RenderGraphStats{};
+	stats.passCount = static_cast<uint32_t>(passes.size());
+
+	gatherUses();
+	cullPasses();
+	assignQueues();
+	allocateTransients();
+	placeBarriers();
+
+	firstFrame = true;
+	compiled = true;
+}
+
+void RenderGraph::gatherUses() {
+	uint32_t transientCount = static_cast<uint32_t>(transientDescs.size());
+
+	// transients take the first resource indices, imported images and buffers follow in first-use order
+	importedResources.clear();
+	importedHandles.clear();
+	resourceCount = transientCount;
+
+	auto imported = [&](const void* key, const VulkanImage* image, const VulkanBuffer* buffer) {
+		auto [it, inserted] = importedResources.try_emplace(key, resourceCount);
+		if (inserted) {
+			importedHandles.push_back({ image, buffer });
+			resourceCount++;
+		}
+		return it->second;
+	};
+
+	passUses.assign(passes.size(), {});
+	for (uint32_t p = 0; p < passes.size(); p++) {
+		const Pass& pass = passes[p];
+		std::vector<ResourceUse>& uses = passUses[p];
+
+		for (const TransientAccess& a : pass.transientAccess) {
+			if (a.image.index >= transientCount)
+				throw std::runtime_error("render graph pass uses an unknown transient image: " + pass.name);
+			uses.push_back({ a.image.index, a.stages, a.access });
+		}
+		for (const ImageAccess& a : pass.imageAccess)
+			uses.push_back({ imported(a.image, a.image, nullptr), a.stages, a.access });
+		for (const BufferAccess& a : pass.bufferAccess)
+			uses.push_back({ imported(a.buffer, nullptr, a.buffer), a.stages, a.access });
+
+		// the baseline synchronises every declared access of every pass on its own
+		stats.naiveBarriers += static_cast<uint32_t>(uses.size());
+	}
+}
+
+void RenderGraph::cullPasses() {
+	uint32_t passCount = static_cast<uint32_t>(passes.size());
+	uint32_t transientCount = static_cast<uint32_t>(transientDescs.size());
+
+	std::vector<std::vector<uint32_t>> producers(passCount);
+	std::vector<uint32_t> lastWriter(resourceCount, UINT32_MAX);
+	std::vector<uint8_t> root(passCount, 0);
+
+	for (uint32_t p = 0; p < passCount; p++) {
+		bool writes = false;
+		bool writesImported = false;
+
+		for (const ResourceUse& use : passUses[p]) {
+			uint32_t writer = lastWriter[use.resource];
+			if (isRead(use.access) && writer != UINT32_MAX && writer != p)
+				producers[p].push_back(writer);
+
+			if (isWrite(use.access)) {
+				lastWriter[use.resource] = p;
+				writes = true;
+				writesImported |= use.resource >= transientCount;
+			}
+		}
+
+		std::sort(producers[p].begin(), producers[p].end());
+		producers[p].erase(std::unique(producers[p].begin(), producers[p].end()), producers[p].end());
+		stats.edgeCount += static_cast<uint32_t>(producers[p].size());
+
+		// passes that declare no writes have effects the graph cannot see and always run
+		root[p] = passes[p].sideEffects || writesImported || !writes;
+	}
+
+	std::vector<uint8_t> kept(passCount, 0);
+	std::vector<uint32_t> stack;
+	for (uint32_t p = 0; p < passCount; p++)
+		if (root[p]) stack.push_back(p);
+
+	while (!stack.empty()) {
+		uint32_t p = stack.back();
+		stack.pop_back();
+		if (kept[p]) continue;
+
+		kept[p] = 1;
+		for (uint32_t producer : producers[p])
+			if (!kept[producer]) stack.push_back(producer);
+	}
+
+	order.clear();
+	for (uint32_t p = 0; p < passCount; p++)
+		if (kept[p]) order.push_back(p);
+
+	stats.culledPasses = passCount - static_cast<uint32_t>(order.size());
+}
+
+void RenderGraph::assignQueues() {
+	batches.clear();
+	passBatch.assign(order.size(), 0);
+	queueBatchCounts.fill(0);
+
+	// a new batch starts wherever the queue changes, declaration order is kept on both queues
+	for (uint32_t i = 0; i < order.size(); i++) {
+		uint32_t queue = asyncCompute && passes[order[i]].computeCapable ? COMPUTE_QUEUE : GRAPHICS_QUEUE;
+		if (queue == COMPUTE_QUEUE)
+			stats.asyncPasses++;
+
+		if (batches.empty() || batches.back().queue != queue) {
+			QueueBatch batch{};
+			batch.queue = queue;
+			batch.begin = i;
+			batch.queueIndex = queueBatchCounts[queue]++;
+			batches.push_back(batch);
+		}
+
+		batches.back().end = i + 1;
+		passBatch[i] = static_cast<uint32_t>(batches.size() - 1);
+	}
+
+	// the caller's buffer goes out first on its own when the graph splits
+	split = stats.asyncPasses > 0;
+	stats.queueSubmits = split ? static_cast<uint32_t>(batches.size()) + 1 : 1;
+}
+
+void RenderGraph::allocateTransients() {
+	releaseTransients();
+
+	uint32_t transientCount = static_cast<uint32_t>(transientDescs.size());
+
+	std::vector<uint32_t> firstUse(transientCount, UINT32_MAX);
+	std::vector<uint32_t> lastUse(transientCount, 0);
+
+	for (uint32_t i = 0; i < order.size(); i++) {
+		for (const ResourceUse& use : passUses[order[i]]) {
+			if (use.resource >= transientCount) continue;
+			firstUse[use.resource] = std::min(firstUse[use.resource], i);
+			lastUse[use.resource] = std::max(lastUse[use.resource], i);
+		}
+	}
+
+	storage = std::make_shared<TransientStorage>(device);
+	storage->images.resize(transientCount);
+
+	std::vector<MemoryRequirements> requirements(transientCount);
+	std::vector<uint32_t> used;
+
+	for (uint32_t t = 0; t < transientCount; t++) {
+		if (firstUse[t] == UINT32_MAX) continue;
+
+		const TransientImageDesc& desc = transientDescs[t];
+
+		ImageDesc imageDesc{};
+		imageDesc.width = desc.width;
+		imageDesc.height = desc.height;
+		imageDesc.format = desc.format;
+		imageDesc.usage = desc.usage;
+		imageDesc.deferMemory = true;
+
+		storage->images[t] = std::make_unique<VulkanImage>(device, imageDesc);
+		requirements[t] = storage->images[t]->getMemoryRequirements();
+		used.push_back(t);
+
+		stats.transientImages++;
+		stats.transientBytes += requirements[t].size;
+	}
+
+	// largest first, each image joins the first slot it fits without overlapping a lifetime already there
+	std::sort(used.begin(), used.end(), [&](uint32_t a, uint32_t b) { return requirements[a].size > requirements[b].size; });
+
+	std::vector<MemoryRequirements> slots;
+	transientSlots.assign(transientCount, UINT32_MAX);
+	slotOccupants.clear();
+
+	for (uint32_t t : used) {
+		const MemoryRequirements& req = requirements[t];
+
+		uint32_t slot = UINT32_MAX;
+		for (uint32_t s = 0; s < slots.size() && slot == UINT32_MAX; s++) {
+			if (!(slots[s].memoryTypeBits & req.memoryTypeBits)) continue;
+
+			bool overlaps = false;
+			for (uint32_t other : slotOccupants[s])
+				overlaps |= firstUse[t] <= lastUse[other] && firstUse[other] <= lastUse[t];
+
+			if (!overlaps) slot = s;
+		}
+
+		if (slot == UINT32_MAX) {
+			slot = static_cast<uint32_t>(slots.size());
+			slots.push_back(req);
+			slotOccupants.emplace_back();
+		}
+
+		MemoryRequirements& merged = slots[slot];
+		merged.size = std::max(merged.size, req.size);
+		merged.alignment = std::max(merged.alignment, req.alignment);
+		merged.memoryTypeBits &= req.memoryTypeBits;
+
+		transientSlots[t] = slot;
+		slotOccupants[slot].push_back(t);
+	}
+
+	for (uint32_t s = 0; s < slots.size(); s++) {
+		std::sort(slotOccupants[s].begin(), slotOccupants[s].end(), [&](uint32_t a, uint32_t b) { return firstUse[a] < firstUse[b]; });
+
+		storage->memory.push_back(device.getAllocator().allocateImageMemory(slots[s], MemoryProperty::DeviceLocal));
+		for (uint32_t t : slotOccupants[s])
+			storage->images[t]->bindMemory(storage->memory.back(), 0);
+
+		stats.aliasedBytes += slots[s].size;
+	}
+	stats.aliasSlots = static_cast<uint32_t>(slots.size());
+}
+
+void RenderGraph::addDependency(PassBarrier& barrier, ResourceState& state, const ResourceUse& use, const ResourceState* predecessor) {
+	bool transient = use.resource < transientDescs.size();
+
+	if (transient) {
+		ImageLayout layout = layoutFor(use.access);
+
+		if (state.layout != layout) {
+			ImageBarrier image{};
+			image.image = storage->images[use.resource].get();
+			image.oldLayout = state.layout;
+			image.newLayout = layout;
+			image.srcAccess = state.writeAccess;
+			image.dstAccess = use.access;
+
+			barrier.srcStages = barrier.srcStages | state.writeStages | state.readStages;
+
+			// the first use takes over memory the previous occupant of the slot may still be accessing
+			if (predecessor) {
+				image.srcAccess = image.srcAccess | predecessor->writeAccess;
+				barrier.srcStages = barrier.srcStages | predecessor->writeStages | predecessor->readStages;
+			}
+
+			barrier.dstStages = barrier.dstStages | use.stages;
+			barrier.images.push_back(image);
+
+			state.layout = layout;
+			if (isWrite(use.access)) {
+				state.writeStages = use.stages;
+				state.writeAccess = use.access;
+				state.visibleStages = PipelineStageFlags{};
+				state.visibleAccess = ResourceAccessFlags{};
+				state.readStages = PipelineStageFlags{};
+			}
+			else {
+				state.visibleStages = use.stages;
+				state.visibleAccess = use.access;
+				state.readStages = use.stages;
+			}
+			return;
+		}
+	}
+
+	if (isWrite(use.access)) {
+		// write after write needs the earlier write finished and flushed, write after read only its execution
+		if (state.writeStages.raw() || state.readStages.raw()) {
+			barrier.srcStages = barrier.srcStages | state.writeStages | state.readStages;
+			barrier.srcAccess = barrier.srcAccess | state.writeAccess;
+			barrier.dstStages = barrier.dstStages | use.stages;
+			barrier.dstAccess = barrier.dstAccess | use.access;
+		}
+
+		state.writeStages = use.stages;
+		state.writeAccess = use.access;
+		state.visibleStages = PipelineStageFlags{};
+		state.visibleAccess = ResourceAccessFlags{};
+		state.readStages = PipelineStageFlags{};
+		return;
+	}
+
+	// read after read never synchronises, a read after a write only until the write is visible to it
+	if (state.writeStages.raw() && !(covers(state.visibleStages, use.stages) && covers(state.visibleAccess, use.access))) {
+		barrier.srcStages = barrier.srcStages | state.writeStages;
+		barrier.srcAccess = barrier.srcAccess | state.writeAccess;
+		barrier.dstStages = barrier.dstStages | use.stages;
+		barrier.dstAccess = barrier.dstAccess | use.access;
+
+		state.visibleStages = state.visibleStages | use.stages;
+		state.visibleAccess = state.visibleAccess | use.access;
+	}
+	state.readStages = state.readStages | use.stages;
+}
+
+void RenderGraph::addWait(QueueBatch& batch, const ResourceState& source, PipelineStageFlags stages) {
+	batch.waitStages = batch.waitStages | stages;
+
+	// timeline values only grow, so the latest batch covers the earlier ones and this frame covers the last
+	if (batch.waitBatch == UINT32_MAX || (batch.waitPrevious && !source.previousFrame)) {
+		batch.waitBatch = source.batch;
+		batch.waitPrevious = source.previousFrame;
+	}
+	else if (batch.waitPrevious == source.previousFrame) {
+		batch.waitBatch = std::max(batch.waitBatch, source.batch);
+	}
+}
+
+void RenderGraph::addQueueTransfer(PassBarrier& barrier, ResourceState& state, const ResourceUse& use, uint32_t batchIndex) {
+	QueueBatch& batch = batches[batchIndex];
+	addWait(batch, state, use.stages);
+
+	QueueTransfer transfer{};
+	transfer.resource = use.resource;
+	transfer.srcQueue = state.queue;
+	transfer.dstQueue = batch.queue;
+	transfer.srcStages = state.writeStages | state.readStages;
+	transfer.srcAccess = state.writeAccess;
+	transfer.dstStages = use.stages;
+	transfer.dstAccess = use.access;
+	transfer.previousFrame = state.previousFrame;
+
+	// a transient changes layout as part of the transfer, both halves have to name the same transition
+	if (use.resource < transientDescs.size()) {
+		transfer.oldLayout = state.layout;
+		transfer.newLayout = layoutFor(use.access);
+		state.layout = transfer.newLayout;
+	}
+
+	batches[state.batch].releases.push_back(transfer);
+	barrier.acquires.push_back(transfer);
+	barrier.dstStages = barrier.dstStages | use.stages;
+
+	// the acquire makes the contents visible to this use, the other queue's stages never reach this queue's barriers
+	bool write = isWrite(use.access);
+	state.writeStages = write ? use.stages : PipelineStageFlags{};
+	state.writeAccess = write ? use.access : ResourceAccessFlags{};
+	state.visibleStages = PipelineStageFlags{};
+	state.visibleAccess = ResourceAccessFlags{};
+	state.readStages = write ? PipelineStageFlags{} : use.stages;
+}
+
+std::vector<RenderGraph::ResourceState> RenderGraph::simulate(const std::vector<ResourceState>* previousFrame) {
+	std::vector<ResourceState> states(resourceCount);
+	barriers.assign(order.size(), PassBarrier{});
+
+	for (QueueBatch& batch : batches) {
+		batch.waitBatch = UINT32_MAX;
+		batch.waitPrevious = false;
+		batch.waitStages = PipelineStageFlags{};
+		batch.releases.clear();
+	}
+
+	uint32_t transientCount = static_cast<uint32_t>(transientDescs.size());
+	std::vector<uint8_t> started(resourceCount, 0);
+
+	for (uint32_t i = 0; i < order.size(); i++) {
+		PassBarrier& barrier = barriers[i];
+		uint32_t batchIndex = passBatch[i];
+		uint32_t queue = batches[batchIndex].queue;
+
+		for (const ResourceUse& use : passUses[order[i]]) {
+			ResourceState& state = states[use.resource];
+			const ResourceState* predecessor = nullptr;
+			ResourceState carried;
+
+			if (!started[use.resource]) {
+				started[use.resource] = 1;
+
+				if (use.resource < transientCount) {
+					// the slot's previous occupant this frame, or its last one from the frame before
+					const std::vector<uint32_t>& occupants = slotOccupants[transientSlots[use.resource]];
+					auto it = std::find(occupants.begin(), occupants.end(), use.resource);
+
+					if (it != occupants.begin()) {
+						predecessor = &states[*(it - 1)];
+					}
+					else if (previousFrame) {
+						carried = (*previousFrame)[occupants.back()];
+						carried.previousFrame = true;
+						predecessor = &carried;
+					}
+				}
+				else if (previousFrame) {
+					// imported contents survive the frame. on the same queue the first use waits on the previous
+					// frame's last one, across queues that queue has to hand them over
+					const ResourceState& last = (*previousFrame)[use.resource];
+					if (last.queue != NO_QUEUE) {
+						state = last;
+						state.previousFrame = true;
+					}
+				}
+			}
+
+			// transient memory taken over from the other queue only needs its work finished, the contents are discarded
+			if (predecessor && predecessor->queue != NO_QUEUE && predecessor->queue != queue) {
+				addWait(batches[batchIndex], *predecessor, use.stages);
+				predecessor = nullptr;
+			}
+
+			if (state.queue != NO_QUEUE && state.queue != queue)
+				addQueueTransfer(barrier, state, use, batchIndex);
+			else
+				addDependency(barrier, state, use, predecessor);
+
+			state.queue = queue;
+			state.batch = batchIndex;
+			state.previousFrame = false;
+		}
+
+		barrier.needed = barrier.srcStages.raw() || barrier.dstStages.raw() || !barrier.images.empty() || !barrier.acquires.empty();
+		if (barrier.needed && !barrier.srcStages.raw())
+			barrier.srcStages = PipelineStage::TopOfPipe;
+	}
+
+	return states;
+}
+
+void RenderGraph::placeBarriers() {
+	// a frame's first transient uses wait on the previous frame's last ones, so the final states go round once
+	std::vector<ResourceState> finalStates = simulate(nullptr);
+	simulate(&finalStates);
+
+	finalLayouts.assign(transientDescs.size(), ImageLayout::Undefined);
+	for (uint32_t t = 0; t < transientDescs.size(); t++)
+		finalLayouts[t] = finalStates[t].layout;
+
+	for (const PassBarrier& barrier : barriers) {
+		if (!barrier.needed) continue;
+		stats.barrierBatches++;
+		stats.imageTransitions += static_cast<uint32_t>(barrier.images.size());
+		stats.ownershipTransfers += static_cast<uint32_t>(barrier.acquires.size());
+	}
+
+	for (const QueueBatch& batch : batches) {
+		bool waits = batch.waitBatch != UINT32_MAX || (split && batch.queue == COMPUTE_QUEUE && batch.queueIndex == 0);
+		if (waits) stats.semaphoreWaits++;
+		if (!batch.releases.empty()) stats.barrierBatches++;
+	}
+}
+
+uint32_t RenderGraph::queueFamily(uint32_t queue) const {
+	return queue == COMPUTE_QUEUE ? device.getComputeQueueFamily() : device.getGraphicsQueueFamily();
+}
+
+void RenderGraph::toBarrier(const QueueTransfer& transfer, bool release, std::vector<ImageBarrier>& images, std::vector<BufferBarrier>& buffers) {
+	// the release only flushes the source accesses and the acquire only makes them visible to the destination
+	ResourceAccessFlags srcAccess = release ? transfer.srcAccess : ResourceAccessFlags{};
+	ResourceAccessFlags dstAccess = release ? ResourceAccessFlags{} : transfer.dstAccess;
+
+	uint32_t transientCount = static_cast<uint32_t>(transientDescs.size());
+	if (transfer.resource < transientCount) {
+		ImageBarrier image{};
+		image.image = storage->images[transfer.resource].get();
+		image.oldLayout = transfer.oldLayout;
+		image.newLayout = transfer.newLayout;
+		image.srcAccess = srcAccess;
+		image.dstAccess = dstAccess;
+		image.srcQueueFamily = queueFamily(transfer.srcQueue);
+		image.dstQueueFamily = queueFamily(transfer.dstQueue);
+		images.push_back(image);
+		return;
+	}
+
+	const ImportedResource& imported = importedHandles[transfer.resource - transientCount];
+	if (imported.image) {
+		ImageBarrier image{};
+		image.image = imported.image;
+		image.oldLayout = imported.image->getLayout();
+		image.newLayout = imported.image->getLayout();
+		image.srcAccess = srcAccess;
+		image.dstAccess = dstAccess;
+		image.srcQueueFamily = queueFamily(transfer.srcQueue);
+		image.dstQueueFamily = queueFamily(transfer.dstQueue);
+		images.push_back(image);
+		return;
+	}
+
+	BufferBarrier buffer{};
+	buffer.buffer = imported.buffer;
+	buffer.offset = 0;
+	buffer.size = imported.buffer->getSize();
+	buffer.srcAccess = srcAccess;
+	buffer.dstAccess = dstAccess;
+	buffer.srcQueueFamily = queueFamily(transfer.srcQueue);
+	buffer.dstQueueFamily = queueFamily(transfer.dstQueue);
+	buffers.push_back(buffer);
+}
+
+void RenderGraph::recordPass(VulkanCommandBuffer& cmd, uint32_t orderIndex, bool skipPreviousFrame) {
+	const PassBarrier& barrier = barriers[orderIndex];
+
+	if (barrier.needed && barrier.acquires.empty()) {
+		cmd.pipelineBarrier(barrier.srcStages, barrier.srcAccess, barrier.dstStages, barrier.dstAccess, barrier.images.data(), static_cast<uint32_t>(barrier.images.size()));
+	}
+	else if (barrier.needed) {
+		std::vector<ImageBarrier> images = barrier.images;
+		std::vector<BufferBarrier> buffers;
+
+		for (const QueueTransfer& transfer : barrier.acquires)
+			if (!(skipPreviousFrame && transfer.previousFrame))
+				toBarrier(transfer, false, images, buffers);
+
+		cmd.pipelineBarrier(barrier.srcStages, barrier.srcAccess, barrier.dstStages, barrier.dstAccess, images.data(), static_cast<uint32_t>(images.size()), buffers.data(), static_cast<uint32_t>(buffers.size()));
+	}
+
+	passes[order[orderIndex]].execute(cmd);
+}
+
+void RenderGraph::recordReleases(VulkanCommandBuffer& cmd, const QueueBatch& batch) {
+	if (batch.releases.empty())
+		return;
+
+	std::vector<ImageBarrier> images;
+	std::vector<BufferBarrier> buffers;
+	PipelineStageFlags srcStages{};
+
+	for (const QueueTransfer& transfer : batch.releases) {
+		toBarrier(transfer, true, images, buffers);
+		srcStages = srcStages | transfer.srcStages;
+	}
+
+	if (!srcStages.raw())
+		srcStages = PipelineStage::TopOfPipe;
+
+	cmd.pipelineBarrier(srcStages, ResourceAccessFlags{}, PipelineStage::BottomOfPipe, ResourceAccessFlags{}, images.data(), static_cast<uint32_t>(images.size()), buffers.data(), static_cast<uint32_t>(buffers.size()));
+}
+
+VulkanCommandBuffer& RenderGraph::batchCommands(uint32_t frameIndex, const QueueBatch& batch) {
+	if (!pools[batch.queue])
+		pools[batch.queue] = std::make_unique<VulkanCommandPool>(device, queueFamily(batch.queue));
+
+	// buffers are only ever added, a recompile may leave earlier ones pending on the gpu
+	std::vector<std::unique_ptr<VulkanCommandBuffer>>& buffers = frameCommands[batch.queue].at(frameIndex);
+	while (buffers.size() <= batch.queueIndex)
+		buffers.push_back(std::make_unique<VulkanCommandBuffer>(device, *pools[batch.queue]));
+
+	return *buffers[batch.queueIndex];
+}
+
+void RenderGraph::beginFrame(uint32_t frameIndex) {
+	const std::array<uint64_t, QUEUE_COUNT>& values = frameValues.at(frameIndex);
+	for (uint32_t q = 0; q < QUEUE_COUNT; q++)
+		if (timelines[q] && values[q]) timelines[q]->wait(values[q]);
+}
+
+void RenderGraph::execute(VulkanCommandBuffer& cmd, uint32_t frameIndex) {
+	if (!compiled)
+		compile();
+
+	if (!split) {
+		for (uint32_t i = 0; i < order.size(); i++)
+			recordPass(cmd, i, false);
+	}
+	else {
+		for (auto& queueTimeline : timelines)
+			if (!queueTimeline) queueTimeline = std::make_unique<VulkanSemaphore>(device, SemaphoreType::Timeline);
+
+		for (const QueueBatch& batch : batches) {
+			VulkanCommandBuffer& batchCmd = batchCommands(frameIndex, batch);
+
+			batchCmd.begin();
+			for (uint32_t i = batch.begin; i < batch.end; i++)
+				recordPass(batchCmd, i, firstFrame);
+			recordReleases(batchCmd, batch);
+			batchCmd.end();
+		}
+	}
+
+	for (uint32_t t = 0; t < finalLayouts.size(); t++)
+		if (storage->images[t]) storage->images[t]->setLayout(finalLayouts[t]);
+}
+
+void RenderGraph::submit(VulkanCommandBuffer& cmd, uint32_t frameIndex, VulkanSemaphore& waitSemaphore, VulkanSemaphore& signalSemaphore, const VulkanSemaphore* timeline, uint64_t timelineWaitValue) {
+	if (!split) {
+		cmd.submit(waitSemaphore, signalSemaphore, timeline, timelineWaitValue);
+		return;
+	}
+
+	// the caller's buffer takes the first graphics value of the frame, the batches follow on each queue
+	std::array<uint64_t, QUEUE_COUNT> base = queueValues;
+	std::array<uint64_t, QUEUE_COUNT> perFrame = { queueBatchCounts[GRAPHICS_QUEUE] + 1ull, queueBatchCounts[COMPUTE_QUEUE] };
+
+	auto signalValue = [&](const QueueBatch& batch) {
+		return base[batch.queue] + batch.queueIndex + (batch.queue == GRAPHICS_QUEUE ? 2 : 1);
+	};
+
+	uint32_t lastGraphics = UINT32_MAX;
+	for (uint32_t b = 0; b < batches.size(); b++)
+		if (batches[b].queue == GRAPHICS_QUEUE) lastGraphics = b;
+
+	// the swapchain semaphores move to the graph's own graphics batches when there are any
+	std::vector<SemaphoreSubmit> waits;
+	std::vector<SemaphoreSubmit> signals;
+
+	if (timeline)
+		waits.push_back({ timeline, timelineWaitValue, PipelineStage::AllCommands });
+	if (lastGraphics == UINT32_MAX)
+		waits.push_back({ &waitSemaphore, 0, PipelineStage::ColorAttachmentOutput });
+
+	signals.push_back({ timelines[GRAPHICS_QUEUE].get(), base[GRAPHICS_QUEUE] + 1 });
+	if (lastGraphics == UINT32_MAX)
+		signals.push_back({ &signalSemaphore, 0, PipelineStageFlags{} });
+
+	cmd.submit(device.getGraphicsQueue(), waits.data(), static_cast<uint32_t>(waits.size()), signals.data(), static_cast<uint32_t>(signals.size()));
+
+	bool firstGraphics = true;
+	for (uint32_t b = 0; b < batches.size(); b++) {
+		const QueueBatch& batch = batches[b];
+		uint32_t other = batch.queue == GRAPHICS_QUEUE ? COMPUTE_QUEUE : GRAPHICS_QUEUE;
+
+		waits.clear();
+		signals.clear();
+
+		uint64_t waitValue = 0;
+		PipelineStageFlags waitStages = batch.waitStages;
+
+		// the first frame after compile has no matching batch behind it, it waits for all the other queue has done
+		if (batch.waitBatch != UINT32_MAX) {
+			waitValue = signalValue(batches[batch.waitBatch]);
+			if (batch.waitPrevious)
+				waitValue = firstFrame ? base[other] : waitValue - perFrame[other];
+		}
+
+		// compute work starts after the uploads and copies the caller recorded ahead of the graph
+		if (batch.queue == COMPUTE_QUEUE && batch.queueIndex == 0 && waitValue < base[GRAPHICS_QUEUE] + 1) {
+			waitValue = base[GRAPHICS_QUEUE] + 1;
+			waitStages = PipelineStage::AllCommands;
+		}
+
+		if (waitValue)
+			waits.push_back({ timelines[other].get(), waitValue, waitStages.raw() ? waitStages : PipelineStageFlags(PipelineStage::AllCommands) });
+
+		if (batch.queue == GRAPHICS_QUEUE && firstGraphics) {
+			waits.push_back({ &waitSemaphore, 0, PipelineStage::ColorAttachmentOutput });
+			firstGraphics = false;
+		}
+
+		signals.push_back({ timelines[batch.queue].get(), signalValue(batch) });
+		if (b == lastGraphics)
+			signals.push_back({ &signalSemaphore, 0, PipelineStageFlags{} });
+
+		VkQueue queue = batch.queue == COMPUTE_QUEUE ? device.getComputeQueue() : device.getGraphicsQueue();
+		batchCommands(frameIndex, batch).submit(queue, waits.data(), static_cast<uint32_t>(waits.size()), signals.data(), static_cast<uint32_t>(signals.size()));
+	}
+
+	for (uint32_t q = 0; q < QUEUE_COUNT; q++)
+		queueValues[q] += perFrame[q];
+
+	frameValues.at(frameIndex) = queueValues;
+	firstFrame = false;
+}
+
+void RenderGraph::releaseTransients() {
+	if (!storage)
+		return;
+
+	if (deletions) {
+		std::shared_ptr<TransientStorage> retired = std::move(storage);
+		deletions->retire([retired]() mutable { retired.reset(); });
+	}
+	storage.reset();
+}
+
+void RenderGraph::reset() {
+	passes.clear();
+	transientDescs.clear();
+	releaseTransients();
+
+	order.clear();
+	barriers.clear();
+	compiled = false;
+}
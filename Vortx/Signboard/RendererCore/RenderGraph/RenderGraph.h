@@ -2,16 +2,209 @@
 
 #include "RenderGraphTypes.h"
 
-class VulkanCommandBuffer;
+#include "Signboard/RHI/vulkan/VulkanCommandBuffer.h"
+#include "Signboard/RHI/vulkan/VulkanMemoryAllocator.h"
 
+#include <array>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+
+class VulkanDevice;
+class VulkanImage;
+class VulkanCommandPool;
+class VulkanSemaphore;
+class DeletionQueue;
+
+// passes run in declaration order. compile derives the dependency dag from the declared accesses, culls passes
+// whose writes reach no output, places one batched barrier in front of each pass that needs one and packs
+// transient images with disjoint lifetimes into shared memory.
+// compute capable passes move to the async compute queue when the device has a separate compute family. the
+// kept passes then split into per queue batches, joined by timeline waits and ownership transfers wherever an
+// access crosses queues. without such a family everything stays in the caller's command buffer.
 class RenderGraph {
 public:
-	RenderGraph() = default;
+	RenderGraph(VulkanDevice& device, uint32_t frameCount);
+	~RenderGraph();
+
+	RenderGraph(const RenderGraph&) = delete;
+	RenderGraph& operator=(const RenderGraph&) = delete;
+
+	Pass& addPass(const GraphPassDesc&);
+	TransientImage createImage(const TransientImageDesc& desc);
+
+	// valid after compile, transient images no kept pass uses are never created
+	VulkanImage& getImage(TransientImage image);
 
-	Pass& addPass(const RenderPassDesc&);
+	// transient memory released by reset goes through the queue when set, so in-flight frames keep it
+	void setDeletionQueue(DeletionQueue* queue) { deletions = queue; }
 
 	void compile();
-	void execute(VulkanCommandBuffer& cmd);
+
+	// waits for the slot's batches, cmd.begin() only covers the caller's own submission
+	void beginFrame(uint32_t frameIndex);
+
+	// split graphs record into their own buffers, cmd then only carries what was recorded before execute
+	void execute(VulkanCommandBuffer& cmd, uint32_t frameIndex);
+	void submit(VulkanCommandBuffer& cmd, uint32_t frameIndex, VulkanSemaphore& waitSemaphore, VulkanSemaphore& signalSemaphore, const VulkanSemaphore* timeline = nullptr, uint64_t timelineWaitValue = 0);
 	void reset();
 
-};
\ No newline at end of file
+	bool isCompiled() const { return compiled; }
+	bool usesAsyncCompute() const { return split; }
+	size_t getPassCount() const { return passes.size(); }
+	const RenderGraphStats& getStats() const { return stats; }
+
+private:
+	static constexpr uint32_t GRAPHICS_QUEUE = 0;
+	static constexpr uint32_t COMPUTE_QUEUE = 1;
+	static constexpr uint32_t QUEUE_COUNT = 2;
+	static constexpr uint32_t NO_QUEUE = UINT32_MAX;
+
+	// last write, the stages and accesses it has been made visible to and the reads since
+	struct ResourceState {
+		PipelineStageFlags writeStages{};
+		ResourceAccessFlags writeAccess{};
+
+		PipelineStageFlags visibleStages{};
+		ResourceAccessFlags visibleAccess{};
+
+		PipelineStageFlags readStages{};
+		ImageLayout layout = ImageLayout::Undefined;
+
+		// queue and batch of the latest access, previousFrame once it is carried into the next frame
+		uint32_t queue = NO_QUEUE;
+		uint32_t batch = 0;
+		bool previousFrame = false;
+	};
+
+	struct ResourceUse {
+		uint32_t resource;
+		PipelineStageFlags stages;
+		ResourceAccessFlags access;
+	};
+
+	// released at the end of the source batch, acquired in front of the pass that crosses queues
+	struct QueueTransfer {
+		uint32_t resource = 0;
+		uint32_t srcQueue = NO_QUEUE;
+		uint32_t dstQueue = NO_QUEUE;
+
+		// transients only, imported images keep the layout their owner left them in
+		ImageLayout oldLayout = ImageLayout::Undefined;
+		ImageLayout newLayout = ImageLayout::Undefined;
+
+		PipelineStageFlags srcStages{};
+		ResourceAccessFlags srcAccess{};
+		PipelineStageFlags dstStages{};
+		ResourceAccessFlags dstAccess{};
+
+		// released by the frame before, nothing releases it on the first frame after compile
+		bool previousFrame = false;
+	};
+
+	struct PassBarrier {
+		PipelineStageFlags srcStages{};
+		PipelineStageFlags dstStages{};
+		ResourceAccessFlags srcAccess{};
+		ResourceAccessFlags dstAccess{};
+		std::vector<ImageBarrier> images;
+		std::vector<QueueTransfer> acquires;
+
+		bool needed = false;
+	};
+
+	// consecutive kept passes on one queue, recorded into one buffer and submitted together
+	struct QueueBatch {
+		uint32_t queue = GRAPHICS_QUEUE;
+		uint32_t begin = 0;
+		uint32_t end = 0;
+		uint32_t queueIndex = 0;
+
+		// latest batch on the other queue this one has to wait for
+		uint32_t waitBatch = UINT32_MAX;
+		bool waitPrevious = false;
+		PipelineStageFlags waitStages{};
+
+		std::vector<QueueTransfer> releases;
+	};
+
+	struct ImportedResource {
+		const VulkanImage* image = nullptr;
+		const VulkanBuffer* buffer = nullptr;
+	};
+
+	struct TransientStorage {
+		VulkanDevice& device;
+		std::vector<std::unique_ptr<VulkanImage>> images;
+		std::vector<MemoryAllocation> memory;
+
+		explicit TransientStorage(VulkanDevice& device);
+		~TransientStorage();
+	};
+
+	void gatherUses();
+	void cullPasses();
+	void assignQueues();
+	void allocateTransients();
+	void placeBarriers();
+
+	// replays one frame of accesses into barriers and returns the final resource states
+	std::vector<ResourceState> simulate(const std::vector<ResourceState>* previousFrame);
+	void addDependency(PassBarrier& barrier, ResourceState& state, const ResourceUse& use, const ResourceState* predecessor);
+	void addQueueTransfer(PassBarrier& barrier, ResourceState& state, const ResourceUse& use, uint32_t batchIndex);
+	void addWait(QueueBatch& batch, const ResourceState& source, PipelineStageFlags stages);
+	void releaseTransients();
+
+	void recordPass(VulkanCommandBuffer& cmd, uint32_t orderIndex, bool skipPreviousFrame);
+	void recordReleases(VulkanCommandBuffer& cmd, const QueueBatch& batch);
+	void toBarrier(const QueueTransfer& transfer, bool release, std::vector<ImageBarrier>& images, std::vector<BufferBarrier>& buffers);
+
+	VulkanCommandBuffer& batchCommands(uint32_t frameIndex, const QueueBatch& batch);
+	uint32_t queueFamily(uint32_t queue) const;
+
+private:
+	VulkanDevice& device;
+	DeletionQueue* deletions = nullptr;
+
+	bool asyncCompute = false;
+
+	std::deque<Pass> passes;
+	std::vector<TransientImageDesc> transientDescs;
+
+	// transients are resources [0, transient count), imported images and buffers follow
+	std::unordered_map<const void*, uint32_t> importedResources;
+	std::vector<ImportedResource> importedHandles;
+	uint32_t resourceCount = 0;
+	std::vector<std::vector<ResourceUse>> passUses;
+
+	// kept passes in execution order, with the barrier recorded in front of each
+	std::vector<uint32_t> order;
+	std::vector<PassBarrier> barriers;
+
+	// queue batches over the kept passes, split once any of them leaves the graphics queue
+	std::vector<QueueBatch> batches;
+	std::vector<uint32_t> passBatch;
+	std::array<uint32_t, QUEUE_COUNT> queueBatchCounts{};
+	bool split = false;
+
+	// alias slot of every transient and each slot's occupants in first-use order
+	std::vector<uint32_t> transientSlots;
+	std::vector<std::vector<uint32_t>> slotOccupants;
+	std::vector<ImageLayout> finalLayouts;
+
+	std::shared_ptr<TransientStorage> storage;
+
+	// created the first time the graph splits. each queue's timeline counts its submissions, the caller's
+	// buffer signals the first graphics value of a frame
+	std::array<std::unique_ptr<VulkanCommandPool>, QUEUE_COUNT> pools;
+	std::array<std::unique_ptr<VulkanSemaphore>, QUEUE_COUNT> timelines;
+	std::array<std::vector<std::vector<std::unique_ptr<VulkanCommandBuffer>>>, QUEUE_COUNT> frameCommands;
+
+	std::array<uint64_t, QUEUE_COUNT> queueValues{};
+	std::vector<std::array<uint64_t, QUEUE_COUNT>> frameValues;
+	bool firstFrame = true;
+
+	RenderGraphStats stats;
+	bool compiled = false;
+};
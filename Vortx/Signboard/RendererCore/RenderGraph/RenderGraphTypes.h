@@ -1,11 +1,51 @@
 #pragma once
 
+#include "Signboard/RHI/common/DeviceTypes.h"
+#include "Signboard/RHI/common/ImageTypes.h"
+
 #include <string>
 #include <vector>
 #include <functional>
 
-struct RenderPassDesc {
+class VulkanImage;
+class VulkanBuffer;
+class VulkanCommandBuffer;
+
+// image owned by the graph, it only exists between compile and the next reset
+struct TransientImage {
+	uint32_t index = UINT32_MAX;
+};
+
+struct TransientImageDesc {
+	std::string name;
+	uint32_t width = 0;
+	uint32_t height = 0;
+	ImageFormat format = ImageFormat::RGBA8;
+	ImageUsageFlags usage = ImageUsage::ColorAttachment;
+};
 
+// imported images keep the layout their owner manages, the graph only orders the accesses
+struct ImageAccess {
+	const VulkanImage* image;
+	PipelineStageFlags stages;
+	ResourceAccessFlags access;
+};
+
+struct BufferAccess {
+	const VulkanBuffer* buffer;
+	PipelineStageFlags stages;
+	ResourceAccessFlags access;
+};
+
+// transient layouts follow from the access, the graph records the transitions
+struct TransientAccess {
+	TransientImage image;
+	PipelineStageFlags stages;
+	ResourceAccessFlags access;
+};
+
+struct GraphPassDesc {
+	std::string name;
 };
 
 struct Pass {
@@ -13,6 +53,35 @@ struct Pass {
 
 	std::vector <ImageAccess> imageAccess;
 	std::vector<BufferAccess> bufferAccess;
+	std::vector<TransientAccess> transientAccess;
+
+	// kept even when nothing reads what it writes, e.g. presenting or host readback
+	bool sideEffects = false;
+
+	// records compute and transfer work only, so it may run on the async compute queue when the device has one
+	bool computeCapable = false;
+
+	std::function<void(VulkanCommandBuffer&)> execute;
+};
+
+struct RenderGraphStats {
+	uint32_t passCount = 0;
+	uint32_t culledPasses = 0;
+	uint32_t edgeCount = 0;
+
+	// pipeline barrier calls the compiled graph records, against one barrier per declared access
+	uint32_t barrierBatches = 0;
+	uint32_t imageTransitions = 0;
+	uint32_t naiveBarriers = 0;
 
-	std::function<void(VulkanCommandBuffer)> execute;
-};
\ No newline at end of file
+	uint32_t transientImages = 0;
+	uint32_t aliasSlots = 0;
+	uint64_t transientBytes = 0;
+	uint64_t aliasedBytes = 0;
+
+	// submissions per frame, passes moved off the graphics queue and what crossing queues costs
+	uint32_t queueSubmits = 0;
+	uint32_t asyncPasses = 0;
+	uint32_t semaphoreWaits = 0;
+	uint32_t ownershipTransfers = 0;
+};
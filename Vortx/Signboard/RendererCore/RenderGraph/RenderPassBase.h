@@ -9,14 +9,23 @@
 #include "pipelines.h"
 #include "PassRegistry.h"
 
+#include <glm/glm.hpp>
+
 struct RenderSystemView {
     ObjectSystem& objects;
     MeshSystem& meshes;
     MaterialSystem& materials;
     PipelineManager& pipelines;
 
-    VkDescriptorSet globalSet;
+    // set 0 of every pass layout, one dynamic uniform whose offset moves to this frame's view state
+    VkDescriptorSetLayout viewStateLayout;
+    VkDescriptorSet viewStateSet;
+    uint32_t viewStateOffset;
+
     uint32_t frameIndex;
+
+    // draw sort keys order instances front to back from here
+    glm::vec3 viewPosition{ 0.0f };
 };
 
 struct PassContext {
@@ -25,8 +34,6 @@ struct PassContext {
     VkFramebuffer framebuffer;
     VkExtent2D extent;
     VkRenderPass renderPass;
-
-    VkDescriptorSet globalSet;
 };
 
 struct DrawItem {
@@ -0,0 +1,59 @@
+#include "RoutineGraph.h"
+
+#include <stdexcept>
+
+static TransientImage findImage(const RoutineGraph& built, const std::string& name, const RoutinePass& pass) {
+	auto it = built.images.find(name);
+	if (it == built.images.end())
+		throw std::runtime_error("render routine pass " + pass.name + " references unknown image: " + name);
+	return it->second;
+}
+
+RoutineGraph addRoutineToGraph(RenderGraph& graph, const RenderRoutine& routine, ImageExtent2D extent, const std::unordered_map<std::string, RoutinePassExecute>& executors) {
+	RoutineGraph built;
+
+	for (const PassImage& image : routine.images) {
+		TransientImageDesc desc{};
+		desc.name = image.name;
+		desc.width = extent.width;
+		desc.height = extent.height;
+		desc.format = image.format;
+		desc.usage = image.usage;
+
+		built.images[image.name] = graph.createImage(desc);
+	}
+
+	for (size_t i = 0; i < routine.passes.size(); i++) {
+		const RoutinePass& routinePass = routine.passes[i];
+
+		auto executor = executors.find(routinePass.name);
+		if (executor == executors.end())
+			throw std::runtime_error("render routine pass has no executor: " + routinePass.name);
+
+		Pass& pass = graph.addPass({ routinePass.name });
+
+		// attachments load what earlier passes left in them, so every attachment is read and written
+		ResourceAccessFlags colorAccess;
+		colorAccess.set(ResourceAccess::ColorAttachmentRead, ResourceAccess::ColorAttachmentWrite);
+
+		for (const std::string& name : routinePass.colorAttachments)
+			pass.transientAccess.push_back({ findImage(built, name, routinePass), PipelineStage::ColorAttachmentOutput, colorAccess });
+
+		if (!routinePass.depthAttachment.empty()) {
+			PipelineStageFlags depthStages;
+			depthStages.set(PipelineStage::EarlyDepthTest, PipelineStage::LateDepthTest);
+
+			ResourceAccessFlags depthAccess;
+			depthAccess.set(ResourceAccess::DepthStencilRead, ResourceAccess::DepthStencilWrite);
+
+			pass.transientAccess.push_back({ findImage(built, routinePass.depthAttachment, routinePass), depthStages, depthAccess });
+		}
+
+		pass.sideEffects = i + 1 == routine.passes.size();
+
+		RoutinePassExecute execute = executor->second;
+		pass.execute = [execute, routinePass](VulkanCommandBuffer& cmd) { execute(cmd, routinePass); };
+	}
+
+	return built;
+}
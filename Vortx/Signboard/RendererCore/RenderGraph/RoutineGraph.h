@@ -0,0 +1,20 @@
+#pragma once
+
+#include "RenderGraph.h"
+
+#include "configLoader/ReadTypes/EngineReadTypes.h"
+
+#include <string>
+#include <functional>
+#include <unordered_map>
+
+using RoutinePassExecute = std::function<void(VulkanCommandBuffer&, const RoutinePass&)>;
+
+// transient image of every routine resource, by name
+struct RoutineGraph {
+	std::unordered_map<std::string, TransientImage> images;
+};
+
+// declares a routine's images as transients and its passes with their attachment accesses. the last pass is the
+// routine's output, so passes that feed nothing into it are culled by compile. every pass needs an executor.
+RoutineGraph addRoutineToGraph(RenderGraph& graph, const RenderRoutine& routine, ImageExtent2D extent, const std::unordered_map<std::string, RoutinePassExecute>& executors);
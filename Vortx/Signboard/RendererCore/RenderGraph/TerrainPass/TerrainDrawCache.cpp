@@ -0,0 +1,131 @@
+#include "TerrainDrawCache.h"
+
+#include "Signboard/RHI/vulkan/VulkanDevice.h"
+#include "Signboard/RHI/vulkan/VulkanBuffer.h"
+#include "Signboard/RHI/vulkan/VulkanCommandBuffer.h"
+#include "Signboard/RHI/vulkan/VulkanPipeline.h"
+
+#include "Signboard/resources/resourceSystems/MeshSystem.h"
+#include "Signboard/resources/resourceSystems/primitive/Mesh.h"
+
+#include "Signboard/RendererCore/Culling/GPUCuller.h"
+
+#include <algorithm>
+#include <chrono>
+
+static constexpr uint32_t MIN_COMMAND_CAPACITY = 64;
+
+TerrainDrawCache::TerrainDrawCache(VulkanDevice& device, uint32_t frameCount)
+	: device(device)
+{
+	multiDrawSupported = device.supportsMultiDrawIndirect();
+	frames.resize(frameCount);
+}
+
+TerrainDrawCache::~TerrainDrawCache() = default;
+
+void TerrainDrawCache::invalidate() {
+	for (FrameCache& frame : frames)
+		frame.valid = false;
+}
+
+void TerrainDrawCache::update(uint32_t frameIndex, const std::vector<MeshHandle>& chunkMeshes, const MeshSystem& meshes) {
+	auto start = std::chrono::steady_clock::now();
+
+	FrameCache& frame = frames.at(frameIndex);
+
+	stats.rebuiltThisFrame = !matches(frame, chunkMeshes);
+	if (stats.rebuiltThisFrame) {
+		rebuild(frame, chunkMeshes, meshes);
+		stats.rebuilds++;
+	}
+	else {
+		stats.reuses++;
+	}
+
+	stats.drawCount = static_cast<uint32_t>(frame.drawMeshes.size());
+	stats.updateMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool TerrainDrawCache::matches(const FrameCache& frame, const std::vector<MeshHandle>& chunkMeshes) const {
+	if (!frame.valid || frame.recordedMeshes.size() != chunkMeshes.size())
+		return false;
+
+	for (size_t i = 0; i < chunkMeshes.size(); i++) {
+		const MeshHandle& a = frame.recordedMeshes[i];
+		const MeshHandle& b = chunkMeshes[i];
+		if (a.index != b.index || a.generation != b.generation)
+			return false;
+	}
+	return true;
+}
+
+void TerrainDrawCache::rebuild(FrameCache& frame, const std::vector<MeshHandle>& chunkMeshes, const MeshSystem& meshes) {
+	std::vector<GPUDrawCommand> commands;
+	commands.reserve(chunkMeshes.size());
+
+	frame.drawMeshes.clear();
+
+	// meshes still uploading are left out and keep the cache invalid so they join once resident
+	bool complete = true;
+	for (const MeshHandle& handle : chunkMeshes) {
+		if (!meshes.isResident(handle)) {
+			complete = false;
+			continue;
+		}
+
+		const Mesh& mesh = meshes.get(handle);
+		uint32_t drawIndex = static_cast<uint32_t>(commands.size());
+		commands.push_back(GPUDrawCommand{ mesh.getIndexCount(), 1, mesh.getFirstIndex(), mesh.getVertexOffset(), drawIndex });
+		frame.drawMeshes.push_back(handle.index);
+	}
+
+	uint32_t count = static_cast<uint32_t>(commands.size());
+	if (count > frame.capacity) {
+		frame.capacity = std::max({ count, frame.capacity * 2, MIN_COMMAND_CAPACITY });
+
+		BufferDesc desc{};
+		desc.size = sizeof(GPUDrawCommand) * frame.capacity;
+		desc.usageFlags = BufferUsage::Indirect;
+		desc.memoryFlags.set(MemoryProperty::HostVisible, MemoryProperty::HostCoherent);
+
+		frame.commands = std::make_unique<VulkanBuffer>(device, desc);
+	}
+
+	if (count)
+		frame.commands->upload(commands.data(), sizeof(GPUDrawCommand) * count);
+
+	frame.recordedMeshes = chunkMeshes;
+	frame.merged = meshes.allArenaResident();
+	frame.valid = complete;
+}
+
+void TerrainDrawCache::draw(VulkanCommandBuffer& cmd, uint32_t frameIndex, const MeshSystem& meshes, const VulkanPipeline& terrainPipeline, const VulkanPipelineLayout& layout, uint32_t materialIndex) const {
+	const FrameCache& frame = frames.at(frameIndex);
+
+	uint32_t count = static_cast<uint32_t>(frame.drawMeshes.size());
+	if (!count)
+		return;
+
+	cmd.bindPipeline(terrainPipeline, PipelineType::Graphics);
+
+	TerrainConstants constants{ materialIndex };
+	cmd.pushConstants(layout, ShaderStageBit::VertexBit, 0, sizeof(TerrainConstants), &constants);
+
+	// arena meshes share one vertex and index buffer, so the whole terrain is a single bind and draw
+	if (frame.merged) {
+		meshes.getArena()->bind(cmd);
+
+		if (multiDrawSupported)
+			cmd.drawIndexedIndirect(*frame.commands, 0, count, sizeof(GPUDrawCommand));
+		else
+			for (uint32_t i = 0; i < count; i++)
+				cmd.drawIndexedIndirect(*frame.commands, sizeof(GPUDrawCommand) * i, 1, sizeof(GPUDrawCommand));
+		return;
+	}
+
+	for (uint32_t i = 0; i < count; i++) {
+		meshes.getByIndex(frame.drawMeshes[i])->bind(cmd);
+		cmd.drawIndexedIndirect(*frame.commands, sizeof(GPUDrawCommand) * i, 1, sizeof(GPUDrawCommand));
+	}
+}
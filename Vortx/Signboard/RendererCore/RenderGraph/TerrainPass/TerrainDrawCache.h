@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Signboard/resources/common/MeshSystemTypes.h"
+
+#include <vector>
+#include <memory>
+
+class VulkanDevice;
+class VulkanBuffer;
+class VulkanCommandBuffer;
+class VulkanPipeline;
+class VulkanPipelineLayout;
+class MeshSystem;
+
+// terrain.vert's push constant block, the layout the terrain pipeline is built with declares it for the vertex stage
+struct TerrainConstants {
+	uint32_t materialIndex;
+};
+
+struct TerrainCacheStats {
+	uint32_t drawCount = 0;
+	uint32_t rebuilds = 0;
+	uint32_t reuses = 0;
+	bool rebuiltThisFrame = false;
+	float updateMs = 0.0f;
+};
+
+// terrain draws kept as indirect commands that outlive the frame. a frame's commands are only rewritten when
+// the visible chunk meshes differ from the ones they were built from, camera motion reaches the shaders
+// through the view uniform alone, so an unchanged chunk set costs one comparison and a replay.
+// firstInstance of a command is the draw's index in the chunk list, not an object slot, so the draws go through
+// the terrain pipeline (terrain.vert), never the object one.
+class TerrainDrawCache {
+public:
+	TerrainDrawCache(VulkanDevice& device, uint32_t frameCount);
+	~TerrainDrawCache();
+
+	TerrainDrawCache(const TerrainDrawCache&) = delete;
+	TerrainDrawCache& operator=(const TerrainDrawCache&) = delete;
+
+	// only once the frame's fence has been waited on. chunkMeshes is the culled chunk list in draw order
+	void update(uint32_t frameIndex, const std::vector<MeshHandle>& chunkMeshes, const MeshSystem& meshes);
+	void draw(VulkanCommandBuffer& cmd, uint32_t frameIndex, const MeshSystem& meshes, const VulkanPipeline& terrainPipeline, const VulkanPipelineLayout& layout, uint32_t materialIndex) const;
+
+	// forces every frame to rebuild, for changes the mesh handles do not show
+	void invalidate();
+
+	const TerrainCacheStats& getStats() const { return stats; }
+
+private:
+	struct FrameCache {
+		std::unique_ptr<VulkanBuffer> commands;
+		uint32_t capacity = 0;
+
+		// the meshes the commands were built from, and the slot of each recorded draw
+		std::vector<MeshHandle> recordedMeshes;
+		std::vector<uint32_t> drawMeshes;
+
+		bool merged = false;
+		bool valid = false;
+	};
+
+	bool matches(const FrameCache& frame, const std::vector<MeshHandle>& chunkMeshes) const;
+	void rebuild(FrameCache& frame, const std::vector<MeshHandle>& chunkMeshes, const MeshSystem& meshes);
+
+private:
+	VulkanDevice& device;
+
+	std::vector<FrameCache> frames;
+	bool multiDrawSupported = false;
+
+	TerrainCacheStats stats;
+};
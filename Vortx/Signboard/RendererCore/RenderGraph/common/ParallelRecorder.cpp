@@ -0,0 +1,114 @@
+#include "ParallelRecorder.h"
+
+#include "Signboard/RHI/vulkan/VulkanCommandPool.h"
+#include "Signboard/RHI/vulkan/VulkanCommandBuffer.h"
+
+#include <algorithm>
+#include <chrono>
+
+ParallelRecorder::ParallelRecorder(VulkanDevice& device, uint32_t framesInFlight, uint32_t workerCount) {
+	if (workerCount == 0) {
+		uint32_t hw = std::thread::hardware_concurrency();
+		workerCount = std::min(7u, hw > 1 ? hw - 1 : 0u);
+	}
+
+	threadFrames.resize(workerCount + 1);
+	for (auto& frames : threadFrames) {
+		frames.resize(framesInFlight);
+		for (ThreadFrame& frame : frames) {
+			frame.pool = std::make_unique<VulkanCommandPool>(device);
+			frame.cmd = std::make_unique<VulkanCommandBuffer>(device, *frame.pool, CommandBufferLevel::Secondary);
+		}
+	}
+
+	for (uint32_t i = 0; i < workerCount; i++)
+		workers.emplace_back(&ParallelRecorder::workerLoop, this, i + 1);
+
+	stats.threadCount = workerCount + 1;
+}
+
+ParallelRecorder::~ParallelRecorder() {
+	{
+		std::lock_guard<std::mutex> lock(workMutex);
+		shuttingDown = true;
+	}
+	workReady.notify_all();
+
+	for (auto& worker : workers)
+		if (worker.joinable()) worker.join();
+}
+
+const std::vector<VkCommandBuffer>& ParallelRecorder::record(uint32_t frameIndex, uint32_t itemCount, VkRenderPass renderPass, uint32_t subpass, VkFramebuffer framebuffer, const RecordRange& recordRange) {
+	auto start = std::chrono::high_resolution_clock::now();
+
+	this->recordRange = &recordRange;
+	this->frameIndex = frameIndex;
+	this->itemCount = itemCount;
+	this->renderPass = renderPass;
+	this->subpass = subpass;
+	this->framebuffer = framebuffer;
+
+	chunkCount = std::max(1u, std::min(getThreadCount(), (itemCount + MIN_ITEMS_PER_CHUNK - 1) / MIN_ITEMS_PER_CHUNK));
+
+	if (chunkCount == 1) {
+		recordChunk(0);
+	}
+	else {
+		// the generation is bumped for every worker, the ones without a chunk go straight back to sleep
+		{
+			std::lock_guard<std::mutex> lock(workMutex);
+			workersBusy = static_cast<uint32_t>(workers.size());
+			++workGeneration;
+		}
+		workReady.notify_all();
+
+		recordChunk(0);
+
+		std::unique_lock<std::mutex> lock(workMutex);
+		workDone.wait(lock, [&] { return workersBusy == 0; });
+	}
+
+	secondaries.clear();
+	for (uint32_t chunk = 0; chunk < chunkCount; chunk++)
+		secondaries.push_back(threadFrames[chunk][frameIndex].cmd->getHandle());
+
+	stats.chunkCount = chunkCount;
+	stats.itemCount = itemCount;
+	stats.recordMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	return secondaries;
+}
+
+void ParallelRecorder::recordChunk(uint32_t thread) {
+	if (thread >= chunkCount)
+		return;
+
+	ThreadFrame& frame = threadFrames[thread][frameIndex];
+	frame.pool->reset();
+
+	uint32_t begin = static_cast<uint32_t>(static_cast<uint64_t>(itemCount) * thread / chunkCount);
+	uint32_t end = static_cast<uint32_t>(static_cast<uint64_t>(itemCount) * (thread + 1) / chunkCount);
+
+	frame.cmd->beginSecondary(renderPass, subpass, framebuffer);
+	(*recordRange)(frame.cmd->getHandle(), begin, end);
+	frame.cmd->end();
+}
+
+void ParallelRecorder::workerLoop(uint32_t thread) {
+	uint64_t seenGeneration = 0;
+
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(workMutex);
+			workReady.wait(lock, [&] { return shuttingDown || workGeneration != seenGeneration; });
+			if (shuttingDown) return;
+			seenGeneration = workGeneration;
+		}
+
+		recordChunk(thread);
+
+		std::lock_guard<std::mutex> lock(workMutex);
+		if (--workersBusy == 0)
+			workDone.notify_one();
+	}
+}
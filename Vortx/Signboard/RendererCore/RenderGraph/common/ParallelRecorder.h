@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Signboard/RHI/vulkan/Common/VulkanFwd.h"
+
+#include <vector>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+class VulkanDevice;
+class VulkanCommandPool;
+class VulkanCommandBuffer;
+
+struct RecordingStats {
+	uint32_t threadCount = 0;
+	uint32_t chunkCount = 0;
+	uint32_t itemCount = 0;
+	float recordMs = 0.0f;
+};
+
+// records one render pass subpass on several threads. the item range is split into contiguous chunks in order,
+// chunk i goes to thread i (the caller is thread 0) and is recorded into that thread's secondary buffer for the
+// frame. executing the secondaries in chunk order keeps the submission order of the items.
+class ParallelRecorder {
+public:
+	using RecordRange = std::function<void(VkCommandBuffer cmd, uint32_t begin, uint32_t end)>;
+
+	// chunks below this many items are not worth a thread wake-up
+	static constexpr uint32_t MIN_ITEMS_PER_CHUNK = 64;
+
+	ParallelRecorder(VulkanDevice& device, uint32_t framesInFlight, uint32_t workerCount = 0);
+	~ParallelRecorder();
+
+	ParallelRecorder(const ParallelRecorder&) = delete;
+	ParallelRecorder& operator=(const ParallelRecorder&) = delete;
+
+	// only once the frame's fence has been waited on, the frame's pools are reset here.
+	// returns the secondaries to execute, valid until the next record for the same frame
+	const std::vector<VkCommandBuffer>& record(uint32_t frameIndex, uint32_t itemCount, VkRenderPass renderPass, uint32_t subpass, VkFramebuffer framebuffer, const RecordRange& recordRange);
+
+	uint32_t getThreadCount() const { return static_cast<uint32_t>(workers.size()) + 1; }
+	const RecordingStats& getStats() const { return stats; }
+
+private:
+	struct ThreadFrame {
+		std::unique_ptr<VulkanCommandPool> pool;
+		std::unique_ptr<VulkanCommandBuffer> cmd;
+	};
+
+	void recordChunk(uint32_t thread);
+	void workerLoop(uint32_t thread);
+
+private:
+	// [thread][frame], a pool is only ever touched by its own thread
+	std::vector<std::vector<ThreadFrame>> threadFrames;
+
+	// the job being recorded, written before workers are woken
+	const RecordRange* recordRange = nullptr;
+	uint32_t frameIndex = 0;
+	uint32_t itemCount = 0;
+	uint32_t chunkCount = 0;
+	VkRenderPass renderPass = nullptr;
+	uint32_t subpass = 0;
+	VkFramebuffer framebuffer = nullptr;
+
+	std::vector<VkCommandBuffer> secondaries;
+
+	std::vector<std::thread> workers;
+	std::mutex workMutex;
+	std::condition_variable workReady;
+	std::condition_variable workDone;
+	uint64_t workGeneration = 0;
+	uint32_t workersBusy = 0;
+	bool shuttingDown = false;
+
+	RecordingStats stats;
+};
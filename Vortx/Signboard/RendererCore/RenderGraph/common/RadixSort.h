@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <array>
+#include <utility>
+
+struct SortEntry {
+	uint64_t key;
+	uint32_t value;
+};
+
+// stable lsd radix sort over 8 bit digits, linear in the entry count. digits every key shares are skipped, so
+// keys that leave their low fields empty cost fewer passes. scratch is reused between calls, once both vectors
+// have grown to the working size sorting does not allocate. returns the number of scatter passes run.
+inline uint32_t radixSort(std::vector<SortEntry>& entries, std::vector<SortEntry>& scratch) {
+	const size_t count = entries.size();
+	if (count < 2)
+		return 0;
+
+	scratch.resize(count);
+
+	// every digit's histogram comes out of a single read over the keys
+	std::array<std::array<uint32_t, 256>, 8> histograms{};
+	for (const SortEntry& entry : entries)
+		for (uint32_t digit = 0; digit < 8; digit++)
+			histograms[digit][(entry.key >> (digit * 8)) & 0xFF]++;
+
+	SortEntry* src = entries.data();
+	SortEntry* dst = scratch.data();
+	uint32_t passes = 0;
+
+	for (uint32_t digit = 0; digit < 8; digit++) {
+		const uint32_t shift = digit * 8;
+		std::array<uint32_t, 256>& histogram = histograms[digit];
+
+		if (histogram[(src[0].key >> shift) & 0xFF] == count)
+			continue;
+
+		uint32_t offset = 0;
+		for (uint32_t& bucket : histogram) {
+			uint32_t bucketCount = bucket;
+			bucket = offset;
+			offset += bucketCount;
+		}
+
+		for (size_t i = 0; i < count; i++)
+			dst[histogram[(src[i].key >> shift) & 0xFF]++] = src[i];
+
+		std::swap(src, dst);
+		passes++;
+	}
+
+	if (src != entries.data())
+		entries.swap(scratch);
+
+	return passes;
+}
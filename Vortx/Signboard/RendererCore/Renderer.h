@@ -3,15 +3,24 @@
 #include "Signboard/RHI/vulkan/VulkanCommandBuffer.h"
 #include "Signboard/RHI/vulkan/VulkanImage.h"
 #include "Signboard/RHI/vulkan/VulkanSemaphore.h"
+#include "Signboard/RHI/vulkan/VulkanPipelineLayout.h"
 
 #include "Signboard/RHI/VulkanRHI.h"
 #include "Signboard/resources/ResourceAPI.h"
 
 #include "RenderGraph/RenderGraph.h"
+#include "RenderGraph/HiZPass/HiZPass.h"
+#include "RenderGraph/TerrainPass/TerrainDrawCache.h"
+#include "Culling/SceneCuller.h"
+#include "Culling/GPUCuller.h"
+#include "Culling/SoftwareOcclusion.h"
+
+#include "core/resource.h"
 
 #include <array>
 #include <vector>
 #include <memory>
+#include <unordered_map>
 
 static constexpr uint32_t FRAMES_IN_FLIGHT = 2;
 
@@ -20,26 +29,64 @@ struct RenderQueue {
 };
 
 class VulkanDevice;
+class World;
 
 class VulkanFrameBuffer;
 class VulkanRenderPass;
+class VulkanPipelineLayout;
 
 class Renderer {
 public:
-	explicit Renderer(RHIView& HInterface, ResourceView resources, SceneView& scene);
+	explicit Renderer(RHIView HInterface, ResourceView resources, SceneView scene);
 	~Renderer();
 
-	void beginFrame();
+	// one whole frame: acquire, cull and upload, execute the graph and present
+	void drawFrame(const glm::mat4& view, const glm::mat4& proj);
+
+	// false when the swapchain had to be recreated, the frame is skipped then
+	bool beginFrame();
 	void submitScene(const SceneView& scene);
+	void cullScene(const glm::mat4& view, const glm::mat4& proj);
+	void submitTerrain(const std::vector<MeshHandle>& chunkMeshes);
 	void renderFrame();
 	void endFrame();
 
+	// chunks are culled through the world's quadtree, the visible ones draw the mesh registered for them
+	void setWorld(World* terrain);
+	void setChunkMesh(const glm::ivec3& chunkPos, MeshHandle mesh) { chunkMeshes[chunkPos] = mesh; }
+	void removeChunkMesh(const glm::ivec3& chunkPos) { chunkMeshes.erase(chunkPos); }
+
+	// terrain.vert hands the index to the fragment shader as the material of every chunk, nothing is drawn
+	// for terrain until it is set
+	void setTerrainMaterial(MaterialHandle material) { terrainMaterial = material; }
+
+	// pipeline for a terrain material shaded by fragmentShader, to go into its MaterialDesc. a miss compiles in
+	// the background and the terrain draws with the prewarmed terrain pipeline until it is ready. pipelines are
+	// shared between materials by key and live as long as the pipeline system
+	PipelineHandle requestTerrainPipeline(const char* fragmentShader);
+
+	// recreates the depth target and framebuffers at the swapchain's current extent
 	void resize();
 
+	// scene pipelines are built against it, the late pass only differs in its load ops and layouts
+	const VulkanRenderPass& getForwardPass() const { return *earlyRenderPass; }
+
+	const RenderQueue& getRenderQueue() const { return renderQueue; }
+	const CullingStats& getCullingStats() const { return culler.getStats(); }
+	const OcclusionStats& getOcclusionStats() const { return occlusion.getStats(); }
+	const GPUCuller& getGPUCuller() const { return gpuCuller; }
+	const GPUCullStats& getGPUCullStats() const { return gpuCuller.getStats(); }
+	const TerrainCacheStats& getTerrainStats() const { return terrainCache.getStats(); }
+	const RenderGraphStats& getGraphStats() const { return graph.getStats(); }
+	std::vector<MemoryHeapStats> getMemoryStats() const;
+
 private:
 	void buildGraph();
+	void createTargets();
 	void drawScene(CommandList& cmd);
 	void drawUI(CommandList& cmd);
+	void drawSceneIndirect(VulkanCommandBuffer& cmd, CullPhase phase);
+	void bindSceneSets(VulkanCommandBuffer& cmd, const VulkanPipelineLayout& layout);
 
 private:
 	RHIView HInterface;
@@ -48,13 +95,39 @@ private:
 
 	RenderGraph graph;
 
-	uint32_t currentFrameIndex;
-	uint32_t acquiredImageIndex;
+	SceneCuller culler;
+	SoftwareOcclusionCuller occlusion;
+	HiZPass hizPass;
+	GPUCuller gpuCuller;
+	TerrainDrawCache terrainCache;
+	RenderQueue renderQueue;
+
+	// the early pass clears, the late one loads what it left and hands the swapchain image to present
+	std::unique_ptr<VulkanRenderPass> earlyRenderPass;
+	std::unique_ptr<VulkanRenderPass> lateRenderPass;
+	std::unique_ptr<VulkanImage> depthImage;
+	std::vector<std::unique_ptr<VulkanFrameBuffer>> frameBuffers;
+
+	// culled objects go through forward_indirect.vert and terrain through terrain.vert. both share one layout,
+	// the view, object, material and bindless sets plus terrain's push constant, so switching between them
+	// keeps the sets bound
+	VulkanPipelineLayout sceneLayout;
+	PipelineHandle objectPipeline = INVALID_PIPELINE;
+	PipelineHandle terrainPipeline = INVALID_PIPELINE;
+
+	World* world = nullptr;
+	MaterialHandle terrainMaterial = INVALID_MATERIAL;
+	std::unordered_map<glm::ivec3, MeshHandle, IVec3Hash, IVec3Equal> chunkMeshes;
+	std::vector<glm::ivec3> visibleChunks;
+	std::vector<MeshHandle> visibleChunkMeshes;
+
+	uint32_t currentFrameIndex = 0;
+	uint32_t acquiredImageIndex = 0;
+	uint64_t uploadWaitValue = 0;
 
 	bool graphDirty = true;
-
-	FrameUnions frameData;
-	BufferHandle frameUniformBuffer;
+	uint32_t graphBufferVersion = 0;
+	uint32_t graphHiZVersion = 0;
 
 	pass forwardPass;
 	pass uiPass;
@@ -67,4 +140,4 @@ private:
 
 	std::vector<Frame> frames;
 
-}
\ No newline at end of file
+};
\ No newline at end of file
@@ -1,28 +1,317 @@
 #include "Renderer.h"
 
-Renderer::Renderer(RHIView& HInterface, ResourceView resources, SceneView& scene)
-	: HInterface(HInterface), resources(resources), scene(scene)
+#include "Signboard/RHI/vulkan/VulkanRenderPass.h"
+#include "Signboard/RHI/vulkan/VulkanFrameBuffer.h"
+
+#include "entityHandlers/world.h"
+#include "core/dataDef/Vertex.h"
+
+#include <cstddef>
+
+static constexpr ImageFormat DEPTH_FORMAT = ImageFormat::Depth32F;
+
+static VertexLayoutDesc makeVertexLayout() {
+	VertexLayoutDesc layout{};
+	layout.bindings.push_back({ 0, sizeof(Vertex) });
+	layout.attributes.push_back({ 0, VertexFormat::Float3, offsetof(Vertex, pos) });
+	layout.attributes.push_back({ 1, VertexFormat::Float3, offsetof(Vertex, normal) });
+	layout.attributes.push_back({ 2, VertexFormat::Float3, offsetof(Vertex, color) });
+	layout.attributes.push_back({ 3, VertexFormat::Float2, offsetof(Vertex, texCoord) });
+	layout.attributes.push_back({ 4, VertexFormat::Float4, offsetof(Vertex, tangent) });
+
+	return layout;
+}
+
+static PipelineDesc makeScenePipelineDesc(ImageFormat colorFormat, const char* vertexShader, const char* fragmentShader) {
+	PipelineDesc desc{};
+	desc.type = PipelineType::Graphics;
+	desc.vertexLayout = makeVertexLayout();
+	desc.samples = RasterSamples::Raster_Samples_1;
+	desc.colorFormat = colorFormat;
+	desc.depthForamt = DEPTH_FORMAT;
+	desc.shaders.push_back({ ShaderStageBit::VertexBit, vertexShader });
+	desc.shaders.push_back({ ShaderStageBit::FragmentBit, fragmentShader });
+
+	return desc;
+}
+
+Renderer::Renderer(RHIView HInterface, ResourceView resources, SceneView scene)
+	: HInterface(HInterface), resources(resources), scene(scene), graph(HInterface.device, FRAMES_IN_FLIGHT), hizPass(HInterface.device, resources.pipelineSystem, resources.deletions), gpuCuller(HInterface.device, resources.pipelineSystem, resources.deletions, FRAMES_IN_FLIGHT), terrainCache(HInterface.device, FRAMES_IN_FLIGHT),
+	  sceneLayout(HInterface.device, VulkanPipelineLayoutDesc{})
 {
 	frames.resize(FRAMES_IN_FLIGHT);
+	gpuCuller.setHiZ(&hizPass);
+	graph.setDeletionQueue(&resources.deletions);
+
+	ImageFormat colorFormat = HInterface.swapchain.getFormat();
+
+	RenderPassDesc earlyDesc{};
+	earlyDesc.colorAttachments.push_back({ colorFormat, LoadOp::Clear, StoreOp::Store });
+	earlyDesc.hasDepth = true;
+	earlyDesc.depthAttachment = { DEPTH_FORMAT, LoadOp::Clear, StoreOp::Store };
+
+	// hi-z build hands the depth back as an attachment, so both attachments are loaded in their attachment layouts
+	RenderPassDesc lateDesc{};
+	lateDesc.colorAttachments.push_back({ colorFormat, LoadOp::Load, StoreOp::Store, ImageLayout::ColorAttachment, ImageLayout::Present });
+	lateDesc.hasDepth = true;
+	lateDesc.depthAttachment = { DEPTH_FORMAT, LoadOp::Load, StoreOp::DontCare, ImageLayout::DepthStencilAttachment };
+
+	earlyRenderPass = std::make_unique<VulkanRenderPass>(HInterface.device, earlyDesc);
+	lateRenderPass = std::make_unique<VulkanRenderPass>(HInterface.device, lateDesc);
+
+	const SceneDescriptors& descriptors = scene.descriptors;
+	sceneLayout.addDescriptorSetLayout(descriptors.viewStateLayout);
+	sceneLayout.addDescriptorSetLayout(descriptors.objectStateLayout);
+	sceneLayout.addDescriptorSetLayout(descriptors.materialVariableLayout);
+	sceneLayout.addDescriptorSetLayout(descriptors.bindlessTextureLayout);
+	sceneLayout.addPushConstantRange({ ShaderStageBit::VertexBit, 0, sizeof(TerrainConstants) });
+	sceneLayout.build();
+
+	// every pipeline the first frame binds, built across worker threads before it so none of them hitches
+	std::vector<PipelineManifestEntry> manifest;
+	manifest.push_back({ &sceneLayout, earlyRenderPass.get(), makeScenePipelineDesc(colorFormat, "shaders/forward_indirect.vert.spv", "shaders/forward.frag.spv") });
+	manifest.push_back({ &sceneLayout, earlyRenderPass.get(), makeScenePipelineDesc(colorFormat, "shaders/terrain.vert.spv", "shaders/forward.frag.spv") });
+	manifest.push_back(gpuCuller.getPipelineEntry());
+	manifest.push_back(hizPass.getPipelineEntry());
+
+	std::vector<PipelineHandle> prewarmed = resources.pipelineSystem.prewarm(manifest);
+	objectPipeline = prewarmed[0];
+	terrainPipeline = prewarmed[1];
+	gpuCuller.setPipeline(prewarmed[2]);
+	hizPass.setPipeline(prewarmed[3]);
+
+	createTargets();
+}
+
+Renderer::~Renderer() {
+	resources.pipelineSystem.destroy(objectPipeline);
+	resources.pipelineSystem.destroy(terrainPipeline);
+
+	// nothing advances the deletion queue after the last frame, so whatever was retired since runs here
+	HInterface.device.waitIdle();
+	resources.deletions.releaseAll();
+}
+
+void Renderer::createTargets() {
+	ImageExtent2D extent = HInterface.swapchain.getExtent();
+
+	ImageDesc depthDesc{};
+	depthDesc.width = extent.width;
+	depthDesc.height = extent.height;
+	depthDesc.format = DEPTH_FORMAT;
+	depthDesc.usage = ImageUsage::DepthAttachment;
+	depthDesc.usage.set(ImageUsage::Sampled);
+
+	// the render passes are compatible, so one framebuffer per swapchain image serves both
+	frameBuffers.clear();
+	depthImage = std::make_unique<VulkanImage>(HInterface.device, depthDesc);
+
+	for (uint32_t i = 0; i < HInterface.swapchain.getImageCount(); i++) {
+		FrameBufferDesc desc{};
+		desc.colorAttachments.push_back(&HInterface.swapchain.getImage(i));
+		desc.depthAttachment = depthImage.get();
+		desc.width = extent.width;
+		desc.height = extent.height;
+
+		frameBuffers.push_back(std::make_unique<VulkanFrameBuffer>(HInterface.device, *earlyRenderPass, desc));
+	}
+
+	hizPass.setDepthSource(*depthImage);
+	graphDirty = true;
+}
+
+PipelineHandle Renderer::requestTerrainPipeline(const char* fragmentShader) {
+	ImageFormat colorFormat = HInterface.swapchain.getFormat();
+	return resources.pipelineSystem.getOrCreatePipleine(sceneLayout, makeScenePipelineDesc(colorFormat, "shaders/terrain.vert.spv", fragmentShader), *earlyRenderPass, terrainPipeline);
+}
+
+void Renderer::resize() {
+	// nothing in flight may still render into the old targets
+	HInterface.device.waitIdle();
+	createTargets();
+}
+
+void Renderer::setWorld(World* terrain) {
+	world = terrain;
+
+	// the world's chunks are the only occluders, without them the depth buffer would stay empty
+	culler.setOcclusionCuller(world ? &occlusion : nullptr);
+}
+
+std::vector<MemoryHeapStats> Renderer::getMemoryStats() const {
+	return HInterface.device.getAllocator().getHeapStats();
+}
+
+void Renderer::buildGraph() {
+	graph.reset();
+
+	// the swapchain image is ordered by the render passes' external dependencies and the acquire wait, the
+	// graph orders the depth target and the indirect buffers
+	PipelineStageFlags depthStages;
+	depthStages.set(PipelineStage::EarlyDepthTest, PipelineStage::LateDepthTest);
+	ResourceAccessFlags depthAccess;
+	depthAccess.set(ResourceAccess::DepthStencilRead, ResourceAccess::DepthStencilWrite);
+
+	gpuCuller.addCullToGraph(graph, currentFrameIndex, CullPhase::Early);
+
+	Pass& early = graph.addPass({ "ForwardEarly" });
+	early.imageAccess.push_back({ depthImage.get(), depthStages, depthAccess });
+	gpuCuller.declareDraws(early);
+	early.execute = [this](VulkanCommandBuffer& cmd) { drawSceneIndirect(cmd, CullPhase::Early); };
+
+	hizPass.addToGraph(graph);
+	gpuCuller.addCullToGraph(graph, currentFrameIndex, CullPhase::Late);
+
+	Pass& late = graph.addPass({ "ForwardLate" });
+	late.imageAccess.push_back({ depthImage.get(), depthStages, depthAccess });
+	gpuCuller.declareDraws(late);
+	late.sideEffects = true;
+	late.execute = [this](VulkanCommandBuffer& cmd) { drawSceneIndirect(cmd, CullPhase::Late); };
+
+	graph.compile();
+	graphDirty = false;
+	graphBufferVersion = gpuCuller.getBufferVersion();
+	graphHiZVersion = hizPass.getVersion();
 }
 
-void Renderer::beginFrame() {
+void Renderer::drawFrame(const glm::mat4& view, const glm::mat4& proj) {
+	if (!beginFrame())
+		return;
+
+	// culling records the frame's uploads into the command buffer, so it has to run before the graph
+	cullScene(view, proj);
+	renderFrame();
+	endFrame();
+}
+
+bool Renderer::beginFrame() {
 	Frame& currentFrame = frames[currentFrameIndex];
 
 	SwapchainImageAcquire acquire =  HInterface.swapchain.accquireNextImage(currentFrame.imageAvailable);
 
 	if (acquire.result == SwapchianAcquireResult::OutOfDate || acquire.result == SwapchianAcquireResult::SurfaceLost) {
 		resize();
-		return;
+		return false;
 	}
 
 	acquiredImageIndex = acquire.imageIndex;
 
 	currentFrame.cmd.begin();
+
+	// the fence only covers the frame's first submission, the graph's queue batches are waited here
+	graph.beginFrame(currentFrameIndex);
+
+	// begin() waited on this slot's fence, so its transient memory is no longer in use
+	HInterface.device.getAllocator().resetTransient(currentFrameIndex);
+	resources.transientUniforms.reset(currentFrameIndex);
+
+	// ownership acquires go first so every pass of this frame sees finished uploads
+	uploadWaitValue = resources.uploadSystem.acquire(currentFrame.cmd);
+
+	// releases queued FRAMES_IN_FLIGHT frames ago run now, their slots are freed by the flushes below
+	resources.deletions.advance();
+	resources.meshSystem.flushDeletes();
+	resources.textureSystem.flushDeletes();
+	resources.textureSystem.writePendingDescriptors();
+	resources.samplerSystem.flushDeletes();
+	resources.materialSystem.flushDeletes();
+	resources.pipelineSystem.flushDeletes();
+	scene.objectSystem.flushDeletes();
+
+	// pipelines finished in the background replace their fallbacks before this frame resolves any handle
+	resources.pipelineSystem.collectCompiled();
+
+	// every descriptor write queued since the last frame goes out in one update
+	resources.descriptorUpdates.flush();
+	return true;
+}
+
+void Renderer::cullScene(const glm::mat4& view, const glm::mat4& proj) {
+	// object and material changes made since the last frame reach the device buffers before culling reads them
+	Frame& currentFrame = frames[currentFrameIndex];
+	scene.objectSystem.uploadDirty(currentFrame.cmd, currentFrameIndex);
+	resources.materialSystem.uploadDirty(currentFrame.cmd, currentFrameIndex);
+
+	scene.viewStateSystem.setCamera(view, proj, glm::vec3(glm::inverse(view)[3]));
+	scene.viewStateSystem.upload();
+
+	culler.beginFrame(view, proj);
+	if (world)
+		culler.rasterizeOccluders(*world);
+
+	// objects and chunks that pass the frustum are tested against the occluders, getOcclusionStats reports the
+	// culled share and the raster and test cost
+	culler.cullObjects(scene.objectSystem, renderQueue.drawList);
+
+	gpuCuller.prepare(currentFrameIndex, scene.objectSystem, resources.meshSystem, proj * view, culler.getFrustum());
+
+	if (!world)
+		return;
+
+	// chunks without an uploaded mesh yet are visible but have nothing to draw
+	culler.cullChunks(*world, visibleChunks);
+
+	visibleChunkMeshes.clear();
+	for (const glm::ivec3& chunkPos : visibleChunks) {
+		auto it = chunkMeshes.find(chunkPos);
+		if (it != chunkMeshes.end())
+			visibleChunkMeshes.push_back(it->second);
+	}
+
+	submitTerrain(visibleChunkMeshes);
+}
+
+void Renderer::submitTerrain(const std::vector<MeshHandle>& chunkMeshes) {
+	// the chunk list comes from SceneCuller::cullChunks, an unchanged list reuses last build's commands
+	terrainCache.update(currentFrameIndex, chunkMeshes, resources.meshSystem);
+}
+
+void Renderer::bindSceneSets(VulkanCommandBuffer& cmd, const VulkanPipelineLayout& layout) {
+	const SceneDescriptors& descriptors = scene.descriptors;
+	uint32_t viewOffset = scene.viewStateSystem.getDynamicOffset();
+
+	cmd.bindDescriptorSet(PipelineType::Graphics, layout, 0, scene.viewStateSystem.getDescriptorSet(), &viewOffset, 1);
+	cmd.bindDescriptorSet(PipelineType::Graphics, layout, 1, descriptors.objectStateSet);
+	cmd.bindDescriptorSet(PipelineType::Graphics, layout, 2, descriptors.materialVariableSet);
+	cmd.bindDescriptorSet(PipelineType::Graphics, layout, 3, descriptors.bindlessTextureSet);
+}
+
+void Renderer::drawSceneIndirect(VulkanCommandBuffer& cmd, CullPhase phase) {
+	bool early = phase == CullPhase::Early;
+	ImageExtent2D extent = HInterface.swapchain.getExtent();
+
+	cmd.beginRenderPass(early ? *earlyRenderPass : *lateRenderPass, *frameBuffers[acquiredImageIndex]);
+	cmd.setViewport(extent.width, extent.height);
+	cmd.setScissor(extent.width, extent.height);
+
+	bindSceneSets(cmd, sceneLayout);
+
+	// terrain is culled on the cpu, it only goes out with the early phase. its commands number chunks rather
+	// than objects, so it binds its own pipeline and pushes its material
+	if (early && terrainMaterial.isValid()) {
+		PipelineHandle pipeline = resources.materialSystem.get(terrainMaterial).pipleine;
+		if (!pipeline.isValid())
+			pipeline = terrainPipeline;
+
+		terrainCache.draw(cmd, currentFrameIndex, resources.meshSystem, resources.pipelineSystem.get(pipeline), sceneLayout, terrainMaterial.index);
+	}
+
+	// whatever the terrain left bound, the object draws always run under the object pipeline
+	cmd.bindPipeline(resources.pipelineSystem.get(objectPipeline), PipelineType::Graphics);
+	gpuCuller.draw(cmd, currentFrameIndex, resources.meshSystem, phase);
+
+	cmd.endRenderPass();
+
+	// the render pass left the depth in its attachment layout, hi-z build transitions from there
+	depthImage->setLayout(ImageLayout::DepthStencilAttachment);
 }
 
 void Renderer::renderFrame() {
-	
+	// the passes name the culler's buffers and the pyramid, replacing any of them invalidates the graph
+	if (graphDirty || graphBufferVersion != gpuCuller.getBufferVersion() || graphHiZVersion != hizPass.getVersion())
+		buildGraph();
+
+	graph.execute(frames[currentFrameIndex].cmd, currentFrameIndex);
 }
 
 void Renderer::endFrame() {
@@ -30,7 +319,8 @@ void Renderer::endFrame() {
 
 	currentFrame.cmd.end();
 
-	currentFrame.cmd.submit(currentFrame.imageAvailable, currentFrame.renderFinished);
+	resources.uploadSystem.submit();
+	graph.submit(currentFrame.cmd, currentFrameIndex, currentFrame.imageAvailable, currentFrame.renderFinished, &resources.uploadSystem.getTimeline(), uploadWaitValue);
 	HInterface.swapchain.present(acquiredImageIndex, currentFrame.renderFinished);
 
 	currentFrameIndex = (currentFrameIndex + 1) % FRAMES_IN_FLIGHT;
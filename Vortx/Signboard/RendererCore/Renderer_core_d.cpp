@@ -12,7 +12,7 @@ Renderer::Renderer(VulkanDevice& device, ResourceView view)
 
 	createFrameContext();
 
-	forwardPass.init(device, systemView, renderPass);
+	forwardPass.init(device, systemView, renderPass, MAX_FRAMES_IN_FLIGHT);
 
 	allocateGlobalDescriptorSets(MAX_FRAMES_IN_FLIGHT);
 	writeGlobalDescriptorSets(MAX_FRAMES_IN_FLIGHT);
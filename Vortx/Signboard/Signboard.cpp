@@ -1,5 +1,7 @@
 #include "Signboard.h"
 
+#include "entityHandlers/world.h"
+
 #include <GLFW/glfw3.h>
 
 Signboard::Signboard() 
@@ -10,4 +12,109 @@ Signboard::Signboard()
 {
 	windowEvents.attachWindow(window.getWindowHandle());
 	windowEvents.bindRenderer(&renderer);
+}
+
+Signboard::~Signboard() {
+	// chunk meshes and the terrain material are retired behind frames that may still be in flight
+	vulkanRHI.getDevice().waitIdle();
+	setWorld(nullptr);
+}
+
+bool Signboard::isOpen() const {
+	return !glfwWindowShouldClose(window.getWindowHandle());
+}
+
+void Signboard::pollEvents() {
+	glfwPollEvents();
+}
+
+void Signboard::setWorld(World* newWorld) {
+	for (auto& [pos, mesh] : chunkMeshes) {
+		renderer.removeChunkMesh(pos);
+		resources.destroy(mesh);
+	}
+	chunkMeshes.clear();
+
+	if (terrainMaterial.isValid()) {
+		resources.destroy(terrainMaterial);
+		resources.destroy(terrainAtlas);
+		terrainMaterial = INVALID_MATERIAL;
+		terrainAtlas = INVALID_TEXTURE;
+	}
+
+	world = newWorld;
+	renderer.setWorld(world);
+	renderer.setTerrainMaterial(INVALID_MATERIAL);
+
+	if (!world)
+		return;
+
+	const TextureAtlas& atlas = world->getAtlas();
+
+	TextureDesc atlasDesc{};
+	atlasDesc.p_pixelData = atlas.ColorData.data();
+	atlasDesc.pixelSize = 4;
+	atlasDesc.pixelCount = static_cast<size_t>(atlas.atlasWidth) * atlas.atlasHeight;
+	atlasDesc.width = atlas.atlasWidth;
+	atlasDesc.height = atlas.atlasHeight;
+	atlasDesc.format = ImageFormat::RGBA8;
+	atlasDesc.usage = ImageUsage::Sampled;
+	terrainAtlas = resources.createTexture(atlasDesc);
+
+	MaterialDesc materialDesc{};
+	materialDesc.pipeline = renderer.requestTerrainPipeline("shaders/forward.frag.spv");
+	materialDesc.material.baseColor = glm::vec4(1.0f);
+	materialDesc.material.metallic = 0.0f;
+	materialDesc.material.roughness = 1.0f;
+	materialDesc.material.albedoTex = terrainAtlas.index;
+	materialDesc.material.normaltex = terrainAtlas.index;
+	terrainMaterial = resources.createMaterial(materialDesc);
+
+	renderer.setTerrainMaterial(terrainMaterial);
+}
+
+void Signboard::drawFrame(const glm::mat4& view, const glm::mat4& proj) {
+	if (world)
+		streamWorld();
+
+	renderer.drawFrame(view, proj);
+}
+
+void Signboard::streamWorld() {
+	world->captureGenratedChunks();
+	world->takeMeshUpdates(meshUpdates, removedChunks);
+
+	for (const glm::ivec3& pos : removedChunks) {
+		auto it = chunkMeshes.find(pos);
+		if (it == chunkMeshes.end()) continue;
+
+		renderer.removeChunkMesh(pos);
+		resources.destroy(it->second);
+		chunkMeshes.erase(it);
+	}
+
+	for (const MeshJob& job : meshUpdates) {
+		auto it = chunkMeshes.find(job.pos);
+		if (it != chunkMeshes.end()) {
+			resources.destroy(it->second);
+			chunkMeshes.erase(it);
+		}
+
+		// chunks without any exposed face, e.g. fully buried ones, have nothing to draw
+		if (job.mesh.indices.empty()) {
+			renderer.removeChunkMesh(job.pos);
+			continue;
+		}
+
+		MeshDesc desc{};
+		desc.p_vertexData = job.mesh.vertices.data();
+		desc.vertexSize = sizeof(Vertex);
+		desc.vertexCount = job.mesh.vertices.size();
+		desc.p_indexData = job.mesh.indices.data();
+		desc.indexCount = static_cast<uint32_t>(job.mesh.indices.size());
+
+		MeshHandle mesh = resources.createMesh(desc);
+		chunkMeshes[job.pos] = mesh;
+		renderer.setChunkMesh(job.pos, mesh);
+	}
 }
\ No newline at end of file
@@ -6,11 +6,29 @@
 #include "resources/ResourceAPI.h"
 #include "RendererCore/Renderer.h"
 
+#include <unordered_map>
+#include <vector>
+
 class GLFWwindow;
+class World;
+struct MeshJob;
 
 class Signboard {
 public:
 	Signboard();
+	~Signboard();
+
+	bool isOpen() const;
+	void pollEvents();
+
+	// the world streams its chunk meshes in at the start of every frame, null detaches it
+	void setWorld(World* world);
+
+	// the application's frame loop calls this once per frame with its camera
+	void drawFrame(const glm::mat4& view, const glm::mat4& proj);
+
+private:
+	void streamWorld();
 
 private:
 	WindowSurface window;
@@ -21,4 +39,12 @@ private:
 	ResourceAPI resources;
 
 	Renderer renderer;
+
+	World* world = nullptr;
+	TextureHandle terrainAtlas = INVALID_TEXTURE;
+	MaterialHandle terrainMaterial = INVALID_MATERIAL;
+
+	std::unordered_map<glm::ivec3, MeshHandle, IVec3Hash, IVec3Equal> chunkMeshes;
+	std::vector<MeshJob> meshUpdates;
+	std::vector<glm::ivec3> removedChunks;
 };
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "ResourceAPI.h"
 
+#include "resourceSystems/primitive/Mesh.h"
+
 ResourceAPI::ResourceAPI(VulkanDevice& device)
 	: device(device),
 
@@ -15,16 +17,29 @@ ResourceAPI::ResourceAPI(VulkanDevice& device)
 	  materialVariableSet(descriptorPool.allocate(materialVariableLayout, nullptr)),
 	  bindlessTextureSet(descriptorPool.allocate(bindlessTextureLayout, DESCRIPTOR_SCHEMA::BINDLESS_TEXTURES::VARIABLE_COUNT)),
 
-	  objectSystem(device, objectStateSet, DESCRIPTOR_SCHEMA::OBJECT_STATE::OBJECT_BUFFER_BINDING, DESCRIPTOR_SCHEMA::OBJECT_STATE::MAX_OBJECT_COUNT),
-	  viewStateSystem(device, viewStateSet, DESCRIPTOR_SCHEMA::VIEW_STATE::VIEW_STATE_BINDING),
+	  descriptorUpdates(device),
+	  deletions(),
+	  transientUniforms(device),
+
+	  objectSystem(device, descriptorUpdates, objectStateSet, DESCRIPTOR_SCHEMA::OBJECT_STATE::OBJECT_BUFFER_BINDING, DESCRIPTOR_SCHEMA::OBJECT_STATE::MAX_OBJECT_COUNT),
+	  viewStateSystem(device, descriptorUpdates, transientUniforms, viewStateSet, DESCRIPTOR_SCHEMA::VIEW_STATE::VIEW_STATE_BINDING),
+
+	  materialSystem(device, descriptorUpdates, deletions, materialVariableSet, DESCRIPTOR_SCHEMA::MATERIAL_VARIABLES::MATERIAL_BUFFER_BINDING, DESCRIPTOR_SCHEMA::MATERIAL_VARIABLES::MAX_MATERIAL_COUNT),
+	  textureSystem(device, uploadSystem, descriptorUpdates, deletions, bindlessTextureSet, DESCRIPTOR_SCHEMA::BINDLESS_TEXTURES::TEXTURE_BINDING, DESCRIPTOR_SCHEMA::BINDLESS_TEXTURES::MAX_TEXTURES),
+	  samplerSystem(device, descriptorUpdates, deletions, bindlessTextureSet, DESCRIPTOR_SCHEMA::BINDLESS_TEXTURES::SAMPLER_BINDING, DESCRIPTOR_SCHEMA::BINDLESS_TEXTURES::MAX_SAMPLERS),
+	  pipelineSystem(device, deletions),
+	  meshSystem(device, uploadSystem, deletions),
 
-	  materialSystem(device, materialVariableSet, DESCRIPTOR_SCHEMA::MATERIAL_VARIABLES::MATERIAL_BUFFER_BINDING, DESCRIPTOR_SCHEMA::MATERIAL_VARIABLES::MAX_MATERIAL_COUNT),
-	  textureSystem(device, bindlessTextureSet, DESCRIPTOR_SCHEMA::BINDLESS_TEXTURES::TEXTURE_BINDING, DESCRIPTOR_SCHEMA::BINDLESS_TEXTURES::MAX_TEXTURES),
-	  samplerSystem(device, bindlessTextureSet, DESCRIPTOR_SCHEMA::BINDLESS_TEXTURES::SAMPLER_BINDING, DESCRIPTOR_SCHEMA::BINDLESS_TEXTURES::MAX_SAMPLERS),
-	  pipelineSystem(device),
-	  meshSystem(device)
+	  uploadSystem(device)
 {
+	// only requests that name a fallback compile in the background, everything else still builds in place
+	pipelineSystem.setAsyncCompilation(true);
 
+	// the upload system is constructed last, the fallback texture can only be uploaded from here
+	textureSystem.createFallback();
+
+	// takes sampler slot 0, the forward shaders sample every material texture through it
+	defaultSampler = samplerSystem.createSampler(SamplerDesc{});
 }
 
 VulkanDescriptorPool ResourceAPI::createDescriptorPool() {
@@ -32,6 +47,10 @@ VulkanDescriptorPool ResourceAPI::createDescriptorPool() {
 	UBO_pool.type = DescriptorType::UniformBuffer;
 	UBO_pool.count = 512;
 
+	DescriptorPoolSizeDesc DynamicUBO_pool{};
+	DynamicUBO_pool.type = DescriptorType::UniformBufferDynamic;
+	DynamicUBO_pool.count = 8;
+
 	DescriptorPoolSizeDesc Texture_pool{};
 	Texture_pool.type = DescriptorType::SampledImage;
 	Texture_pool.count = 512;
@@ -41,7 +60,7 @@ VulkanDescriptorPool ResourceAPI::createDescriptorPool() {
 	Sampler_pool.count = 32;
 
 	DescriptorPoolDesc desc;
-	desc.poolSizes = { UBO_pool, Texture_pool, Sampler_pool };
+	desc.poolSizes = { UBO_pool, DynamicUBO_pool, Texture_pool, Sampler_pool };
 	desc.maxSets = 128;
 
 	return VulkanDescriptorPool(device, desc);
@@ -50,7 +69,7 @@ VulkanDescriptorPool ResourceAPI::createDescriptorPool() {
 VulkanDescriptorSetLayout ResourceAPI::createViewStateLayout() {
 	DescriptorBindingDesc viewState{};
 	viewState.binding = DESCRIPTOR_SCHEMA::VIEW_STATE::VIEW_STATE_BINDING;
-	viewState.type = DescriptorType::UniformBuffer;
+	viewState.type = DescriptorType::UniformBufferDynamic;
 	viewState.stages.set(ShaderStageBit::VertexBit, ShaderStageBit::FragmentBit);
 	viewState.count = DESCRIPTOR_SCHEMA::VIEW_STATE::VIEW_STATE_COUNT;
 	
@@ -107,8 +126,49 @@ VulkanDescriptorSetLayout ResourceAPI::createBindlessTextureLayout() {
 	return VulkanDescriptorSetLayout(device, desc);
 }
 
-MeshHandle ResourceAPI::createMesh(VulkanCommandBuffer& cmd, const MeshDesc& desc) {
-	return meshSystem.createMesh(cmd, desc);
+MeshHandle ResourceAPI::createMesh(const MeshDesc& desc) {
+	return meshSystem.createMesh(desc);
+}
+
+TextureHandle ResourceAPI::createTexture(const TextureDesc& desc) {
+	return textureSystem.createTexture(desc);
+}
+
+MaterialHandle ResourceAPI::createMaterial(const MaterialDesc& desc) {
+	return materialSystem.createMaterial(desc);
+}
+
+ObjectHandle ResourceAPI::createObject(MeshHandle mesh, MaterialHandle material, const glm::mat4& transform) {
+	ObjectHandle object = objectSystem.createObject(mesh, material, transform);
+
+	// the mesh's box is known from creation on, culling tests the object against it rather than letting it
+	// through as unbounded
+	objectSystem.setBounds(object, meshSystem.get(mesh).getBounds());
+	return object;
+}
+
+void ResourceAPI::destroy(MeshHandle mesh) {
+	meshSystem.destroy(mesh);
+}
+
+void ResourceAPI::destroy(TextureHandle texture) {
+	textureSystem.destroy(texture);
+}
+
+void ResourceAPI::destroy(MaterialHandle material) {
+	materialSystem.destroy(material);
+}
+
+bool ResourceAPI::isResident(MeshHandle mesh) const {
+	return meshSystem.isResident(mesh);
+}
+
+bool ResourceAPI::isResident(TextureHandle texture) const {
+	return textureSystem.isResident(texture);
+}
+
+void ResourceAPI::flush() {
+	uploadSystem.submit();
 }
 
 ResourceView ResourceAPI::getResourceView() {
@@ -117,7 +177,11 @@ ResourceView ResourceAPI::getResourceView() {
 		materialSystem, 
 		textureSystem, 
 		samplerSystem, 
-		meshSystem 
+		meshSystem,
+		uploadSystem,
+		descriptorUpdates,
+		deletions,
+		transientUniforms
 	};
 }
 
@@ -125,6 +189,15 @@ SceneView ResourceAPI::getSceneView() {
 	return SceneView{
 		objectSystem,
 		viewStateSystem,
+		SceneDescriptors{
+			viewStateLayout,
+			objectStateLayout,
+			materialVariableLayout,
+			bindlessTextureLayout,
+			objectStateSet,
+			materialVariableSet,
+			bindlessTextureSet
+		}
 	};
 }
 
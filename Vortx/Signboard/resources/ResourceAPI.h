@@ -5,6 +5,10 @@
 #include "resourceSystems/SamplerSystem.h"
 #include "resourceSystems/MaterialSystem.h"
 #include "resourceSystems/PipelineSystem.h"
+#include "resourceSystems/UploadSystem.h"
+#include "resourceSystems/DescriptorUpdateQueue.h"
+#include "resourceSystems/DeletionQueue.h"
+#include "resourceSystems/TransientUniformAllocator.h"
 
 #include "scene/ObjectSystem.h"
 #include "scene/ViewStateSystem.h"
@@ -21,11 +25,29 @@ struct ResourceView {
 	TextureSystem&		textureSystem;
 	SamplerSystem&		samplerSystem;
 	MeshSystem&			meshSystem;
+	UploadSystem&		uploadSystem;
+	DescriptorUpdateQueue&	descriptorUpdates;
+	DeletionQueue&		deletions;
+	TransientUniformAllocator&	transientUniforms;
+};
+
+// the scene pipelines' set layouts in DESCRIPTOR_SCHEMA set order, with the set bound at each. the view state
+// set comes from the ViewStateSystem together with its dynamic offset
+struct SceneDescriptors {
+	VulkanDescriptorSetLayout& viewStateLayout;
+	VulkanDescriptorSetLayout& objectStateLayout;
+	VulkanDescriptorSetLayout& materialVariableLayout;
+	VulkanDescriptorSetLayout& bindlessTextureLayout;
+
+	const VulkanDescriptorSet& objectStateSet;
+	const VulkanDescriptorSet& materialVariableSet;
+	const VulkanDescriptorSet& bindlessTextureSet;
 };
 
 struct SceneView {
 	ObjectSystem& objectSystem;
 	ViewStateSystem& viewStateSystem;
+	SceneDescriptors descriptors;
 };
 
 struct MeshDesc;
@@ -44,8 +66,8 @@ public:
 	ResourceView getResourceView();
 	SceneView getSceneView();
 	
-	MeshHandle createMesh(VulkanCommandBuffer& cmd, const MeshDesc& desc);
-	TextureHandle createTexture(VulkanCommandBuffer& cmd, const TextureDesc& desc);
+	MeshHandle createMesh(const MeshDesc& desc);
+	TextureHandle createTexture(const TextureDesc& desc);
 	SamplerHandle createSampler(const SamplerDesc& desc);
 	MaterialHandle createMaterial(const MaterialDesc& desc);
 	ObjectHandle createObject(MeshHandle mesh, MaterialHandle material, const glm::mat4& transform);
@@ -56,6 +78,9 @@ public:
 	void destroy(MaterialHandle material);
 	void destory(ObjectHandle object);
 
+	bool isResident(MeshHandle mesh) const;
+	bool isResident(TextureHandle texture) const;
+
 	void flush();
 
 private:
@@ -81,6 +106,14 @@ private:
 	VulkanDescriptorSet materialVariableSet;
 	VulkanDescriptorSet bindlessTextureSet;
 
+	// outlives every system that queues writes into it
+	DescriptorUpdateQueue descriptorUpdates;
+
+	// pending releases capture the systems below, it is destroyed after them and drops what is left
+	DeletionQueue deletions;
+
+	TransientUniformAllocator transientUniforms;
+
 	ObjectSystem objectSystem;
 	ViewStateSystem viewStateSystem;
 
@@ -90,4 +123,9 @@ private:
 	SamplerSystem samplerSystem;
 	MeshSystem meshSystem;
 
+	// declared last so it is destroyed first, waiting out uploads into buffers the systems above still own
+	UploadSystem uploadSystem;
+
+	SamplerHandle defaultSampler = INVALID_SAMPLER;
+
 };
\ No newline at end of file
@@ -8,8 +8,9 @@ struct MaterialHandle {
 	uint32_t index;
 	uint32_t generation;
 
+	// slot generations start at 1, INVALID_MATERIAL is told apart by its index
 	bool isValid() const {
-		return generation != 0;
+		return index != UINT32_MAX && generation != 0;
 	}
 };
 constexpr MaterialHandle INVALID_MATERIAL{ UINT32_MAX, UINT32_MAX };
@@ -5,5 +5,9 @@
 struct PipelineHandle {
 	uint32_t index;
 	uint32_t generation;
+
+	bool isValid() const {
+		return index != UINT32_MAX && generation != 0;
+	}
 };
 constexpr PipelineHandle INVALID_PIPELINE {UINT32_MAX, UINT32_MAX};
\ No newline at end of file
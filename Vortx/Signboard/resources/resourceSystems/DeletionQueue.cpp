@@ -0,0 +1,32 @@
+#include "DeletionQueue.h"
+
+#include <utility>
+
+DeletionQueue::DeletionQueue(uint32_t retireLatency)
+	: retireLatency(retireLatency) {}
+
+DeletionQueue::~DeletionQueue() = default;
+
+void DeletionQueue::retire(std::function<void()> release) {
+	entries.push_back({ frame, std::move(release) });
+}
+
+void DeletionQueue::advance() {
+	frame++;
+
+	uint64_t completed = getCompletedFrame();
+	while (!entries.empty() && entries.front().frame <= completed) {
+		// a release may retire more work, so take it off the queue before running it
+		std::function<void()> release = std::move(entries.front().release);
+		entries.pop_front();
+		release();
+	}
+}
+
+void DeletionQueue::releaseAll() {
+	while (!entries.empty()) {
+		std::function<void()> release = std::move(entries.front().release);
+		entries.pop_front();
+		release();
+	}
+}
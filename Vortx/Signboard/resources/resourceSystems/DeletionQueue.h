@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+
+// releases resources once the gpu has retired every frame that could still reference them
+class DeletionQueue {
+public:
+	// matches the renderer's frames in flight
+	static constexpr uint32_t DEFAULT_RETIRE_LATENCY = 2;
+
+	explicit DeletionQueue(uint32_t retireLatency = DEFAULT_RETIRE_LATENCY);
+
+	// anything still queued is dropped without running, call releaseAll once the device is idle to run it
+	~DeletionQueue();
+
+	DeletionQueue(const DeletionQueue&) = delete;
+	DeletionQueue& operator=(const DeletionQueue&) = delete;
+
+	// release runs once the frame being recorded now, and every earlier one, has completed
+	void retire(std::function<void()> release);
+
+	// once per frame, after the frame fence has been waited on
+	void advance();
+
+	// runs everything still queued, only valid once the device is idle
+	void releaseAll();
+
+	uint64_t getFrame() const { return frame; }
+	uint64_t getCompletedFrame() const { return frame > retireLatency ? frame - retireLatency : 0; }
+	uint32_t getPendingCount() const { return static_cast<uint32_t>(entries.size()); }
+
+private:
+	struct Entry {
+		uint64_t frame;
+		std::function<void()> release;
+	};
+
+	uint32_t retireLatency;
+	uint64_t frame = 0;
+
+	// frames only grow, so entries stay ordered and retire from the front
+	std::deque<Entry> entries;
+};
@@ -0,0 +1,117 @@
+#include "DescriptorUpdateQueue.h"
+
+#include "Signboard/RHI/vulkan/VulkanDescriptorSet.h"
+#include "Signboard/RHI/vulkan/VulkanDescriptorWriter.h"
+
+#include <stdexcept>
+
+DescriptorUpdateQueue::DescriptorUpdateQueue(VulkanDevice& device)
+	: device(device) {}
+
+void DescriptorUpdateQueue::writeSampledImage(const VulkanDescriptorSet& set, uint32_t binding, uint32_t arrayIndex, const VulkanImage* image) {
+	Write write{ DescriptorType::SampledImage, binding, arrayIndex };
+	write.image = image;
+	queue(set, write);
+}
+
+void DescriptorUpdateQueue::writeSampler(const VulkanDescriptorSet& set, uint32_t binding, uint32_t arrayIndex, const VulkanSampler* sampler) {
+	Write write{ DescriptorType::TextureSampler, binding, arrayIndex };
+	write.sampler = sampler;
+	queue(set, write);
+}
+
+void DescriptorUpdateQueue::writeStorageBuffer(const VulkanDescriptorSet& set, uint32_t binding, const VulkanBuffer* buffer, uint64_t range, uint64_t offset) {
+	Write write{ DescriptorType::StorageBuffer, binding, 0 };
+	write.buffer = buffer;
+	write.range = range;
+	write.offset = offset;
+	queue(set, write);
+}
+
+void DescriptorUpdateQueue::writeUniformBuffer(const VulkanDescriptorSet& set, uint32_t binding, const VulkanBuffer* buffer, uint64_t range, uint64_t offset) {
+	Write write{ DescriptorType::UniformBuffer, binding, 0 };
+	write.buffer = buffer;
+	write.range = range;
+	write.offset = offset;
+	queue(set, write);
+}
+
+void DescriptorUpdateQueue::writeUniformBufferDynamic(const VulkanDescriptorSet& set, uint32_t binding, const VulkanBuffer* buffer, uint64_t range) {
+	Write write{ DescriptorType::UniformBufferDynamic, binding, 0 };
+	write.buffer = buffer;
+	write.range = range;
+	queue(set, write);
+}
+
+void DescriptorUpdateQueue::queue(const VulkanDescriptorSet& set, const Write& write) {
+	SetWrites* target = nullptr;
+	for (SetWrites& entry : sets) {
+		if (entry.set == &set) {
+			target = &entry;
+			break;
+		}
+	}
+
+	if (!target) {
+		sets.push_back(SetWrites{ &set });
+		target = &sets.back();
+	}
+
+	stats.queuedWrites++;
+
+	uint64_t key = (static_cast<uint64_t>(write.binding) << 32) | write.arrayIndex;
+	auto it = target->slots.find(key);
+	if (it != target->slots.end()) {
+		target->writes[it->second] = write;
+		stats.coalescedWrites++;
+		return;
+	}
+
+	target->slots.emplace(key, static_cast<uint32_t>(target->writes.size()));
+	target->writes.push_back(write);
+	pendingCount++;
+}
+
+void DescriptorUpdateQueue::flush() {
+	if (pendingCount == 0)
+		return;
+
+	VulkanDescriptorWriter writer(device);
+
+	for (SetWrites& entry : sets) {
+		if (entry.writes.empty()) continue;
+
+		writer.target(*entry.set);
+		for (const Write& write : entry.writes) {
+			switch (write.type) {
+			case DescriptorType::SampledImage:
+				writer.writeSampledImage(write.binding, write.arrayIndex, write.image);
+				break;
+			case DescriptorType::TextureSampler:
+				writer.writeSampler(write.binding, write.arrayIndex, write.sampler);
+				break;
+			case DescriptorType::StorageBuffer:
+				writer.writeStorageBuffer(write.binding, write.buffer, write.range, write.offset);
+				break;
+			case DescriptorType::UniformBuffer:
+				writer.writeUniformBuffer(write.binding, write.buffer, write.range, write.offset);
+				break;
+			case DescriptorType::UniformBufferDynamic:
+				writer.writeUniformBufferDynamic(write.binding, write.buffer, write.range);
+				break;
+			default:
+				throw std::runtime_error("unsupported deferred descriptor type!");
+			}
+		}
+
+		// keep the per-set storage around, the same sets are written every frame
+		entry.writes.clear();
+		entry.slots.clear();
+	}
+
+	stats.flushedWrites += writer.getWriteCount();
+	stats.updateCalls++;
+
+	writer.commit();
+	pendingCount = 0;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Signboard/RHI/common/DescriptorTypes.h"
+
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+
+class VulkanDevice;
+class VulkanDescriptorSet;
+class VulkanBuffer;
+class VulkanImage;
+class VulkanSampler;
+
+struct DescriptorUpdateStats {
+	uint32_t queuedWrites = 0;
+	uint32_t coalescedWrites = 0;
+	uint32_t flushedWrites = 0;
+	uint32_t updateCalls = 0;
+};
+
+class DescriptorUpdateQueue {
+public:
+	explicit DescriptorUpdateQueue(VulkanDevice& device);
+
+	DescriptorUpdateQueue(const DescriptorUpdateQueue&) = delete;
+	DescriptorUpdateQueue& operator=(const DescriptorUpdateQueue&) = delete;
+
+	// a later write to the same set, binding and array element replaces the queued one
+	void writeSampledImage(const VulkanDescriptorSet& set, uint32_t binding, uint32_t arrayIndex, const VulkanImage* image);
+	void writeSampler(const VulkanDescriptorSet& set, uint32_t binding, uint32_t arrayIndex, const VulkanSampler* sampler);
+	void writeStorageBuffer(const VulkanDescriptorSet& set, uint32_t binding, const VulkanBuffer* buffer, uint64_t range, uint64_t offset = 0);
+	void writeUniformBuffer(const VulkanDescriptorSet& set, uint32_t binding, const VulkanBuffer* buffer, uint64_t range, uint64_t offset = 0);
+	void writeUniformBufferDynamic(const VulkanDescriptorSet& set, uint32_t binding, const VulkanBuffer* buffer, uint64_t range);
+
+	// all queued writes go out in a single vkUpdateDescriptorSets
+	void flush();
+
+	bool isEmpty() const { return pendingCount == 0; }
+	const DescriptorUpdateStats& getStats() const { return stats; }
+
+private:
+	struct Write {
+		DescriptorType type;
+		uint32_t binding;
+		uint32_t arrayIndex;
+
+		const VulkanImage* image = nullptr;
+		const VulkanSampler* sampler = nullptr;
+		const VulkanBuffer* buffer = nullptr;
+		uint64_t range = 0;
+		uint64_t offset = 0;
+	};
+
+	struct SetWrites {
+		const VulkanDescriptorSet* set;
+		std::vector<Write> writes;
+		std::unordered_map<uint64_t, uint32_t> slots;
+	};
+
+	void queue(const VulkanDescriptorSet& set, const Write& write);
+
+private:
+	VulkanDevice& device;
+
+	std::vector<SetWrites> sets;
+	uint32_t pendingCount = 0;
+
+	DescriptorUpdateStats stats;
+};
@@ -1,108 +1,74 @@
 #include "MaterialSystem.h"
 
-#include "Signboard/RHI/vulkan/VulkanDescriptorWriter.h"
 #include "Signboard/RHI/vulkan/VulkanDescriptorSet.h"
+#include "Signboard/RHI/vulkan/VulkanBuffer.h"
 
 #include "Signboard/RHI/vulkan/VulkanImage.h"
 
 #include "TextureSystem.h"
+#include "DescriptorUpdateQueue.h"
+#include "DeletionQueue.h"
 #include "primitive/Texture.h"
 
 #include <array>
 #include <stdexcept>
 
-MaterialSystem::MaterialSystem(VulkanDevice& device, VulkanDescriptorSet& materialSet, uint32_t materialBindingIndex, uint32_t maxMaterialCount)
-    : device(device), materialSet(materialSet), materialBindingIndex(materialBindingIndex), maxMaterialCount(maxMaterialCount), materialBuffer(createMaterialStorageBuffer())
-{
-    writeMaterialDescriptor();
+static PipelineStageFlags materialReadStages() {
+    PipelineStageFlags stages;
+    stages.set(PipelineStage::VertexShader, PipelineStage::FragmentShader);
+    return stages;
 }
 
-VulkanBuffer MaterialSystem::createMaterialStorageBuffer() {
-    BufferDesc bufferDesc{};
-    bufferDesc.size = sizeof(GPUMaterial) * maxMaterialCount;
-    bufferDesc.memoryFlags.set(MemoryProperty::HostVisible, MemoryProperty::HostCoherent);
-    bufferDesc.usageFlags = BufferUsage::Storage;
-
-    return VulkanBuffer(device, bufferDesc);
+MaterialSystem::MaterialSystem(VulkanDevice& device, DescriptorUpdateQueue& descriptorUpdates, DeletionQueue& deletions, VulkanDescriptorSet& materialSet, uint32_t materialBindingIndex, uint32_t maxMaterialCount)
+    : device(device), descriptorUpdates(descriptorUpdates), deletions(deletions), materialSet(materialSet), materialBindingIndex(materialBindingIndex), maxMaterialCount(maxMaterialCount),
+      materials(maxMaterialCount), mirror(device, sizeof(GPUMaterial), maxMaterialCount, materialReadStages())
+{
+    writeMaterialDescriptor();
 }
 
 void MaterialSystem::writeMaterialDescriptor() {
-    VulkanDescriptorWriter writer(device, materialSet);
-
-    writer.writeStorageBuffer(materialBindingIndex, &materialBuffer, materialBuffer.getSize());
-    writer.commit();
+    const VulkanBuffer& materialBuffer = mirror.getBuffer();
+    descriptorUpdates.writeStorageBuffer(materialSet, materialBindingIndex, &materialBuffer, materialBuffer.getSize());
 }
 
 MaterialSystem::~MaterialSystem() {
 }
 
 MaterialHandle MaterialSystem::createMaterial(const MaterialDesc& desc) {
-    MaterialHandle handle = allocateSlot();
+    if (materials.isFull())
+        throw std::runtime_error("out of material slots!");
 
-    MaterialSlot& slot = slots[handle.index];
+    MaterialSlot slot;
     slot.pipleine = desc.pipeline;
     slot.material = desc.material;
-    slot.generation++;
-    slot.alive = true;
-
-    return handle;
-}
 
-void MaterialSystem::upload(uint32_t index) {
-    materialBuffer.upload(&slots[index].material, sizeof(GPUMaterial), index * sizeof(GPUMaterial));
+    return materials.insert(slot);
 }
 
-MaterialHandle MaterialSystem::allocateSlot() {
-    uint32_t index;
-
-    if (!freeList.empty()) {
-        index = freeList.back();
-        freeList.pop_back();
-    } else {
-        index = static_cast<uint32_t>(slots.size());
-        slots.emplace_back();
-    }
-
-    return MaterialHandle{ index, slots[index].generation };
+void MaterialSystem::uploadDirty(VulkanCommandBuffer& cmd, uint32_t frameIndex) {
+    materials.consumeDirty([&](uint32_t begin, uint32_t end) {
+        GPUMaterial* staging = static_cast<GPUMaterial*>(mirror.stage(frameIndex, begin, end));
+        for (uint32_t i = begin; i < end; i++)
+            staging[i - begin] = materials.at(i).material;
+    });
+    mirror.record(cmd, frameIndex);
 }
 
 void MaterialSystem::destroy(MaterialHandle handle) {
-    if (!handle.isValid())
+    if (!materials.contains(handle))
         return;
 
-    uint32_t index = handle.index;
-    if (index >= slots.size())
-        return;
-
-    MaterialSlot& slot = slots[index];
-    if (slot.generation != handle.generation || !slot.alive)
-        return;
-
-    slot.alive = false;
-    pendingDeletes.push_back(index);
+    deletions.retire([this, handle]() { materials.destroy(handle); });
 }
 
 void MaterialSystem::flushDeletes() {
-    for (uint32_t index : pendingDeletes) {
-        MaterialSlot& slot = slots[index];
-
-        slot.generation++;
-        freeList.push_back(index);
-    }
-    pendingDeletes.clear();
+    materials.flushDeletes();
 }
 
 const MaterialSlot& MaterialSystem::get(MaterialHandle handle) const {
-    if (!handle.isValid())
+    const MaterialSlot* slot = materials.find(handle);
+    if (!slot)
         throw std::runtime_error("invalid handle!");
 
-    uint32_t index = handle.index;
-    if (index >= slots.size())
-        return;
-
-    const MaterialSlot& slot = slots[index];
-    if (slot.generation != handle.generation || !slot.alive)
-        return;
-
-    return slot;
+    return *slot;
 }
\ No newline at end of file
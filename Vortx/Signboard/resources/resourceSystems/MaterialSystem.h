@@ -2,7 +2,8 @@
 
 #include "Signboard/resources/common/MaterialSystemTypes.h"
 
-#include "Signboard/RHI/vulkan/VulkanBuffer.h"
+#include "primitive/SlotTable.h"
+#include "primitive/SlotMirror.h"
 
 #include <glm/glm.hpp>
 #include <memory>
@@ -10,19 +11,19 @@
 struct MaterialSlot {
 	PipelineHandle pipleine;
 	GPUMaterial material;
-	uint32_t generation = 0;
-	bool alive = false;
 };
 
 class VulkanDevice;
 class VulkanDescriptorSet;
 class VulkanCommandBuffer;
+class DescriptorUpdateQueue;
+class DeletionQueue;
 
 class PipelineSystem;
 
 class MaterialSystem {
 public:
-	explicit MaterialSystem(VulkanDevice& device, VulkanDescriptorSet& materialSet, uint32_t materialBindingIndex, uint32_t maxMaterialCount);
+	explicit MaterialSystem(VulkanDevice& device, DescriptorUpdateQueue& descriptorUpdates, DeletionQueue& deletions, VulkanDescriptorSet& materialSet, uint32_t materialBindingIndex, uint32_t maxMaterialCount);
 	~MaterialSystem();
 
 	MaterialHandle createMaterial(const MaterialDesc& desc);
@@ -32,24 +33,21 @@ public:
 	void destroy(MaterialHandle handle);
 	void flushDeletes();
 
-private:
-	MaterialHandle allocateSlot();
-	void upload(uint32_t index);
+	// copies materials created since the last call into the device buffer, record before any pass reads it
+	void uploadDirty(VulkanCommandBuffer& cmd, uint32_t frameIndex);
 
-	VulkanBuffer createMaterialStorageBuffer();
+private:
 	void writeMaterialDescriptor();
 
 private:
 	VulkanDevice& device;
+	DescriptorUpdateQueue& descriptorUpdates;
+	DeletionQueue& deletions;
 
 	VulkanDescriptorSet& materialSet;
 	uint32_t materialBindingIndex;
 	uint32_t maxMaterialCount;
 
-	VulkanBuffer materialBuffer;
-
-	std::vector<MaterialSlot> slots;
-	std::vector<uint32_t> freeList;
-
-	std::vector<uint32_t> pendingDeletes;
+	SlotTable<MaterialSlot, MaterialHandle> materials;
+	SlotMirror mirror;
 };
\ No newline at end of file
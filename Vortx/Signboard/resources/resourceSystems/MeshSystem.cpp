@@ -1,113 +1,118 @@
 #include "MeshSystem.h"
 #include "primitive/Mesh.h"
+#include "UploadSystem.h"
+#include "DeletionQueue.h"
 
 #include "renderSystem/RHI/vulkan/VulkanBuffer.h"
 
 #include <stdexcept>
-#include <cassert>
+#include <cstring>
+#include <cfloat>
+#include <algorithm>
 
-MeshSystem::MeshSystem(VulkanDevice& device)
-	: device(device) {}
+static AABB computeBounds(const MeshDesc& desc) {
+	const uint8_t* vertex = static_cast<const uint8_t*>(desc.p_vertexData);
 
-MeshSystem::~MeshSystem() {
-	slots.clear();
-	freeList.clear();
-}
-
-MeshHandle MeshSystem::allocateSlot(std::unique_ptr<Mesh> mesh) {
-	uint32_t index;
+	AABB bounds{ glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX) };
+	for (size_t i = 0; i < desc.vertexCount; i++, vertex += desc.vertexSize) {
+		glm::vec3 position;
+		std::memcpy(&position, vertex, sizeof(glm::vec3));
 
-	if (!freeList.empty()) {
-		index = freeList.back();
-		freeList.pop_back();
-	} else {
-		index = static_cast<uint32_t>(slots.size());
-		slots.emplace_back();
+		bounds.min = glm::min(bounds.min, position);
+		bounds.max = glm::max(bounds.max, position);
 	}
 
-	Slot& slot = slots[index];
-	slot.mesh = std::move(mesh);
+	return bounds;
+}
 
-	return MeshHandle{ index, slot.generation };
+MeshSystem::MeshSystem(VulkanDevice& device, UploadSystem& uploads, DeletionQueue& deletions, bool useArena)
+	: device(device), uploads(uploads), deletions(deletions)
+{
+	if (useArena)
+		arena = std::make_unique<GeometryArena>(device);
+}
+
+MeshSystem::~MeshSystem() {
 }
 
 const Mesh& MeshSystem::get(MeshHandle handle) const {
-	assert(handle.index < slots.size());
+	return *meshes.get(handle);
+}
 
-	const Slot& slot = slots[handle.index];
+bool MeshSystem::isResident(MeshHandle handle) const {
+	const std::unique_ptr<Mesh>* mesh = meshes.find(handle);
+	return mesh && uploads.isComplete((*mesh)->uploadValue);
+}
 
-	assert(slot.mesh && "MeshHandle refers to destroyed mesh");
-	assert(slot.generation == handle.generation && "MeshHandle generation mismatch");
+const Mesh* MeshSystem::getByIndex(uint32_t index) const {
+	if (!meshes.isAlive(index))
+		return nullptr;
 
-	return *slot.mesh;
+	const Mesh* mesh = meshes.at(index).get();
+	return uploads.isComplete(mesh->uploadValue) ? mesh : nullptr;
 }
 
 void MeshSystem::destroy(MeshHandle handle) {
-	uint32_t index = handle.index;
-	if (index == INVALID_MESH.index)
-		return;
-	assert(index < slots.size());
-
-	Slot& slot = slots[index];
-	if (slot.generation != handle.generation)
+	if (!meshes.contains(handle))
 		return;
 
-	pendingDeletes.push_back(index);
+	// frames already recorded may still draw the mesh, the slot is only queued for deletion once they retire
+	deletions.retire([this, handle]() { meshes.destroy(handle); });
 }
 
 void MeshSystem::flushDeletes() {
-	for (uint32_t index : pendingDeletes) {
-		Slot& slot = slots[index];
-
-		if (!slot.mesh) continue;
-		slot.mesh.reset();
-		++slot.generation;
-		freeList.push_back(index);
-	}
-	pendingDeletes.clear();
+	// meshes still being written by the transfer queue wait for their upload before retiring
+	meshes.flushDeletes([&](uint32_t, std::unique_ptr<Mesh>& mesh) {
+		if (!uploads.isComplete(mesh->uploadValue))
+			return false;
+
+		if (mesh->isArenaResident())
+			arena->release(mesh->range);
+		else
+			dedicatedMeshCount--;
+		return true;
+	});
 }
 
-MeshHandle MeshSystem::createMesh(VulkanCommandBuffer& cmd, const MeshDesc& desc) {
+MeshHandle MeshSystem::createMesh(const MeshDesc& desc) {
 	if (!desc.p_vertexData || !desc.p_indexData || desc.vertexCount == 0 || desc.indexCount == 0)
 		return INVALID_MESH; 
 
 	uint64_t vertexBufferSize = desc.vertexCount * desc.vertexSize;
 	uint64_t indexBufferSize = desc.indexCount * sizeof(uint32_t);
 
-	BufferDesc stagingVertexDesc{};
-	stagingVertexDesc.size = vertexBufferSize;
-	stagingVertexDesc.memoryFlags.set(MemoryProperty::HostVisible, MemoryProperty::HostCoherent);
-	stagingVertexDesc.usageFlags = BufferUsage::TransferSource;
+	std::unique_ptr<Mesh> mesh;
+	uint64_t uploadValue;
 
-	VulkanBuffer stagingVertex(device, stagingVertexDesc);
-	stagingVertex.upload(desc.p_vertexData, vertexBufferSize);
+	GeometryRange range;
+	if (arena && arena->allocate(vertexBufferSize, static_cast<uint32_t>(desc.vertexSize), indexBufferSize, range)) {
+		uploads.uploadBuffer(arena->getVertexBuffer(), range.vertexByteOffset, desc.p_vertexData, vertexBufferSize);
+		uploadValue = uploads.uploadBuffer(arena->getIndexBuffer(), range.indexByteOffset, desc.p_indexData, indexBufferSize);
 
-	BufferDesc stagingIndexDesc{};
-	stagingIndexDesc.size = indexBufferSize;
-	stagingIndexDesc.memoryFlags.set(MemoryProperty::HostVisible, MemoryProperty::HostCoherent);
-	stagingIndexDesc.usageFlags = BufferUsage::TransferSource;
-
-	VulkanBuffer stagingIndex(device, stagingIndexDesc);
-	stagingIndex.upload(desc.p_vertexData, indexBufferSize);
-
-	BufferDesc vertexDesc{};
-	vertexDesc.size = vertexBufferSize;
-	vertexDesc.memoryFlags = MemoryProperty::DeviceLocal;
-	vertexDesc.usageFlags.set(BufferUsage::TransferDestination, BufferUsage::Vertex);
+		mesh.reset(new Mesh(*arena, range, desc.indexCount));
+	} else {
+		BufferDesc vertexDesc{};
+		vertexDesc.size = vertexBufferSize;
+		vertexDesc.memoryFlags = MemoryProperty::DeviceLocal;
+		vertexDesc.usageFlags.set(BufferUsage::TransferDestination, BufferUsage::Vertex);
 
-	VulkanBuffer vertexBuffer(device, vertexDesc);
+		auto vertexBuffer = std::make_unique<VulkanBuffer>(device, vertexDesc);
 
-	BufferDesc indexDesc{};
-	indexDesc.size = indexBufferSize;
-	indexDesc.memoryFlags = MemoryProperty::DeviceLocal;
-	indexDesc.usageFlags.set(BufferUsage::TransferDestination, BufferUsage::Index);
+		BufferDesc indexDesc{};
+		indexDesc.size = indexBufferSize;
+		indexDesc.memoryFlags = MemoryProperty::DeviceLocal;
+		indexDesc.usageFlags.set(BufferUsage::TransferDestination, BufferUsage::Index);
 
-	VulkanBuffer indexBuffer(device, indexDesc);
+		auto indexBuffer = std::make_unique<VulkanBuffer>(device, indexDesc);
 
-	vertexBuffer.copyFrom(cmd, stagingVertex, vertexBufferSize);
-	indexBuffer.copyFrom(cmd, stagingIndex, indexBufferSize);
+		uploads.uploadBuffer(*vertexBuffer, 0, desc.p_vertexData, vertexBufferSize);
+		uploadValue = uploads.uploadBuffer(*indexBuffer, 0, desc.p_indexData, indexBufferSize);
 
-	auto mesh = std::make_unique<Mesh>(vertexBuffer, indexBuffer, desc.indexCount);
+		mesh.reset(new Mesh(std::move(vertexBuffer), std::move(indexBuffer), desc.indexCount));
+		dedicatedMeshCount++;
+	}
+	mesh->bounds = computeBounds(desc);
+	mesh->uploadValue = uploadValue;
 
-	return allocateSlot(std::move(mesh));
+	return meshes.insert(std::move(mesh));
 }
\ No newline at end of file
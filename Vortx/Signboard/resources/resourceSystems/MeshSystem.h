@@ -1,40 +1,46 @@
 #pragma once
 
 #include "Signboard/resources/common/MeshSystemTypes.h"
+#include "primitive/GeometryArena.h"
+#include "primitive/SlotTable.h"
 
 #include <vector>
 #include <memory>
 
 class Mesh;
+class UploadSystem;
+class DeletionQueue;
 
 class VulkanDevice;
-class VulkanCommandBuffer;
 
 class MeshSystem {
 public:
-	explicit MeshSystem(VulkanDevice& device);
+	MeshSystem(VulkanDevice& device, UploadSystem& uploads, DeletionQueue& deletions, bool useArena = true);
 	~MeshSystem();	
 
-	MeshHandle createMesh(VulkanCommandBuffer& cmd, const MeshDesc& desc);
+	MeshHandle createMesh(const MeshDesc& desc);
 	const Mesh& get(MeshHandle handle) const;
+	bool isResident(MeshHandle handle) const;
+
+	// null for free slots and for meshes whose upload has not completed yet
+	uint32_t getSlotCount() const { return meshes.getSlotCount(); }
+	const Mesh* getByIndex(uint32_t index) const;
+
+	const GeometryArena* getArena() const { return arena.get(); }
+	bool allArenaResident() const { return arena && dedicatedMeshCount == 0; }
+	GeometryArenaStats getArenaStats() const { return arena ? arena->getStats() : GeometryArenaStats{}; }
 
 	void destroy(MeshHandle handle);
 	void flushDeletes();
 
-private:
-	MeshHandle allocateSlot(std::unique_ptr<Mesh> mesh);
-
 private:
 	VulkanDevice& device;
+	UploadSystem& uploads;
+	DeletionQueue& deletions;
 
-	struct Slot	{
-		std::unique_ptr<Mesh> mesh;
-		uint32_t generation = 0;
-	};
-
-	std::vector<Slot> slots;
-	std::vector<uint32_t> freeList;
+	SlotTable<std::unique_ptr<Mesh>, MeshHandle> meshes;
 
-	std::vector<uint32_t> pendingDeletes;
+	std::unique_ptr<GeometryArena> arena;
+	uint32_t dedicatedMeshCount = 0;
 
 };
\ No newline at end of file
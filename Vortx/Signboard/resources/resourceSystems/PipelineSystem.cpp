@@ -1,113 +1,730 @@
 #include "PipelineSystem.h"
 
+#include "Signboard/RHI/vulkan/VulkanDevice.h"
 #include "Signboard/RHI/vulkan/VulkanPipeline.h"
 #include "Signboard/RHI/vulkan/VulkanPipelineLayout.h"
 #include "Signboard/RHI/vulkan/VulkanPipelineCache.h"
 
 #include "Signboard/RHI/vulkan/VulkanRenderPass.h"
+#include "Signboard/RHI/vulkan/VulkanShaderModule.h"
 
 #include"ResourceHash/PipelineHash.h"
+#include "DeletionQueue.h"
 
-#include <cassert>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
 
-PipelineSystem::PipelineSystem(VulkanDevice& device) 
-	: device(device), cache(device)
+static constexpr std::chrono::seconds CACHE_SAVE_INTERVAL{ 60 };
+
+static float elapsedMs(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static std::vector<const VulkanShaderModule*> moduleList(const std::vector<std::shared_ptr<VulkanShaderModule>>& modules) {
+	std::vector<const VulkanShaderModule*> list;
+	list.reserve(modules.size());
+	for (const auto& module : modules)
+		list.push_back(module.get());
+
+	return list;
+}
+
+static std::string describe(const std::exception_ptr& error) {
+	try {
+		std::rethrow_exception(error);
+	}
+	catch (const std::exception& e) {
+		return e.what();
+	}
+	catch (...) {
+		return "unknown error";
+	}
+}
+
+PipelineSystem::PipelineSystem(VulkanDevice& device, DeletionQueue& deletions, std::string cachePath)
+	: device(device), deletions(deletions), cache(device), shaders(device), cachePath(std::move(cachePath))
 {
+	auto start = std::chrono::steady_clock::now();
+	if (!this->cachePath.empty())
+		stats.cacheLoaded = cache.loadFromDisk(this->cachePath.c_str());
+
+	stats.cacheLoadMs = elapsedMs(start);
+	lastCacheSave = std::chrono::steady_clock::now();
 
+	useLibraries = device.supportsPipelineLibrary();
+	fastLinking = device.supportsPipelineLibraryFastLinking();
 }
 
 PipelineSystem::~PipelineSystem() {
-	slots.clear();
-	freeList.clear();
+	stopWorkers();
+	finishCacheSave(true);
+
+	if (cacheDirty)
+		saveCache();
 }
 
-PipelineHandle PipelineSystem::getOrCreatePipleine(VulkanPipelineLayout& layout, const PipelineDesc& desc, const VulkanRenderPass& renderPass) {
+PipelineHandle PipelineSystem::getOrCreatePipleine(VulkanPipelineLayout& layout, const PipelineDesc& desc, const VulkanRenderPass& renderPass, PipelineHandle fallback) {
+	auto start = std::chrono::steady_clock::now();
 	PipelineKey key = makeKey(layout, desc, renderPass);
 
 	auto it = pipelineLookup.find(key);
 	if (it != pipelineLookup.end())
-		return PipelineHandle{ it->second, slots[it->second].generation };
+		return pipelines.getHandle(it->second);
 
-	auto pipeline = std::make_unique<VulkanPipeline>(device, cache);
-	pipeline->build(renderPass, layout, desc);
+	CompileJob job = makeJob(layout, &renderPass, desc);
 
-	PipelineHandle handle = allocateSlot(std::move(pipeline), key);
+	// with every part compiled already the request only needs a link, which is cheaper than the frames a
+	// fallback would stand in for
+	bool linkOnly = job.useLibraries && std::all_of(job.parts.begin(), job.parts.end(), [](const auto& part) { return part != nullptr; });
+
+	// a fallback still compiling itself has nothing to stand in with, the request is then built in place
+	const PipelineSlot* fallbackSlot = asyncCompilation && !linkOnly ? pipelines.find(fallback) : nullptr;
+	if (fallbackSlot && fallbackSlot->pipeline) {
+		PipelineHandle handle = pipelines.insert(PipelineSlot{ nullptr, key, fallback });
+		pipelineLookup.emplace(key, handle.index);
+		pipelines.get(fallback).fallbackUsers++;
+
+		// nothing waits on a background build, so it links optimised straight away
+		job.handle = handle;
+		job.fallback = fallback;
+		job.optimize = true;
+		queue(std::move(job));
+
+		stats.asyncQueued++;
+		recordRequest(elapsedMs(start), false);
+		return handle;
+	}
+
+	// the fast link is only worth it when a worker relinks it optimised later and the driver links fast
+	job.optimize = !asyncCompilation || !fastLinking;
+	compile(job, cache);
+	if (job.error)
+		std::rethrow_exception(job.error);
+
+	adoptParts(job);
+
+	PipelineHandle handle = pipelines.insert(PipelineSlot{ std::move(job.pipeline), key });
 	pipelineLookup.emplace(key, handle.index);
+	cacheDirty = true;
 
+	if (job.useLibraries && job.optimize) {
+		stats.optimizedLinks++;
+	}
+	else if (job.useLibraries) {
+		stats.fastLinks++;
+		stats.lastFastLinkMs = job.linkMs;
+		queueOptimizedLink(handle, job);
+	}
+
+	recordRequest(elapsedMs(start), true);
 	return handle;
 }
 
-PipelineHandle PipelineSystem::allocateSlot(std::unique_ptr<VulkanPipeline> pipeline, const PipelineKey& key) {
-	uint32_t index;
+PipelineHandle PipelineSystem::getOrCreateComputePipeline(VulkanPipelineLayout& layout, const PipelineDesc& desc) {
+	auto start = std::chrono::steady_clock::now();
+	PipelineKey key = makeKey(layout, desc);
+
+	auto it = pipelineLookup.find(key);
+	if (it != pipelineLookup.end())
+		return pipelines.getHandle(it->second);
+
+	CompileJob job = makeJob(layout, nullptr, desc);
+	compile(job, cache);
+	if (job.error)
+		std::rethrow_exception(job.error);
+
+	PipelineHandle handle = pipelines.insert(PipelineSlot{ std::move(job.pipeline), key });
+	pipelineLookup.emplace(key, handle.index);
+	cacheDirty = true;
+
+	recordRequest(elapsedMs(start), true);
+	return handle;
+}
+
+std::vector<PipelineHandle> PipelineSystem::prewarm(const std::vector<PipelineManifestEntry>& manifest, uint32_t threadCount) {
+	auto start = std::chrono::steady_clock::now();
+
+	std::vector<PipelineHandle> handles;
+	handles.reserve(manifest.size());
+
+	// slots are claimed up front so duplicates within the manifest share one build
+	std::vector<CompileJob> jobs;
+	for (const PipelineManifestEntry& entry : manifest) {
+		PipelineKey key = entry.renderPass ? makeKey(*entry.layout, entry.desc, *entry.renderPass) : makeKey(*entry.layout, entry.desc);
+
+		auto it = pipelineLookup.find(key);
+		if (it != pipelineLookup.end()) {
+			handles.push_back(pipelines.getHandle(it->second));
+			continue;
+		}
+
+		CompileJob job = makeJob(*entry.layout, entry.renderPass, entry.desc);
+		job.handle = pipelines.insert(PipelineSlot{ nullptr, key });
+
+		pipelineLookup.emplace(key, job.handle.index);
+		handles.push_back(job.handle);
+		jobs.push_back(std::move(job));
+	}
+
+	// library parts shared within the manifest are built once, by the first job that needs them
+	std::unordered_map<uint64_t, size_t> partOwners;
+	std::vector<std::pair<size_t, uint32_t>> partBuilds;
+	for (size_t i = 0; i < jobs.size(); i++) {
+		jobs[i].optimize = true;
+		if (!jobs[i].useLibraries)
+			continue;
+
+		for (uint32_t part = 0; part < PIPELINE_LIBRARY_PART_COUNT; part++)
+			if (!jobs[i].parts[part] && partOwners.emplace(jobs[i].partKeys[part], partBuilds.size()).second)
+				partBuilds.emplace_back(i, part);
+	}
+
+	if (threadCount == 0)
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	threadCount = std::max(1u, std::min(threadCount, static_cast<uint32_t>(std::max(jobs.size(), partBuilds.size()))));
+
+	// the calling thread builds into the shared cache, every other thread into its own copy of it so the
+	// threads never contend on one cache. the copies are merged back once all builds are done
+	std::vector<std::unique_ptr<VulkanPipelineCache>> threadCaches;
+	std::vector<const VulkanPipelineCache*> mergeSources;
+	for (uint32_t i = 1; i < threadCount; i++) {
+		threadCaches.push_back(std::make_unique<VulkanPipelineCache>(device));
+		threadCaches.back()->merge({ &cache });
+		mergeSources.push_back(threadCaches.back().get());
+	}
+
+	auto parallel = [&](size_t count, const std::function<void(size_t, VulkanPipelineCache&)>& work) {
+		std::atomic<size_t> next{ 0 };
+		auto run = [&](VulkanPipelineCache* target) {
+			for (size_t i = next++; i < count; i = next++)
+				work(i, *target);
+		};
+
+		std::vector<std::thread> threads;
+		for (auto& threadCache : threadCaches)
+			threads.emplace_back(run, threadCache.get());
+		run(&cache);
+
+		for (auto& thread : threads)
+			thread.join();
+	};
+
+	// parts first, then every pipeline links from them. two parts of one job may build at once, so part errors
+	// are kept per build and only handed to the jobs afterwards
+	std::vector<std::exception_ptr> partErrors(partBuilds.size());
+	parallel(partBuilds.size(), [&](size_t i, VulkanPipelineCache& target) {
+		try {
+			buildPart(jobs[partBuilds[i].first], partBuilds[i].second, target);
+		}
+		catch (...) {
+			partErrors[i] = std::current_exception();
+		}
+	});
+
+	for (CompileJob& job : jobs) {
+		if (!job.useLibraries)
+			continue;
+
+		for (uint32_t part = 0; part < PIPELINE_LIBRARY_PART_COUNT; part++) {
+			if (job.parts[part])
+				continue;
 
-	if (!freeList.empty()) {
-		index = freeList.back();
-		freeList.pop_back();
-	} else {
-		index = static_cast<uint32_t>(slots.size());
-		slots.emplace_back();
+			size_t owner = partOwners.at(job.partKeys[part]);
+			job.parts[part] = jobs[partBuilds[owner].first].parts[partBuilds[owner].second];
+			if (!job.parts[part])
+				job.error = partErrors[owner];
+		}
 	}
 
-	PipelineSlot& slot = slots[index];
-	slot.pipeline = std::move(pipeline);
-	slot.key = key;
-	slot.generation++;
+	parallel(jobs.size(), [&](size_t i, VulkanPipelineCache& target) {
+		if (!jobs[i].error)
+			compile(jobs[i], target);
+	});
 
-	return PipelineHandle{ index, slot.generation };
+	cache.merge(mergeSources);
+
+	std::exception_ptr error;
+	for (CompileJob& job : jobs) {
+		if (job.error) {
+			if (!error)
+				error = job.error;
+
+			pipelineLookup.erase(pipelines.get(job.handle).key);
+			pipelines.erase(job.handle);
+			continue;
+		}
+		adoptParts(job);
+		pipelines.get(job.handle).pipeline = std::move(job.pipeline);
+		cacheDirty = true;
+
+		if (job.useLibraries)
+			stats.optimizedLinks++;
+	}
+
+	stats.prewarmed += static_cast<uint32_t>(jobs.size());
+	stats.prewarmThreads = threadCount;
+	stats.prewarmMs = elapsedMs(start);
+
+	if (error)
+		std::rethrow_exception(error);
+
+	return handles;
 }
 
-const VulkanPipeline& PipelineSystem::get(PipelineHandle handle) const {
-	assert(handle.index < slots.size());
+void PipelineSystem::setAsyncCompilation(bool enable, uint32_t workerCount) {
+	if (enable) {
+		asyncCompilation = true;
+		if (!workers.empty())
+			return;
+
+		// each worker builds into its own copy of the shared cache, saveCache merges them back
+		shuttingDown = false;
+		workerCaches.clear();
+		for (uint32_t i = 0; i < std::max(1u, workerCount); i++) {
+			workerCaches.push_back(std::make_unique<VulkanPipelineCache>(device));
+			workerCaches.back()->merge({ &cache });
+		}
+
+		for (uint32_t i = 0; i < workerCaches.size(); i++)
+			workers.emplace_back(&PipelineSystem::compileLoop, this, i);
+		return;
+	}
+
+	stopWorkers();
 
-	const PipelineSlot& slot = slots[handle.index];
-	assert(slot.pipeline);
-	assert(slot.generation == handle.generation);
-	
-	return *slot.pipeline;
+	// whatever was still queued is built here so no slot is left on its fallback
+	for (CompileJob& job : queuedJobs) {
+		compile(job, cache);
+		finishedJobs.push_back(std::move(job));
+	}
+	queuedJobs.clear();
+
+	std::vector<const VulkanPipelineCache*> sources;
+	for (auto& workerCache : workerCaches)
+		sources.push_back(workerCache.get());
+	cache.merge(sources);
+	workerCaches.clear();
+
+	asyncCompilation = false;
 }
 
-void PipelineSystem::destroy(PipelineHandle handle) {
-	uint32_t index = handle.index;
-	if (index >= slots.size())
+void PipelineSystem::collectCompiled() {
+	std::vector<CompileJob> finished;
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+		finished.swap(finishedJobs);
+	}
+
+	for (CompileJob& job : finished) {
+		stats.pending--;
+
+		PipelineSlot* slot = pipelines.find(job.handle);
+
+		// a failed slot stays on its fallback, or its fast link for a relink, so the fallback has to stay alive
+		// with it. the frame goes on drawing with what the slot already resolves to
+		if (job.error) {
+			stats.asyncFailures++;
+			stats.lastAsyncFailure = describe(job.error);
+			if (slot)
+				continue;
+		}
+		else if (slot) {
+			adoptParts(job);
+
+			// an optimised relink replaces the fast linked pipeline, which frames in flight may still have bound
+			if (slot->pipeline) {
+				std::shared_ptr<VulkanPipeline> linked = std::move(slot->pipeline);
+				deletions.retire([linked]() mutable { linked.reset(); });
+			}
+
+			slot->pipeline = std::move(job.pipeline);
+			slot->fallback = INVALID_PIPELINE;
+			cacheDirty = true;
+
+			if (job.useLibraries)
+				stats.optimizedLinks++;
+			stats.asyncCompiled++;
+			stats.lastCompileMs = job.compileMs;
+		}
+
+		// destroyed while compiling, the pipeline was never bound and goes with the job. relinks have no fallback
+		if (PipelineSlot* fallbackSlot = pipelines.find(job.fallback))
+			fallbackSlot->fallbackUsers--;
+	}
+
+	stats.frameRequestMs = 0.0f;
+
+	// periodic saves keep a crash from losing a whole session's builds, and cost nothing while none happen
+	finishCacheSave(false);
+	if (cacheDirty && std::chrono::steady_clock::now() - lastCacheSave >= CACHE_SAVE_INTERVAL)
+		startCacheSave();
+}
+
+bool PipelineSystem::saveCache() {
+	finishCacheSave(true);
+
+	lastCacheSave = std::chrono::steady_clock::now();
+	if (cachePath.empty())
+		return false;
+
+	auto start = std::chrono::steady_clock::now();
+
+	std::vector<const VulkanPipelineCache*> sources;
+	for (auto& workerCache : workerCaches)
+		sources.push_back(workerCache.get());
+
+	// persisting is best effort, a read-only or full disk must not take the renderer down
+	try {
+		cache.merge(sources);
+		stats.cacheBytes = cache.saveToDisk(cachePath.c_str());
+	}
+	catch (const std::runtime_error&) {
+		stats.cacheSaveFailures++;
+		return false;
+	}
+
+	cacheDirty = false;
+	stats.cacheSaves++;
+	stats.lastCacheSaveMs = elapsedMs(start);
+	return true;
+}
+
+void PipelineSystem::startCacheSave() {
+	lastCacheSave = std::chrono::steady_clock::now();
+
+	// a save still writing takes this interval's builds with it next time
+	if (cachePath.empty() || cacheSaver.joinable())
+		return;
+
+	auto start = std::chrono::steady_clock::now();
+
+	// reading the data is all the render thread does, the workers may keep building into their caches meanwhile
+	std::vector<std::vector<uint8_t>> snapshots;
+	try {
+		snapshots.push_back(cache.getData());
+		for (auto& workerCache : workerCaches)
+			snapshots.push_back(workerCache->getData());
+	}
+	catch (const std::runtime_error&) {
+		stats.cacheSaveFailures++;
+		return;
+	}
+
+	cacheDirty = false;
+	stats.lastCacheSnapshotMs = elapsedMs(start);
+
+	cacheSaveDone = false;
+	cacheSaver = std::thread(&PipelineSystem::writeCacheSnapshots, this, std::move(snapshots));
+}
+
+void PipelineSystem::finishCacheSave(bool wait) {
+	if (!cacheSaver.joinable() || (!wait && !cacheSaveDone))
 		return;
 
-	if (slots[index].generation != handle.generation)
+	cacheSaver.join();
+
+	// the snapshot's builds are still unsaved, the next interval tries again
+	if (!cacheSaveResult.saved) {
+		stats.cacheSaveFailures++;
+		cacheDirty = true;
 		return;
+	}
+
+	stats.cacheSaves++;
+	stats.cacheBytes = cacheSaveResult.bytes;
+	stats.lastCacheSaveMs = cacheSaveResult.ms;
+}
+
+void PipelineSystem::writeCacheSnapshots(std::vector<std::vector<uint8_t>> snapshots) {
+	auto start = std::chrono::steady_clock::now();
+	CacheSaveResult result;
+
+	// the snapshots are merged into a cache of their own, the shared one is left to the render thread
+	try {
+		VulkanPipelineCache merged(device, snapshots.front());
+
+		std::vector<std::unique_ptr<VulkanPipelineCache>> parts;
+		std::vector<const VulkanPipelineCache*> sources;
+		for (size_t i = 1; i < snapshots.size(); i++) {
+			parts.push_back(std::make_unique<VulkanPipelineCache>(device, snapshots[i]));
+			sources.push_back(parts.back().get());
+		}
+		merged.merge(sources);
+
+		result.bytes = VulkanPipelineCache::writeToDisk(cachePath.c_str(), merged.getData());
+		result.saved = true;
+	}
+	catch (const std::runtime_error&) {
+		result.saved = false;
+	}
+
+	result.ms = elapsedMs(start);
+	cacheSaveResult = result;
+	cacheSaveDone = true;
+}
+
+uint32_t PipelineSystem::reloadShaders() {
+	return shaders.refresh();
+}
+
+PipelineSystem::CompileJob PipelineSystem::makeJob(VulkanPipelineLayout& layout, const VulkanRenderPass* renderPass, const PipelineDesc& desc) {
+	CompileJob job;
+	job.layout = &layout;
+	job.renderPass = renderPass;
+	job.desc = desc;
+
+	// the job keeps its modules alive, a reload meanwhile only swaps the library's entries
+	job.modules.reserve(desc.shaders.size());
+	for (const ShaderDesc& shader : desc.shaders)
+		job.modules.push_back(shaders.get(shader.path).module);
+
+	// compute pipelines have no parts to share and are always built whole
+	if (useLibraries && renderPass) {
+		job.useLibraries = true;
+		job.partKeys = makePartKeys(layout, desc, *renderPass);
 
-	pendingDeletes.push_back(index);
+		for (uint32_t part = 0; part < PIPELINE_LIBRARY_PART_COUNT; part++) {
+			auto it = libraryParts.find(job.partKeys[part]);
+			if (it != libraryParts.end())
+				job.parts[part] = it->second;
+		}
+	}
+
+	return job;
+}
+
+void PipelineSystem::compile(CompileJob& job, VulkanPipelineCache& target) {
+	auto start = std::chrono::steady_clock::now();
+
+	try {
+		if (job.modules.empty())
+			throw std::runtime_error("pipeline must have atleast one shader!");
+
+		if (job.useLibraries) {
+			for (uint32_t part = 0; part < PIPELINE_LIBRARY_PART_COUNT; part++)
+				if (!job.parts[part])
+					buildPart(job, part, target);
+
+			auto linkStart = std::chrono::steady_clock::now();
+
+			std::vector<const VulkanPipeline*> libraries;
+			for (const auto& part : job.parts)
+				libraries.push_back(part.get());
+
+			job.pipeline = std::make_unique<VulkanPipeline>(device, target);
+			job.pipeline->link(*job.layout, libraries, job.optimize);
+			job.linkMs = elapsedMs(linkStart);
+		}
+		else if (job.renderPass) {
+			job.pipeline = std::make_unique<VulkanPipeline>(device, target);
+			job.pipeline->build(*job.renderPass, *job.layout, job.desc, moduleList(job.modules));
+		}
+		else {
+			job.pipeline = std::make_unique<VulkanPipeline>(device, target);
+			job.pipeline->buildCompute(*job.layout, job.desc, *job.modules[0]);
+		}
+	}
+	catch (...) {
+		job.error = std::current_exception();
+	}
+
+	job.compileMs = elapsedMs(start);
+}
+
+void PipelineSystem::buildPart(CompileJob& job, uint32_t part, VulkanPipelineCache& target) {
+	auto library = std::make_shared<VulkanPipeline>(device, target);
+	library->buildLibrary(static_cast<PipelineLibraryPart>(part), *job.renderPass, *job.layout, job.desc, moduleList(job.modules));
+
+	job.parts[part] = std::move(library);
+}
+
+void PipelineSystem::adoptParts(const CompileJob& job) {
+	if (!job.useLibraries)
+		return;
+
+	// two jobs may have built the same part, the first one to finish is the one kept
+	for (uint32_t part = 0; part < PIPELINE_LIBRARY_PART_COUNT; part++)
+		if (job.parts[part] && libraryParts.emplace(job.partKeys[part], job.parts[part]).second)
+			stats.libraryParts++;
+}
+
+void PipelineSystem::queueOptimizedLink(PipelineHandle handle, const CompileJob& job) {
+	CompileJob relink;
+	relink.handle = handle;
+	relink.layout = job.layout;
+	relink.renderPass = job.renderPass;
+	relink.desc = job.desc;
+	relink.modules = job.modules;
+
+	relink.useLibraries = true;
+	relink.optimize = true;
+	relink.partKeys = job.partKeys;
+	relink.parts = job.parts;
+
+	queue(std::move(relink));
+}
+
+void PipelineSystem::queue(CompileJob job) {
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+		queuedJobs.push_back(std::move(job));
+	}
+	jobReady.notify_one();
+
+	stats.pending++;
+}
+
+void PipelineSystem::compileLoop(uint32_t worker) {
+	while (true) {
+		CompileJob job;
+		{
+			std::unique_lock<std::mutex> lock(jobMutex);
+			jobReady.wait(lock, [&] { return shuttingDown || !queuedJobs.empty(); });
+			if (shuttingDown)
+				return;
+
+			job = std::move(queuedJobs.front());
+			queuedJobs.pop_front();
+		}
+
+		compile(job, *workerCaches[worker]);
+
+		std::lock_guard<std::mutex> lock(jobMutex);
+		finishedJobs.push_back(std::move(job));
+	}
+}
+
+void PipelineSystem::stopWorkers() {
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+		shuttingDown = true;
+	}
+	jobReady.notify_all();
+
+	for (auto& worker : workers)
+		if (worker.joinable()) worker.join();
+	workers.clear();
+}
+
+void PipelineSystem::recordRequest(float ms, bool built) {
+	if (built)
+		stats.syncBuilds++;
+
+	stats.frameRequestMs += ms;
+	stats.worstFrameRequestMs = std::max(stats.worstFrameRequestMs, stats.frameRequestMs);
+}
+
+const VulkanPipeline& PipelineSystem::get(PipelineHandle handle) const {
+	const PipelineSlot& slot = pipelines.get(handle);
+	if (slot.pipeline)
+		return *slot.pipeline;
+
+	return *pipelines.get(slot.fallback).pipeline;
+}
+
+bool PipelineSystem::isReady(PipelineHandle handle) const {
+	const PipelineSlot* slot = pipelines.find(handle);
+	return slot && slot->pipeline;
+}
+
+void PipelineSystem::destroy(PipelineHandle handle) {
+	if (!pipelines.contains(handle))
+		return;
+
+	// command buffers still in flight may have the pipeline bound
+	deletions.retire([this, handle]() { pipelines.destroy(handle); });
 }
 
 void PipelineSystem::flushDeletes() {
-	for (uint32_t index : pendingDeletes) {
-		PipelineSlot& slot = slots[index];
+	pipelines.flushDeletes([&](uint32_t, PipelineSlot& slot) {
+		// pending pipelines still resolve to it
+		if (slot.fallbackUsers)
+			return false;
 
-		if (!slot.pipeline) continue;
 		pipelineLookup.erase(slot.key);
-		slot.pipeline.reset();
-		slot.generation++;
-		freeList.push_back(index);
-	}
-	pendingDeletes.clear();
+		return true;
+	});
 }
 
 PipelineKey PipelineSystem::makeKey(VulkanPipelineLayout& layout, const PipelineDesc& desc, const VulkanRenderPass& renderPass) {
-	PipelineKey key{};
+	PipelineKey key = makeKey(layout, desc);
 
-	key.type = desc.type;
-
-	key.layout = layout.getHandle();
 	key.renderPass = renderPass.getHandle();
 
 	key.colorFormat = desc.colorFormat;
 	key.depthForamt = desc.depthForamt;
 
-	key.shadersHashes.reserve(desc.shaders.size());
-	for (const ShaderDesc& shader : desc.shaders) {
-		key.shadersHashes.push_back(hashShaderFile(shader.path));
-	}
-
 	key.raster = desc.raster;
 	key.blend = desc.blend;
 
 	return key;
+}
+
+PipelineKey PipelineSystem::makeKey(VulkanPipelineLayout& layout, const PipelineDesc& desc) {
+	if (desc.shaders.size() > MAX_PIPELINE_SHADERS)
+		throw std::runtime_error("pipeline has more shaders than a key can hold!");
+
+	PipelineKey key{};
+
+	key.type = desc.type;
+	key.layout = layout.getHandle();
+
+	// loaded shaders resolve from the library, so only a shader's first use reads the disk
+	key.shaderCount = static_cast<uint32_t>(desc.shaders.size());
+	for (uint32_t i = 0; i < key.shaderCount; i++)
+		key.shadersHashes[i] = shaders.get(desc.shaders[i].path).hash;
+
+	return key;
+}
+
+std::array<uint64_t, PIPELINE_LIBRARY_PART_COUNT> PipelineSystem::makePartKeys(VulkanPipelineLayout& layout, const PipelineDesc& desc, const VulkanRenderPass& renderPass) {
+	std::array<size_t, PIPELINE_LIBRARY_PART_COUNT> seeds{};
+	for (uint32_t part = 0; part < PIPELINE_LIBRARY_PART_COUNT; part++)
+		hashCombine(seeds[part], part);
+
+	size_t& vertexInput = seeds[static_cast<uint32_t>(PipelineLibraryPart::VertexInput)];
+	size_t& preRasterization = seeds[static_cast<uint32_t>(PipelineLibraryPart::PreRasterization)];
+	size_t& fragmentShader = seeds[static_cast<uint32_t>(PipelineLibraryPart::FragmentShader)];
+	size_t& fragmentOutput = seeds[static_cast<uint32_t>(PipelineLibraryPart::FragmentOutput)];
+
+	for (const VertexBindingDesc& binding : desc.vertexLayout.bindings) {
+		hashCombine(vertexInput, binding.binding);
+		hashCombine(vertexInput, binding.stride);
+		hashCombine(vertexInput, binding.perinstance);
+	}
+	for (const VertexAttributeDesc& attribute : desc.vertexLayout.attributes) {
+		hashCombine(vertexInput, attribute.location);
+		hashCombine(vertexInput, attribute.format);
+		hashCombine(vertexInput, attribute.offset);
+	}
+
+	// the shader parts are compiled against the layout and the pass they run in
+	for (size_t* seed : { &preRasterization, &fragmentShader }) {
+		hashCombine(*seed, layout.getHandle());
+		hashCombine(*seed, renderPass.getHandle());
+	}
+
+	for (const ShaderDesc& shader : desc.shaders) {
+		size_t& seed = shader.stage == ShaderStageBit::FragmentBit ? fragmentShader : preRasterization;
+		hashCombine(seed, shader.stage);
+		hashCombine(seed, shaders.get(shader.path).hash);
+	}
+
+	hashCombine(fragmentShader, desc.samples);
+	hashCombine(fragmentShader, desc.raster.depthTest);
+	hashCombine(fragmentShader, desc.raster.depthWrite);
+
+	hashCombine(fragmentOutput, renderPass.getHandle());
+	hashCombine(fragmentOutput, desc.samples);
+	hashCombine(fragmentOutput, desc.colorFormat);
+	hashCombine(fragmentOutput, desc.depthForamt);
+	hashCombine(fragmentOutput, desc.blend.enable);
+
+	std::array<uint64_t, PIPELINE_LIBRARY_PART_COUNT> keys{};
+	for (uint32_t part = 0; part < PIPELINE_LIBRARY_PART_COUNT; part++)
+		keys[part] = seeds[part];
+
+	return keys;
 }
\ No newline at end of file
@@ -3,52 +3,215 @@
 #include "Signboard/resources/common/PipelineSystemTypes.h"
 #include "Signboard/RHI/common/PipelineTypes.h"
 #include "ResourceHash/PipelineHash.h"
+#include "primitive/SlotTable.h"
+#include "ShaderLibrary.h"
 
 #include "Signboard/RHI/vulkan/VulkanPipelineCache.h"
 
+#include <array>
 #include <memory>
 #include <unordered_map>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <string>
+#include <chrono>
 
 class VulkanDevice;
 class VulkanPipelineLayout;
 class VulkanPipeline;
 class VulkanRenderPass;
+class VulkanShaderModule;
 
 class VulkanPipelineCache;
-
+class DeletionQueue;
+
+// one pipeline known ahead of use, renderPass stays null for compute pipelines
+struct PipelineManifestEntry {
+	VulkanPipelineLayout* layout = nullptr;
+	const VulkanRenderPass* renderPass = nullptr;
+	PipelineDesc desc;
+};
+
+struct PipelineSystemStats {
+	uint32_t prewarmed = 0;
+	uint32_t prewarmThreads = 0;
+	float prewarmMs = 0.0f;
+
+	// misses built on the calling thread and misses handed to the background workers
+	uint32_t syncBuilds = 0;
+	uint32_t asyncQueued = 0;
+	uint32_t asyncCompiled = 0;
+	uint32_t pending = 0;
+
+	// background builds and optimised relinks that threw, their slots keep the fallback or the fast link
+	uint32_t asyncFailures = 0;
+	std::string lastAsyncFailure;
+
+	// calling thread time spent on misses since the last collectCompiled, i.e. the hitch a frame that meets a
+	// new material pays, and the worst such frame so far
+	float frameRequestMs = 0.0f;
+	float worstFrameRequestMs = 0.0f;
+	float lastCompileMs = 0.0f;
+
+	// the on-disk cache, loaded at construction and written back periodically and at shutdown
+	bool cacheLoaded = false;
+	float cacheLoadMs = 0.0f;
+	uint32_t cacheSaves = 0;
+	uint32_t cacheSaveFailures = 0;
+	size_t cacheBytes = 0;
+	float lastCacheSaveMs = 0.0f;
+
+	// what a periodic save costs the render thread, its merge and write run on a thread of their own
+	float lastCacheSnapshotMs = 0.0f;
+
+	// graphics pipeline library parts compiled so far, and pipelines linked from them on demand and relinked
+	// optimised in the background
+	uint32_t libraryParts = 0;
+	uint32_t fastLinks = 0;
+	uint32_t optimizedLinks = 0;
+	float lastFastLinkMs = 0.0f;
+};
+
+// pipelines are deduplicated by key and built into one shared cache. a manifest can be prewarmed across worker
+// threads at startup, and with async compilation a graphics miss that names a ready fallback returns at once:
+// get() resolves the handle to the fallback until collectCompiled swaps the finished pipeline in.
+// the cache is loaded from cachePath when the file matches this driver and device, an empty path disables
+// persistence.
+// with VK_EXT_graphics_pipeline_library graphics pipelines are linked from separately cached parts, so a miss
+// whose parts are all known costs a fast link on the calling thread, and the workers relink it optimised.
+// without the extension every graphics pipeline is built whole.
 class PipelineSystem {
 public:
-	explicit PipelineSystem(VulkanDevice& device);
+	PipelineSystem(VulkanDevice& device, DeletionQueue& deletions, std::string cachePath = "pipeline_cache.bin");
 	~PipelineSystem();
 
-	PipelineHandle getOrCreatePipleine(VulkanPipelineLayout& layout, const PipelineDesc& desc, const VulkanRenderPass& renderPass);
+	// the fallback is only used with async compilation enabled, without it the miss builds in place
+	PipelineHandle getOrCreatePipleine(VulkanPipelineLayout& layout, const PipelineDesc& desc, const VulkanRenderPass& renderPass, PipelineHandle fallback = INVALID_PIPELINE);
+	PipelineHandle getOrCreateComputePipeline(VulkanPipelineLayout& layout, const PipelineDesc& desc);
+
+	// builds every entry not already known on up to threadCount threads, handles come back in manifest order
+	std::vector<PipelineHandle> prewarm(const std::vector<PipelineManifestEntry>& manifest, uint32_t threadCount = 0);
+
+	// layouts and render passes of queued requests must outlive their compilation
+	void setAsyncCompilation(bool enable, uint32_t workerCount = 1);
+
+	// once per frame on the render thread, before anything resolves handles for recording. also snapshots the
+	// caches for a background save once new pipelines have been built and the save interval has passed. failed
+	// background builds and saves are counted in the stats rather than thrown
+	void collectCompiled();
+
+	// merges the worker caches into the shared one and writes it out on the calling thread, after any
+	// background save has finished. false when nothing could be written
+	bool saveCache();
+
+	// reloads shader files changed on disk, later requests using them get new keys and so new pipelines
+	uint32_t reloadShaders();
 
 	const VulkanPipeline& get(PipelineHandle handle) const;
+	bool isReady(PipelineHandle handle) const;
 
 	void destroy(PipelineHandle handle);
 	void flushDeletes();
 
+	const PipelineSystemStats& getStats() const { return stats; }
+	const ShaderLibrary& getShaders() const { return shaders; }
+
 private:
-	PipelineHandle allocateSlot(std::unique_ptr<VulkanPipeline> pipeline, const PipelineKey& key);
+	struct CompileJob {
+		PipelineHandle handle = INVALID_PIPELINE;
+		PipelineHandle fallback = INVALID_PIPELINE;
+		VulkanPipelineLayout* layout = nullptr;
+		const VulkanRenderPass* renderPass = nullptr;
+		PipelineDesc desc;
+		std::vector<std::shared_ptr<VulkanShaderModule>> modules;
+
+		// library jobs build the parts still null and link them, optimised or fast
+		bool useLibraries = false;
+		bool optimize = false;
+		std::array<uint64_t, PIPELINE_LIBRARY_PART_COUNT> partKeys{};
+		std::array<std::shared_ptr<VulkanPipeline>, PIPELINE_LIBRARY_PART_COUNT> parts;
+
+		std::unique_ptr<VulkanPipeline> pipeline;
+		std::exception_ptr error;
+		float compileMs = 0.0f;
+		float linkMs = 0.0f;
+	};
 
 	PipelineKey makeKey(VulkanPipelineLayout& layout, const PipelineDesc& desc, const VulkanRenderPass& renderPass);
+	PipelineKey makeKey(VulkanPipelineLayout& layout, const PipelineDesc& desc);
+	std::array<uint64_t, PIPELINE_LIBRARY_PART_COUNT> makePartKeys(VulkanPipelineLayout& layout, const PipelineDesc& desc, const VulkanRenderPass& renderPass);
+
+	CompileJob makeJob(VulkanPipelineLayout& layout, const VulkanRenderPass* renderPass, const PipelineDesc& desc);
+	void compile(CompileJob& job, VulkanPipelineCache& target);
+	void buildPart(CompileJob& job, uint32_t part, VulkanPipelineCache& target);
+	void adoptParts(const CompileJob& job);
+	void queueOptimizedLink(PipelineHandle handle, const CompileJob& job);
+	void queue(CompileJob job);
+	void compileLoop(uint32_t worker);
+	void stopWorkers();
+
+	void startCacheSave();
+	void finishCacheSave(bool wait);
+	void writeCacheSnapshots(std::vector<std::vector<uint8_t>> snapshots);
+
+	void recordRequest(float ms, bool built);
 
 private:
 	VulkanDevice& device;
+	DeletionQueue& deletions;
 
 	VulkanPipelineCache cache;
+	ShaderLibrary shaders;
+
+	std::string cachePath;
+	bool cacheDirty = false;
+	std::chrono::steady_clock::time_point lastCacheSave;
+
+	// a periodic save runs here from snapshots of the caches, its outcome reaches the stats once it is joined
+	struct CacheSaveResult {
+		bool saved = false;
+		size_t bytes = 0;
+		float ms = 0.0f;
+	};
+
+	std::thread cacheSaver;
+	std::atomic<bool> cacheSaveDone{ false };
+	CacheSaveResult cacheSaveResult;
 
+	// pipeline stays null while a background compile is pending, get() then resolves to the fallback,
+	// which is kept alive for as long as fallbackUsers pending slots point at it
 	struct PipelineSlot {
 		std::unique_ptr<VulkanPipeline> pipeline;
 		PipelineKey key;
-		uint32_t generation = 0;
+
+		PipelineHandle fallback = INVALID_PIPELINE;
+		uint32_t fallbackUsers = 0;
 	};
 
-	std::vector<PipelineSlot> slots;
-	std::vector<uint32_t> freeList;
+	SlotTable<PipelineSlot, PipelineHandle> pipelines;
 
 	std::unordered_map<PipelineKey, uint32_t, PipelineKeyHash> pipelineLookup;
 
-	std::vector<uint32_t> pendingDeletes;
+	// library parts by part key, shared by every pipeline that links them and never bound themselves
+	bool useLibraries = false;
+	bool fastLinking = false;
+	std::unordered_map<uint64_t, std::shared_ptr<VulkanPipeline>> libraryParts;
+
+	// background compilation, the workers only touch jobs, slots are written on the render thread alone
+	bool asyncCompilation = false;
+
+	std::vector<std::thread> workers;
+	std::vector<std::unique_ptr<VulkanPipelineCache>> workerCaches;
+	std::mutex jobMutex;
+	std::condition_variable jobReady;
+	std::deque<CompileJob> queuedJobs;
+	std::vector<CompileJob> finishedJobs;
+	bool shuttingDown = false;
 
+	PipelineSystemStats stats;
 };
\ No newline at end of file
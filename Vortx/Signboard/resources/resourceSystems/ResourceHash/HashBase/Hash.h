@@ -1,6 +1,8 @@
 #pragma once
 
 #include <functional>
+#include <cstdint>
+#include <cstring>
 
 template<typename T>
 inline void hashCombine(std::size_t& seed, const T& v) {
@@ -23,5 +25,101 @@ inline uint64_t fnv1a64(const void* data, size_t size) {
 		hash *= 1099511628211ULL;
 	}
 
+	return hash;
+}
+
+// xxh64, four 64-bit lanes over 32 byte stripes. several times the throughput of the byte wise fnv above,
+// meant for bulk content such as spir-v
+namespace hashDetail {
+	constexpr uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+	constexpr uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+	constexpr uint64_t PRIME3 = 0x165667B19E3779F9ULL;
+	constexpr uint64_t PRIME4 = 0x85EBCA77C2B2AE63ULL;
+	constexpr uint64_t PRIME5 = 0x27D4EB2F165667C5ULL;
+
+	inline uint64_t rotl(uint64_t value, int bits) {
+		return (value << bits) | (value >> (64 - bits));
+	}
+
+	inline uint64_t read64(const uint8_t* p) {
+		uint64_t value;
+		std::memcpy(&value, p, sizeof(value));
+		return value;
+	}
+
+	inline uint32_t read32(const uint8_t* p) {
+		uint32_t value;
+		std::memcpy(&value, p, sizeof(value));
+		return value;
+	}
+
+	inline uint64_t round(uint64_t acc, uint64_t input) {
+		acc += input * PRIME2;
+		acc = rotl(acc, 31);
+		return acc * PRIME1;
+	}
+
+	inline uint64_t mergeRound(uint64_t acc, uint64_t lane) {
+		acc ^= round(0, lane);
+		return acc * PRIME1 + PRIME4;
+	}
+}
+
+inline uint64_t xxhash64(const void* data, size_t size, uint64_t seed = 0) {
+	using namespace hashDetail;
+
+	const uint8_t* p = static_cast<const uint8_t*>(data);
+	const uint8_t* end = p + size;
+
+	uint64_t hash;
+	if (size >= 32) {
+		uint64_t v1 = seed + PRIME1 + PRIME2;
+		uint64_t v2 = seed + PRIME2;
+		uint64_t v3 = seed;
+		uint64_t v4 = seed - PRIME1;
+
+		const uint8_t* limit = end - 32;
+		do {
+			v1 = round(v1, read64(p));
+			v2 = round(v2, read64(p + 8));
+			v3 = round(v3, read64(p + 16));
+			v4 = round(v4, read64(p + 24));
+			p += 32;
+		} while (p <= limit);
+
+		hash = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+		hash = mergeRound(hash, v1);
+		hash = mergeRound(hash, v2);
+		hash = mergeRound(hash, v3);
+		hash = mergeRound(hash, v4);
+	}
+	else {
+		hash = seed + PRIME5;
+	}
+
+	hash += static_cast<uint64_t>(size);
+
+	for (; p + 8 <= end; p += 8) {
+		hash ^= round(0, read64(p));
+		hash = rotl(hash, 27) * PRIME1 + PRIME4;
+	}
+
+	if (p + 4 <= end) {
+		hash ^= static_cast<uint64_t>(read32(p)) * PRIME1;
+		hash = rotl(hash, 23) * PRIME2 + PRIME3;
+		p += 4;
+	}
+
+	for (; p < end; p++) {
+		hash ^= static_cast<uint64_t>(*p) * PRIME5;
+		hash = rotl(hash, 11) * PRIME1;
+	}
+
+	hash ^= hash >> 33;
+	hash *= PRIME2;
+	hash ^= hash >> 29;
+	hash *= PRIME3;
+	hash ^= hash >> 32;
+
 	return hash;
 }
\ No newline at end of file
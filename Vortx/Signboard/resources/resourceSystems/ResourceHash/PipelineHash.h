@@ -3,6 +3,12 @@
 #include "Signboard/RHI/common/PipelineTypes.h"
 #include "HashBase/Hash.h"
 
+#include <array>
+
+// vertex, tessellation control and evaluation, geometry and fragment
+constexpr uint32_t MAX_PIPELINE_SHADERS = 5;
+
+// fixed size so building a key for a lookup never allocates
 struct PipelineKey {
 	PipelineType type;
 
@@ -12,7 +18,8 @@ struct PipelineKey {
 	ImageFormat colorFormat;
 	ImageFormat depthForamt;
 
-	std::vector<uint64_t> shadersHashes;
+	std::array<uint64_t, MAX_PIPELINE_SHADERS> shadersHashes{};
+	uint32_t shaderCount = 0;
 
 	RasterState raster;
 	BlendState blend;
@@ -23,6 +30,7 @@ struct PipelineKey {
 			renderPass == rhs.renderPass &&
 			colorFormat == rhs.colorFormat &&
 			depthForamt == rhs.depthForamt &&
+			shaderCount == rhs.shaderCount &&
 			shadersHashes == rhs.shadersHashes &&
 			raster.depthTest == rhs.raster.depthTest &&
 			raster.depthWrite == rhs.raster.depthWrite &&
@@ -30,13 +38,7 @@ struct PipelineKey {
 	}
 };
 
-struct PipelineKeyHash {
-	size_t operator()(const PipelineKey& key) const {
-		return hashPipelineKey(key);
-	}
-};
-
-size_t hashPipelineKey(const PipelineKey& key) {
+inline size_t hashPipelineKey(const PipelineKey& key) {
 	size_t hash = 0;
 	hashCombine(hash, key.type);
 	hashCombine(hash, key.layout);
@@ -44,16 +46,17 @@ size_t hashPipelineKey(const PipelineKey& key) {
 	hashCombine(hash, key.colorFormat);
 	hashCombine(hash, key.depthForamt);
 
-	hashCombineRange(hash, key.shadersHashes.data(), key.shadersHashes.size());
+	hashCombineRange(hash, key.shadersHashes.data(), key.shaderCount);
 
-	hashCombine(hash, key.raster);
-	hashCombine(hash, key.blend);
+	hashCombine(hash, key.raster.depthTest);
+	hashCombine(hash, key.raster.depthWrite);
+	hashCombine(hash, key.blend.enable);
 
 	return hash;
 }
 
-uint64_t hashShaderFile(const std::string& path) {
-	auto bytes = readBinaryFile(path.c_str());
-
-	return fnv1a64(bytes.data(), bytes.size());
-}
\ No newline at end of file
+struct PipelineKeyHash {
+	size_t operator()(const PipelineKey& key) const {
+		return hashPipelineKey(key);
+	}
+};
\ No newline at end of file
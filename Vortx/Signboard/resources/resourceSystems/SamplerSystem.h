@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Signboard/resources/common/SamplerSystemTypes.h"
+#include "primitive/SlotTable.h"
 
 #include <vector>
 #include <memory>
@@ -9,10 +10,12 @@ class VulkanDevice;
 class VulkanSampler;
 
 class VulkanDescriptorSet;
+class DescriptorUpdateQueue;
+class DeletionQueue;
 
 class SamplerSystem{
 public:
-	explicit SamplerSystem(VulkanDevice& device, VulkanDescriptorSet& samplerSet, uint32_t samplerBindingIndex, uint32_t maxSampelrCount);
+	explicit SamplerSystem(VulkanDevice& device, DescriptorUpdateQueue& descriptorUpdates, DeletionQueue& deletions, VulkanDescriptorSet& samplerSet, uint32_t samplerBindingIndex, uint32_t maxSampelrCount);
 	~SamplerSystem();
 
 	SamplerHandle createSampler(const SamplerDesc& desc);
@@ -25,25 +28,17 @@ private:
 	void writeSamplerDescriptor(const SamplerHandle handle);
 	void clearSamplerDescriptor(const SamplerHandle handle);
 
-	SamplerHandle allocateSlot(std::unique_ptr<VulkanSampler> sampler);
-
 private:
 	VulkanDevice& device;
+	DescriptorUpdateQueue& descriptorUpdates;
+	DeletionQueue& deletions;
 
 	VulkanDescriptorSet& samplerSet;
 
 	uint32_t samplerBindingIndex;
 	uint32_t maxSamplerCount;
 
-	struct Slot {
-		std::unique_ptr<VulkanSampler> sampler;
-		uint32_t generation;
-	};
-
-	std::vector<Slot> slots;
-	std::vector<uint32_t> freeList;
-
-	std::vector<uint32_t> pendingDeletes;
+	SlotTable<std::unique_ptr<VulkanSampler>, SamplerHandle> samplers;
 
 };
 
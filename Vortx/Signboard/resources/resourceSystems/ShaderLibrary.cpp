@@ -0,0 +1,96 @@
+#include "ShaderLibrary.h"
+
+#include "Signboard/RHI/vulkan/VulkanShaderModule.h"
+
+#include "ResourceHash/HashBase/Hash.h"
+
+#include <fstream>
+#include <vector>
+#include <stdexcept>
+
+static std::vector<uint32_t> readSPIRV(const std::string& path) {
+	std::ifstream file(path, std::ios::ate | std::ios::binary);
+	if (!file.is_open())
+		throw std::runtime_error("failed to open file!" + path);
+
+	size_t size = static_cast<size_t>(file.tellg());
+	if (size % 4 != 0)
+		throw std::runtime_error("SPIR-V file size is not a mutiple of 4: " + path);
+
+	std::vector<uint32_t> buffer(size / 4);
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(buffer.data()), size);
+
+	return buffer;
+}
+
+static uint64_t hashSPIRV(const std::vector<uint32_t>& spirv) {
+	return xxhash64(spirv.data(), spirv.size() * sizeof(uint32_t));
+}
+
+ShaderLibrary::ShaderLibrary(VulkanDevice& device)
+	: device(device)
+{
+
+}
+
+ShaderLibrary::~ShaderLibrary() {
+}
+
+const ShaderEntry& ShaderLibrary::get(const std::string& path) {
+	auto it = shaders.find(path);
+	if (it != shaders.end())
+		return it->second;
+
+	return shaders.emplace(path, load(path)).first->second;
+}
+
+uint32_t ShaderLibrary::refresh() {
+	uint32_t reloaded = 0;
+
+	for (auto& [path, entry] : shaders) {
+		std::error_code error;
+		auto modified = std::filesystem::last_write_time(path, error);
+		if (error || modified == entry.modified)
+			continue;
+
+		// a file caught halfway through being rewritten keeps its module until the next refresh
+		std::vector<uint32_t> spirv;
+		try {
+			spirv = readSPIRV(path);
+		}
+		catch (const std::runtime_error&) {
+			continue;
+		}
+
+		// touched but unchanged files keep their module, and with it every pipeline key that uses them
+		uint64_t hash = hashSPIRV(spirv);
+		if (hash != entry.hash) {
+			entry.module = std::make_shared<VulkanShaderModule>(device, spirv.data(), spirv.size());
+			entry.hash = hash;
+			reloaded++;
+		}
+		entry.modified = modified;
+	}
+
+	stats.reloads += reloaded;
+	return reloaded;
+}
+
+ShaderEntry ShaderLibrary::load(const std::string& path) {
+	// the time is taken first, a write landing during the read then shows up on the next refresh
+	std::error_code error;
+	auto modified = std::filesystem::last_write_time(path, error);
+
+	std::vector<uint32_t> spirv = readSPIRV(path);
+
+	ShaderEntry entry;
+	entry.hash = hashSPIRV(spirv);
+	entry.module = std::make_shared<VulkanShaderModule>(device, spirv.data(), spirv.size());
+	entry.modified = modified;
+
+	stats.loads++;
+	stats.bytesLoaded += spirv.size() * sizeof(uint32_t);
+
+	return entry;
+}
\ No newline at end of file
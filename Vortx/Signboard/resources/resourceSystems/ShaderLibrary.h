@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <filesystem>
+#include <unordered_map>
+
+class VulkanDevice;
+class VulkanShaderModule;
+
+struct ShaderEntry {
+	uint64_t hash = 0;
+	std::shared_ptr<VulkanShaderModule> module;
+	std::filesystem::file_time_type modified{};
+};
+
+struct ShaderLibraryStats {
+	uint32_t loads = 0;
+	uint32_t reloads = 0;
+	uint64_t bytesLoaded = 0;
+};
+
+// every spir-v file is read, hashed and turned into a module once. later lookups are a single map probe on the
+// path, without touching the disk. refresh compares the modification times of the loaded files and reloads the
+// changed ones, pipelines then pick the new module up through the new content hash in their key.
+// pending builds hold their own reference, so a reload never pulls a module from under a compiling pipeline.
+class ShaderLibrary {
+public:
+	explicit ShaderLibrary(VulkanDevice& device);
+	~ShaderLibrary();
+
+	ShaderLibrary(const ShaderLibrary&) = delete;
+	ShaderLibrary& operator=(const ShaderLibrary&) = delete;
+
+	// loads the file on first use, the entry stays valid until the library goes away
+	const ShaderEntry& get(const std::string& path);
+
+	// returns the number of modules replaced
+	uint32_t refresh();
+
+	size_t getShaderCount() const { return shaders.size(); }
+	const ShaderLibraryStats& getStats() const { return stats; }
+
+private:
+	ShaderEntry load(const std::string& path);
+
+private:
+	VulkanDevice& device;
+
+	std::unordered_map<std::string, ShaderEntry> shaders;
+
+	ShaderLibraryStats stats;
+};
\ No newline at end of file
@@ -1,38 +1,44 @@
 #include "TextureSystem.h"
 
 #include "primitive/Texture.h"
+#include "UploadSystem.h"
+#include "DescriptorUpdateQueue.h"
+#include "DeletionQueue.h"
 
-#include "Signboard/RHI/vulkan/VulkanBuffer.h"
 #include "Signboard/RHI/vulkan/VulkanImage.h"
 
 #include "Signboard/RHI/vulkan/VulkanDescriptorSet.h"
-#include "Signboard/RHI/vulkan/VulkanDescriptorWriter.h"
 
 #include <stdexcept>
-#include <cassert>
 
-TextureSystem::TextureSystem(VulkanDevice& device, VulkanDescriptorSet& textureSet, uint32_t textureBindingIndex, uint32_t maxTextureCount)
-	: device(device), textureSet(textureSet), textureBindingIndex(textureBindingIndex), maxTextureCount(maxTextureCount) {}
+TextureSystem::TextureSystem(VulkanDevice& device, UploadSystem& uploads, DescriptorUpdateQueue& descriptorUpdates, DeletionQueue& deletions, VulkanDescriptorSet& textureSet, uint32_t textureBindingIndex, uint32_t maxTextureCount)
+	: device(device), uploads(uploads), descriptorUpdates(descriptorUpdates), deletions(deletions), textureSet(textureSet), textureBindingIndex(textureBindingIndex), maxTextureCount(maxTextureCount), textures(maxTextureCount) {}
 
 TextureSystem::~TextureSystem() {
-	slots.clear();
-	freeList.clear();
 }
 
-TextureHandle TextureSystem::createTexture(VulkanCommandBuffer& cmd, const TextureDesc& desc) {
-	if (slots.size() >= maxTextureCount) {
-		throw std::runtime_error("Out of bindless texture slots");
-	}
+void TextureSystem::createFallback() {
+	if (textures.contains(fallback))
+		return;
 
-	uint64_t pixelBufferSize = desc.pixelCount * desc.pixelSize;
+	const uint32_t white = 0xFFFFFFFF;
 
-	BufferDesc stagingPixelDesc{};
-	stagingPixelDesc.size = pixelBufferSize;
-	stagingPixelDesc.memoryFlags.set(MemoryProperty::HostVisible, MemoryProperty::HostCoherent);
-	stagingPixelDesc.usageFlags = BufferUsage::TransferSource;
+	TextureDesc desc{};
+	desc.p_pixelData = &white;
+	desc.pixelSize = sizeof(white);
+	desc.pixelCount = 1;
+	desc.width = 1;
+	desc.height = 1;
+	desc.format = ImageFormat::RGBA8;
+	desc.usage = ImageUsage::Sampled;
 
-	VulkanBuffer stagingPixel(device, stagingPixelDesc);
-	stagingPixel.upload(desc.p_pixelData, pixelBufferSize);
+	fallback = createTexture(desc);
+}
+
+TextureHandle TextureSystem::createTexture(const TextureDesc& desc) {
+	if (textures.isFull()) {
+		throw std::runtime_error("Out of bindless texture slots");
+	}
 
 	ImageDesc imageDesc{};
 	imageDesc.width = desc.width;
@@ -40,88 +46,87 @@ TextureHandle TextureSystem::createTexture(VulkanCommandBuffer& cmd, const Textu
 	imageDesc.format = desc.format;
 	imageDesc.usage = desc.usage;
 
-	VulkanImage textureImage(device, imageDesc);
+	auto textureImage = std::make_unique<VulkanImage>(device, imageDesc);
 
-	textureImage.copyFromBuffer(cmd, stagingPixel);
-	textureImage.transitionLayout(cmd, ImageLayout::ShaderReadOnly, PipelineStage::Transfer, PipelineStage::FragmentShader);
+	uint64_t uploadValue = uploads.uploadImage(*textureImage, desc.p_pixelData, static_cast<uint32_t>(desc.width * desc.pixelSize), static_cast<uint32_t>(desc.pixelSize));
 
-	auto texture = std::make_unique<Texture>(textureImage);
+	std::unique_ptr<Texture> texture(new Texture(std::move(textureImage)));
+	texture->uploadValue = uploadValue;
 
-	TextureHandle handle =  assignSlot(std::move(texture));
+	Texture& tex = *texture;
+	TextureHandle handle = textures.insert(std::move(texture));
 
-	const Texture& tex = get(handle);
-	writeTextureDescriptor(tex);
+	tex.bindlessIndex = handle.index;
+
+	// the image is not readable before the frame that acquires its upload, until then the slot samples the fallback
+	pendingDescriptors.push_back({ handle });
 
 	return handle;
 }
 
-void TextureSystem::writeTextureDescriptor(const Texture& texture) {
-	VulkanDescriptorWriter writer(device, textureSet);
-
-	writer.writeSampledImage(textureBindingIndex, texture.bindlessIndex, &texture.getImage());
-	writer.commit();
-}
+void TextureSystem::writePendingDescriptors() {
+	const std::unique_ptr<Texture>* fallbackTexture = textures.find(fallback);
+	bool fallbackResident = fallbackTexture && uploads.isComplete((*fallbackTexture)->uploadValue);
 
-void TextureSystem::clearTextureDescriptor(const Texture& texture) {
-	VulkanDescriptorWriter writer(device, textureSet);
+	size_t kept = 0;
+	for (PendingDescriptor& pending : pendingDescriptors) {
+		// destroyed before its upload finished, flushDeletes already cleared the slot
+		const std::unique_ptr<Texture>* texture = textures.find(pending.handle);
+		if (!texture)
+			continue;
 
-	writer.writeSampledImage(textureBindingIndex, texture.bindlessIndex, nullptr);
-	writer.commit();
-}
+		if (uploads.isComplete((*texture)->uploadValue)) {
+			writeTextureDescriptor(**texture);
+			continue;
+		}
 
-TextureHandle TextureSystem::assignSlot(std::unique_ptr<Texture> texture) {
-	uint32_t index;
+		if (!pending.onFallback && fallbackResident) {
+			writeFallbackDescriptor(**texture);
+			pending.onFallback = true;
+		}
 
-	if (!freeList.empty()) {
-		index = freeList.back();
-		freeList.pop_back();
-	}
-	else {
-		index = static_cast<uint32_t>(slots.size());
-		slots.emplace_back();
+		pendingDescriptors[kept++] = pending;
 	}
 
-	Slot& slot = slots[index];
-	slot.texture = std::move(texture);
-	slot.texture->bindlessIndex = index;
+	pendingDescriptors.resize(kept);
+}
 
-	return TextureHandle{ index, slot.generation };
+void TextureSystem::writeTextureDescriptor(const Texture& texture) {
+	descriptorUpdates.writeSampledImage(textureSet, textureBindingIndex, texture.bindlessIndex, &texture.getImage());
 }
 
-const Texture& TextureSystem::get(TextureHandle handle) const {
-	assert(handle.index < slots.size());
+void TextureSystem::writeFallbackDescriptor(const Texture& texture) {
+	descriptorUpdates.writeSampledImage(textureSet, textureBindingIndex, texture.bindlessIndex, &textures.get(fallback)->getImage());
+}
 
-	const Slot& slot = slots[handle.index];
+void TextureSystem::clearTextureDescriptor(const Texture& texture) {
+	descriptorUpdates.writeSampledImage(textureSet, textureBindingIndex, texture.bindlessIndex, nullptr);
+}
 
-	assert(slot.texture && "TextureHandle refers to destroyed texture!");
-	assert(slot.generation == handle.generation && "TextureHandle generation mismatch!");
+const Texture& TextureSystem::get(TextureHandle handle) const {
+	return *textures.get(handle);
+}
 
-	return *slot.texture;
+bool TextureSystem::isResident(TextureHandle handle) const {
+	const std::unique_ptr<Texture>* texture = textures.find(handle);
+	return texture && uploads.isComplete((*texture)->uploadValue);
 }
 
 void TextureSystem::destroy(TextureHandle handle) {
-	uint32_t index = handle.index;
-	if (index == INVALID_TEXTURE.index)
-		return;
-	assert(index < slots.size());
-
-	Slot& slot = slots[index];
-	if (slot.generation != handle.generation)
+	if (!textures.contains(handle))
 		return;
 
-	pendingDeletes.push_back(index);
+	// in-flight frames may still sample the slot, so neither the image nor the bindless index is reused before they retire
+	deletions.retire([this, handle]() { textures.destroy(handle); });
 }
 
 void TextureSystem::flushDeletes() {
-	for (uint32_t index : pendingDeletes) {
-		Slot& slot = slots[index];
-
-		if (!slot.texture) continue;
-		clearTextureDescriptor(*slot.texture);
-		slot.texture.reset();
-		++slot.generation;
-		freeList.push_back(index);
-	}
-	pendingDeletes.clear();
+	// the upload still references the image until its ownership acquire is recorded
+	textures.flushDeletes([&](uint32_t, std::unique_ptr<Texture>& texture) {
+		if (!uploads.isComplete(texture->uploadValue))
+			return false;
+
+		clearTextureDescriptor(*texture);
+		return true;
+	});
 }
-
@@ -1,14 +1,17 @@
 #pragma once
 
 #include "Signboard/resources/common/TextureSystemType.h"
+#include "primitive/SlotTable.h"
 
 #include <vector>
 #include <memory>
 
 class Texture;
+class UploadSystem;
+class DescriptorUpdateQueue;
+class DeletionQueue;
 
 class VulkanDevice;
-class VulkanCommandBuffer;
 
 class VulkanDescriptorPool;
 class VulkanDescriptorSet;
@@ -16,37 +19,48 @@ class VulkanDescriptorSetLayout;
 
 class TextureSystem {
 public:
-	explicit TextureSystem(VulkanDevice& device, VulkanDescriptorSet& textureSet, uint32_t textureBindingIndex, uint32_t maxTextureCount);
+	explicit TextureSystem(VulkanDevice& device, UploadSystem& uploads, DescriptorUpdateQueue& descriptorUpdates, DeletionQueue& deletions, VulkanDescriptorSet& textureSet, uint32_t textureBindingIndex, uint32_t maxTextureCount);
 	~TextureSystem();
 
-	TextureHandle createTexture(VulkanCommandBuffer& cmd, const TextureDesc& desc);
+	// a 1x1 white texture that stands in for every texture whose upload has not been acquired yet
+	void createFallback();
+
+	TextureHandle createTexture(const TextureDesc& desc);
 	const Texture& get(TextureHandle texture) const;
+	bool isResident(TextureHandle texture) const;
+
+	// once per frame after the upload acquire: slots of finished uploads get their image, the rest the fallback
+	void writePendingDescriptors();
 
 	void destroy(TextureHandle texture);
 	void flushDeletes();
 
 private:
 	void writeTextureDescriptor(const Texture& texture);
+	void writeFallbackDescriptor(const Texture& texture);
 	void clearTextureDescriptor(const Texture& texture);
 
-	TextureHandle assignSlot(std::unique_ptr<Texture> texture);
-
 private:
 	VulkanDevice& device;
+	UploadSystem& uploads;
+	DescriptorUpdateQueue& descriptorUpdates;
+	DeletionQueue& deletions;
 
 	VulkanDescriptorSet& textureSet;
 
-	struct Slot {
-		std::unique_ptr<Texture> texture;
-		uint32_t generation;
-	};
-
 	uint32_t textureBindingIndex;
 	uint32_t maxTextureCount;
-		
-	std::vector<Slot> slots;
-	std::vector<uint32_t> freeList;
 
-	std::vector<uint32_t> pendingDeletes;
+	// slot index doubles as the bindless array index
+	SlotTable<std::unique_ptr<Texture>, TextureHandle> textures;
+
+	// textures whose slot does not show their own image yet, the descriptor is written once the upload is acquired
+	struct PendingDescriptor {
+		TextureHandle handle;
+		bool onFallback = false;
+	};
+	std::vector<PendingDescriptor> pendingDescriptors;
+
+	TextureHandle fallback = INVALID_TEXTURE;
 
 };
@@ -0,0 +1,61 @@
+#include "TransientUniformAllocator.h"
+
+#include "Signboard/RHI/vulkan/VulkanDevice.h"
+#include "Signboard/RHI/vulkan/VulkanBuffer.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+static uint64_t alignUp(uint64_t value, uint64_t alignment) {
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+TransientUniformAllocator::TransientUniformAllocator(VulkanDevice& device, uint32_t frameCount, uint64_t frameCapacity)
+	: alignment(device.getMinUniformBufferOffsetAlignment()),
+	  frameCapacity(alignUp(frameCapacity, device.getMinUniformBufferOffsetAlignment())),
+	  frameCount(frameCount)
+{
+	// dynamic offsets are 32 bit
+	if (this->frameCapacity * frameCount > UINT32_MAX)
+		throw std::runtime_error("transient uniform buffer exceeds dynamic offset range!");
+
+	BufferDesc desc{};
+	desc.size = this->frameCapacity * frameCount;
+	desc.usageFlags = BufferUsage::Uniform;
+	desc.memoryFlags.set(MemoryProperty::HostVisible, MemoryProperty::HostCoherent);
+
+	buffer = std::make_unique<VulkanBuffer>(device, desc);
+	mapped = static_cast<uint8_t*>(buffer->map());
+
+	stats.frameCapacity = this->frameCapacity;
+}
+
+TransientUniformAllocator::~TransientUniformAllocator() = default;
+
+void TransientUniformAllocator::reset(uint32_t frameIndex) {
+	if (frameIndex >= frameCount)
+		throw std::runtime_error("transient frame index out of range!");
+
+	frameBegin = frameCapacity * frameIndex;
+	head = frameBegin;
+
+	stats.usedBytes = 0;
+	stats.allocations = 0;
+}
+
+TransientAllocation TransientUniformAllocator::allocate(uint64_t size) {
+	uint64_t offset = alignUp(head, alignment);
+	if (offset + size > frameBegin + frameCapacity)
+		throw std::runtime_error("transient uniform allocator is out of space!");
+
+	head = offset + size;
+
+	stats.usedBytes = head - frameBegin;
+	stats.peakBytes = std::max(stats.peakBytes, stats.usedBytes);
+	stats.allocations++;
+
+	TransientAllocation allocation;
+	allocation.data = mapped + offset;
+	allocation.offset = static_cast<uint32_t>(offset);
+	return allocation;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+class VulkanDevice;
+class VulkanBuffer;
+
+struct TransientAllocation {
+	void* data = nullptr;
+	// passed as the dynamic offset when the set is bound
+	uint32_t offset = 0;
+};
+
+struct TransientUniformStats {
+	uint64_t frameCapacity = 0;
+	uint64_t usedBytes = 0;
+	uint64_t peakBytes = 0;
+	uint32_t allocations = 0;
+};
+
+// linear allocator for per-frame constants. one mapped uniform buffer is split into a region per frame in flight,
+// allocations bump through the current region and are addressed with dynamic offsets, so a single descriptor
+// covers every allocation and a frame's data is never overwritten while the gpu may still read it.
+class TransientUniformAllocator {
+public:
+	// matches the renderer's frames in flight
+	static constexpr uint32_t DEFAULT_FRAME_COUNT = 2;
+	static constexpr uint64_t DEFAULT_FRAME_CAPACITY = 1ull << 20;
+
+	explicit TransientUniformAllocator(VulkanDevice& device, uint32_t frameCount = DEFAULT_FRAME_COUNT, uint64_t frameCapacity = DEFAULT_FRAME_CAPACITY);
+	~TransientUniformAllocator();
+
+	TransientUniformAllocator(const TransientUniformAllocator&) = delete;
+	TransientUniformAllocator& operator=(const TransientUniformAllocator&) = delete;
+
+	// only once the frame's fence has been waited on
+	void reset(uint32_t frameIndex);
+
+	// a descriptor of range R reads R bytes from the offset, allocations bound through it need at least that size
+	TransientAllocation allocate(uint64_t size);
+
+	template<typename T>
+	uint32_t push(const T& value) {
+		TransientAllocation allocation = allocate(sizeof(T));
+		std::memcpy(allocation.data, &value, sizeof(T));
+		return allocation.offset;
+	}
+
+	const VulkanBuffer& getBuffer() const { return *buffer; }
+	uint64_t getAlignment() const { return alignment; }
+	const TransientUniformStats& getStats() const { return stats; }
+
+private:
+	std::unique_ptr<VulkanBuffer> buffer;
+	uint8_t* mapped = nullptr;
+
+	uint64_t alignment;
+	uint64_t frameCapacity;
+	uint32_t frameCount;
+
+	uint64_t frameBegin = 0;
+	uint64_t head = 0;
+
+	TransientUniformStats stats;
+};
@@ -0,0 +1,265 @@
+#include "UploadSystem.h"
+
+#include "Signboard/RHI/vulkan/VulkanDevice.h"
+#include "Signboard/RHI/vulkan/VulkanBuffer.h"
+#include "Signboard/RHI/vulkan/VulkanImage.h"
+#include "Signboard/RHI/vulkan/VulkanSemaphore.h"
+#include "Signboard/RHI/vulkan/VulkanCommandPool.h"
+#include "Signboard/RHI/vulkan/VulkanCommandBuffer.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+static constexpr uint64_t COPY_ALIGNMENT = 16;
+
+static ResourceAccessFlags geometryReadAccess() {
+	ResourceAccessFlags access;
+	access.set(ResourceAccess::VertexAttributeRead, ResourceAccess::IndexRead, ResourceAccess::ShaderRead, ResourceAccess::IndirectCommandRead);
+	return access;
+}
+
+static PipelineStageFlags geometryReadStages() {
+	PipelineStageFlags stages;
+	stages.set(PipelineStage::VertexInput, PipelineStage::VertexShader, PipelineStage::ComputeShader, PipelineStage::DrawIndirect);
+	return stages;
+}
+
+UploadSystem::UploadSystem(VulkanDevice& device, uint64_t stagingCapacity)
+	: device(device),
+	  transferFamily(device.getTransferQueueFamily()),
+	  graphicsFamily(device.getGraphicsQueueFamily()),
+	  ownershipTransfer(device.hasDedicatedTransferQueue()),
+	  ring(device, stagingCapacity),
+	  maxUploadSize(stagingCapacity / 2)
+{
+	timeline = std::make_unique<VulkanSemaphore>(device, SemaphoreType::Timeline, 0);
+	commandPool = std::make_unique<VulkanCommandPool>(device, transferFamily);
+
+	batches.resize(MAX_BATCHES);
+	for (Batch& batch : batches)
+		batch.cmd = std::make_unique<VulkanCommandBuffer>(device, *commandPool);
+
+	stats.stagingCapacity = stagingCapacity;
+	stats.dedicatedQueue = ownershipTransfer;
+}
+
+UploadSystem::~UploadSystem() {
+	submit();
+	if (submittedValue)
+		timeline->wait(submittedValue);
+}
+
+uint64_t UploadSystem::stage(uint64_t size, uint64_t alignment) {
+	uint64_t offset = ring.allocate(size, alignment);
+
+	// the ring is full: push out what is queued and wait for the oldest batch to hand its space back
+	while (offset == StagingRing::INVALID_OFFSET) {
+		submit();
+		if (completedValue == submittedValue)
+			throw std::runtime_error("upload exceeds staging ring capacity!");
+
+		timeline->wait(completedValue + 1);
+		retireCompleted(timeline->getCounterValue());
+
+		offset = ring.allocate(size, alignment);
+	}
+
+	stats.uploadedBytes += size;
+	return offset;
+}
+
+UploadSystem::Batch& UploadSystem::openBatch() {
+	if (openIndex != UINT32_MAX)
+		return batches[openIndex];
+
+	Batch& batch = batches[nextBatch];
+	if (batch.value > completedValue) {
+		timeline->wait(batch.value);
+		retireCompleted(timeline->getCounterValue());
+	}
+
+	batch.cmd->begin();
+
+	openIndex = nextBatch;
+	nextBatch = (nextBatch + 1) % MAX_BATCHES;
+	return batch;
+}
+
+uint64_t UploadSystem::uploadBuffer(const VulkanBuffer& dst, uint64_t dstOffset, const void* data, uint64_t size) {
+	if (size == 0)
+		return acquiredValue;
+
+	if (dstOffset + size > dst.getSize())
+		throw std::runtime_error("upload exceeds destination buffer!");
+
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+	// large uploads go through the ring in pieces so one transfer never owns all of it
+	uint64_t value = 0;
+	for (uint64_t done = 0; done < size; done += maxUploadSize) {
+		uint64_t chunk = std::min(maxUploadSize, size - done);
+
+		uint64_t offset = stage(chunk, COPY_ALIGNMENT);
+		ring.write(offset, bytes + done, chunk);
+
+		openBatch();
+
+		PendingCopy copy;
+		copy.dst = &dst;
+		copy.region.srcOffset = offset;
+		copy.region.dstOffset = dstOffset + done;
+		copy.region.size = chunk;
+		pendingCopies.push_back(copy);
+		pendingBytes += chunk;
+
+		value = submittedValue + 1;
+
+		if (pendingBytes >= ring.getCapacity() / 4)
+			submit();
+	}
+
+	return value;
+}
+
+uint64_t UploadSystem::uploadImage(VulkanImage& dst, const void* data, uint32_t rowBytes, uint32_t texelSize) {
+	uint32_t height = dst.getExtent().height;
+	uint32_t rowsPerChunk = static_cast<uint32_t>(maxUploadSize / rowBytes);
+	if (rowsPerChunk == 0)
+		throw std::runtime_error("image row exceeds staging ring capacity!");
+
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+	for (uint32_t row = 0; row < height; row += rowsPerChunk) {
+		uint32_t rows = std::min(rowsPerChunk, height - row);
+		uint64_t size = static_cast<uint64_t>(rows) * rowBytes;
+
+		// buffer offsets for image copies must be a multiple of both 4 and the texel size
+		uint64_t offset = stage(size, static_cast<uint64_t>(texelSize) * 4);
+		ring.write(offset, bytes + static_cast<uint64_t>(row) * rowBytes, size);
+
+		Batch& batch = openBatch();
+		dst.copyFromBuffer(*batch.cmd, ring.getBuffer(), offset, row, rows);
+		stats.copyCommands++;
+	}
+
+	Batch& batch = openBatch();
+	if (ownershipTransfer) {
+		dst.releaseOwnership(*batch.cmd, ImageLayout::ShaderReadOnly, transferFamily, graphicsFamily, PipelineStage::Transfer);
+		batch.imageAcquires.push_back(&dst);
+	} else {
+		dst.transitionLayout(*batch.cmd, ImageLayout::ShaderReadOnly, PipelineStage::Transfer, PipelineStage::FragmentShader);
+	}
+
+	return submittedValue + 1;
+}
+
+void UploadSystem::recordPendingCopies(Batch& batch) {
+	if (pendingCopies.empty())
+		return;
+
+	std::stable_sort(pendingCopies.begin(), pendingCopies.end(), [](const PendingCopy& a, const PendingCopy& b) {
+		return a.dst < b.dst;
+	});
+
+	std::vector<BufferCopyRegion> regions;
+	regions.reserve(pendingCopies.size());
+
+	for (size_t i = 0; i < pendingCopies.size();) {
+		const VulkanBuffer* dst = pendingCopies[i].dst;
+
+		regions.clear();
+		for (; i < pendingCopies.size() && pendingCopies[i].dst == dst; i++)
+			regions.push_back(pendingCopies[i].region);
+
+		batch.cmd->copyBuffer(ring.getBuffer(), *dst, regions.data(), static_cast<uint32_t>(regions.size()));
+		stats.copyRegions += static_cast<uint32_t>(regions.size());
+		stats.copyCommands++;
+	}
+
+	// on a shared family the timeline wait in the graphics submit already makes the writes visible
+	if (ownershipTransfer) {
+		std::vector<BufferBarrier> releases;
+		releases.reserve(pendingCopies.size());
+
+		for (const PendingCopy& copy : pendingCopies) {
+			BufferBarrier barrier;
+			barrier.buffer = copy.dst;
+			barrier.offset = copy.region.dstOffset;
+			barrier.size = copy.region.size;
+			barrier.srcQueueFamily = transferFamily;
+			barrier.dstQueueFamily = graphicsFamily;
+
+			barrier.srcAccess = ResourceAccess::TransferWrite;
+			releases.push_back(barrier);
+
+			barrier.srcAccess = ResourceAccess::None;
+			barrier.dstAccess = geometryReadAccess();
+			batch.bufferAcquires.push_back(barrier);
+		}
+
+		batch.cmd->bufferBarriers(releases.data(), static_cast<uint32_t>(releases.size()), PipelineStage::Transfer, PipelineStage::BottomOfPipe);
+	}
+
+	pendingCopies.clear();
+	pendingBytes = 0;
+}
+
+void UploadSystem::submit() {
+	if (openIndex == UINT32_MAX)
+		return;
+
+	Batch& batch = batches[openIndex];
+	recordPendingCopies(batch);
+
+	batch.cmd->end();
+	batch.value = ++submittedValue;
+	batch.ringMark = ring.getMark();
+	batch.cmd->submit(device.getTransferQueue(), *timeline, batch.value);
+
+	openIndex = UINT32_MAX;
+}
+
+void UploadSystem::retireCompleted(uint64_t completed) {
+	for (Batch& batch : batches) {
+		if (batch.value == 0 || batch.value > completed) continue;
+
+		readyBufferAcquires.insert(readyBufferAcquires.end(), batch.bufferAcquires.begin(), batch.bufferAcquires.end());
+		readyImageAcquires.insert(readyImageAcquires.end(), batch.imageAcquires.begin(), batch.imageAcquires.end());
+		batch.bufferAcquires.clear();
+		batch.imageAcquires.clear();
+
+		ring.release(batch.ringMark);
+		batch.value = 0;
+	}
+
+	completedValue = std::max(completedValue, completed);
+}
+
+uint64_t UploadSystem::acquire(VulkanCommandBuffer& cmd) {
+	retireCompleted(timeline->getCounterValue());
+
+	if (!readyBufferAcquires.empty()) {
+		cmd.bufferBarriers(readyBufferAcquires.data(), static_cast<uint32_t>(readyBufferAcquires.size()), PipelineStage::TopOfPipe, geometryReadStages());
+		readyBufferAcquires.clear();
+	}
+
+	for (VulkanImage* image : readyImageAcquires)
+		image->acquireOwnership(cmd, ImageLayout::TransferDst, transferFamily, graphicsFamily, PipelineStage::FragmentShader);
+	readyImageAcquires.clear();
+
+	acquiredValue = completedValue;
+	return acquiredValue;
+}
+
+UploadStats UploadSystem::getStats() const {
+	UploadStats result = stats;
+	result.stagingUsed = ring.getUsed();
+	result.submittedValue = submittedValue;
+	result.completedValue = completedValue;
+
+	for (const Batch& batch : batches) {
+		if (batch.value > completedValue)
+			result.batchesInFlight++;
+	}
+	return result;
+}
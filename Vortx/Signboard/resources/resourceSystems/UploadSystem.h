@@ -0,0 +1,106 @@
+#pragma once
+
+#include "primitive/StagingRing.h"
+#include "Signboard/RHI/common/BufferTypes.h"
+
+#include <vector>
+#include <memory>
+
+class VulkanBuffer;
+class VulkanImage;
+class VulkanDevice;
+class VulkanSemaphore;
+class VulkanCommandPool;
+class VulkanCommandBuffer;
+
+struct BufferBarrier;
+
+struct UploadStats {
+	uint64_t stagingCapacity = 0;
+	uint64_t stagingUsed = 0;
+
+	uint64_t uploadedBytes = 0;
+	uint64_t submittedValue = 0;
+	uint64_t completedValue = 0;
+
+	uint32_t batchesInFlight = 0;
+	uint32_t copyRegions = 0;
+	uint32_t copyCommands = 0;
+
+	bool dedicatedQueue = false;
+};
+
+class UploadSystem {
+public:
+	static constexpr uint64_t DEFAULT_STAGING_CAPACITY = 16ull << 20;
+	static constexpr uint32_t MAX_BATCHES = 4;
+
+	explicit UploadSystem(VulkanDevice& device, uint64_t stagingCapacity = DEFAULT_STAGING_CAPACITY);
+	~UploadSystem();
+
+	UploadSystem(const UploadSystem&) = delete;
+	UploadSystem& operator=(const UploadSystem&) = delete;
+
+	// both return the timeline value that marks the upload as complete
+	uint64_t uploadBuffer(const VulkanBuffer& dst, uint64_t dstOffset, const void* data, uint64_t size);
+	uint64_t uploadImage(VulkanImage& dst, const void* data, uint32_t rowBytes, uint32_t texelSize);
+
+	void submit();
+
+	// records queue ownership acquires for finished batches, returns the value the graphics submit has to wait on
+	uint64_t acquire(VulkanCommandBuffer& cmd);
+
+	bool isComplete(uint64_t value) const { return value <= acquiredValue; }
+
+	const VulkanSemaphore& getTimeline() const { return *timeline; }
+	UploadStats getStats() const;
+
+private:
+	struct PendingCopy {
+		const VulkanBuffer* dst;
+		BufferCopyRegion region;
+	};
+
+	struct Batch {
+		std::unique_ptr<VulkanCommandBuffer> cmd;
+		uint64_t value = 0;
+		uint64_t ringMark = 0;
+
+		std::vector<BufferBarrier> bufferAcquires;
+		std::vector<VulkanImage*> imageAcquires;
+	};
+
+	uint64_t stage(uint64_t size, uint64_t alignment);
+	Batch& openBatch();
+	void recordPendingCopies(Batch& batch);
+	void retireCompleted(uint64_t completed);
+
+private:
+	VulkanDevice& device;
+
+	uint32_t transferFamily;
+	uint32_t graphicsFamily;
+	bool ownershipTransfer;
+
+	StagingRing ring;
+	uint64_t maxUploadSize;
+
+	std::unique_ptr<VulkanSemaphore> timeline;
+	std::unique_ptr<VulkanCommandPool> commandPool;
+
+	std::vector<Batch> batches;
+	uint32_t nextBatch = 0;
+	uint32_t openIndex = UINT32_MAX;
+
+	std::vector<PendingCopy> pendingCopies;
+	uint64_t pendingBytes = 0;
+
+	uint64_t submittedValue = 0;
+	uint64_t completedValue = 0;
+	uint64_t acquiredValue = 0;
+
+	std::vector<BufferBarrier> readyBufferAcquires;
+	std::vector<VulkanImage*> readyImageAcquires;
+
+	UploadStats stats;
+};
@@ -0,0 +1,135 @@
+#include "GeometryArena.h"
+
+#include "Signboard/RHI/vulkan/VulkanBuffer.h"
+#include "Signboard/RHI/vulkan/VulkanCommandBuffer.h"
+
+#include <algorithm>
+#include <iterator>
+
+RangeAllocator::RangeAllocator(uint64_t capacity)
+	: capacity(capacity)
+{
+	freeRanges.emplace(0, capacity);
+}
+
+uint64_t RangeAllocator::allocate(uint64_t size, uint64_t alignment) {
+	if (size == 0)
+		return INVALID_OFFSET;
+
+	// best fit keeps the large ranges intact for chunk-sized allocations
+	auto best = freeRanges.end();
+	uint64_t bestWaste = UINT64_MAX;
+
+	for (auto it = freeRanges.begin(); it != freeRanges.end(); ++it) {
+		uint64_t aligned = (it->first + alignment - 1) / alignment * alignment;
+		uint64_t padding = aligned - it->first;
+		if (it->second < padding + size) continue;
+
+		uint64_t waste = it->second - size;
+		if (waste < bestWaste) {
+			best = it;
+			bestWaste = waste;
+			if (waste == padding) break;
+		}
+	}
+
+	if (best == freeRanges.end())
+		return INVALID_OFFSET;
+
+	uint64_t rangeOffset = best->first;
+	uint64_t rangeSize = best->second;
+	uint64_t aligned = (rangeOffset + alignment - 1) / alignment * alignment;
+	freeRanges.erase(best);
+
+	if (aligned > rangeOffset)
+		freeRanges.emplace(rangeOffset, aligned - rangeOffset);
+
+	uint64_t end = aligned + size;
+	if (end < rangeOffset + rangeSize)
+		freeRanges.emplace(end, rangeOffset + rangeSize - end);
+
+	used += size;
+	return aligned;
+}
+
+void RangeAllocator::free(uint64_t offset, uint64_t size) {
+	used -= size;
+
+	auto next = freeRanges.lower_bound(offset);
+	if (next != freeRanges.end() && offset + size == next->first) {
+		size += next->second;
+		next = freeRanges.erase(next);
+	}
+
+	if (next != freeRanges.begin()) {
+		auto prev = std::prev(next);
+		if (prev->first + prev->second == offset) {
+			prev->second += size;
+			return;
+		}
+	}
+
+	freeRanges.emplace(offset, size);
+}
+
+GeometryArena::GeometryArena(VulkanDevice& device, uint64_t vertexCapacity, uint64_t indexCapacity)
+	: vertexRanges(vertexCapacity), indexRanges(indexCapacity)
+{
+	BufferDesc vertexDesc{};
+	vertexDesc.size = vertexCapacity;
+	vertexDesc.memoryFlags = MemoryProperty::DeviceLocal;
+	vertexDesc.usageFlags.set(BufferUsage::TransferDestination, BufferUsage::Vertex);
+
+	vertexBuffer = std::make_unique<VulkanBuffer>(device, vertexDesc);
+
+	BufferDesc indexDesc{};
+	indexDesc.size = indexCapacity;
+	indexDesc.memoryFlags = MemoryProperty::DeviceLocal;
+	indexDesc.usageFlags.set(BufferUsage::TransferDestination, BufferUsage::Index);
+
+	indexBuffer = std::make_unique<VulkanBuffer>(device, indexDesc);
+}
+
+GeometryArena::~GeometryArena() = default;
+
+bool GeometryArena::allocate(uint64_t vertexBytes, uint32_t vertexStride, uint64_t indexBytes, GeometryRange& range) {
+	uint64_t vertexOffset = vertexRanges.allocate(vertexBytes, vertexStride);
+	if (vertexOffset == RangeAllocator::INVALID_OFFSET)
+		return false;
+
+	uint64_t indexOffset = indexRanges.allocate(indexBytes, sizeof(uint32_t));
+	if (indexOffset == RangeAllocator::INVALID_OFFSET) {
+		vertexRanges.free(vertexOffset, vertexBytes);
+		return false;
+	}
+
+	range.vertexByteOffset = vertexOffset;
+	range.vertexBytes = vertexBytes;
+	range.indexByteOffset = indexOffset;
+	range.indexBytes = indexBytes;
+	range.vertexOffset = static_cast<int32_t>(vertexOffset / vertexStride);
+	range.firstIndex = static_cast<uint32_t>(indexOffset / sizeof(uint32_t));
+
+	return true;
+}
+
+void GeometryArena::release(const GeometryRange& range) {
+	vertexRanges.free(range.vertexByteOffset, range.vertexBytes);
+	indexRanges.free(range.indexByteOffset, range.indexBytes);
+}
+
+void GeometryArena::bind(VulkanCommandBuffer& cmd) const {
+	cmd.bindVertexBuffer(*vertexBuffer);
+	cmd.bindIndexBuffer(*indexBuffer);
+}
+
+GeometryArenaStats GeometryArena::getStats() const {
+	GeometryArenaStats stats;
+	stats.vertexCapacity = vertexRanges.getCapacity();
+	stats.vertexUsed = vertexRanges.getUsed();
+	stats.indexCapacity = indexRanges.getCapacity();
+	stats.indexUsed = indexRanges.getUsed();
+	stats.vertexFreeRanges = vertexRanges.getFreeRangeCount();
+	stats.indexFreeRanges = indexRanges.getFreeRangeCount();
+	return stats;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+class VulkanBuffer;
+class VulkanDevice;
+class VulkanCommandBuffer;
+
+class RangeAllocator {
+public:
+	static constexpr uint64_t INVALID_OFFSET = UINT64_MAX;
+
+	explicit RangeAllocator(uint64_t capacity);
+
+	uint64_t allocate(uint64_t size, uint64_t alignment);
+	void free(uint64_t offset, uint64_t size);
+
+	uint64_t getCapacity() const { return capacity; }
+	uint64_t getUsed() const { return used; }
+	uint32_t getFreeRangeCount() const { return static_cast<uint32_t>(freeRanges.size()); }
+
+private:
+	std::map<uint64_t, uint64_t> freeRanges;
+	uint64_t capacity;
+	uint64_t used = 0;
+};
+
+struct GeometryRange {
+	uint64_t vertexByteOffset = 0;
+	uint64_t vertexBytes = 0;
+	uint64_t indexByteOffset = 0;
+	uint64_t indexBytes = 0;
+
+	int32_t vertexOffset = 0;
+	uint32_t firstIndex = 0;
+};
+
+struct GeometryArenaStats {
+	uint64_t vertexCapacity = 0;
+	uint64_t vertexUsed = 0;
+	uint64_t indexCapacity = 0;
+	uint64_t indexUsed = 0;
+
+	uint32_t vertexFreeRanges = 0;
+	uint32_t indexFreeRanges = 0;
+};
+
+class GeometryArena {
+public:
+	static constexpr uint64_t DEFAULT_VERTEX_CAPACITY = 128ull << 20;
+	static constexpr uint64_t DEFAULT_INDEX_CAPACITY = 64ull << 20;
+
+	GeometryArena(VulkanDevice& device, uint64_t vertexCapacity = DEFAULT_VERTEX_CAPACITY, uint64_t indexCapacity = DEFAULT_INDEX_CAPACITY);
+	~GeometryArena();
+
+	GeometryArena(const GeometryArena&) = delete;
+	GeometryArena& operator=(const GeometryArena&) = delete;
+
+	bool allocate(uint64_t vertexBytes, uint32_t vertexStride, uint64_t indexBytes, GeometryRange& range);
+	// frees immediately, callers go through the deletion queue so no in-flight frame still draws the range
+	void release(const GeometryRange& range);
+
+	void bind(VulkanCommandBuffer& cmd) const;
+
+	VulkanBuffer& getVertexBuffer() const { return *vertexBuffer; }
+	VulkanBuffer& getIndexBuffer() const { return *indexBuffer; }
+
+	GeometryArenaStats getStats() const;
+
+private:
+	std::unique_ptr<VulkanBuffer> vertexBuffer;
+	std::unique_ptr<VulkanBuffer> indexBuffer;
+
+	RangeAllocator vertexRanges;
+	RangeAllocator indexRanges;
+};
@@ -8,6 +8,9 @@
 Mesh::Mesh(std::unique_ptr<VulkanBuffer> vbo, std::unique_ptr<VulkanBuffer> ibo, uint32_t indexCount = 0)	
 	: vertexBuffer(std::move(vbo)), indexBuffer(std::move(ibo)), indexCount(indexCount) {}
 
+Mesh::Mesh(const GeometryArena& arena, const GeometryRange& range, uint32_t indexCount)
+	: arena(&arena), range(range), indexCount(indexCount) {}
+
 Mesh::~Mesh() = default;
 
 Mesh::Mesh(Mesh&& other) noexcept = default;
@@ -15,10 +18,14 @@ Mesh::Mesh(Mesh&& other) noexcept = default;
 Mesh& Mesh::operator=(Mesh&& other) noexcept = default;
 
 void Mesh::bind(VulkanCommandBuffer& cmd) const {
+	if (arena) {
+		arena->bind(cmd);
+		return;
+	}
 	cmd.bindVertexBuffer(*vertexBuffer);
 	cmd.bindIndexBuffer(*indexBuffer);
 }
 
 void Mesh::draw(VulkanCommandBuffer& cmd) const {
-	cmd.drawIndexed(indexCount);
+	cmd.drawIndexed(indexCount, 1, range.firstIndex, range.vertexOffset);
 }
\ No newline at end of file
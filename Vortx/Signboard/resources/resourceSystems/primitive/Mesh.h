@@ -1,8 +1,12 @@
 #pragma once
 
+#include "core/dataDef/Bounds.h"
+#include "GeometryArena.h"
+
 #include <memory>
 
 class VulkanBuffer;
+class VulkanCommandBuffer;
 
 class Mesh {
 public:
@@ -15,17 +19,30 @@ public:
 	~Mesh();
 
 	uint32_t getIndexCount() const { return indexCount; }
+	uint32_t getFirstIndex() const { return range.firstIndex; }
+	int32_t getVertexOffset() const { return range.vertexOffset; }
+	const AABB& getBounds() const { return bounds; }
+
+	bool isArenaResident() const { return arena != nullptr; }
 
 	void bind(VulkanCommandBuffer& cmd) const;
 	void draw(VulkanCommandBuffer& cmd) const;
 	
 private:
 	friend class Renderer;
+	friend class MeshSystem;
 	Mesh(std::unique_ptr<VulkanBuffer> vertexBuffer, std::unique_ptr<VulkanBuffer> indexBuffer, uint32_t indexCount = 0);
+	Mesh(const GeometryArena& arena, const GeometryRange& range, uint32_t indexCount);
 
 private:
 	std::unique_ptr<VulkanBuffer> vertexBuffer;
 	std::unique_ptr<VulkanBuffer> indexBuffer;
 
+	const GeometryArena* arena = nullptr;
+	GeometryRange range;
+
 	uint32_t indexCount = 0;
+	AABB bounds;
+
+	uint64_t uploadValue = 0;
 };
\ No newline at end of file
@@ -0,0 +1,75 @@
+#include "SlotMirror.h"
+
+#include "Signboard/RHI/vulkan/VulkanBuffer.h"
+#include "Signboard/RHI/vulkan/VulkanCommandBuffer.h"
+
+#include <stdexcept>
+
+SlotMirror::SlotMirror(VulkanDevice& device, uint64_t elementSize, uint32_t capacity, PipelineStageFlags readStages)
+	: device(device), elementSize(elementSize), readStages(readStages)
+{
+	BufferDesc desc{};
+	desc.size = elementSize * capacity;
+	desc.usageFlags.set(BufferUsage::Storage, BufferUsage::TransferDestination);
+	desc.memoryFlags = MemoryProperty::DeviceLocal;
+
+	buffer = std::make_unique<VulkanBuffer>(device, desc);
+}
+
+SlotMirror::~SlotMirror() = default;
+
+void* SlotMirror::stage(uint32_t frameIndex, uint32_t begin, uint32_t end) {
+	uint64_t offset = begin * elementSize;
+	uint64_t size = (end - begin) * elementSize;
+
+	if (offset + size > buffer->getSize())
+		throw std::runtime_error("slot range exceeds mirror capacity!");
+
+	if (stagingBuffers.size() <= frameIndex) {
+		stagingBuffers.resize(frameIndex + 1);
+		stagingMapped.resize(frameIndex + 1, nullptr);
+	}
+
+	if (!stagingBuffers[frameIndex]) {
+		BufferDesc desc{};
+		desc.size = buffer->getSize();
+		desc.usageFlags = BufferUsage::TransferSource;
+		desc.memoryFlags.set(MemoryProperty::HostVisible, MemoryProperty::HostCoherent);
+
+		stagingBuffers[frameIndex] = std::make_unique<VulkanBuffer>(device, desc);
+		stagingMapped[frameIndex] = static_cast<uint8_t*>(stagingBuffers[frameIndex]->map());
+	}
+
+	regions.push_back({ offset, offset, size });
+	pending.stagedSlots += end - begin;
+	pending.uploadedBytes += size;
+
+	return stagingMapped[frameIndex] + offset;
+}
+
+void SlotMirror::record(VulkanCommandBuffer& cmd, uint32_t frameIndex) {
+	if (regions.empty()) {
+		stats = SlotMirrorStats{};
+		return;
+	}
+
+	BufferBarrier barrier;
+	barrier.buffer = buffer.get();
+	barrier.size = buffer->getSize();
+
+	// the previous frame may still be reading the slots about to be overwritten
+	barrier.dstAccess = ResourceAccess::TransferWrite;
+	cmd.bufferBarriers(&barrier, 1, readStages, PipelineStage::Transfer);
+
+	cmd.copyBuffer(*stagingBuffers[frameIndex], *buffer, regions.data(), static_cast<uint32_t>(regions.size()));
+
+	barrier.srcAccess = ResourceAccess::TransferWrite;
+	barrier.dstAccess = ResourceAccess::ShaderRead;
+	cmd.bufferBarriers(&barrier, 1, PipelineStage::Transfer, readStages);
+
+	stats = pending;
+	stats.copyRegions = static_cast<uint32_t>(regions.size());
+
+	pending = SlotMirrorStats{};
+	regions.clear();
+}
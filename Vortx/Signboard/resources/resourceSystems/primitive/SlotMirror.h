@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Signboard/RHI/common/DeviceTypes.h"
+#include "Signboard/RHI/common/BufferTypes.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class VulkanBuffer;
+class VulkanDevice;
+class VulkanCommandBuffer;
+
+struct SlotMirrorStats {
+	uint32_t stagedSlots = 0;
+	uint32_t copyRegions = 0;
+	uint64_t uploadedBytes = 0;
+};
+
+// device-local copy of a slot-indexed array, only the slot ranges staged each frame are copied across
+class SlotMirror {
+public:
+	SlotMirror(VulkanDevice& device, uint64_t elementSize, uint32_t capacity, PipelineStageFlags readStages);
+	~SlotMirror();
+
+	SlotMirror(const SlotMirror&) = delete;
+	SlotMirror& operator=(const SlotMirror&) = delete;
+
+	// returns the staging memory for slots [begin, end) of this frame, staging mirrors the device layout
+	void* stage(uint32_t frameIndex, uint32_t begin, uint32_t end);
+
+	// copies everything staged for the frame, ordered after the previous frame's reads and before this one's
+	void record(VulkanCommandBuffer& cmd, uint32_t frameIndex);
+
+	const VulkanBuffer& getBuffer() const { return *buffer; }
+	// covers the last recorded upload
+	const SlotMirrorStats& getStats() const { return stats; }
+
+private:
+	VulkanDevice& device;
+
+	uint64_t elementSize;
+	PipelineStageFlags readStages;
+
+	std::unique_ptr<VulkanBuffer> buffer;
+
+	// one per frame in flight, the previous frame may still be copying out of its own
+	std::vector<std::unique_ptr<VulkanBuffer>> stagingBuffers;
+	std::vector<uint8_t*> stagingMapped;
+
+	std::vector<BufferCopyRegion> regions;
+	SlotMirrorStats pending;
+	SlotMirrorStats stats;
+};
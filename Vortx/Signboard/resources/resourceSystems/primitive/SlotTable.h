@@ -0,0 +1,194 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <cassert>
+#include <stdexcept>
+
+// generational slot storage shared by the resource systems. values, generations and live positions are
+// separate slot-indexed arrays so slot indices stay stable for gpu-side indexing, live slots are also packed
+// densely for iteration. Handle is any { index, generation } aggregate.
+template<typename T, typename Handle>
+class SlotTable {
+public:
+	static constexpr uint32_t NO_LIMIT = UINT32_MAX;
+
+	explicit SlotTable(uint32_t capacity = NO_LIMIT)
+		: capacity(capacity) {}
+
+	Handle insert(T value) {
+		uint32_t index;
+
+		if (!freeList.empty()) {
+			index = freeList.back();
+			freeList.pop_back();
+		} else {
+			if (isFull())
+				throw std::runtime_error("slot table is full!");
+
+			index = static_cast<uint32_t>(values.size());
+			values.emplace_back();
+			generations.push_back(1);
+			livePositions.push_back(NONE);
+		}
+
+		values[index] = std::move(value);
+		livePositions[index] = static_cast<uint32_t>(live.size());
+		live.push_back(index);
+
+		markDirty(index);
+		return Handle{ index, generations[index] };
+	}
+
+	bool contains(Handle handle) const {
+		return handle.index < values.size() && livePositions[handle.index] != NONE && generations[handle.index] == handle.generation;
+	}
+
+	T& get(Handle handle) {
+		assert(contains(handle) && "handle refers to a destroyed or reused slot!");
+		return values[handle.index];
+	}
+
+	const T& get(Handle handle) const {
+		assert(contains(handle) && "handle refers to a destroyed or reused slot!");
+		return values[handle.index];
+	}
+
+	T* find(Handle handle) { return contains(handle) ? &values[handle.index] : nullptr; }
+	const T* find(Handle handle) const { return contains(handle) ? &values[handle.index] : nullptr; }
+
+	// raw slot access for systems whose slot index is also a gpu index
+	T& at(uint32_t index) { return values[index]; }
+	const T& at(uint32_t index) const { return values[index]; }
+
+	bool isAlive(uint32_t index) const { return index < values.size() && livePositions[index] != NONE; }
+	Handle getHandle(uint32_t index) const { return Handle{ index, generations[index] }; }
+
+	uint32_t getSlotCount() const { return static_cast<uint32_t>(values.size()); }
+	uint32_t getLiveCount() const { return static_cast<uint32_t>(live.size()); }
+	const std::vector<uint32_t>& getLiveIndices() const { return live; }
+
+	bool isFull() const { return freeList.empty() && values.size() >= capacity; }
+
+	// removal is deferred to flushDeletes so work already in flight can keep using the slot
+	bool destroy(Handle handle) {
+		if (!contains(handle))
+			return false;
+
+		pendingDeletes.push_back(handle.index);
+		return true;
+	}
+
+	// retire(index, value) returns false to keep the slot pending until a later flush
+	template<typename Retire>
+	void flushDeletes(Retire&& retire) {
+		std::vector<uint32_t> deferred;
+
+		for (uint32_t index : pendingDeletes) {
+			if (!isAlive(index)) continue;
+
+			if (!retire(index, values[index])) {
+				deferred.push_back(index);
+				continue;
+			}
+			erase(index);
+		}
+		pendingDeletes.swap(deferred);
+	}
+
+	void flushDeletes() {
+		flushDeletes([](uint32_t, T&) { return true; });
+	}
+
+	void erase(Handle handle) {
+		if (contains(handle))
+			erase(handle.index);
+	}
+
+	void markDirty(uint32_t index) {
+		uint32_t word = index / 64;
+		if (word >= dirtyBits.size())
+			dirtyBits.resize(word + 1, 0);
+
+		if (!dirtyBits[word])
+			dirtyWords.push_back(word);
+		dirtyBits[word] |= 1ull << (index % 64);
+	}
+
+	bool hasDirty() const { return !dirtyWords.empty(); }
+
+	// hands every contiguous run of dirty slots to range(begin, end) in ascending order and clears them,
+	// cost follows the number of touched words rather than the slot count
+	template<typename Range>
+	void consumeDirty(Range&& range) {
+		std::sort(dirtyWords.begin(), dirtyWords.end());
+
+		uint32_t runBegin = NONE;
+		uint32_t runEnd = NONE;
+
+		for (uint32_t word : dirtyWords) {
+			uint64_t bits = dirtyBits[word];
+			dirtyBits[word] = 0;
+
+			while (bits) {
+				uint32_t index = word * 64 + lowestBit(bits);
+				bits &= bits - 1;
+
+				if (index != runEnd) {
+					if (runBegin != NONE)
+						range(runBegin, runEnd);
+					runBegin = index;
+				}
+				runEnd = index + 1;
+			}
+		}
+
+		if (runBegin != NONE)
+			range(runBegin, runEnd);
+
+		dirtyWords.clear();
+	}
+
+private:
+	static constexpr uint32_t NONE = UINT32_MAX;
+
+	static uint32_t lowestBit(uint64_t value) {
+		uint32_t bit = 0;
+		while (!(value & 1ull)) {
+			value >>= 1;
+			bit++;
+		}
+		return bit;
+	}
+
+	void erase(uint32_t index) {
+		uint32_t position = livePositions[index];
+		uint32_t moved = live.back();
+
+		live[position] = moved;
+		livePositions[moved] = position;
+		live.pop_back();
+
+		livePositions[index] = NONE;
+		values[index] = T{};
+		++generations[index];
+
+		freeList.push_back(index);
+	}
+
+private:
+	uint32_t capacity;
+
+	std::vector<T> values;
+	std::vector<uint32_t> generations;
+	std::vector<uint32_t> livePositions;
+
+	std::vector<uint32_t> live;
+	std::vector<uint32_t> freeList;
+	std::vector<uint32_t> pendingDeletes;
+
+	std::vector<uint64_t> dirtyBits;
+	std::vector<uint32_t> dirtyWords;
+};
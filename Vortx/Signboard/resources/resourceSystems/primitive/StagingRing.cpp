@@ -0,0 +1,50 @@
+#include "StagingRing.h"
+
+#include "Signboard/RHI/vulkan/VulkanBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+StagingRing::StagingRing(VulkanDevice& device, uint64_t capacity)
+	: capacity(capacity)
+{
+	BufferDesc desc{};
+	desc.size = capacity;
+	desc.memoryFlags.set(MemoryProperty::HostVisible, MemoryProperty::HostCoherent);
+	desc.usageFlags = BufferUsage::TransferSource;
+
+	buffer = std::make_unique<VulkanBuffer>(device, desc);
+	mapped = static_cast<uint8_t*>(buffer->map());
+}
+
+StagingRing::~StagingRing() = default;
+
+uint64_t StagingRing::allocate(uint64_t size, uint64_t alignment) {
+	if (size > capacity)
+		return INVALID_OFFSET;
+
+	uint64_t ringOffset = head % capacity;
+	uint64_t aligned = (ringOffset + alignment - 1) / alignment * alignment;
+
+	uint64_t advance;
+	if (aligned + size > capacity) {
+		aligned = 0;
+		advance = capacity - ringOffset + size;
+	} else {
+		advance = aligned - ringOffset + size;
+	}
+
+	if (head + advance - tail > capacity)
+		return INVALID_OFFSET;
+
+	head += advance;
+	return aligned;
+}
+
+void StagingRing::write(uint64_t offset, const void* data, uint64_t size) {
+	std::memcpy(mapped + offset, data, size);
+}
+
+void StagingRing::release(uint64_t mark) {
+	tail = std::max(tail, mark);
+}
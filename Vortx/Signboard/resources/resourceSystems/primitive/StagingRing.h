@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+class VulkanBuffer;
+class VulkanDevice;
+
+class StagingRing {
+public:
+	static constexpr uint64_t INVALID_OFFSET = UINT64_MAX;
+
+	StagingRing(VulkanDevice& device, uint64_t capacity);
+	~StagingRing();
+
+	StagingRing(const StagingRing&) = delete;
+	StagingRing& operator=(const StagingRing&) = delete;
+
+	uint64_t allocate(uint64_t size, uint64_t alignment);
+	void write(uint64_t offset, const void* data, uint64_t size);
+
+	// everything allocated before a mark is reclaimed once the work reading it has completed
+	uint64_t getMark() const { return head; }
+	void release(uint64_t mark);
+
+	const VulkanBuffer& getBuffer() const { return *buffer; }
+	uint64_t getCapacity() const { return capacity; }
+	uint64_t getUsed() const { return head - tail; }
+
+private:
+	std::unique_ptr<VulkanBuffer> buffer;
+	uint8_t* mapped = nullptr;
+	uint64_t capacity;
+
+	// head and tail only grow, the ring offset is taken modulo capacity
+	uint64_t head = 0;
+	uint64_t tail = 0;
+};
@@ -24,4 +24,5 @@ private:
 private:
 	std::unique_ptr<VulkanImage> image;
 	uint32_t bindlessIndex;
+	uint64_t uploadValue = 0;
 };
@@ -2,10 +2,14 @@
 
 #include "renderSystem/RHI/vulkan/VulkanDescriptorSet.h"
 #include "renderSystem/RHI/vulkan/VulkanBuffer.h"
-#include "renderSystem/RHI/vulkan/VulkanDescriptorWriter.h"
+#include "Signboard/RHI/vulkan/VulkanCommandBuffer.h"
+
+#include "Signboard/resources/resourceSystems/DescriptorUpdateQueue.h"
 
 #include <glm/gtc/matrix_transform.hpp>
 #include <array>
+#include <cstring>
+#include <stdexcept>
 
 struct objectUniformAllocation {
 	VulkanDescriptorSet descriptor;
@@ -15,84 +19,87 @@ struct objectUniformAllocation {
 	objectUniformAllocation(VulkanDevice& device, const BufferDesc& desc) : UBO(device, desc) {}
 };
 
-ObjectSystem::ObjectSystem(VulkanDevice& device, VulkanDescriptorSet& objectSet, uint32_t objectBufferBinding, uint32_t maxObjectCount)
-	: device(device), objectSet(objectSet), objectBufferBinding(objectBufferBinding), maxObjectCount(maxObjectCount), objectBuffer(createObjectStoragebuffer())
-{
-	mapped = reinterpret_cast<GPUObject*>(objectBuffer.map());
-	writeObjectStorageBuffer();
+static PipelineStageFlags objectReadStages() {
+	PipelineStageFlags stages;
+	stages.set(PipelineStage::VertexShader, PipelineStage::ComputeShader);
+	return stages;
 }
 
-VulkanBuffer ObjectSystem::createObjectStoragebuffer() {
-	BufferDesc desc{};
-	desc.size = sizeof(GPUObject) * maxObjectCount;
-	desc.usageFlags = BufferUsage::Storage;
-	desc.memoryFlags.set(MemoryProperty::HostVisible, MemoryProperty::HostCoherent);
-
-	return VulkanBuffer(device, desc);
+ObjectSystem::ObjectSystem(VulkanDevice& device, DescriptorUpdateQueue& descriptorUpdates, VulkanDescriptorSet& objectSet, uint32_t objectBufferBinding, uint32_t maxObjectCount)
+	: device(device), descriptorUpdates(descriptorUpdates), objectSet(objectSet), objectBufferBinding(objectBufferBinding), maxObjectCount(maxObjectCount),
+	  objects(maxObjectCount), mirror(device, sizeof(GPUObject), maxObjectCount, objectReadStages())
+{
+	writeObjectStorageBuffer();
 }
 
 void ObjectSystem::writeObjectStorageBuffer() {
-	VulkanDescriptorWriter writer(device, objectSet);
-
-	writer.writeStorageBuffer(objectBufferBinding, &objectBuffer, objectBuffer.getSize());
-	writer.commit();
+	const VulkanBuffer& objectBuffer = mirror.getBuffer();
+	descriptorUpdates.writeStorageBuffer(objectSet, objectBufferBinding, &objectBuffer, objectBuffer.getSize());
 }
 
 ObjectSystem::~ObjectSystem() {
 }
 
 ObjectHandle ObjectSystem::createObject(MeshHandle mesh, MaterialHandle material, glm::mat4 transform) {
-	ObjectHandle handle = allocateSlot();
-
-	uint32_t index = handle.index;
-	ObjectSlot& slot = slots[index];
-	slot.generation++;
-	slot.alive = true;
+	if (objects.isFull())
+		throw std::runtime_error("out of object slots!");
 
-	GPUObject& gpu = mapped[index];
+	GPUObject gpu{};
 	gpu.meshIndex = mesh.index;
 	gpu.materialIndex = material.index;
 	gpu.model = transform;
 
-	return ObjectHandle{ index, slot.generation };
-}
-
-ObjectHandle ObjectSystem::allocateSlot() {
-	uint32_t index;
+	ObjectHandle handle = objects.insert(gpu);
+	uint32_t index = handle.index;
 
-	if (!freeList.empty()) {
-		index = freeList.back();
-		freeList.pop_back();
-	} else {
-		index = static_cast<uint32_t>(slots.size());
-		slots.emplace_back();
+	if (index == transforms.size()) {
+		transforms.emplace_back(1.0f);
+		localBounds.push_back(AABB::unbounded());
+		worldBounds.push(AABB::unbounded());
 	}
 
-	return ObjectHandle{ index, slots[index].generation };
+	transforms[index] = transform;
+	localBounds[index] = AABB::unbounded();
+	worldBounds.set(index, localBounds[index].transformed(transform));
+
+	return handle;
 }
 
 void ObjectSystem::updateTransform(ObjectHandle handle, const glm::mat4& transform) {
-	ObjectSlot& slot = slots[handle.index];
-	if (!slot.alive || slot.generation != handle.generation)
+	GPUObject* gpu = objects.find(handle);
+	if (!gpu)
 		return;
 
-	mapped[handle.index].model = transform;
+	gpu->model = transform;
+	objects.markDirty(handle.index);
+
+	transforms[handle.index] = transform;
+	worldBounds.set(handle.index, localBounds[handle.index].transformed(transform));
 }
 
-void ObjectSystem::destroy(ObjectHandle handle) {
-	ObjectSlot& slot = slots[handle.index];
-	if (!slot.alive || slot.generation != handle.generation)
+void ObjectSystem::setBounds(ObjectHandle handle, const AABB& bounds) {
+	if (!objects.contains(handle))
 		return;
 
-	slot.alive = false;
-	freeList.push_back(handle.index);
+	localBounds[handle.index] = bounds;
+	worldBounds.set(handle.index, bounds.transformed(transforms[handle.index]));
+}
+
+void ObjectSystem::destroy(ObjectHandle handle) {
+	objects.destroy(handle);
 }
 
 void ObjectSystem::flushDeletes() {
-	for (uint32_t index : freeList) {
-		++slots[index].generation;
-	}
-	freeList.clear();
+	// the generation only moves once the slot is actually freed, so a reused slot never matches a stale handle
+	objects.flushDeletes();
+}
+
+void ObjectSystem::uploadDirty(VulkanCommandBuffer& cmd, uint32_t frameIndex) {
+	objects.consumeDirty([&](uint32_t begin, uint32_t end) {
+		void* staging = mirror.stage(frameIndex, begin, end);
+		std::memcpy(staging, &objects.at(begin), (end - begin) * sizeof(GPUObject));
+	});
+	mirror.record(cmd, frameIndex);
 }
 
 {
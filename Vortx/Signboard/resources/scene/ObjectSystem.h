@@ -2,7 +2,10 @@
 
 #include "Signboard/resources/common/ObjectSystemTypes.h"
 
-#include "Signboard/RHI/vulkan/VulkanBuffer.h"
+#include "Signboard/resources/resourceSystems/primitive/SlotTable.h"
+#include "Signboard/resources/resourceSystems/primitive/SlotMirror.h"
+
+#include "core/dataDef/Bounds.h"
 
 #include <vector>
 #include <memory>
@@ -11,40 +14,50 @@ class VulkanDevice;
 class VulkanDescriptorPool;
 class VulkanDescriptorSetLayout;
 class VulkanDescriptorSet;
+class VulkanCommandBuffer;
+class DescriptorUpdateQueue;
 
 class ObjectSystem {
 public:
-	ObjectSystem(VulkanDevice& device, VulkanDescriptorSet& objectSet, uint32_t objectBufferBinding, uint32_t maxObjectBinding);
+	ObjectSystem(VulkanDevice& device, DescriptorUpdateQueue& descriptorUpdates, VulkanDescriptorSet& objectSet, uint32_t objectBufferBinding, uint32_t maxObjectBinding);
 	~ObjectSystem();
 
 	ObjectHandle createObject(MeshHandle mesh, MaterialHandle material, const glm::mat4 tranform);
 
 	void updateTransform(ObjectHandle handle, const glm::mat4& transform);
+	void setBounds(ObjectHandle handle, const AABB& localBounds);
+
+	uint32_t getSlotCount() const { return objects.getSlotCount(); }
+	bool isAlive(uint32_t index) const { return objects.isAlive(index); }
+	ObjectHandle getHandle(uint32_t index) const { return objects.getHandle(index); }
+	uint32_t getMeshIndex(uint32_t index) const { return objects.at(index).meshIndex; }
+	const std::vector<uint32_t>& getLiveIndices() const { return objects.getLiveIndices(); }
+	const VulkanBuffer& getObjectBuffer() const { return mirror.getBuffer(); }
+	const BoundsSoA& getWorldBounds() const { return worldBounds; }
 
 	void destroy(ObjectHandle handle);
 	void flushDeletes();
 
+	// copies the objects changed since the last call into the device buffer, record before any pass reads it
+	void uploadDirty(VulkanCommandBuffer& cmd, uint32_t frameIndex);
+	const SlotMirrorStats& getUploadStats() const { return mirror.getStats(); }
+
 private:
-	VulkanBuffer createObjectStoragebuffer();
 	void writeObjectStorageBuffer();
 
-	ObjectHandle allocateSlot();
-
 private:
 	VulkanDevice& device;
+	DescriptorUpdateQueue& descriptorUpdates;
 
 	VulkanDescriptorSet& objectSet;
 	uint32_t objectBufferBinding;
 	uint32_t maxObjectCount;
 
-	VulkanBuffer objectBuffer;
-	GPUObject* mapped = nullptr;
+	// the cpu copy of every GPUObject, dirty slots are staged into the device-local mirror once per frame
+	SlotTable<GPUObject, ObjectHandle> objects;
+	SlotMirror mirror;
 
-	struct ObjectSlot {
-		uint32_t generation = 0;
-		bool alive = false;
-	};
-	
-	std::vector<ObjectSlot> slots;
-	std::vector<uint32_t> freeList;
+	std::vector<glm::mat4> transforms;
+	std::vector<AABB> localBounds;
+	BoundsSoA worldBounds;
 };
@@ -1,36 +1,22 @@
 #include "ViewStateSystem.h"
 
-#include "renderSystem/RHI/vulkan/VulkanDescriptorWriter.h"
+#include "Signboard/resources/resourceSystems/DescriptorUpdateQueue.h"
+#include "Signboard/resources/resourceSystems/TransientUniformAllocator.h"
 
-ViewStateSystem::ViewStateSystem(VulkanDevice& device, VulkanDescriptorSet& viewStateSet, uint32_t viewStateBinding)
-	: device(device), viewStateSet(viewStateSet), viewStateBinding(viewStateBinding), viewStateBuffer(createViewStateBuffer()), mapped(reinterpret_cast<ViewUniform*>(viewStateBuffer.map()))
+ViewStateSystem::ViewStateSystem(VulkanDevice& device, DescriptorUpdateQueue& descriptorUpdates, TransientUniformAllocator& transients, VulkanDescriptorSet& viewStateSet, uint32_t viewStateBinding)
+	: device(device), transients(transients), viewStateSet(viewStateSet), viewStateBinding(viewStateBinding)
 {
-	writeViewStateBuffer();
-}
-
-VulkanBuffer ViewStateSystem::createViewStateBuffer() {
-	BufferDesc desc{};
-	desc.size = sizeof(ViewUniform);
-	desc.usageFlags = BufferUsage::Uniform;
-	desc.memoryFlags.set(MemoryProperty::HostVisible, MemoryProperty::HostCoherent);
-
-	return VulkanBuffer(device, desc);
-}
-
-void ViewStateSystem::writeViewStateBuffer() {
-	VulkanDescriptorWriter writer(device, viewStateSet);
-
-	writer.writeUniformBuffer(viewStateBinding, &viewStateBuffer, viewStateBuffer.getSize());
-	writer.commit();
+	// written once, each frame only moves the dynamic offset
+	descriptorUpdates.writeUniformBufferDynamic(viewStateSet, viewStateBinding, &transients.getBuffer(), sizeof(ViewUniform));
 }
 
 void ViewStateSystem::setCamera(const glm::mat4& view, const glm::mat4& proj, const glm::vec3& cameraPos) {
-	mapped->view = view;
-	mapped->proj = proj;
-	mapped->viewProj = proj * view;
-	mapped->cameraPos = cameraPos;
+	state.view = view;
+	state.proj = proj;
+	state.viewProj = proj * view;
+	state.cameraPos = cameraPos;
 }
 
 void ViewStateSystem::upload() {
-
+	dynamicOffset = transients.push(state);
 }
\ No newline at end of file
@@ -1,9 +1,9 @@
 #pragma once
 
-#include "Signboard/RHI/vulkan/VulkanBuffer.h"
-
 #include <glm/glm.hpp>
 
+#include <cstdint>
+
 struct ViewUniform {
 	glm::mat4 view;
 	glm::mat4 proj;
@@ -15,26 +15,27 @@ struct ViewUniform {
 
 class VulkanDevice;
 class VulkanDescriptorSet;
-class VulkanBuffer;
+class DescriptorUpdateQueue;
+class TransientUniformAllocator;
 
 class ViewStateSystem {
 public:
-	ViewStateSystem(VulkanDevice& device, VulkanDescriptorSet& viewStateSet, uint32_t viewStateBinding);
+	ViewStateSystem(VulkanDevice& device, DescriptorUpdateQueue& descriptorUpdates, TransientUniformAllocator& transients, VulkanDescriptorSet& viewStateSet, uint32_t viewStateBinding);
 
 	void setCamera(const glm::mat4& view, const glm::mat4& proj, const glm::vec3& position);
-	void upload();
 
-	const VulkanBuffer& buffer() const;
+	// copies the current state into this frame's transient memory, once per frame after the allocator reset
+	void upload();
 
-private:
-	VulkanBuffer createViewStateBuffer();
-	void writeViewStateBuffer();
+	const VulkanDescriptorSet& getDescriptorSet() const { return viewStateSet; }
+	uint32_t getDynamicOffset() const { return dynamicOffset; }
 
 private:
 	VulkanDevice& device;
+	TransientUniformAllocator& transients;
 
-	VulkanBuffer viewStateBuffer;
-	ViewUniform* mapped = nullptr;
+	ViewUniform state{};
+	uint32_t dynamicOffset = 0;
 
 	VulkanDescriptorSet& viewStateSet;
 	uint32_t viewStateBinding;
@@ -0,0 +1,204 @@
+// Times ForwardPass::build's batching over 10k and 100k synthetic draws, in a scene with little state and one
+// with a lot: the hashed (pipeline, material, mesh) map with scattered instances it replaced, against DenseRemap
+// keys sorted by radixSort as build does now, with std::stable_sort of the same keys for reference. Reports ms
+// per build, batch count and radix passes.
+//
+// build and run, from Vortx/:
+//   g++ -std=c++17 -O2 -I. bench/draw_sort_bench.cpp -o draw_sort_bench
+//   ./draw_sort_bench
+
+#include "Signboard/RendererCore/RenderGraph/common/RadixSort.h"
+#include "Signboard/RendererCore/RenderGraph/ForwardPass/batch.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+struct Draw {
+	uint32_t pipeline;
+	uint32_t material;
+	uint32_t mesh;
+	uint32_t object;
+	float distanceSq;
+};
+
+struct Batch {
+	uint32_t firstInstance;
+	uint32_t instanceCount;
+};
+
+// the batch key the map was keyed on before draws were sorted
+struct BatchKey {
+	uint32_t pipeline;
+	uint32_t material;
+	uint32_t mesh;
+
+	bool operator==(const BatchKey& other) const {
+		return pipeline == other.pipeline && material == other.material && mesh == other.mesh;
+	}
+};
+
+struct BatchKeyHash {
+	size_t operator()(const BatchKey& k) const noexcept {
+		size_t h1 = std::hash<uint32_t>{}(k.pipeline);
+		size_t h2 = std::hash<uint32_t>{}(k.material);
+		size_t h3 = std::hash<uint32_t>{}(k.mesh);
+		return h1 ^ (h2 << 1) ^ (h3 << 2);
+	}
+};
+
+static double elapsedMs(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// materials spread over 8 pipelines. handles are slot indices spread over their tables, as a scene with churn
+// leaves them
+static std::vector<Draw> makeDraws(uint32_t count, uint32_t materials, uint32_t meshes) {
+	std::mt19937 rng(1);
+	std::vector<Draw> draws(count);
+	for (uint32_t i = 0; i < count; i++) {
+		uint32_t material = static_cast<uint32_t>(rng() % materials);
+		uint32_t mesh = static_cast<uint32_t>(rng() % meshes);
+		float distanceSq = static_cast<float>(rng() % 100000) * 0.25f;
+		draws[i] = { material % 8 * 37, material * 13, mesh * 7, i, distanceSq };
+	}
+
+	return draws;
+}
+
+static void buildHashed(const std::vector<Draw>& draws, std::vector<Batch>& batches, std::vector<uint32_t>& instanceObjects) {
+	batches.clear();
+
+	std::unordered_map<BatchKey, size_t, BatchKeyHash> batchMap;
+	std::vector<std::pair<uint32_t, uint32_t>> instances;
+	instances.reserve(draws.size());
+
+	for (const Draw& draw : draws) {
+		BatchKey key{ draw.pipeline, draw.material, draw.mesh };
+
+		size_t batchIndex;
+		auto it = batchMap.find(key);
+		if (it == batchMap.end()) {
+			batchIndex = batches.size();
+			batchMap.emplace(key, batchIndex);
+			batches.push_back({ 0, 0 });
+		}
+		else {
+			batchIndex = it->second;
+		}
+
+		batches[batchIndex].instanceCount++;
+		instances.push_back({ static_cast<uint32_t>(batchIndex), draw.object });
+	}
+
+	uint32_t firstInstance = 0;
+	for (Batch& batch : batches) {
+		batch.firstInstance = firstInstance;
+		firstInstance += batch.instanceCount;
+	}
+
+	instanceObjects.resize(instances.size());
+	std::vector<uint32_t> cursor(batches.size(), 0);
+	for (auto& [batchIndex, objectIndex] : instances)
+		instanceObjects[batches[batchIndex].firstInstance + cursor[batchIndex]++] = objectIndex;
+}
+
+// the state ForwardPass keeps between builds, so a steady frame does not allocate
+struct SortedBuild {
+	DenseRemap pipelineRemap;
+	DenseRemap materialRemap;
+	DenseRemap meshRemap;
+	std::vector<SortEntry> drawKeys;
+	std::vector<SortEntry> sortScratch;
+	uint32_t sortPasses = 0;
+};
+
+static void buildSorted(SortedBuild& state, const std::vector<Draw>& draws, bool radix, std::vector<Batch>& batches, std::vector<uint32_t>& instanceObjects) {
+	state.drawKeys.clear();
+	state.pipelineRemap.reset();
+	state.materialRemap.reset();
+	state.meshRemap.reset();
+
+	for (uint32_t i = 0; i < draws.size(); i++) {
+		const Draw& draw = draws[i];
+		uint64_t key = DrawKey::pack(state.pipelineRemap.remap(draw.pipeline), state.materialRemap.remap(draw.material), state.meshRemap.remap(draw.mesh), DrawKey::quantizeDepth(draw.distanceSq));
+		state.drawKeys.push_back({ key, i });
+	}
+
+	if (radix)
+		state.sortPasses = radixSort(state.drawKeys, state.sortScratch);
+	else
+		std::stable_sort(state.drawKeys.begin(), state.drawKeys.end(), [](const SortEntry& a, const SortEntry& b) { return a.key < b.key; });
+
+	batches.clear();
+	instanceObjects.resize(state.drawKeys.size());
+
+	for (uint32_t i = 0; i < state.drawKeys.size(); i++) {
+		const Draw& draw = draws[state.drawKeys[i].value];
+		instanceObjects[i] = draw.object;
+
+		if (i > 0) {
+			const Draw& previous = draws[state.drawKeys[i - 1].value];
+			if (draw.pipeline == previous.pipeline && draw.material == previous.material && draw.mesh == previous.mesh) {
+				batches.back().instanceCount++;
+				continue;
+			}
+		}
+
+		batches.push_back({ i, 1 });
+	}
+}
+
+template<typename Build>
+static double bestOf(int runs, Build&& build) {
+	double best = 1e30;
+	for (int run = 0; run < runs; run++) {
+		auto start = std::chrono::steady_clock::now();
+		build();
+		best = std::min(best, elapsedMs(start));
+	}
+	return best;
+}
+
+int main() {
+	const int runs = 50;
+	int result = 0;
+
+	// a scene whose draws mostly share state, and one where almost every draw is a batch of its own
+	struct Scene {
+		uint32_t materials;
+		uint32_t meshes;
+	};
+
+	for (Scene scene : { Scene{ 32, 64 }, Scene{ 256, 512 } })
+	for (uint32_t count : { 10000u, 100000u }) {
+		std::vector<Draw> draws = makeDraws(count, scene.materials, scene.meshes);
+
+		std::vector<Batch> hashedBatches, sortedBatches, stdBatches;
+		std::vector<uint32_t> hashedInstances, sortedInstances, stdInstances;
+		SortedBuild radixState, stdState;
+
+		double hashedMs = bestOf(runs, [&]() { buildHashed(draws, hashedBatches, hashedInstances); });
+		double radixMs = bestOf(runs, [&]() { buildSorted(radixState, draws, true, sortedBatches, sortedInstances); });
+		double stdMs = bestOf(runs, [&]() { buildSorted(stdState, draws, false, stdBatches, stdInstances); });
+
+		std::printf("%u draws, %u materials, %u meshes\n", count, scene.materials, scene.meshes);
+		std::printf("  hashed map             %.3f ms, %zu batches\n", hashedMs, hashedBatches.size());
+		std::printf("  radix sorted keys      %.3f ms, %zu batches, %u passes\n", radixMs, sortedBatches.size(), radixState.sortPasses);
+		std::printf("  std::stable_sort keys  %.3f ms, %zu batches\n", stdMs, stdBatches.size());
+		std::printf("  hashed / radix         %.2fx\n", hashedMs / radixMs);
+
+		// both orders must agree, and every batch has to be one run of identical state
+		bool sorted = std::is_sorted(radixState.drawKeys.begin(), radixState.drawKeys.end(), [](const SortEntry& a, const SortEntry& b) { return a.key < b.key; });
+		if (!sorted || sortedBatches.size() != hashedBatches.size() || sortedInstances != stdInstances) {
+			std::printf("FAIL: radix build disagrees with the reference builds\n");
+			result = 1;
+		}
+	}
+
+	return result;
+}
@@ -0,0 +1,141 @@
+// Runs the software occlusion culler headless over a surface scene and reports the culled percentage and the
+// per-frame cost. The scene is a 32x32 chunk world at ground level: coarse ground slabs and ridges as occluders,
+// every chunk section and 20k surface objects as the boxes tested. The camera turns a full circle over the
+// frames. A few known boxes are checked first, the harness exits 1 when one of them comes out wrong.
+//
+// build and run, from Vortx/ (add -mavx2 for the AVX2 tile loop):
+//   g++ -std=c++17 -O2 -I. bench/occlusion_bench.cpp Signboard/RendererCore/Culling/SoftwareOcclusion.cpp \
+//       -lpthread -o occlusion_bench
+//   ./occlusion_bench [workers]
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+
+#include "Signboard/RendererCore/Culling/SoftwareOcclusion.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+static const int CHUNKS = 32;
+static const int CHUNK_SIZE = 16;
+static const int SECTIONS = 8;
+static const float SURFACE = 64.0f;
+
+static glm::mat4 makeViewProj(const glm::vec3& eye, float yaw) {
+	glm::vec3 forward(std::sin(yaw), -0.15f, -std::cos(yaw));
+	glm::mat4 proj = glm::perspective(glm::radians(70.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+	return proj * glm::lookAt(eye, eye + forward, glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+// a wall in front of the camera hides the box behind it, not the one before it or the one beside it
+static bool checkKnownBoxes(SoftwareOcclusionCuller& culler) {
+	glm::mat4 proj = glm::perspective(glm::radians(45.0f), 320.0f / 192.0f, 0.1f, 1000.0f);
+	glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+	culler.beginFrame(proj * view);
+	culler.addOccluderBox(AABB{ glm::vec3(-10.0f, -10.0f, -12.0f), glm::vec3(10.0f, 10.0f, -10.0f) });
+	culler.rasterize();
+
+	AABB behind{ glm::vec3(-1.0f, -1.0f, -30.0f), glm::vec3(1.0f, 1.0f, -28.0f) };
+	AABB front{ glm::vec3(-1.0f, -1.0f, -6.0f), glm::vec3(1.0f, 1.0f, -5.0f) };
+	AABB beside{ glm::vec3(40.0f, -1.0f, -30.0f), glm::vec3(42.0f, 1.0f, -28.0f) };
+
+	bool ok = !culler.isVisible(behind) && culler.isVisible(front) && culler.isVisible(beside);
+
+	// an occluder crossing the near plane is clipped rather than dropped, its far side still hides the box
+	culler.beginFrame(proj * view);
+	culler.addOccluderBox(AABB{ glm::vec3(-100.0f, -100.0f, -20.0f), glm::vec3(100.0f, 100.0f, -0.05f) });
+	culler.rasterize();
+	ok = ok && !culler.isVisible(behind);
+
+	return ok;
+}
+
+int main(int argc, char** argv) {
+	uint32_t workers = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 0;
+	SoftwareOcclusionCuller culler(320, 192, workers);
+
+	if (!checkKnownBoxes(culler)) {
+		std::printf("FAIL: a known box came out on the wrong side of its occluder\n");
+		return 1;
+	}
+
+	const float half = CHUNKS * CHUNK_SIZE * 0.5f;
+
+	// the ground below the surface in 8x8 chunk slabs, and ridges scattered over it
+	std::vector<AABB> occluders;
+	for (int x = 0; x < CHUNKS; x += 8)
+		for (int z = 0; z < CHUNKS; z += 8)
+			occluders.push_back(AABB{ glm::vec3(x * CHUNK_SIZE - half, 0.0f, z * CHUNK_SIZE - half), glm::vec3((x + 8) * CHUNK_SIZE - half, SURFACE - 2.0f, (z + 8) * CHUNK_SIZE - half) });
+
+	std::mt19937 rng(1);
+	std::uniform_real_distribution<float> position(-half, half);
+	for (int i = 0; i < 24; i++) {
+		glm::vec3 center(position(rng), SURFACE, position(rng));
+		float length = 24.0f + static_cast<float>(rng() % 64);
+		float height = 8.0f + static_cast<float>(rng() % 32);
+		bool alongX = rng() % 2 == 0;
+		glm::vec3 extent(alongX ? length : 4.0f, height, alongX ? 4.0f : length);
+		occluders.push_back(AABB{ center - glm::vec3(extent.x, 0.0f, extent.z), center + glm::vec3(extent.x, extent.y, extent.z) });
+	}
+
+	// every section of every chunk, then small objects on the surface
+	std::vector<AABB> boxes;
+	for (int x = 0; x < CHUNKS; x++)
+		for (int z = 0; z < CHUNKS; z++)
+			for (int y = 0; y < SECTIONS; y++) {
+				glm::vec3 min(x * CHUNK_SIZE - half, static_cast<float>(y * CHUNK_SIZE), z * CHUNK_SIZE - half);
+				boxes.push_back(AABB{ min, min + glm::vec3(static_cast<float>(CHUNK_SIZE)) });
+			}
+
+	const size_t sectionCount = boxes.size();
+	for (int i = 0; i < 20000; i++) {
+		glm::vec3 min(position(rng), SURFACE, position(rng));
+		boxes.push_back(AABB{ min, min + glm::vec3(1.0f, 2.0f, 1.0f) });
+	}
+
+	std::vector<uint8_t> visible(boxes.size());
+
+	const int frames = 120;
+	double rasterizeMs = 0.0, testMs = 0.0, worstMs = 0.0;
+	uint64_t tested = 0, culled = 0, sectionsCulled = 0;
+	uint32_t occluderTriangles = 0, rasterizedTriangles = 0;
+
+	glm::vec3 eye(0.0f, SURFACE + 2.0f, 0.0f);
+	for (int frame = 0; frame < frames; frame++) {
+		float yaw = 6.2831853f * frame / frames;
+		culler.beginFrame(makeViewProj(eye, yaw));
+
+		for (const AABB& occluder : occluders)
+			culler.addOccluderBox(occluder);
+		culler.rasterize();
+
+		culler.testVisibility(boxes.data(), static_cast<uint32_t>(boxes.size()), visible.data());
+
+		const OcclusionStats& stats = culler.getStats();
+		rasterizeMs += stats.rasterizeMs;
+		testMs += stats.testMs;
+		worstMs = std::max(worstMs, static_cast<double>(stats.totalMs()));
+		tested += stats.tested;
+		culled += stats.culled;
+		occluderTriangles = stats.occluderTriangles;
+		rasterizedTriangles += stats.rasterizedTriangles;
+
+		for (size_t i = 0; i < sectionCount; i++)
+			sectionsCulled += visible[i] == 0;
+	}
+
+	std::printf("depth buffer             %ux%u, %u workers requested (0 = default)\n", culler.getWidth(), culler.getHeight(), workers);
+	std::printf("occluders                %zu boxes, %u triangles, %.0f rasterized per frame\n", occluders.size(), occluderTriangles, static_cast<double>(rasterizedTriangles) / frames);
+	std::printf("tested per frame         %zu boxes, %zu of them chunk sections\n", boxes.size(), sectionCount);
+	std::printf("culled                   %.1f%% of all boxes, %.1f%% of sections\n", 100.0 * culled / tested, 100.0 * sectionsCulled / (sectionCount * frames));
+	std::printf("per frame                rasterize %.3f ms, test %.3f ms, total %.3f ms, worst %.3f ms\n", rasterizeMs / frames, testMs / frames, (rasterizeMs + testMs) / frames, worstMs);
+
+	return 0;
+}
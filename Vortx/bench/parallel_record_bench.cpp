@@ -0,0 +1,218 @@
+// Records forward-pass style batches, each rebinding what changed and issuing one indexed draw, into secondary
+// command buffers: once on the calling thread into a single secondary, as the pass did before, and once through
+// ParallelRecorder. Reports recording time for 1k, 10k and 100k batches. Nothing is submitted, the timing covers
+// recording alone.
+//
+// build, from Vortx/ with the shaders compiled to .spv next to their sources (glslc shaders/x -o shaders/x.spv),
+// and a renderSystem -> Signboard link in an include root for the RHI headers that still use that path:
+//   g++ -std=c++17 -O2 -I. bench/parallel_record_bench.cpp Signboard/RHI/vulkan/*.cpp \
+//       Signboard/RendererCore/RenderGraph/common/ParallelRecorder.cpp \
+//       Signboard/resources/*.cpp Signboard/resources/resourceSystems/*.cpp \
+//       Signboard/resources/resourceSystems/*/*.cpp Signboard/resources/scene/*.cpp \
+//       -lvulkan -lglfw -o parallel_record_bench
+// run, e.g. on lavapipe:
+//   VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json ./parallel_record_bench
+
+#include "Signboard/RHI/vulkan/Common/VulkanCommon.h"
+#include "Signboard/RHI/vulkan/VulkanContext.h"
+#include "Signboard/RHI/vulkan/VulkanDevice.h"
+#include "Signboard/RHI/vulkan/VulkanBuffer.h"
+#include "Signboard/RHI/vulkan/VulkanCommandPool.h"
+#include "Signboard/RHI/vulkan/VulkanCommandBuffer.h"
+#include "Signboard/RHI/vulkan/VulkanPipeline.h"
+#include "Signboard/RHI/vulkan/VulkanRenderPass.h"
+#include "Signboard/RHI/vulkan/VulkanPipelineLayout.h"
+#include "Signboard/RendererCore/RenderGraph/common/ParallelRecorder.h"
+#include "Signboard/resources/ResourceAPI.h"
+
+#include "core/dataDef/Vertex.h"
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+static const uint32_t MESH_COUNT = 64;
+static const uint32_t MESH_INDICES = 36;
+
+struct Batch {
+	VkPipeline pipeline;
+	const VulkanBuffer* vertices;
+	const VulkanBuffer* indices;
+	uint32_t objectIndex;
+	uint32_t instanceCount;
+	uint32_t firstInstance;
+};
+
+static double elapsedMs(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static PipelineDesc makeSceneDesc(const char* vertexShader, bool blend) {
+	PipelineDesc desc{};
+	desc.type = PipelineType::Graphics;
+	desc.vertexLayout.bindings.push_back({ 0, sizeof(Vertex) });
+	desc.vertexLayout.attributes.push_back({ 0, VertexFormat::Float3, offsetof(Vertex, pos) });
+	desc.vertexLayout.attributes.push_back({ 1, VertexFormat::Float3, offsetof(Vertex, normal) });
+	desc.vertexLayout.attributes.push_back({ 2, VertexFormat::Float3, offsetof(Vertex, color) });
+	desc.vertexLayout.attributes.push_back({ 3, VertexFormat::Float2, offsetof(Vertex, texCoord) });
+	desc.vertexLayout.attributes.push_back({ 4, VertexFormat::Float4, offsetof(Vertex, tangent) });
+	desc.samples = RasterSamples::Raster_Samples_1;
+	desc.colorFormat = ImageFormat::BGRA8;
+	desc.depthForamt = ImageFormat::Depth32F;
+	desc.shaders.push_back({ ShaderStageBit::VertexBit, vertexShader });
+	desc.shaders.push_back({ ShaderStageBit::FragmentBit, "shaders/forward.frag.spv" });
+	desc.blend.enable = blend;
+
+	return desc;
+}
+
+// what ForwardPass::recordBatches does per range: viewport and scissor, then only the state that changed
+static void recordBatches(VkCommandBuffer cmd, VkPipelineLayout layout, const std::vector<Batch>& batches, uint32_t begin, uint32_t end) {
+	VkViewport viewport{ 0.0f, 0.0f, 1920.0f, 1080.0f, 0.0f, 1.0f };
+	vkCmdSetViewport(cmd, 0, 1, &viewport);
+
+	VkRect2D scissor{ { 0, 0 }, { 1920, 1080 } };
+	vkCmdSetScissor(cmd, 0, 1, &scissor);
+
+	VkPipeline lastPipeline = VK_NULL_HANDLE;
+	const VulkanBuffer* lastMesh = nullptr;
+
+	for (uint32_t i = begin; i < end; i++) {
+		const Batch& batch = batches[i];
+
+		if (batch.pipeline != lastPipeline) {
+			vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, batch.pipeline);
+			lastPipeline = batch.pipeline;
+		}
+
+		if (batch.vertices != lastMesh) {
+			VkBuffer vertexBuffer = batch.vertices->getHandle();
+			VkDeviceSize offset = 0;
+			vkCmdBindVertexBuffers(cmd, 0, 1, &vertexBuffer, &offset);
+			vkCmdBindIndexBuffer(cmd, batch.indices->getHandle(), 0, VK_INDEX_TYPE_UINT32);
+			lastMesh = batch.vertices;
+		}
+
+		vkCmdPushConstants(cmd, layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(uint32_t), &batch.objectIndex);
+		vkCmdDrawIndexed(cmd, MESH_INDICES, batch.instanceCount, 0, 0, batch.firstInstance);
+	}
+}
+
+int main() {
+	if (!glfwInit()) {
+		std::printf("SKIP: no window system to create a surface on\n");
+		return 0;
+	}
+
+	glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	GLFWwindow* window = glfwCreateWindow(64, 64, "parallel_record_bench", nullptr, nullptr);
+
+	{
+		VulkanContext context(window);
+		VulkanDevice device(context.getInstance(), window);
+
+		ResourceAPI resources(device);
+		SceneDescriptors descriptors = resources.getSceneView().descriptors;
+
+		VulkanPipelineLayout layout(device, VulkanPipelineLayoutDesc{});
+		layout.addDescriptorSetLayout(descriptors.viewStateLayout);
+		layout.addDescriptorSetLayout(descriptors.objectStateLayout);
+		layout.addDescriptorSetLayout(descriptors.materialVariableLayout);
+		layout.addDescriptorSetLayout(descriptors.bindlessTextureLayout);
+		layout.addPushConstantRange({ ShaderStageBit::VertexBit, 0, sizeof(uint32_t) });
+		layout.build();
+
+		RenderPassDesc passDesc{};
+		passDesc.colorAttachments.push_back({ ImageFormat::BGRA8, LoadOp::Clear, StoreOp::Store });
+		passDesc.hasDepth = true;
+		passDesc.depthAttachment = { ImageFormat::Depth32F, LoadOp::Clear, StoreOp::Store };
+		VulkanRenderPass renderPass(device, passDesc);
+
+		// an empty cache path keeps the system from loading or writing pipeline_cache.bin
+		DeletionQueue deletions;
+		PipelineSystem pipelines(device, deletions, "");
+
+		std::vector<PipelineManifestEntry> manifest;
+		for (const char* vertexShader : { "shaders/forward_indirect.vert.spv", "shaders/terrain.vert.spv" })
+			for (bool blend : { false, true })
+				manifest.push_back({ &layout, &renderPass, makeSceneDesc(vertexShader, blend) });
+		std::vector<PipelineHandle> pipelineHandles = pipelines.prewarm(manifest);
+
+		std::vector<std::unique_ptr<VulkanBuffer>> meshBuffers;
+		for (uint32_t i = 0; i < MESH_COUNT * 2; i++) {
+			BufferDesc desc{};
+			desc.size = i % 2 ? sizeof(uint32_t) * MESH_INDICES : sizeof(Vertex) * 24;
+			desc.usageFlags.set(i % 2 ? BufferUsage::Index : BufferUsage::Vertex);
+			desc.memoryFlags = MemoryProperty::DeviceLocal;
+			meshBuffers.push_back(std::make_unique<VulkanBuffer>(device, desc));
+		}
+
+		ParallelRecorder recorder(device, 1);
+
+		VulkanCommandPool pool(device);
+		VulkanCommandBuffer single(device, pool, CommandBufferLevel::Secondary);
+
+		std::printf("recorder threads         %u\n", recorder.getThreadCount());
+
+		const int runs = 20;
+		for (uint32_t count : { 1000u, 10000u, 100000u }) {
+			// sorted as the pass sorts them: by pipeline, then mesh
+			std::mt19937 rng(1);
+			std::vector<std::pair<uint32_t, uint32_t>> states(count);
+			for (uint32_t i = 0; i < count; i++)
+				states[i] = { static_cast<uint32_t>(i * pipelineHandles.size() / count), static_cast<uint32_t>(rng() % MESH_COUNT) };
+			std::sort(states.begin(), states.end());
+
+			std::vector<Batch> batches(count);
+			uint32_t firstInstance = 0;
+			for (uint32_t i = 0; i < count; i++) {
+				auto [pipeline, mesh] = states[i];
+				uint32_t instanceCount = 1 + static_cast<uint32_t>(rng() % 4);
+				batches[i] = { pipelines.get(pipelineHandles[pipeline]).getHandle(), meshBuffers[mesh * 2].get(), meshBuffers[mesh * 2 + 1].get(), i, instanceCount, firstInstance };
+				firstInstance += instanceCount;
+			}
+
+			double singleMs = 1e30;
+			double parallelMs = 1e30;
+			uint32_t chunks = 0;
+
+			for (int run = 0; run < runs; run++) {
+				auto start = std::chrono::steady_clock::now();
+				pool.reset();
+				single.beginSecondary(renderPass.getHandle(), 0, VK_NULL_HANDLE);
+				recordBatches(single.getHandle(), layout.getHandle(), batches, 0, count);
+				single.end();
+				singleMs = std::min(singleMs, elapsedMs(start));
+
+				start = std::chrono::steady_clock::now();
+				recorder.record(0, count, renderPass.getHandle(), 0, VK_NULL_HANDLE, [&](VkCommandBuffer cmd, uint32_t begin, uint32_t end) {
+					recordBatches(cmd, layout.getHandle(), batches, begin, end);
+				});
+				parallelMs = std::min(parallelMs, elapsedMs(start));
+				chunks = recorder.getStats().chunkCount;
+			}
+
+			std::printf("%u batches\n", count);
+			std::printf("  single thread          %.3f ms\n", singleMs);
+			std::printf("  ParallelRecorder       %.3f ms in %u chunks, %.2fx\n", parallelMs, chunks, singleMs / parallelMs);
+		}
+
+		for (PipelineHandle handle : pipelineHandles)
+			pipelines.destroy(handle);
+
+		device.waitIdle();
+		deletions.releaseAll();
+	}
+
+	glfwDestroyWindow(window);
+	glfwTerminate();
+	return 0;
+}
@@ -0,0 +1,147 @@
+// Prewarms the scene pipeline variants twice, cold without a cache file and warm from the file the cold run
+// saved, and reports the cache load and stats.prewarmMs for both. The driver's own shader cache hides the
+// difference, so run with it off.
+//
+// build, from Vortx/ with the shaders compiled to .spv next to their sources (glslc shaders/x -o shaders/x.spv),
+// and a renderSystem -> Signboard link in an include root for the RHI headers that still use that path:
+//   g++ -std=c++17 -O2 -I. bench/pipeline_cache_bench.cpp Signboard/RHI/vulkan/*.cpp \
+//       Signboard/resources/*.cpp Signboard/resources/resourceSystems/*.cpp \
+//       Signboard/resources/resourceSystems/*/*.cpp Signboard/resources/scene/*.cpp \
+//       -lvulkan -lglfw -o pipeline_cache_bench
+// run, e.g. on lavapipe:
+//   MESA_SHADER_CACHE_DISABLE=true VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json ./pipeline_cache_bench
+
+#include "Signboard/RHI/vulkan/VulkanContext.h"
+#include "Signboard/RHI/vulkan/VulkanDevice.h"
+#include "Signboard/RHI/vulkan/VulkanRenderPass.h"
+#include "Signboard/RHI/vulkan/VulkanPipelineLayout.h"
+#include "Signboard/resources/ResourceAPI.h"
+
+#include "core/dataDef/Vertex.h"
+
+#include <GLFW/glfw3.h>
+
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+#include <vector>
+
+static const char* CACHE_PATH = "pipeline_cache_bench.bin";
+
+// the renderer's scene pipelines, varied over vertex shader, raster state and blending
+static std::vector<PipelineDesc> makeVariants() {
+	VertexLayoutDesc layout{};
+	layout.bindings.push_back({ 0, sizeof(Vertex) });
+	layout.attributes.push_back({ 0, VertexFormat::Float3, offsetof(Vertex, pos) });
+	layout.attributes.push_back({ 1, VertexFormat::Float3, offsetof(Vertex, normal) });
+	layout.attributes.push_back({ 2, VertexFormat::Float3, offsetof(Vertex, color) });
+	layout.attributes.push_back({ 3, VertexFormat::Float2, offsetof(Vertex, texCoord) });
+	layout.attributes.push_back({ 4, VertexFormat::Float4, offsetof(Vertex, tangent) });
+
+	const char* vertexShaders[] = { "shaders/forward_indirect.vert.spv", "shaders/terrain.vert.spv" };
+	const RasterState rasterStates[] = { { true, true }, { true, false }, { false, false } };
+
+	std::vector<PipelineDesc> variants;
+	for (const char* vertexShader : vertexShaders)
+	for (const RasterState& raster : rasterStates)
+	for (bool blend : { false, true }) {
+		PipelineDesc desc{};
+		desc.type = PipelineType::Graphics;
+		desc.vertexLayout = layout;
+		desc.samples = RasterSamples::Raster_Samples_1;
+		desc.colorFormat = ImageFormat::BGRA8;
+		desc.depthForamt = ImageFormat::Depth32F;
+		desc.shaders.push_back({ ShaderStageBit::VertexBit, vertexShader });
+		desc.shaders.push_back({ ShaderStageBit::FragmentBit, "shaders/forward.frag.spv" });
+		desc.raster = raster;
+		desc.blend.enable = blend;
+		variants.push_back(desc);
+	}
+
+	return variants;
+}
+
+// one startup: the system loads whatever cache file there is, prewarms the manifest and saves on the way out
+static PipelineSystemStats startup(VulkanDevice& device, DeletionQueue& deletions, const std::vector<PipelineManifestEntry>& manifest) {
+	PipelineSystem pipelines(device, deletions, CACHE_PATH);
+
+	std::vector<PipelineHandle> handles = pipelines.prewarm(manifest);
+	pipelines.saveCache();
+
+	PipelineSystemStats stats = pipelines.getStats();
+	for (PipelineHandle handle : handles)
+		pipelines.destroy(handle);
+	deletions.releaseAll();
+
+	return stats;
+}
+
+static void report(const char* name, const PipelineSystemStats& stats) {
+	std::printf("%s\n", name);
+	std::printf("  cache                  %s in %.3f ms\n", stats.cacheLoaded ? "loaded" : "not loaded", stats.cacheLoadMs);
+	std::printf("  prewarm                %u pipelines on %u threads in %.3f ms\n", stats.prewarmed, stats.prewarmThreads, stats.prewarmMs);
+	std::printf("  saved                  %zu bytes in %.3f ms\n", stats.cacheBytes, stats.lastCacheSaveMs);
+}
+
+int main() {
+	if (!glfwInit()) {
+		std::printf("SKIP: no window system to create a surface on\n");
+		return 0;
+	}
+
+	glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	GLFWwindow* window = glfwCreateWindow(64, 64, "pipeline_cache_bench", nullptr, nullptr);
+
+	int result = 0;
+	{
+		VulkanContext context(window);
+		VulkanDevice device(context.getInstance(), window);
+
+		ResourceAPI resources(device);
+		SceneDescriptors descriptors = resources.getSceneView().descriptors;
+
+		VulkanPipelineLayout layout(device, VulkanPipelineLayoutDesc{});
+		layout.addDescriptorSetLayout(descriptors.viewStateLayout);
+		layout.addDescriptorSetLayout(descriptors.objectStateLayout);
+		layout.addDescriptorSetLayout(descriptors.materialVariableLayout);
+		layout.addDescriptorSetLayout(descriptors.bindlessTextureLayout);
+		layout.addPushConstantRange({ ShaderStageBit::VertexBit, 0, sizeof(uint32_t) });
+		layout.build();
+
+		RenderPassDesc passDesc{};
+		passDesc.colorAttachments.push_back({ ImageFormat::BGRA8, LoadOp::Clear, StoreOp::Store });
+		passDesc.hasDepth = true;
+		passDesc.depthAttachment = { ImageFormat::Depth32F, LoadOp::Clear, StoreOp::Store };
+		VulkanRenderPass renderPass(device, passDesc);
+
+		std::vector<PipelineManifestEntry> manifest;
+		for (const PipelineDesc& desc : makeVariants())
+			manifest.push_back({ &layout, &renderPass, desc });
+
+		// nothing is submitted, so each run's queue can be drained before its system goes
+		std::error_code error;
+		std::filesystem::remove(CACHE_PATH, error);
+
+		DeletionQueue deletions;
+		PipelineSystemStats cold = startup(device, deletions, manifest);
+		PipelineSystemStats warm = startup(device, deletions, manifest);
+
+		report("cold, no cache file", cold);
+		report("warm, from the cold run's file", warm);
+
+		if (cold.prewarmMs > 0.0f)
+			std::printf("warm / cold              %.2f\n", warm.prewarmMs / cold.prewarmMs);
+
+		if (!warm.cacheLoaded) {
+			std::printf("FAIL: the warm run did not load the cache the cold run saved\n");
+			result = 1;
+		}
+
+		std::filesystem::remove(CACHE_PATH, error);
+	}
+
+	glfwDestroyWindow(window);
+	glfwTerminate();
+	return result;
+}
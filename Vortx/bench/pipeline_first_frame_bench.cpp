@@ -0,0 +1,139 @@
+// Measures what the first frame that meets a new material pays on the render thread: the material's terrain
+// pipeline requested in place, and requested with async compilation and the prewarmed terrain pipeline as its
+// fallback, the path Renderer::requestTerrainPipeline takes. Also reports the prewarm of the renderer's
+// graphics manifest and how many frames the background build takes to swap in.
+//
+// build, from Vortx/ with the shaders compiled to .spv next to their sources (glslc shaders/x -o shaders/x.spv),
+// and a renderSystem -> Signboard link in an include root for the RHI headers that still use that path:
+//   g++ -std=c++17 -O2 -I. bench/pipeline_first_frame_bench.cpp Signboard/RHI/vulkan/*.cpp \
+//       Signboard/resources/*.cpp Signboard/resources/resourceSystems/*.cpp \
+//       Signboard/resources/resourceSystems/*/*.cpp Signboard/resources/scene/*.cpp \
+//       -lvulkan -lglfw -o pipeline_first_frame_bench
+// run, e.g. on lavapipe:
+//   VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json ./pipeline_first_frame_bench
+
+#include "Signboard/RHI/vulkan/VulkanContext.h"
+#include "Signboard/RHI/vulkan/VulkanDevice.h"
+#include "Signboard/RHI/vulkan/VulkanRenderPass.h"
+#include "Signboard/RHI/vulkan/VulkanPipelineLayout.h"
+#include "Signboard/resources/ResourceAPI.h"
+
+#include "core/dataDef/Vertex.h"
+
+#include <GLFW/glfw3.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+static PipelineDesc makeSceneDesc(const char* vertexShader, const char* fragmentShader, bool blend) {
+	PipelineDesc desc{};
+	desc.type = PipelineType::Graphics;
+	desc.vertexLayout.bindings.push_back({ 0, sizeof(Vertex) });
+	desc.vertexLayout.attributes.push_back({ 0, VertexFormat::Float3, offsetof(Vertex, pos) });
+	desc.vertexLayout.attributes.push_back({ 1, VertexFormat::Float3, offsetof(Vertex, normal) });
+	desc.vertexLayout.attributes.push_back({ 2, VertexFormat::Float3, offsetof(Vertex, color) });
+	desc.vertexLayout.attributes.push_back({ 3, VertexFormat::Float2, offsetof(Vertex, texCoord) });
+	desc.vertexLayout.attributes.push_back({ 4, VertexFormat::Float4, offsetof(Vertex, tangent) });
+	desc.samples = RasterSamples::Raster_Samples_1;
+	desc.colorFormat = ImageFormat::BGRA8;
+	desc.depthForamt = ImageFormat::Depth32F;
+	desc.shaders.push_back({ ShaderStageBit::VertexBit, vertexShader });
+	desc.shaders.push_back({ ShaderStageBit::FragmentBit, fragmentShader });
+	desc.blend.enable = blend;
+
+	return desc;
+}
+
+struct FirstFrame {
+	float requestMs = 0.0f;
+	uint32_t framesUntilReady = 0;
+};
+
+// one frame meets the material, later frames only collect until the pipeline stops resolving to the fallback
+static FirstFrame meetMaterial(PipelineSystem& pipelines, VulkanPipelineLayout& layout, const VulkanRenderPass& renderPass, PipelineHandle fallback, bool blend) {
+	FirstFrame result;
+
+	PipelineHandle handle = pipelines.getOrCreatePipleine(layout, makeSceneDesc("shaders/terrain.vert.spv", "shaders/forward.frag.spv", blend), renderPass, fallback);
+	result.requestMs = pipelines.getStats().frameRequestMs;
+	pipelines.collectCompiled();
+
+	while (!pipelines.isReady(handle)) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		pipelines.collectCompiled();
+		result.framesUntilReady++;
+	}
+
+	return result;
+}
+
+int main() {
+	if (!glfwInit()) {
+		std::printf("SKIP: no window system to create a surface on\n");
+		return 0;
+	}
+
+	glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	GLFWwindow* window = glfwCreateWindow(64, 64, "pipeline_first_frame_bench", nullptr, nullptr);
+
+	{
+		VulkanContext context(window);
+		VulkanDevice device(context.getInstance(), window);
+
+		ResourceAPI resources(device);
+		SceneDescriptors descriptors = resources.getSceneView().descriptors;
+
+		VulkanPipelineLayout layout(device, VulkanPipelineLayoutDesc{});
+		layout.addDescriptorSetLayout(descriptors.viewStateLayout);
+		layout.addDescriptorSetLayout(descriptors.objectStateLayout);
+		layout.addDescriptorSetLayout(descriptors.materialVariableLayout);
+		layout.addDescriptorSetLayout(descriptors.bindlessTextureLayout);
+		layout.addPushConstantRange({ ShaderStageBit::VertexBit, 0, sizeof(uint32_t) });
+		layout.build();
+
+		RenderPassDesc passDesc{};
+		passDesc.colorAttachments.push_back({ ImageFormat::BGRA8, LoadOp::Clear, StoreOp::Store });
+		passDesc.hasDepth = true;
+		passDesc.depthAttachment = { ImageFormat::Depth32F, LoadOp::Clear, StoreOp::Store };
+		VulkanRenderPass renderPass(device, passDesc);
+
+		std::vector<PipelineManifestEntry> manifest;
+		manifest.push_back({ &layout, &renderPass, makeSceneDesc("shaders/forward_indirect.vert.spv", "shaders/forward.frag.spv", false) });
+		manifest.push_back({ &layout, &renderPass, makeSceneDesc("shaders/terrain.vert.spv", "shaders/forward.frag.spv", false) });
+
+		// each run gets a system of its own with persistence off, so neither finds the other's pipeline. nothing is
+		// submitted, so the queue can be drained before each system goes
+		DeletionQueue deletions;
+		{
+			PipelineSystem pipelines(device, deletions, "");
+			std::vector<PipelineHandle> prewarmed = pipelines.prewarm(manifest);
+			std::printf("prewarm                  %u pipelines on %u threads in %.3f ms\n", pipelines.getStats().prewarmed, pipelines.getStats().prewarmThreads, pipelines.getStats().prewarmMs);
+
+			FirstFrame inPlace = meetMaterial(pipelines, layout, renderPass, prewarmed[1], true);
+			std::printf("new material, in place   %.3f ms on the frame\n", inPlace.requestMs);
+
+			for (PipelineHandle handle : prewarmed)
+				pipelines.destroy(handle);
+			deletions.releaseAll();
+		}
+		{
+			PipelineSystem pipelines(device, deletions, "");
+			std::vector<PipelineHandle> prewarmed = pipelines.prewarm(manifest);
+			pipelines.setAsyncCompilation(true);
+
+			FirstFrame fallback = meetMaterial(pipelines, layout, renderPass, prewarmed[1], true);
+			std::printf("new material, fallback   %.3f ms on the frame, ready %u frames later after %.3f ms in the background\n", fallback.requestMs, fallback.framesUntilReady, pipelines.getStats().lastCompileMs);
+
+			for (PipelineHandle handle : prewarmed)
+				pipelines.destroy(handle);
+			deletions.releaseAll();
+		}
+	}
+
+	glfwDestroyWindow(window);
+	glfwTerminate();
+	return 0;
+}
@@ -0,0 +1,174 @@
+// Builds the scene pipeline variants once whole and once through PipelineSystem, which links them from library
+// parts when VK_EXT_graphics_pipeline_library is present, and reports creation time per pipeline for both.
+// Exits 0 with a SKIP line when the device has no pipeline library support, e.g. a lavapipe build without it.
+//
+// build, from Vortx/ with the shaders compiled to .spv next to their sources (glslc shaders/x -o shaders/x.spv),
+// and a renderSystem -> Signboard link in an include root for the RHI headers that still use that path:
+//   g++ -std=c++17 -O2 -I. bench/pipeline_library_bench.cpp Signboard/RHI/vulkan/*.cpp \
+//       Signboard/resources/*.cpp Signboard/resources/resourceSystems/*.cpp \
+//       Signboard/resources/resourceSystems/*/*.cpp Signboard/resources/scene/*.cpp \
+//       -lvulkan -lglfw -o pipeline_library_bench
+// run on lavapipe:
+//   VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json ./pipeline_library_bench
+
+#include "Signboard/RHI/vulkan/VulkanContext.h"
+#include "Signboard/RHI/vulkan/VulkanDevice.h"
+#include "Signboard/RHI/vulkan/VulkanRenderPass.h"
+#include "Signboard/RHI/vulkan/VulkanPipeline.h"
+#include "Signboard/RHI/vulkan/VulkanPipelineCache.h"
+#include "Signboard/RHI/vulkan/VulkanPipelineLayout.h"
+#include "Signboard/resources/ResourceAPI.h"
+
+#include "core/dataDef/Vertex.h"
+
+#include <GLFW/glfw3.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+static double elapsedMs(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// the renderer's scene pipelines, varied over the state each library part owns: the vertex shader for
+// pre-rasterisation, depth state for the fragment shader part and blending for the output interface
+static std::vector<PipelineDesc> makeVariants() {
+	VertexLayoutDesc layout{};
+	layout.bindings.push_back({ 0, sizeof(Vertex) });
+	layout.attributes.push_back({ 0, VertexFormat::Float3, offsetof(Vertex, pos) });
+	layout.attributes.push_back({ 1, VertexFormat::Float3, offsetof(Vertex, normal) });
+	layout.attributes.push_back({ 2, VertexFormat::Float3, offsetof(Vertex, color) });
+	layout.attributes.push_back({ 3, VertexFormat::Float2, offsetof(Vertex, texCoord) });
+	layout.attributes.push_back({ 4, VertexFormat::Float4, offsetof(Vertex, tangent) });
+
+	const char* vertexShaders[] = { "shaders/forward_indirect.vert.spv", "shaders/terrain.vert.spv" };
+	const RasterState rasterStates[] = { { true, true }, { true, false }, { false, false } };
+
+	std::vector<PipelineDesc> variants;
+	for (const char* vertexShader : vertexShaders)
+	for (const RasterState& raster : rasterStates)
+	for (bool blend : { false, true }) {
+		PipelineDesc desc{};
+		desc.type = PipelineType::Graphics;
+		desc.vertexLayout = layout;
+		desc.samples = RasterSamples::Raster_Samples_1;
+		desc.colorFormat = ImageFormat::BGRA8;
+		desc.depthForamt = ImageFormat::Depth32F;
+		desc.shaders.push_back({ ShaderStageBit::VertexBit, vertexShader });
+		desc.shaders.push_back({ ShaderStageBit::FragmentBit, "shaders/forward.frag.spv" });
+		desc.raster = raster;
+		desc.blend.enable = blend;
+		variants.push_back(desc);
+	}
+
+	return variants;
+}
+
+int main() {
+	if (!glfwInit()) {
+		std::printf("SKIP: no window system to create a surface on\n");
+		return 0;
+	}
+
+	glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	GLFWwindow* window = glfwCreateWindow(64, 64, "pipeline_library_bench", nullptr, nullptr);
+
+	int result = 0;
+	{
+		VulkanContext context(window);
+		VulkanDevice device(context.getInstance(), window);
+
+		if (!device.supportsPipelineLibrary()) {
+			std::printf("SKIP: VK_EXT_graphics_pipeline_library is not supported by this device\n");
+		}
+		else {
+			ResourceAPI resources(device);
+			SceneDescriptors descriptors = resources.getSceneView().descriptors;
+
+			VulkanPipelineLayout layout(device, VulkanPipelineLayoutDesc{});
+			layout.addDescriptorSetLayout(descriptors.viewStateLayout);
+			layout.addDescriptorSetLayout(descriptors.objectStateLayout);
+			layout.addDescriptorSetLayout(descriptors.materialVariableLayout);
+			layout.addDescriptorSetLayout(descriptors.bindlessTextureLayout);
+			layout.addPushConstantRange({ ShaderStageBit::VertexBit, 0, sizeof(uint32_t) });
+			layout.build();
+
+			RenderPassDesc passDesc{};
+			passDesc.colorAttachments.push_back({ ImageFormat::BGRA8, LoadOp::Clear, StoreOp::Store });
+			passDesc.hasDepth = true;
+			passDesc.depthAttachment = { ImageFormat::Depth32F, LoadOp::Clear, StoreOp::Store };
+			VulkanRenderPass renderPass(device, passDesc);
+
+			std::vector<PipelineDesc> variants = makeVariants();
+
+			// whole pipelines, each into an empty cache of its own so no variant reuses another's work
+			ShaderLibrary shaders(device);
+			double monolithicMs = 0.0;
+			for (const PipelineDesc& desc : variants) {
+				std::vector<const VulkanShaderModule*> modules;
+				for (const ShaderDesc& shader : desc.shaders)
+					modules.push_back(shaders.get(shader.path).module.get());
+
+				VulkanPipelineCache cache(device);
+				VulkanPipeline pipeline(device, cache);
+
+				auto start = std::chrono::steady_clock::now();
+				pipeline.build(renderPass, layout, desc, modules);
+				monolithicMs += elapsedMs(start);
+			}
+
+			// an empty cache path keeps the system from loading or writing pipeline_cache.bin
+			DeletionQueue deletions;
+			PipelineSystem pipelines(device, deletions, "");
+			pipelines.setAsyncCompilation(true, 2);
+
+			std::vector<PipelineHandle> handles;
+			std::vector<double> requestMs;
+			for (const PipelineDesc& desc : variants) {
+				auto start = std::chrono::steady_clock::now();
+				handles.push_back(pipelines.getOrCreatePipleine(layout, desc, renderPass));
+				requestMs.push_back(elapsedMs(start));
+				pipelines.collectCompiled();
+			}
+
+			// the optimised relinks run on the workers, wait them out so their count is final
+			auto relinkStart = std::chrono::steady_clock::now();
+			while (pipelines.getStats().pending > 0)
+				pipelines.collectCompiled();
+			double relinkMs = elapsedMs(relinkStart);
+
+			const PipelineSystemStats& stats = pipelines.getStats();
+			double firstMs = requestMs.front();
+			double restMs = 0.0;
+			for (size_t i = 1; i < requestMs.size(); i++)
+				restMs += requestMs[i];
+
+			std::printf("variants                 %zu\n", variants.size());
+			std::printf("fast linking             %s\n", device.supportsPipelineLibraryFastLinking() ? "yes" : "no");
+			std::printf("monolithic               %.3f ms/pipeline\n", monolithicMs / variants.size());
+			std::printf("library, first request   %.3f ms (compiles all four parts)\n", firstMs);
+			std::printf("library, later requests  %.3f ms/pipeline\n", restMs / (requestMs.size() - 1));
+			std::printf("library parts            %u\n", stats.libraryParts);
+			std::printf("fast links               %u, last %.3f ms\n", stats.fastLinks, stats.lastFastLinkMs);
+			std::printf("optimised relinks        %u, drained in %.3f ms\n", stats.optimizedLinks, relinkMs);
+
+			for (PipelineHandle handle : handles) {
+				if (!pipelines.isReady(handle)) {
+					std::printf("FAIL: a requested pipeline never became ready\n");
+					result = 1;
+				}
+				pipelines.destroy(handle);
+			}
+
+			device.waitIdle();
+			deletions.releaseAll();
+		}
+	}
+
+	glfwDestroyWindow(window);
+	glfwTerminate();
+	return result;
+}
@@ -0,0 +1,138 @@
+// Compiles a deferred-style frame and the XML routine through RenderGraph and reports what compile saves against
+// a naive baseline of one barrier per declared access and one allocation per transient image: culled passes,
+// barrier batches, transitions and the transient memory left after aliasing. The frame also has two compute
+// passes, so on a device with a separate compute family it reports the async split as well.
+//
+// build, from Vortx/ with a renderSystem -> Signboard link in an include root for the RHI headers that still use
+// that path:
+//   g++ -std=c++17 -O2 -I. bench/render_graph_bench.cpp Signboard/RHI/vulkan/*.cpp \
+//       Signboard/RendererCore/RenderGraph/*.cpp configLoader/*.cpp configLoader/XMLLoader/*.cpp \
+//       -lvulkan -lglfw -o render_graph_bench
+// run, from Vortx/ so the routine path resolves, e.g. on lavapipe:
+//   VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json ./render_graph_bench
+
+#include "Signboard/RHI/vulkan/VulkanContext.h"
+#include "Signboard/RHI/vulkan/VulkanDevice.h"
+#include "Signboard/RHI/vulkan/VulkanBuffer.h"
+#include "Signboard/RendererCore/RenderGraph/RenderGraph.h"
+#include "Signboard/RendererCore/RenderGraph/RoutineGraph.h"
+
+#include "configLoader/ConfigLoader.h"
+
+#include <GLFW/glfw3.h>
+
+#include <cstdio>
+
+static void printStats(const char* name, const RenderGraph& graph) {
+	const RenderGraphStats& stats = graph.getStats();
+
+	std::printf("%s\n", name);
+	std::printf("  passes                 %u, %u culled\n", stats.passCount, stats.culledPasses);
+	std::printf("  edges                  %u\n", stats.edgeCount);
+	std::printf("  barriers               %u batches, %u image transitions, naive %u\n", stats.barrierBatches, stats.imageTransitions, stats.naiveBarriers);
+	std::printf("  transient memory       %.2f MiB in %u slots, naive %.2f MiB for %u images\n", stats.aliasedBytes / (1024.0 * 1024.0), stats.aliasSlots, stats.transientBytes / (1024.0 * 1024.0), stats.transientImages);
+	std::printf("  queues                 %u submits, %u async passes, %u waits, %u ownership transfers\n", stats.queueSubmits, stats.asyncPasses, stats.semaphoreWaits, stats.ownershipTransfers);
+}
+
+// geometry into a g-buffer, a debug view nothing reads, lighting, a compute bloom and the composite. the light
+// binning pass reads the depth on compute and writes an imported buffer the lighting reads
+static void compileDeferredFrame(VulkanDevice& device) {
+	RenderGraph graph(device, 2);
+
+	BufferDesc lightDesc{};
+	lightDesc.size = 64 * 1024;
+	lightDesc.usageFlags.set(BufferUsage::Storage);
+	lightDesc.memoryFlags = MemoryProperty::DeviceLocal;
+	VulkanBuffer lights(device, lightDesc);
+
+	TransientImage gbuffer = graph.createImage({ "gbuffer", 1920, 1080, ImageFormat::RGBA16F, ImageUsage::ColorAttachment });
+	TransientImage depth = graph.createImage({ "depth", 1920, 1080, ImageFormat::Depth32F, ImageUsage::DepthAttachment });
+	TransientImage debug = graph.createImage({ "debug", 1920, 1080, ImageFormat::RGBA8, ImageUsage::ColorAttachment });
+	TransientImage lit = graph.createImage({ "lit", 1920, 1080, ImageFormat::RGBA16F, ImageUsage::ColorAttachment });
+	TransientImage bloom = graph.createImage({ "bloom", 1920, 1080, ImageFormat::RGBA16F, ImageUsage::Storage });
+
+	PipelineStageFlags depthStages;
+	depthStages.set(PipelineStage::EarlyDepthTest, PipelineStage::LateDepthTest);
+	ResourceAccessFlags depthAccess;
+	depthAccess.set(ResourceAccess::DepthStencilRead, ResourceAccess::DepthStencilWrite);
+
+	auto nothing = [](VulkanCommandBuffer&) {};
+
+	Pass& geometry = graph.addPass({ "Geometry" });
+	geometry.transientAccess.push_back({ gbuffer, PipelineStage::ColorAttachmentOutput, ResourceAccess::ColorAttachmentWrite });
+	geometry.transientAccess.push_back({ depth, depthStages, depthAccess });
+	geometry.execute = nothing;
+
+	Pass& debugView = graph.addPass({ "Debug" });
+	debugView.transientAccess.push_back({ debug, PipelineStage::ColorAttachmentOutput, ResourceAccess::ColorAttachmentWrite });
+	debugView.execute = nothing;
+
+	Pass& binning = graph.addPass({ "LightBinning" });
+	binning.computeCapable = true;
+	binning.transientAccess.push_back({ depth, PipelineStage::ComputeShader, ResourceAccess::ShaderRead });
+	binning.bufferAccess.push_back({ &lights, PipelineStage::ComputeShader, ResourceAccess::ShaderWrite });
+	binning.execute = nothing;
+
+	Pass& lighting = graph.addPass({ "Lighting" });
+	lighting.transientAccess.push_back({ gbuffer, PipelineStage::FragmentShader, ResourceAccess::ShaderRead });
+	lighting.transientAccess.push_back({ depth, PipelineStage::FragmentShader, ResourceAccess::ShaderRead });
+	lighting.transientAccess.push_back({ lit, PipelineStage::ColorAttachmentOutput, ResourceAccess::ColorAttachmentWrite });
+	lighting.bufferAccess.push_back({ &lights, PipelineStage::FragmentShader, ResourceAccess::ShaderRead });
+	lighting.execute = nothing;
+
+	Pass& bloomPass = graph.addPass({ "Bloom" });
+	bloomPass.computeCapable = true;
+	bloomPass.transientAccess.push_back({ lit, PipelineStage::ComputeShader, ResourceAccess::ShaderRead });
+	bloomPass.transientAccess.push_back({ bloom, PipelineStage::ComputeShader, ResourceAccess::ShaderWrite });
+	bloomPass.execute = nothing;
+
+	Pass& composite = graph.addPass({ "Composite" });
+	composite.transientAccess.push_back({ bloom, PipelineStage::FragmentShader, ResourceAccess::ShaderRead });
+	composite.sideEffects = true;
+	composite.execute = nothing;
+
+	graph.compile();
+	printStats("deferred frame", graph);
+	graph.reset();
+}
+
+// the routine the renderer config describes, declared through the same path a routine driven renderer takes
+static void compileRoutine(VulkanDevice& device, const char* path) {
+	ConfigLoader config(path);
+	RenderRoutine routine = config.BuildRoutine();
+
+	std::unordered_map<std::string, RoutinePassExecute> executors;
+	for (const RoutinePass& pass : routine.passes)
+		executors[pass.name] = [](VulkanCommandBuffer&, const RoutinePass&) {};
+
+	RenderGraph graph(device, 2);
+	addRoutineToGraph(graph, routine, { 1920, 1080 }, executors);
+
+	graph.compile();
+	printStats(routine.name.c_str(), graph);
+	graph.reset();
+}
+
+int main() {
+	if (!glfwInit()) {
+		std::printf("SKIP: no window system to create a surface on\n");
+		return 0;
+	}
+
+	glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	GLFWwindow* window = glfwCreateWindow(64, 64, "render_graph_bench", nullptr, nullptr);
+
+	{
+		VulkanContext context(window);
+		VulkanDevice device(context.getInstance(), window);
+
+		std::printf("async compute queue      %s\n", device.hasAsyncComputeQueue() ? "yes" : "no");
+		compileDeferredFrame(device);
+		compileRoutine(device, "configLoader/renderConfig/routine_1.xml");
+	}
+
+	glfwDestroyWindow(window);
+	glfwTerminate();
+	return 0;
+}
@@ -0,0 +1,279 @@
+// Generates a pipeline manifest of tens of thousands of entries and reports load and parse throughput, in MB/s
+// and nodes/s, for XMLConfigLoader against the getline / std::string parser it replaced, kept below as the
+// baseline. Also times keyed lookups of every entry through XMLChildIndex.
+//
+// build and run, from Vortx/:
+//   g++ -std=c++17 -O2 -I. bench/xml_parse_bench.cpp configLoader/XMLLoader/*.cpp -o xml_parse_bench
+//   ./xml_parse_bench [entries]
+
+#include "configLoader/XMLLoader/XMLConfigLoader.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// the parser before the in-place rewrite: every name and value an std::string, every node owning its children
+namespace legacy {
+
+struct XMLAttribute {
+	std::string name;
+	std::string value;
+};
+
+struct XMLNode {
+	std::string name;
+	std::vector<XMLAttribute> attributes;
+	std::vector<XMLNode> children;
+};
+
+class XMLConfigLoader {
+public:
+	std::string readFile(const std::string& path) {
+		std::ifstream file(path);
+		if (!file.is_open())
+			throw std::runtime_error("failed to load config file!");
+
+		std::string content, line;
+		while (std::getline(file, line)) {
+			content += line;
+			content += '\n';
+		}
+		return content;
+	}
+
+	XMLNode Parse(const std::string& text) {
+		m_text = text;
+		m_pos = 0;
+		SkipWhitespace();
+		return ParseNode();
+	}
+
+private:
+	char Peek() const { return m_text[m_pos]; }
+	char Get() { return m_text[m_pos++]; }
+
+	void SkipWhitespace() {
+		while (m_pos < m_text.size() && isspace(Peek()))
+			m_pos++;
+	}
+
+	XMLNode ParseNode() {
+		if (Get() != '<')
+			throw std::runtime_error("Expected '<'");
+
+		XMLNode node;
+		node.name = ParseIdentifier();
+		node.attributes = ParseAttributes();
+
+		if (StartsWith("/>")) {
+			m_pos += 2;
+			return node;
+		}
+
+		if (Get() != '>')
+			throw std::runtime_error("Expected '>'");
+
+		while (true) {
+			SkipWhitespace();
+
+			if (StartsWith("</")) {
+				m_pos += 2;
+				std::string endName = ParseIdentifier();
+				if (endName != node.name)
+					throw std::runtime_error("Mismatched closing tag");
+
+				SkipWhitespace();
+				Get();
+				break;
+			}
+
+			if (Peek() == '<')
+				node.children.push_back(ParseNode());
+			else
+				Get();
+		}
+
+		return node;
+	}
+
+	std::string ParseIdentifier() {
+		SkipWhitespace();
+		std::string id;
+
+		while (m_pos < m_text.size()) {
+			char c = Peek();
+			if (isalnum(c) || c == '_' || c == '-')
+				id += Get();
+			else
+				break;
+		}
+
+		return id;
+	}
+
+	std::vector<XMLAttribute> ParseAttributes() {
+		std::vector<XMLAttribute> attrs;
+
+		while (true) {
+			SkipWhitespace();
+
+			if (Peek() == '/' || Peek() == '>')
+				break;
+
+			XMLAttribute attr;
+			attr.name = ParseIdentifier();
+
+			SkipWhitespace();
+			if (Get() != '=')
+				throw std::runtime_error("Expected '='");
+
+			attr.value = ParseQuotedString();
+			attrs.push_back(attr);
+		}
+
+		return attrs;
+	}
+
+	std::string ParseQuotedString() {
+		SkipWhitespace();
+		if (Get() != '"')
+			throw std::runtime_error("Expected '\"'");
+
+		std::string value;
+		while (Peek() != '"')
+			value += Get();
+
+		Get();
+		return value;
+	}
+
+	bool StartsWith(const std::string& s) const {
+		return m_text.compare(m_pos, s.size(), s) == 0;
+	}
+
+private:
+	std::string m_text;
+	size_t m_pos = 0;
+};
+
+static size_t countNodes(const XMLNode& node) {
+	size_t count = 1;
+	for (const XMLNode& child : node.children)
+		count += countNodes(child);
+	return count;
+}
+
+}
+
+static double elapsedMs(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// one pipeline entry per shader pair and state, each with a few defines, the shape a material manifest takes
+static std::string makeManifest(uint32_t entries) {
+	const char* cullModes[] = { "back", "front", "none" };
+
+	std::string text = "<PipelineManifest version=\"1\">\n";
+	for (uint32_t i = 0; i < entries; i++) {
+		text += "    <Pipeline name=\"material_" + std::to_string(i) + "\" type=\"Graphics\"";
+		text += " vertex=\"shaders/variant_" + std::to_string(i % 64) + ".vert.spv\"";
+		text += " fragment=\"shaders/variant_" + std::to_string(i % 128) + ".frag.spv\"";
+		text += std::string(" cull=\"") + cullModes[i % 3] + "\" blend=\"" + (i % 4 == 0 ? "true" : "false") + "\">\n";
+		text += "        <Define name=\"MATERIAL_ID\" value=\"" + std::to_string(i) + "\"/>\n";
+		text += "        <Define name=\"USE_NORMAL_MAP\" value=\"" + std::to_string(i % 2) + "\"/>\n";
+		text += "        <RenderPass ref=\"Forward\"/>\n";
+		text += "    </Pipeline>\n";
+	}
+	text += "</PipelineManifest>\n";
+
+	return text;
+}
+
+struct Result {
+	double loadMs = 1e30;
+	double parseMs = 1e30;
+	size_t nodes = 0;
+};
+
+static void report(const char* name, const Result& result, size_t bytes) {
+	double mb = bytes / (1024.0 * 1024.0);
+	std::printf("%s\n", name);
+	std::printf("  parse                  %.3f ms, %.1f MB/s, %.2f M nodes/s\n", result.parseMs, mb / (result.parseMs / 1000.0), result.nodes / (result.parseMs / 1000.0) / 1e6);
+	std::printf("  load (read + parse)    %.3f ms, %.1f MB/s\n", result.loadMs, mb / (result.loadMs / 1000.0));
+}
+
+int main(int argc, char** argv) {
+	uint32_t entries = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 50000;
+	const int runs = 5;
+
+	std::string text = makeManifest(entries);
+	std::string path = (std::filesystem::temp_directory_path() / "xml_parse_bench.xml").string();
+	{
+		std::ofstream file(path, std::ios::binary);
+		file << text;
+	}
+
+	std::printf("manifest                 %u entries, %.2f MB\n", entries, text.size() / (1024.0 * 1024.0));
+
+	// best of a few runs, the first one also pays for faulting the file into the page cache
+	Result old;
+	for (int run = 0; run < runs; run++) {
+		legacy::XMLConfigLoader loader;
+
+		auto start = std::chrono::steady_clock::now();
+		legacy::XMLNode root = loader.Parse(text);
+		old.parseMs = std::min(old.parseMs, elapsedMs(start));
+		old.nodes = legacy::countNodes(root);
+
+		start = std::chrono::steady_clock::now();
+		legacy::XMLNode loaded = loader.Parse(loader.readFile(path));
+		old.loadMs = std::min(old.loadMs, elapsedMs(start));
+	}
+
+	Result current;
+	double lookupMs = 1e30;
+	size_t found = 0;
+	for (int run = 0; run < runs; run++) {
+		XMLConfigLoader loader;
+
+		// Parse keeps its text, the copy is made outside the timing as Load hands over the read buffer
+		std::string copy = text;
+		auto start = std::chrono::steady_clock::now();
+		const XMLNode& root = loader.Parse(std::move(copy));
+		current.parseMs = std::min(current.parseMs, elapsedMs(start));
+		current.nodes = loader.getNodeCount();
+
+		start = std::chrono::steady_clock::now();
+		XMLChildIndex index(root, "name");
+		found = 0;
+		for (uint32_t i = 0; i < entries; i++)
+			found += index.Find("material_" + std::to_string(i)) != nullptr;
+		lookupMs = std::min(lookupMs, elapsedMs(start));
+
+		start = std::chrono::steady_clock::now();
+		loader.Load(path);
+		current.loadMs = std::min(current.loadMs, elapsedMs(start));
+	}
+
+	std::filesystem::remove(path);
+
+	report("getline / std::string", old, text.size());
+	report("in place", current, text.size());
+	std::printf("parse speedup            %.2fx\n", old.parseMs / current.parseMs);
+	std::printf("load speedup             %.2fx\n", old.loadMs / current.loadMs);
+	std::printf("keyed lookups            %zu of %u found, index and lookups in %.3f ms\n", found, entries, lookupMs);
+
+	if (current.nodes != old.nodes || found != entries) {
+		std::printf("FAIL: %zu nodes against %zu from the old parser\n", current.nodes, old.nodes);
+		return 1;
+	}
+
+	return 0;
+}
@@ -1,21 +1,88 @@
 #include "ConfigLoader.h"
 
+#include <stdexcept>
+
+static ImageFormat parseImageFormat(std::string_view value) {
+	if (value == "RGBA8")	return ImageFormat::RGBA8;
+	if (value == "BGRA8")	return ImageFormat::BGRA8;
+	if (value == "RGBA16F")	return ImageFormat::RGBA16F;
+	if (value == "D24S8")	return ImageFormat::Depth24Stencil8;
+	if (value == "D32")		return ImageFormat::Depth32F;
+	if (value == "R32F")	return ImageFormat::R32F;
+
+	throw std::runtime_error("unknown image format in render routine: " + std::string(value));
+}
+
+static ImageUsageFlags parseImageUsage(std::string_view value) {
+	ImageUsageFlags usage;
+
+	size_t begin = 0;
+	while (begin <= value.size()) {
+		size_t end = value.find('|', begin);
+		if (end == std::string_view::npos) end = value.size();
+
+		std::string_view token = value.substr(begin, end - begin);
+		if (token == "Color")			usage.set(ImageUsage::ColorAttachment);
+		else if (token == "Depth")		usage.set(ImageUsage::DepthAttachment);
+		else if (token == "Sampled")	usage.set(ImageUsage::Sampled);
+		else if (token == "Storage")	usage.set(ImageUsage::Storage);
+		else throw std::runtime_error("unknown image usage in render routine: " + std::string(token));
+
+		begin = end + 1;
+	}
+	return usage;
+}
+
 ConfigLoader::ConfigLoader(const std::string& path) {
-	std::string file_obj = xml.readFile(path);
-	data_root = xml.Parse(file_obj);
+	data_root = &xml.Load(path);
+}
+
+std::string_view ConfigLoader::RequireAttr(const XMLNode& node, std::string_view name) {
+	const XMLAttribute* attr = xml.FindAttr(node, name);
+	if (!attr)
+		throw std::runtime_error("render routine node " + std::string(node.name) + " is missing attribute: " + std::string(name));
+	return attr->value;
 }
 
 RenderRoutine ConfigLoader::BuildRoutine(const XMLNode& root) {
 	RenderRoutine routine;
-	routine.name = xml.FindAttr(root, "name")->value;
-
-	const XMLNode* resources = xml.FindChild(root, "Resources");
-	for (auto& img : resources->children) {
-		PassImage image;
-		image.name = img.name;
-		image.format = xml.FindAttr(img, "format")->value.c_str();
-		image.usage = xml.FindAttr(img, "usage")->value.c_str();
-		routine.images.push_back(image);
+	routine.name = RequireAttr(root, "name");
+
+	for (auto& section : root.children) {
+		if (section.name == "Resources") {
+			for (auto& img : section.children) {
+				PassImage image;
+				image.name = RequireAttr(img, "name");
+				image.format = parseImageFormat(RequireAttr(img, "format"));
+				image.usage = parseImageUsage(RequireAttr(img, "usage"));
+				routine.images.push_back(image);
+			}
+		}
+		else if (section.name == "Passes") {
+			for (auto& node : section.children) {
+				RoutinePass pass;
+				pass.name = RequireAttr(node, "name");
+
+				const XMLAttribute* type = xml.FindAttr(node, "type");
+				if (type && type->value == "Compute")
+					pass.type = RoutinePassType::Compute;
+
+				for (auto& child : node.children) {
+					if (child.name == "Attachments") {
+						for (auto& attachment : child.children) {
+							if (attachment.name == "Color")
+								pass.colorAttachments.emplace_back(RequireAttr(attachment, "ref"));
+							else if (attachment.name == "Depth")
+								pass.depthAttachment = RequireAttr(attachment, "ref");
+						}
+					}
+					else if (child.name == "Pipeline") {
+						pass.pipeline = RequireAttr(child, "ref");
+					}
+				}
+				routine.passes.push_back(pass);
+			}
+		}
 	}
 
 	return routine;
@@ -4,12 +4,17 @@
 #include "ReadTypes/EngineReadTypes.h"
 
 class ConfigLoader {
+public:
 	ConfigLoader(const std::string& path);
 
 	RenderRoutine BuildRoutine(const XMLNode& node);
+	RenderRoutine BuildRoutine() { return BuildRoutine(*data_root); }
+
+private:
+	std::string_view RequireAttr(const XMLNode& node, std::string_view name);
 
 private:
 	XMLConfigLoader xml;
 
-	XMLNode data_root;
+	const XMLNode* data_root = nullptr;
 };
\ No newline at end of file
@@ -1,7 +1,6 @@
 #pragma once
 
 #include "Signboard/RHI/common/ImageTypes.h"
-#include "Signboard/RHI/Common/RenderPassTypes.h"
 
 #include <vector>
 #include <string>
@@ -9,19 +8,24 @@
 struct PassImage{
 	std::string name;
 	ImageFormat format;
-	ImageUsage usage;
+	ImageUsageFlags usage;
 };
 
-struct Pass {
+enum class RoutinePassType {
+	Graphics,
+	Compute
+};
+
+struct RoutinePass {
 	std::string name;
-	//PassType type;
-	std::vector<std::string> colorAttachment;
-	std::vector<std::string> depthAttachment;
+	RoutinePassType type = RoutinePassType::Graphics;
+	std::vector<std::string> colorAttachments;
+	std::string depthAttachment;
 	std::string pipeline;
 };
 
 struct RenderRoutine {
 	std::string name;
 	std::vector<PassImage> images;
-	std::vector<Pass> passes;
+	std::vector<RoutinePass> passes;
 };
\ No newline at end of file
@@ -0,0 +1,44 @@
+#include "XMLArena.h"
+
+#include <algorithm>
+
+XMLArena::XMLArena(size_t blockSize)
+	: blockSize(blockSize)
+{
+}
+
+void XMLArena::reset() {
+	if (blocks.size() > 1) {
+		auto largest = std::max_element(blocks.begin(), blocks.end(), [](const Block& a, const Block& b) { return a.size < b.size; });
+		Block kept = std::move(*largest);
+		blocks.clear();
+		blocks.push_back(std::move(kept));
+	}
+
+	offset = 0;
+	usedBytes = 0;
+	reservedBytes = blocks.empty() ? 0 : blocks.front().size;
+}
+
+void* XMLArena::allocateBytes(size_t size, size_t alignment) {
+	if (!blocks.empty()) {
+		Block& block = blocks.back();
+		size_t aligned = (offset + alignment - 1) & ~(alignment - 1);
+		if (aligned + size <= block.size) {
+			offset = aligned + size;
+			usedBytes += size;
+			return block.data.get() + aligned;
+		}
+	}
+
+	// new[] storage is aligned for any fundamental type, oversized requests get a block of their own
+	Block block;
+	block.size = std::max(blockSize, size);
+	block.data = std::make_unique<std::byte[]>(block.size);
+	reservedBytes += block.size;
+
+	offset = size;
+	usedBytes += size;
+	blocks.push_back(std::move(block));
+	return blocks.back().data.get();
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <type_traits>
+
+// bump allocator for parsed nodes and attributes. nothing is destroyed individually, the blocks go with the arena
+class XMLArena {
+public:
+	explicit XMLArena(size_t blockSize = 64 * 1024);
+
+	XMLArena(const XMLArena&) = delete;
+	XMLArena& operator=(const XMLArena&) = delete;
+
+	template<typename T>
+	T* allocate(size_t count) {
+		static_assert(std::is_trivially_destructible_v<T>, "arena entries are never destroyed");
+		return static_cast<T*>(allocateBytes(sizeof(T) * count, alignof(T)));
+	}
+
+	// keeps the largest block for the next parse
+	void reset();
+
+	size_t getUsedBytes() const { return usedBytes; }
+	size_t getReservedBytes() const { return reservedBytes; }
+
+private:
+	void* allocateBytes(size_t size, size_t alignment);
+
+private:
+	struct Block {
+		std::unique_ptr<std::byte[]> data;
+		size_t size = 0;
+	};
+
+	size_t blockSize;
+	std::vector<Block> blocks;
+	size_t offset = 0;
+
+	size_t usedBytes = 0;
+	size_t reservedBytes = 0;
+};
\ No newline at end of file
@@ -1,32 +1,59 @@
 #include "XMLConfigLoader.h"
 
 #include <fstream>
+#include <cstring>
+#include <stdexcept>
+
+static bool isSpace(char c)
+{
+	return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+static bool isNameChar(char c)
+{
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '-' || c == ':' || c == '.';
+}
 
 std::string XMLConfigLoader::readFile(const std::string& path) 
 {
-	std::ifstream file(path);
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
 	if (!file.is_open())
 		throw std::runtime_error("failed to load config file!");
 
-	std::string content, line;
-	while (std::getline(file, line)) {
-		content += line;
-		content += '\n';
-	}
+	std::streamsize size = file.tellg();
+	std::string content(static_cast<size_t>(size), '\0');
+
+	file.seekg(0);
+	if (size > 0 && !file.read(content.data(), size))
+		throw std::runtime_error("failed to read config file!");
+
 	return content;
 }
 
-XMLNode XMLConfigLoader::Parse(const std::string& text) 
+const XMLNode& XMLConfigLoader::Parse(std::string text) 
 {
-	m_text = text;
-	m_pos = 0;
+	m_text = std::move(text);
+	m_cur = m_text.data();
+	m_end = m_text.data() + m_text.size();
+
+	m_arena.reset();
+	m_pendingNodes.clear();
+	m_pendingAttributes.clear();
+	m_nodeCount = 0;
+
 	SkipWhitespace();
-	return ParseNode();
+	while (StartsWith("<?") || StartsWith("<!")) {
+		SkipMarkup();
+		SkipWhitespace();
+	}
+
+	m_root = ParseNode();
+	return m_root;
 }
 
 const XMLAttribute* XMLConfigLoader::FindAttr(
 	const XMLNode&		node, 
-	const std::string&	name) 
+	std::string_view	name) const
 {
 	for (auto& a : node.attributes)
 		if (a.name == name)
@@ -34,84 +61,123 @@ const XMLAttribute* XMLConfigLoader::FindAttr(
 	return nullptr;
 }
 
-const XMLNode* XMLConfigLoader::FindChild(const XMLNode& node, const std::string& name)
+const XMLNode* XMLConfigLoader::FindChild(const XMLNode& node, std::string_view name) const
 {
-	for (auto& c : node.children) {
+	for (auto& c : node.children)
 		if (c.name == name)
 			return &c;
-		return nullptr;
-	}
+	return nullptr;
 }
 
 void XMLConfigLoader::SkipWhitespace() 
 {
-	while (m_pos < m_text.size() && isspace(Peek()))
-		m_pos++;
+	while (m_cur < m_end && isSpace(Peek()))
+		m_cur++;
+}
+
+void XMLConfigLoader::SkipMarkup()
+{
+	// comments, declarations and processing instructions carry nothing the loaders read
+	std::string_view rest(m_cur, m_end - m_cur);
+	std::string_view terminator = StartsWith("<!--") ? "-->" : StartsWith("<?") ? "?>" : ">";
+
+	size_t end = rest.find(terminator);
+	if (end == std::string_view::npos)
+		throw std::runtime_error("Unterminated markup");
+
+	m_cur += end + terminator.size();
+}
+
+template<typename T>
+XMLRange<T> XMLConfigLoader::Commit(std::vector<T>& pending, size_t base)
+{
+	XMLRange<T> range;
+	range.count = static_cast<uint32_t>(pending.size() - base);
+	if (range.count) {
+		range.data = m_arena.allocate<T>(range.count);
+		std::memcpy(range.data, pending.data() + base, sizeof(T) * range.count);
+	}
+
+	pending.resize(base);
+	return range;
 }
 
 XMLNode XMLConfigLoader::ParseNode() 
 {
-	if (Get() != '<')
+	if (m_cur >= m_end || Get() != '<')
 		throw std::runtime_error("Expected '<'");
 
 	XMLNode node;
 	node.name = ParseIdentifier();
+	if (node.name.empty())
+		throw std::runtime_error("Expected element name");
+
 	node.attributes = ParseAttributes();
+	m_nodeCount++;
 
 	if (StartsWith("/>")) {
-		m_pos += 2;
+		m_cur += 2;
 		return node;
 	}
 
 	if (Get() != '>')
 		throw std::runtime_error("Expected '>'");
 
+	size_t base = m_pendingNodes.size();
+
 	while (true) {
-		SkipWhitespace();
+		// text content is not kept, the next tag is all that matters
+		const void* tag = std::memchr(m_cur, '<', m_end - m_cur);
+		if (!tag)
+			throw std::runtime_error("Unterminated element: " + std::string(node.name));
+		m_cur = static_cast<const char*>(tag);
 
 		if (StartsWith("</")) {
-			m_pos += 2;
-			std::string endName = ParseIdentifier();
+			m_cur += 2;
+			std::string_view endName = ParseIdentifier();
 			if (endName != node.name)
 				throw std::runtime_error("Mismatched closing tag");
 
 			SkipWhitespace();
-			Get();
+			if (m_cur >= m_end || Get() != '>')
+				throw std::runtime_error("Expected '>'");
 			break;
 		}
 
-		if (Peek() == '<')
-			node.children.push_back(ParseNode());
-		else
-			Get();
+		if (StartsWith("<!") || StartsWith("<?")) {
+			SkipMarkup();
+			continue;
+		}
+
+		// a child's own children are committed before it returns, so the pending run above base is this node's
+		XMLNode child = ParseNode();
+		m_pendingNodes.push_back(child);
 	}
 
+	node.children = Commit(m_pendingNodes, base);
 	return node;
 }
 
-std::string XMLConfigLoader::ParseIdentifier() 
+std::string_view XMLConfigLoader::ParseIdentifier() 
 {
 	SkipWhitespace();
-	std::string id;
 
-	while (m_pos < m_text.size()) {
-		char c = Peek();
-		if (isalnum(c) || c == '_' || c == '-')
-			id += Get();
-		else
-			break;
-	}
+	const char* start = m_cur;
+	while (m_cur < m_end && isNameChar(Peek()))
+		m_cur++;
 
-	return id;
+	return std::string_view(start, m_cur - start);
 }
 
-std::vector<XMLAttribute> XMLConfigLoader::ParseAttributes() 
+XMLRange<XMLAttribute> XMLConfigLoader::ParseAttributes() 
 {
-	std::vector<XMLAttribute> attrs;
+	size_t base = m_pendingAttributes.size();
 
 	while (true) {
 		SkipWhitespace();
 
+		if (m_cur >= m_end)
+			throw std::runtime_error("Unexpected end of document");
 		if (Peek() == '/' || Peek() == '>')
 			break;
 
@@ -119,31 +185,52 @@ std::vector<XMLAttribute> XMLConfigLoader::ParseAttributes()
 		attr.name = ParseIdentifier();
 
 		SkipWhitespace();
-		if (Get() != '=')
+		if (m_cur >= m_end || Get() != '=')
 			throw std::runtime_error("Expected '='");
 
 		attr.value = ParseQuotedString();
-		attrs.push_back(attr);
+		m_pendingAttributes.push_back(attr);
 	}
 
-	return attrs;
+	return Commit(m_pendingAttributes, base);
 }
 
-std::string XMLConfigLoader::ParseQuotedString() 
+std::string_view XMLConfigLoader::ParseQuotedString() 
 {
 	SkipWhitespace();
-	if (Get() != '"')
+	if (m_cur >= m_end || (Peek() != '"' && Peek() != '\''))
 		throw std::runtime_error("Expected '\"'");
 
-	std::string value;
-	while (Peek() != '"')
-		value += Get();
+	char quote = Get();
+	const void* close = std::memchr(m_cur, quote, m_end - m_cur);
+	if (!close)
+		throw std::runtime_error("Unterminated attribute value");
 
-	Get();
+	std::string_view value(m_cur, static_cast<const char*>(close) - m_cur);
+	m_cur = static_cast<const char*>(close) + 1;
 	return value;
 }
 
-bool XMLConfigLoader::StartsWith(const std::string& s) const 
+bool XMLConfigLoader::StartsWith(std::string_view s) const 
+{
+	return static_cast<size_t>(m_end - m_cur) >= s.size() && std::memcmp(m_cur, s.data(), s.size()) == 0;
+}
+
+XMLChildIndex::XMLChildIndex(const XMLNode& node, std::string_view keyAttribute)
+{
+	m_entries.reserve(node.children.size());
+
+	// the first entry wins, children without the key are not indexed
+	for (auto& child : node.children)
+		for (auto& attr : child.attributes)
+			if (attr.name == keyAttribute) {
+				m_entries.emplace(attr.value, &child);
+				break;
+			}
+}
+
+const XMLNode* XMLChildIndex::Find(std::string_view key) const
 {
-	return m_text.compare(m_pos, s.size(), s) == 0;
+	auto it = m_entries.find(key);
+	return it != m_entries.end() ? it->second : nullptr;
 }
\ No newline at end of file
@@ -1,32 +1,69 @@
 #pragma once
 
 #include "XMLReadTypes/XMLTypes.h"
+#include "XMLArena.h"
 
 #include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
 
+// parses in place: names and values are views into the loaded text, nodes and attributes come from the arena
+// as one contiguous run per parent so they can be indexed directly.
 class XMLConfigLoader {
 public:
 	std::string readFile(const std::string& path);
-	XMLNode Parse(const std::string& text);
 
-	const XMLAttribute* FindAttr(const XMLNode& node, const std::string& name);
-	const XMLNode* FindChild(const XMLNode& node, const std::string& name);
+	// the loader keeps the text, a later parse invalidates the previous tree
+	const XMLNode& Parse(std::string text);
+	const XMLNode& Load(const std::string& path) { return Parse(readFile(path)); }
+
+	const XMLAttribute* FindAttr(const XMLNode& node, std::string_view name) const;
+	const XMLNode* FindChild(const XMLNode& node, std::string_view name) const;
+
+	size_t getNodeCount() const { return m_nodeCount; }
+	const XMLArena& getArena() const { return m_arena; }
 
 private:
-	char Peek() const { return m_text[m_pos]; }
-	char Get() { return m_text[m_pos++]; }
+	char Peek() const { return *m_cur; }
+	char Get() { return *m_cur++; }
 
 	void SkipWhitespace();
+	void SkipMarkup();
 
 	XMLNode ParseNode();
 
-	std::string ParseIdentifier();
-	std::vector<XMLAttribute> ParseAttributes();
-	std::string ParseQuotedString();
+	std::string_view ParseIdentifier();
+	XMLRange<XMLAttribute> ParseAttributes();
+	std::string_view ParseQuotedString();
+
+	bool StartsWith(std::string_view s) const;
 
-	bool StartsWith(const std::string& s) const;
+	template<typename T>
+	XMLRange<T> Commit(std::vector<T>& pending, size_t base);
 
 private:
 	std::string m_text;
-	size_t m_pos = 0;
+	const char* m_cur = nullptr;
+	const char* m_end = nullptr;
+
+	XMLArena m_arena;
+	XMLNode m_root;
+	size_t m_nodeCount = 0;
+
+	// children and attributes of the nodes still open, moved into the arena when their node closes
+	std::vector<XMLNode> m_pendingNodes;
+	std::vector<XMLAttribute> m_pendingAttributes;
+};
+
+// keyed lookup over the children of one node, e.g. manifest entries by their name attribute
+class XMLChildIndex {
+public:
+	XMLChildIndex(const XMLNode& node, std::string_view keyAttribute);
+
+	const XMLNode* Find(std::string_view key) const;
+	size_t size() const { return m_entries.size(); }
+
+private:
+	std::unordered_map<std::string_view, const XMLNode*> m_entries;
 };
\ No newline at end of file
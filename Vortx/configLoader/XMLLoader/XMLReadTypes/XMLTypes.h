@@ -1,15 +1,30 @@
 #pragma once
 
-#include <string>
-#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
 
+// contiguous arena allocated run, indexable and iterable in document order
+template<typename T>
+struct XMLRange {
+	T* data = nullptr;
+	uint32_t count = 0;
+
+	T* begin() const { return data; }
+	T* end() const { return data + count; }
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+	T& operator[](size_t index) const { return data[index]; }
+};
+
+// names and values view the loader's text, they stay valid until it parses again or goes away
 struct XMLAttribute {
-	std::string name;
-	std::string value;
+	std::string_view name;
+	std::string_view value;
 };
 
 struct XMLNode {
-	std::string name;
-	std::vector<XMLAttribute> attributes;
-	std::vector<XMLNode> children;
+	std::string_view name;
+	XMLRange<XMLAttribute> attributes;
+	XMLRange<XMLNode> children;
 };
\ No newline at end of file
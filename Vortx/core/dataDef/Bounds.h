@@ -0,0 +1,62 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+
+struct AABB {
+	glm::vec3 min{ 0.0f };
+	glm::vec3 max{ 0.0f };
+
+	static AABB unbounded() { return AABB{ glm::vec3(-1e9f), glm::vec3(1e9f) }; }
+
+	glm::vec3 center() const { return (min + max) * 0.5f; }
+	glm::vec3 extent() const { return (max - min) * 0.5f; }
+
+	AABB transformed(const glm::mat4& m) const {
+		glm::vec3 c = glm::vec3(m * glm::vec4(center(), 1.0f));
+		glm::vec3 e = extent();
+
+		glm::vec3 r{};
+		for (int i = 0; i < 3; i++)
+			r[i] = std::abs(m[0][i]) * e.x + std::abs(m[1][i]) * e.y + std::abs(m[2][i]) * e.z;
+
+		return AABB{ c - r, c + r };
+	}
+};
+
+struct BoundsSoA {
+	std::vector<float> minX, minY, minZ;
+	std::vector<float> maxX, maxY, maxZ;
+
+	uint32_t size() const { return static_cast<uint32_t>(minX.size()); }
+
+	void resize(uint32_t count) {
+		minX.resize(count); minY.resize(count); minZ.resize(count);
+		maxX.resize(count); maxY.resize(count); maxZ.resize(count);
+	}
+
+	void clear() { resize(0); }
+
+	void set(uint32_t i, const AABB& box) {
+		minX[i] = box.min.x; minY[i] = box.min.y; minZ[i] = box.min.z;
+		maxX[i] = box.max.x; maxY[i] = box.max.y; maxZ[i] = box.max.z;
+	}
+
+	void push(const AABB& box) {
+		resize(size() + 1);
+		set(size() - 1, box);
+	}
+
+	void swapRemove(uint32_t i) {
+		uint32_t last = size() - 1;
+		if (i != last) set(i, get(last));
+		resize(last);
+	}
+
+	AABB get(uint32_t i) const {
+		return AABB{ { minX[i], minY[i], minZ[i] }, { maxX[i], maxY[i], maxZ[i] } };
+	}
+};
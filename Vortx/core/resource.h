@@ -16,6 +16,8 @@ struct TextureData{
 
 constexpr int CHUNK_SIZE = 16;
 constexpr int CHUNK_HEIGHT = 256;
+constexpr int CHUNK_SECTION_HEIGHT = 16;
+constexpr int CHUNK_SECTIONS = CHUNK_HEIGHT / CHUNK_SECTION_HEIGHT;
 
 struct Chunk {
 	glm::ivec3 chunkPos{};
@@ -27,6 +29,15 @@ struct Chunk {
 	bool dirty = true;
 	uint64_t version = 0;
 
+	int occluderHeight = 0;
+	int surfaceHeight = 0;
+
+	uint16_t columnSolid[CHUNK_SIZE][CHUNK_SIZE] = {};
+	uint16_t columnTop[CHUNK_SIZE][CHUNK_SIZE] = {};
+
+	uint16_t irregularSections = 0;
+	uint16_t editedSections = 0;
+
 	inline uint8_t get(int x, int y, int z) const {
 		if (x < 0 || x >= CHUNK_SIZE ||
 			y < 0 || y >= CHUNK_HEIGHT ||
@@ -1,7 +1,7 @@
 #include "ModelManager.h"
 
 ModelManager::ModelManager(ContextHandle handle) :
-	running(true), loaderThread(&ModelManager::loaderLoop, this) {
+	deletions(handle.MAX_FRAMES_IN_FLIGHT), running(true), loaderThread(&ModelManager::loaderLoop, this) {
 	device = handle.device;
 	physicalDevice = handle.physicalDevice;
 	queue = handle.graphicsQueue;
@@ -11,6 +11,9 @@ ModelManager::ModelManager(ContextHandle handle) :
 }
 
 void ModelManager::update() {
+	// called once per main loop iteration, ahead of that iteration's frame
+	deletions.advance();
+
 	auto maybeModel = loadedModels.try_pop();
 	while (maybeModel.has_value()) {
 		auto model = std::move(maybeModel.value());
@@ -54,6 +57,7 @@ void ModelManager::drawAll(VkCommandBuffer commandbuffer, VkPipelineLayout pipel
 }
 
 void ModelManager::cleanUp() {
+	deletions.releaseAll();
 	for (auto& model : models) {
 		model->cleanup(device);
 	}
@@ -63,9 +67,17 @@ void ModelManager::cleanUp() {
 
 void ModelManager::destroyModel(Model* model) {
 	if (!model) return;
-	vkDeviceWaitIdle(device);
-	model->cleanup(device);
-	models.erase(std::remove_if(models.begin(), models.end(), [&](const std::unique_ptr<Model>& m) {return m.get() == model; }), models.end());
+
+	auto it = std::find_if(models.begin(), models.end(), [&](const std::unique_ptr<Model>& m) {return m.get() == model; });
+	if (it == models.end()) return;
+
+	// no longer drawn from this frame on, the buffers are released once earlier frames have retired
+	std::shared_ptr<Model> retired = std::move(*it);
+	models.erase(it);
+	selectedModels.erase(model);
+
+	VkDevice device = this->device;
+	deletions.retire([device, retired]() { retired->cleanup(device); });
 }
 
 Model* ModelManager::getModel(size_t index) { 
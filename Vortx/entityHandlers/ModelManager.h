@@ -14,6 +14,7 @@
 #include "commProtocols/threadCommProtocol.h"
 
 #include "renderer/VulkanContext.h"
+#include "Signboard/resources/resourceSystems/DeletionQueue.h"
 
 class ModelManager {
 public:
@@ -55,6 +56,9 @@ private:
 
 	std::vector<std::unique_ptr<Model>> models;
 
+	// destroyed models stay alive until the frames that may still draw them have retired
+	DeletionQueue deletions;
+
 	struct LoadRequest {
 		std::string object_path;
 		std::string texture_path;
@@ -1,5 +1,7 @@
 ﻿#include "world.h"
 
+#include "Signboard/RendererCore/Culling/SoftwareOcclusion.h"
+
 #include <stdexcept>
 #include <iostream>
 #include <random>
@@ -14,12 +16,7 @@
 #include "renderer/utility/stb_image_write.h"
 #pragma warning(pop)
 
-World::World(const ContextHandle& handle) : 
-	device(handle.device),
-	physicalDevice(handle.physicalDevice),
-	descriptorSetLayout(handle.descriptorSetLayout),
-	queue(handle.graphicsQueue),
-	commandPool(handle.commandPool),
+World::World() : 
 	chunkBuilderActive(true),
 	ChunkGenerator(&World::chunkBuilderLoop, this),
 	ChunkMesher(&World::chunkMesherLoop, this)
@@ -27,8 +24,6 @@ World::World(const ContextHandle& handle) :
 	heightMap.SetNoiseType(FastNoiseLite::NoiseType_Perlin);
 	heightMap.SetFrequency(terrainScale);
 
-	createDescriptorPool(handle.MAX_FRAMES_IN_FLIGHT);
-
 	BlockData grass{};
 	grass.name = "grass";
 	grass.ColorMap = "block_textures/grass_256.png";
@@ -55,28 +50,12 @@ World::World(const ContextHandle& handle) :
 
 	std::vector<BlockData> inBlocks = { grass , stone, dirt, netherack };
 	atlas = buildTextureAtlas(inBlocks, 256);
-
-	colorTexture.format = VK_FORMAT_R8G8B8A8_SRGB;
-	colorTexture.samples = VK_SAMPLE_COUNT_1_BIT;
-	colorTexture.aspectFlagBits = VK_IMAGE_ASPECT_COLOR_BIT;
-	createTextureImage(atlas.ColorData.data(), colorTexture);
-
-	NormalTexture.format = VK_FORMAT_R8G8B8A8_SRGB;
-	NormalTexture.samples = VK_SAMPLE_COUNT_1_BIT;
-	NormalTexture.aspectFlagBits = VK_IMAGE_ASPECT_COLOR_BIT;
-	createTextureImage(atlas.NormalData.data(), NormalTexture);
-
-	VulkanUtils::createTextureSampler(device, physicalDevice, textureSampler, VK_FILTER_NEAREST);
-
-	createWorldUniformBuffer(handle.MAX_FRAMES_IN_FLIGHT);
-	createWorldDescriptorSet(descriptorSetLayout, handle.MAX_FRAMES_IN_FLIGHT);
 }
 
 World::~World() {
 	chunkBuilderActive = false;
 	if (ChunkGenerator.joinable()) ChunkGenerator.join();
 	if (ChunkMesher.joinable()) ChunkMesher.join();
-	cleanup();
 }
 
 std::unique_ptr<Chunk> World::generateChunk(const glm::ivec3& pos) {
@@ -110,42 +89,235 @@ std::unique_ptr<Chunk> World::generateChunk(const glm::ivec3& pos) {
 	//GreedyMesher(*chunk, chunk->chunkMesh.vertices, chunk->chunkMesh.indices);
 	//Mesher(*chunk, chunk->chunkMesh.vertices, chunk->chunkMesh.indices);
 
+	computeChunkHeights(*chunk);
+
 	chunk->dirty = true;
 	return chunk;
 }
 
-void World::Mesher(const Chunk& chunk, std::vector<Vertex>& verts, std::vector<uint32_t>& indices) {
-	glm::ivec3 pos = chunk.chunkPos;
+void World::computeChunkHeights(Chunk& chunk) {
+	int occluderHeight = CHUNK_HEIGHT;
+	int surfaceHeight = 0;
+
+	chunk.irregularSections = 0;
+
+	for (int x = 0; x < CHUNK_SIZE; x++)
+		for (int z = 0; z < CHUNK_SIZE; z++) {
+			int solidRun = 0;
+			while (solidRun < CHUNK_HEIGHT && chunk.voxels[x][solidRun][z]) solidRun++;
+
+			int top = solidRun;
+			for (int y = CHUNK_HEIGHT - 1; y > solidRun; y--)
+				if (chunk.voxels[x][y][z]) {
+					top = y + 1;
+					break;
+				}
+
+			chunk.columnSolid[x][z] = static_cast<uint16_t>(solidRun);
+			chunk.columnTop[x][z] = static_cast<uint16_t>(top);
+
+			// caves and overhangs: sections holding voxels above the solid run need the per-voxel mesher. a column
+			// solid up to its top stays a span, whichever section its surface ends in
+			if (top > solidRun) {
+				int floating = solidRun + 1;
+				while (!chunk.voxels[x][floating][z]) floating++;
+
+				for (int s = floating / CHUNK_SECTION_HEIGHT; s * CHUNK_SECTION_HEIGHT < top; s++)
+					chunk.irregularSections |= static_cast<uint16_t>(1u << s);
+			}
+
+			occluderHeight = std::min(occluderHeight, solidRun);
+			surfaceHeight = std::max(surfaceHeight, top);
+		}
+
+	chunk.occluderHeight = occluderHeight;
+	chunk.surfaceHeight = surfaceHeight;
+}
+
+void World::gatherOccluders(SoftwareOcclusionCuller& culler) {
+	std::lock_guard<std::mutex> lock(chunkMutex);
+
+	for (auto& [pos, chunk] : chunks) {
+		if (chunk->occluderHeight <= 0) continue;
+
+		glm::vec3 base(pos.x * CHUNK_SIZE, 0.0f, pos.z * CHUNK_SIZE);
+		culler.addOccluderBox(AABB{ base, base + glm::vec3(CHUNK_SIZE, chunk->occluderHeight, CHUNK_SIZE) });
+	}
+}
+
+void World::refreshChunkBounds(const glm::ivec3& pos, const Chunk& chunk) {
+	glm::vec3 base(pos.x * CHUNK_SIZE, 0.0f, pos.z * CHUNK_SIZE);
+	chunkTree.remove(pos);
+	chunkTree.insert(pos, AABB{ base, base + glm::vec3(CHUNK_SIZE, chunk.surfaceHeight, CHUNK_SIZE) });
+}
+
+void World::cullChunks(const Frustum& frustum, std::vector<glm::ivec3>& visibleChunks, CullingStats& stats) {
+	std::lock_guard<std::mutex> lock(chunkMutex);
+	chunkTree.query(frustum, visibleChunks, stats);
+}
+
+void World::cullOccludedChunks(SoftwareOcclusionCuller& culler, std::vector<glm::ivec3>& visibleChunks) {
+	std::vector<AABB> bounds;
+	bounds.reserve(visibleChunks.size());
+	{
+		std::lock_guard<std::mutex> lock(chunkMutex);
+
+		for (const glm::ivec3& pos : visibleChunks) {
+			auto it = chunks.find(pos);
+			int top = it != chunks.end() ? it->second->surfaceHeight : CHUNK_HEIGHT;
+
+			glm::vec3 base(pos.x * CHUNK_SIZE, 0.0f, pos.z * CHUNK_SIZE);
+			bounds.push_back(AABB{ base, base + glm::vec3(CHUNK_SIZE, top, CHUNK_SIZE) });
+		}
+	}
 
+	std::vector<uint8_t> visible(bounds.size());
+	culler.testVisibility(bounds.data(), static_cast<uint32_t>(bounds.size()), visible.data());
+
+	size_t kept = 0;
+	for (size_t i = 0; i < visibleChunks.size(); i++)
+		if (visible[i]) visibleChunks[kept++] = visibleChunks[i];
+	visibleChunks.resize(kept);
+}
+
+static const glm::ivec3 faceNormals[6] = {
+	{ 1, 0, 0 },
+	{-1, 0, 0 },
+	{ 0, 1, 0 },
+	{ 0,-1, 0 },
+	{ 0, 0, 1 },
+	{ 0, 0,-1 }
+};
+
+static const glm::vec4 faceTangents[6] = {
+	{ 0, 0, 1,  1 },
+	{ 0, 0, 1, -1 },
+	{ 1, 0, 0,  1 },
+	{ 1, 0, 0, -1 },
+	{ 1, 0, 0,  1 },
+	{ 1, 0, 0, -1 }
+};
+
+static const glm::vec3 faceVertices[6][4] = {
+	{ {1,0,0}, {1,1,0}, {1,1,1}, {1,0,1} },
+	{ {0,0,1}, {0,1,1}, {0,1,0}, {0,0,0} },
+	{ {0,1,1}, {1,1,1}, {1,1,0}, {0,1,0} },
+	{ {0,0,0}, {1,0,0}, {1,0,1}, {0,0,1} },
+	{ {0,0,1}, {1,0,1}, {1,1,1}, {0,1,1} },
+	{ {1,0,0}, {0,0,0}, {0,1,0}, {1,1,0} }
+};
+
+// +x, -x, +z, -z
+static const int sideFaces[4] = { 0, 1, 4, 5 };
+
+static void emitFace(std::vector<Vertex>& verts, std::vector<uint32_t>& indices, int face, const glm::vec3& origin, float height, const glm::vec4& uvRect) {
+	const glm::vec2 uvFace[4] = {
+		{uvRect.x, uvRect.y},
+		{uvRect.z, uvRect.y},
+		{uvRect.z, uvRect.w},
+		{uvRect.x, uvRect.w}
+	};
+
+	uint32_t baseIndex = static_cast<uint32_t>(verts.size());
+	for (int v = 0; v < 4; v++) {
+		const glm::vec3& corner = faceVertices[face][v];
+
+		Vertex vert;
+		vert.pos = origin + glm::vec3(corner.x, corner.y * height, corner.z);
+		vert.normal = glm::vec3(faceNormals[face]);
+		vert.color = { 1.0f,1.0f,1.0f };
+		vert.texCoord = uvFace[v];
+		vert.tangent = faceTangents[face];
+		verts.push_back(vert);
+	}
+	indices.push_back(baseIndex + 0);
+	indices.push_back(baseIndex + 1);
+	indices.push_back(baseIndex + 2);
+	indices.push_back(baseIndex + 2);
+	indices.push_back(baseIndex + 3);
+	indices.push_back(baseIndex + 0);
+}
+
+glm::vec4 World::getBlockUV(uint8_t block) const {
+	auto it = atlas.uvRanges.find(block);
+	if (it == atlas.uvRanges.end()) return glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+	return it->second;
+}
+
+void World::Mesher(const Chunk& chunk, std::vector<Vertex>& verts, std::vector<uint32_t>& indices) {
 	verts.clear();
 	indices.clear();
 
-	const glm::ivec3 faceNormals[6] = {
-		{ 1, 0, 0 },
-		{-1, 0, 0 },
-		{ 0, 1, 0 },
-		{ 0,-1, 0 },
-		{ 0, 0, 1 },
-		{ 0, 0,-1 }
-	};
+	const Chunk* neighbors[4];
+	for (int side = 0; side < 4; side++)
+		neighbors[side] = findChunk(chunk.chunkPos + faceNormals[sideFaces[side]]);
 
-	const glm::vec4 faceTangents[6] = {
-		{ 0, 0, 1,  1 },
-		{ 0, 0, 1, -1 },
-		{ 1, 0, 0,  1 },
-		{ 1, 0, 0, -1 },
-		{ 1, 0, 0,  1 },
-		{ 1, 0, 0, -1 }
-	};
+	uint16_t voxelSections = chunk.irregularSections | chunk.editedSections;
 
-	const glm::vec3 faceVertices[6][4] = {
-		{ {1,0,0}, {1,1,0}, {1,1,1}, {1,0,1} },
-		{ {0,0,1}, {0,1,1}, {0,1,0}, {0,0,0} },
-		{ {0,1,1}, {1,1,1}, {1,1,0}, {0,1,0} },
-		{ {0,0,0}, {1,0,0}, {1,0,1}, {0,0,1} },
-		{ {0,0,1}, {1,0,1}, {1,1,1}, {0,1,1} },
-		{ {1,0,0}, {0,0,0}, {0,1,0}, {1,1,0} }
-	};
+	for (int s = 0; s < CHUNK_SECTIONS; s++) {
+		int yBegin = s * CHUNK_SECTION_HEIGHT;
+		if (yBegin >= chunk.surfaceHeight) break;
+
+		int yEnd = yBegin + CHUNK_SECTION_HEIGHT;
+
+		if (voxelSections & (1u << s)) meshVoxels(chunk, yBegin, yEnd, verts, indices);
+		else meshColumns(chunk, neighbors, yBegin, yEnd, verts, indices);
+	}
+}
+
+void World::meshColumns(const Chunk& chunk, const Chunk* const neighbors[4], int yBegin, int yEnd, std::vector<Vertex>& verts, std::vector<uint32_t>& indices) {
+	int baseWX = chunk.chunkPos.x * CHUNK_SIZE;
+	int baseWZ = chunk.chunkPos.z * CHUNK_SIZE;
+
+	for (int x = 0; x < CHUNK_SIZE; x++)
+		for (int z = 0; z < CHUNK_SIZE; z++) {
+			int solid = chunk.columnSolid[x][z];
+			int lo = yBegin;
+			int hi = std::min(solid, yEnd);
+			if (lo >= hi) continue;
+
+			glm::vec3 column(baseWX + x, 0.0f, baseWZ + z);
+
+			if (lo == 0)
+				emitFace(verts, indices, 3, column, 1.0f, getBlockUV(chunk.voxels[x][0][z]));
+			if (hi == solid)
+				emitFace(verts, indices, 2, column + glm::vec3(0.0f, solid - 1, 0.0f), 1.0f, getBlockUV(chunk.voxels[x][solid - 1][z]));
+
+			for (int side = 0; side < 4; side++) {
+				glm::ivec3 n = faceNormals[sideFaces[side]];
+				int nx = x + n.x;
+				int nz = z + n.z;
+
+				const Chunk* nChunk = &chunk;
+				if (nx < 0 || nx >= CHUNK_SIZE || nz < 0 || nz >= CHUNK_SIZE) {
+					nChunk = neighbors[side];
+					nx = (nx + CHUNK_SIZE) % CHUNK_SIZE;
+					nz = (nz + CHUNK_SIZE) % CHUNK_SIZE;
+				}
+
+				// the neighbour is solid below its own solid run, so only the height difference is exposed
+				int y = nChunk ? std::max(lo, static_cast<int>(nChunk->columnSolid[nx][nz])) : lo;
+				int nTop = nChunk ? nChunk->columnTop[nx][nz] : 0;
+
+				while (y < hi) {
+					if (y < nTop && nChunk->voxels[nx][y][nz]) {
+						y++;
+						continue;
+					}
+
+					uint8_t block = chunk.voxels[x][y][z];
+					int end = y + 1;
+					while (end < hi && chunk.voxels[x][end][z] == block && !(end < nTop && nChunk->voxels[nx][end][nz])) end++;
+
+					emitFace(verts, indices, sideFaces[side], column + glm::vec3(0.0f, y, 0.0f), static_cast<float>(end - y), getBlockUV(block));
+					y = end;
+				}
+			}
+		}
+}
+
+void World::meshVoxels(const Chunk& chunk, int yBegin, int yEnd, std::vector<Vertex>& verts, std::vector<uint32_t>& indices) {
+	glm::ivec3 pos = chunk.chunkPos;
 
 	auto isSolid = [&](int WorldX, int WorldY, int WorldZ) -> bool {
 		glm::ivec3 cpos((int)std::floor(WorldX / (float)CHUNK_SIZE), 0, (int)std::floor(WorldZ / (float)CHUNK_SIZE));
@@ -157,31 +329,16 @@ void World::Mesher(const Chunk& chunk, std::vector<Vertex>& verts, std::vector<u
 		return (c->get(lx, ly, lz) != 0);
 	};
 
-	auto getUVForBlock = [&](uint8_t block) -> glm::vec4 {
-		auto it = atlas.uvRanges.find(block);
-		if (it == atlas.uvRanges.end()) {
-			static glm::vec4 defaultUV(0.0f, 0.0f, 1.0f, 1.0f);
-			return defaultUV;
-		}
-		return it->second;
-	};
-
 	int baseWX = pos.x * CHUNK_SIZE;
 	int baseWZ = pos.z * CHUNK_SIZE;
 
 	for (int x = 0; x < CHUNK_SIZE; x++){
-		for (int y = 0; y < CHUNK_HEIGHT; y++){
+		for (int y = yBegin; y < yEnd; y++){
 			for (int z = 0; z < CHUNK_SIZE; z++){
 				uint8_t block = chunk.get(x, y, z);
 				if (!block) continue;
 
-				glm::vec4 uvRect = getUVForBlock(block);
-				glm::vec2 uvFace[4] = {
-					{uvRect.x, uvRect.y},
-					{uvRect.z, uvRect.y},
-					{uvRect.z, uvRect.w},
-					{uvRect.x, uvRect.w}
-				};
+				glm::vec4 uvRect = getBlockUV(block);
 
 				int WorldX = baseWX + x;
 				int WorldY = y;
@@ -196,22 +353,7 @@ void World::Mesher(const Chunk& chunk, std::vector<Vertex>& verts, std::vector<u
 
 					if (isSolid(nx, ny, nz)) continue;
 
-					uint32_t baseIndex = static_cast<uint32_t>(verts.size());
-					for (int v = 0; v < 4; v++){
-						Vertex vert;
-						vert.pos = glm::vec3(WorldX, WorldY, WorldZ) + faceVertices[f][v];
-						vert.normal = glm::vec3(n);
-						vert.color = {1.0f,1.0f,1.0f};
-						vert.texCoord = uvFace[v];
-						vert.tangent = faceTangents[f];
-						verts.push_back(vert);
-					}
-					indices.push_back(baseIndex + 0);
-					indices.push_back(baseIndex + 1);
-					indices.push_back(baseIndex + 2);
-					indices.push_back(baseIndex + 2);
-					indices.push_back(baseIndex + 3);
-					indices.push_back(baseIndex + 0);
+					emitFace(verts, indices, f, glm::vec3(WorldX, WorldY, WorldZ), 1.0f, uvRect);
 				}
 			}
 		}
@@ -440,8 +582,26 @@ void World::updateChunkMesh(const glm::ivec3& pos) {
 	auto it = chunks.find(pos);
 	if (it == chunks.end()) return;
 	Chunk& chunk = *it->second;
-	destroyChunkBuffers(chunk);
-	uploadChunkToGPU(chunk);
+
+	std::lock_guard<std::mutex> lock(chunkMutex);
+	refreshChunkBounds(pos, chunk);
+	chunk.dirty = true;
+}
+
+void World::takeMeshUpdates(std::vector<MeshJob>& updated, std::vector<glm::ivec3>& removed) {
+	updated.clear();
+	removed.clear();
+
+	std::lock_guard<std::mutex> lock(chunkMutex);
+	removed.swap(removedChunks);
+
+	for (auto& [pos, chunkPtr] : chunks) {
+		Chunk& chunk = *chunkPtr;
+		if (!chunk.dirty) continue;
+
+		updated.push_back(MeshJob{ pos, chunk.meshData });
+		chunk.dirty = false;
+	}
 }
 
 TextureAtlas World::buildTextureAtlas(std::vector<BlockData>& inputBlocks, int tileSize) {
@@ -519,36 +679,36 @@ TextureAtlas World::buildTextureAtlas(std::vector<BlockData>& inputBlocks, int t
 	return result;
 }
 
-void World::createTextureImage(unsigned char* imageData, ImageResources& image) {
-	VkDeviceSize imageSize = atlas.atlasWidth * atlas.atlasHeight * 4;
-
-	if (!imageData) {
-		throw std::runtime_error("failed to load texture image!");
-	}
-
-	VkBuffer stagingBuffer;
-	VkDeviceMemory stagingBufferMemory;
-	VulkanUtils::createBuffer(physicalDevice, device, imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
-
-	void* data;
-	vkMapMemory(device, stagingBufferMemory, 0, imageSize, 0, &data);
-	memcpy(data, imageData, static_cast<size_t>(imageSize));
-	vkUnmapMemory(device, stagingBufferMemory);
-
-	VulkanUtils::createImageResources(device, physicalDevice, atlas.atlasWidth, atlas.atlasHeight, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image);
-	VulkanUtils::transitionImageLayout(commandPool, device, queue, image.image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-	VulkanUtils::copyBufferToImage(device, queue, commandPool, stagingBuffer, image.image, static_cast<uint32_t>(atlas.atlasWidth), static_cast<uint32_t>(atlas.atlasHeight));
-	VulkanUtils::transitionImageLayout(commandPool, device, queue, image.image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-
-	vkDestroyBuffer(device, stagingBuffer, nullptr);
-	vkFreeMemory(device, stagingBufferMemory, nullptr);
-
-	//imageView = VulkanUtils::createImageView(device, image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT);
-}
+//void World::createTextureImage(unsigned char* imageData, ImageResources& image) {
+//	VkDeviceSize imageSize = atlas.atlasWidth * atlas.atlasHeight * 4;
+//
+//	if (!imageData) {
+//		throw std::runtime_error("failed to load texture image!");
+//	}
+//
+//	VkBuffer stagingBuffer;
+//	VkDeviceMemory stagingBufferMemory;
+//	VulkanUtils::createBuffer(physicalDevice, device, imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+//
+//	void* data;
+//	vkMapMemory(device, stagingBufferMemory, 0, imageSize, 0, &data);
+//	memcpy(data, imageData, static_cast<size_t>(imageSize));
+//	vkUnmapMemory(device, stagingBufferMemory);
+//
+//	VulkanUtils::createImageResources(device, physicalDevice, atlas.atlasWidth, atlas.atlasHeight, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image);
+//	VulkanUtils::transitionImageLayout(commandPool, device, queue, image.image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+//	VulkanUtils::copyBufferToImage(device, queue, commandPool, stagingBuffer, image.image, static_cast<uint32_t>(atlas.atlasWidth), static_cast<uint32_t>(atlas.atlasHeight));
+//	VulkanUtils::transitionImageLayout(commandPool, device, queue, image.image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+//
+//	vkDestroyBuffer(device, stagingBuffer, nullptr);
+//	vkFreeMemory(device, stagingBufferMemory, nullptr);
+//
+//	//imageView = VulkanUtils::createImageView(device, image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT);
+//}
 
-void World::updateUBO(VkDevice device, const World_UBO& uboData, uint32_t currentImage) {
-	memcpy(uniformBuffersMapped[currentImage], &uboData, sizeof(uboData));
-}
+//void World::updateUBO(VkDevice device, const World_UBO& uboData, uint32_t currentImage) {
+//	memcpy(uniformBuffersMapped[currentImage], &uboData, sizeof(uboData));
+//}
 
 //void World::draw(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, uint16_t currentFrame) {
 //	if (chunks.empty()) return;
@@ -584,11 +744,31 @@ glm::ivec2 World::getChunkCoordinates(glm::vec3 pos) {
 }
 
 void World::setBlock(int x, int y, int z, int blockType) {
-	glm::vec3 chunkPos = { x / CHUNK_SIZE, y / CHUNK_SIZE, z / CHUNK_SIZE };
+	if (y < 0 || y >= CHUNK_HEIGHT) return;
+
+	std::lock_guard<std::mutex> lock(chunkMutex);
+
+	glm::ivec3 chunkPos((int)std::floor(x / (float)CHUNK_SIZE), 0, (int)std::floor(z / (float)CHUNK_SIZE));
 	auto it = chunks.find(chunkPos);
 	if (it == chunks.end()) return;
 
-	it->second->dirty = true;
+	Chunk& chunk = *it->second;
+	chunk.voxels[x - chunkPos.x * CHUNK_SIZE][y][z - chunkPos.z * CHUNK_SIZE] = static_cast<uint8_t>(blockType);
+	chunk.editedSections |= static_cast<uint16_t>(1u << (y / CHUNK_SECTION_HEIGHT));
+
+	computeChunkHeights(chunk);
+	refreshChunkBounds(chunkPos, chunk);
+	chunk.dirty = true;
+}
+
+MeshingStats World::getMeshingStats() {
+	std::lock_guard<std::mutex> lock(meshingStatsMutex);
+	return meshingStats;
+}
+
+void World::resetMeshingStats() {
+	std::lock_guard<std::mutex> lock(meshingStatsMutex);
+	meshingStats = MeshingStats{};
 }
 
 //void World::cleanup() {
@@ -624,10 +804,6 @@ void World::setBlock(int x, int y, int z, int blockType) {
 //	VulkanUtils::destroyImageResources(device, NormalTexture);
 //}
 
-void World::createChunkBuffers(Chunk& chunk) {
-	uploadChunkToGPU(chunk);
-}
-
 //void World::createDescriptorPool(uint16_t MAX_FRAMES_IN_FLIGHT) {
 //	std::array<VkDescriptorPoolSize, 3> poolSizes;
 //	poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
@@ -650,79 +826,79 @@ void World::createChunkBuffers(Chunk& chunk) {
 //	}
 //}
 
-void World::createWorldDescriptorSet(VkDescriptorSetLayout descriptorSetLayout, uint16_t FRAMES_IN_FLIGHT) {
-	std::vector<VkDescriptorSetLayout> layouts(FRAMES_IN_FLIGHT, descriptorSetLayout);
-
-	VkDescriptorSetAllocateInfo allocInfo{};
-	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-	allocInfo.descriptorPool = descriptorPool;
-	allocInfo.descriptorSetCount = static_cast<uint32_t>(FRAMES_IN_FLIGHT);
-	allocInfo.pSetLayouts = layouts.data();
-
-	descriptorSets.resize(FRAMES_IN_FLIGHT);
-	if (vkAllocateDescriptorSets(device, &allocInfo, descriptorSets.data()) != VK_SUCCESS) {
-		throw std::runtime_error("failed to allocate world descriptor set!");
-	}
-
-	for (size_t i = 0; i < FRAMES_IN_FLIGHT; i++) {
-		VkDescriptorBufferInfo bufferInfo{};
-		bufferInfo.buffer = uniformBuffers[i];
-		bufferInfo.offset = 0;
-		bufferInfo.range = sizeof(World_UBO);
-
-		VkDescriptorImageInfo ColorMapInfo{};
-		ColorMapInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		ColorMapInfo.imageView = colorTexture.view;
-		ColorMapInfo.sampler = textureSampler;
-
-		VkDescriptorImageInfo NormalMapInfo{};
-		NormalMapInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		NormalMapInfo.imageView = NormalTexture.view;
-		NormalMapInfo.sampler = textureSampler;
-
-		std::array<VkWriteDescriptorSet, 3> descriptorWrites{};
-		descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		descriptorWrites[0].dstSet = descriptorSets[i];
-		descriptorWrites[0].dstBinding = 0;
-		descriptorWrites[0].dstArrayElement = 0;
-		descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		descriptorWrites[0].descriptorCount = 1;
-		descriptorWrites[0].pBufferInfo = &bufferInfo;
-		descriptorWrites[0].pImageInfo = nullptr;
-		descriptorWrites[0].pTexelBufferView = nullptr;
-
-		descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		descriptorWrites[1].dstSet = descriptorSets[i];
-		descriptorWrites[1].dstBinding = 1;
-		descriptorWrites[1].dstArrayElement = 0;
-		descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		descriptorWrites[1].descriptorCount = 1;
-		descriptorWrites[1].pImageInfo = &ColorMapInfo;
-
-		descriptorWrites[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		descriptorWrites[2].dstSet = descriptorSets[i];
-		descriptorWrites[2].dstBinding = 2;
-		descriptorWrites[2].dstArrayElement = 0;
-		descriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		descriptorWrites[2].descriptorCount = 1;
-		descriptorWrites[2].pImageInfo = &NormalMapInfo;
-
-		vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
-	}
-}
-
-void World::createWorldUniformBuffer(uint16_t MAX_FRAMES_IN_FLIGHT) {
-	VkDeviceSize bufferSize = sizeof(World_UBO);
-
-	uniformBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-	uniformBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
-	uniformBuffersMapped.resize(MAX_FRAMES_IN_FLIGHT);
+//void World::createWorldDescriptorSet(VkDescriptorSetLayout descriptorSetLayout, uint16_t FRAMES_IN_FLIGHT) {
+//	std::vector<VkDescriptorSetLayout> layouts(FRAMES_IN_FLIGHT, descriptorSetLayout);
+//
+//	VkDescriptorSetAllocateInfo allocInfo{};
+//	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+//	allocInfo.descriptorPool = descriptorPool;
+//	allocInfo.descriptorSetCount = static_cast<uint32_t>(FRAMES_IN_FLIGHT);
+//	allocInfo.pSetLayouts = layouts.data();
+//
+//	descriptorSets.resize(FRAMES_IN_FLIGHT);
+//	if (vkAllocateDescriptorSets(device, &allocInfo, descriptorSets.data()) != VK_SUCCESS) {
+//		throw std::runtime_error("failed to allocate world descriptor set!");
+//	}
+//
+//	for (size_t i = 0; i < FRAMES_IN_FLIGHT; i++) {
+//		VkDescriptorBufferInfo bufferInfo{};
+//		bufferInfo.buffer = uniformBuffers[i];
+//		bufferInfo.offset = 0;
+//		bufferInfo.range = sizeof(World_UBO);
+//
+//		VkDescriptorImageInfo ColorMapInfo{};
+//		ColorMapInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+//		ColorMapInfo.imageView = colorTexture.view;
+//		ColorMapInfo.sampler = textureSampler;
+//
+//		VkDescriptorImageInfo NormalMapInfo{};
+//		NormalMapInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+//		NormalMapInfo.imageView = NormalTexture.view;
+//		NormalMapInfo.sampler = textureSampler;
+//
+//		std::array<VkWriteDescriptorSet, 3> descriptorWrites{};
+//		descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+//		descriptorWrites[0].dstSet = descriptorSets[i];
+//		descriptorWrites[0].dstBinding = 0;
+//		descriptorWrites[0].dstArrayElement = 0;
+//		descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+//		descriptorWrites[0].descriptorCount = 1;
+//		descriptorWrites[0].pBufferInfo = &bufferInfo;
+//		descriptorWrites[0].pImageInfo = nullptr;
+//		descriptorWrites[0].pTexelBufferView = nullptr;
+//
+//		descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+//		descriptorWrites[1].dstSet = descriptorSets[i];
+//		descriptorWrites[1].dstBinding = 1;
+//		descriptorWrites[1].dstArrayElement = 0;
+//		descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+//		descriptorWrites[1].descriptorCount = 1;
+//		descriptorWrites[1].pImageInfo = &ColorMapInfo;
+//
+//		descriptorWrites[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+//		descriptorWrites[2].dstSet = descriptorSets[i];
+//		descriptorWrites[2].dstBinding = 2;
+//		descriptorWrites[2].dstArrayElement = 0;
+//		descriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+//		descriptorWrites[2].descriptorCount = 1;
+//		descriptorWrites[2].pImageInfo = &NormalMapInfo;
+//
+//		vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+//	}
+//}
 
-	for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-		VulkanUtils::createBuffer(physicalDevice, device, bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, uniformBuffers[i], uniformBuffersMemory[i]);
-		vkMapMemory(device, uniformBuffersMemory[i], 0, bufferSize, 0, &uniformBuffersMapped[i]);
-	}
-}
+//void World::createWorldUniformBuffer(uint16_t MAX_FRAMES_IN_FLIGHT) {
+//	VkDeviceSize bufferSize = sizeof(World_UBO);
+//
+//	uniformBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+//	uniformBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
+//	uniformBuffersMapped.resize(MAX_FRAMES_IN_FLIGHT);
+//
+//	for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+//		VulkanUtils::createBuffer(physicalDevice, device, bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, uniformBuffers[i], uniformBuffersMemory[i]);
+//		vkMapMemory(device, uniformBuffersMemory[i], 0, bufferSize, 0, &uniformBuffersMapped[i]);
+//	}
+//}
 
 int World::getTerrainHeight(int x, int z) {
 	float n = heightMap.GetNoise((float)x, (float)z);
@@ -771,7 +947,41 @@ void World::chunkMesherLoop() {
 			chunkPtr = it->second.get();
 		}
 		MeshData meshData;
+
+		auto start = std::chrono::steady_clock::now();
 		Mesher(*chunkPtr, meshData.vertices, meshData.indices);
+		double meshingMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		double voxelMs = 0.0;
+		bool profiled = profileMeshing.load();
+		if (profiled) {
+			MeshData reference;
+			start = std::chrono::steady_clock::now();
+			meshVoxels(*chunkPtr, 0, CHUNK_HEIGHT, reference.vertices, reference.indices);
+			voxelMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		}
+
+		{
+			uint32_t sections = (chunkPtr->surfaceHeight + CHUNK_SECTION_HEIGHT - 1) / CHUNK_SECTION_HEIGHT;
+			uint16_t voxelMask = chunkPtr->irregularSections | chunkPtr->editedSections;
+
+			uint32_t voxelSections = 0;
+			for (uint32_t s = 0; s < sections; s++)
+				if (voxelMask & (1u << s)) voxelSections++;
+
+			std::lock_guard<std::mutex> lock(meshingStatsMutex);
+			meshingStats.chunks++;
+			meshingStats.voxelSections += voxelSections;
+			meshingStats.columnSections += sections - voxelSections;
+			meshingStats.quads += meshData.indices.size() / 6;
+			meshingStats.meshingMs += meshingMs;
+
+			if (profiled) {
+				meshingStats.profiledChunks++;
+				meshingStats.profiledMeshingMs += meshingMs;
+				meshingStats.profiledVoxelMs += voxelMs;
+			}
+		}
 
 		MeshJob job;
 		job.pos = pos;
@@ -801,8 +1011,9 @@ void World::captureGenratedChunks() {
 			chunks[job.pos] = std::move(chunkPtr);
 			chunks[job.pos]->meshData = std::move(job.mesh);
 			chunks[job.pos]->dirty = true;
+
+			refreshChunkBounds(job.pos, *chunks[job.pos]);
 		}
-		//possible here - chunk upload code.
 		opt = meshedChunks.try_pop();
 	}
 }
@@ -823,8 +1034,10 @@ void World::updateTerrainConstants() {
 }
 
 void World::clearLoadedChunks() {
-	for (auto& [pos, chunkPtr] : chunks) destroyChunkBuffers(*chunkPtr);
+	std::lock_guard<std::mutex> lock(chunkMutex);
+	for (auto& [pos, chunkPtr] : chunks) removedChunks.push_back(pos);
 	chunks.clear();
+	chunkTree.clear();
 }
 
 void World::requestChunk(const glm::ivec3& pos) {
@@ -11,6 +11,8 @@
 
 #include "FastNoiseLite.h"
 
+#include "Signboard/RendererCore/Culling/ChunkQuadtree.h"
+
 struct World_UBO {
 	alignas(16) glm::mat4 model;
 	alignas(16) glm::mat4 view;
@@ -55,14 +57,29 @@ struct genratedChunk {
 	std::unique_ptr<Chunk> chunk;
 };
 
+class SoftwareOcclusionCuller;
+
 struct MeshJob {
 	glm::ivec3 pos;
 	MeshData mesh;
 };
 
+struct MeshingStats {
+	uint32_t chunks = 0;
+	uint32_t columnSections = 0;
+	uint32_t voxelSections = 0;
+	uint64_t quads = 0;
+
+	double meshingMs = 0.0;
+
+	uint32_t profiledChunks = 0;
+	double profiledMeshingMs = 0.0;
+	double profiledVoxelMs = 0.0;
+};
+
 class World {
 public:
-	//World(const ContextHandle& handle);
+	World();
 	~World();
 
 	int getChunkCount();
@@ -75,6 +92,15 @@ public:
 	Chunk* findChunk(const glm::ivec3& pos);
 
 	void updateChunkMesh(const glm::ivec3& pos);
+
+	// hands out the meshes of chunks meshed or edited since the last call and the chunks dropped since then, the
+	// caller owns their GPU copies
+	void takeMeshUpdates(std::vector<MeshJob>& updated, std::vector<glm::ivec3>& removed);
+
+	void cullChunks(const Frustum& frustum, std::vector<glm::ivec3>& visibleChunks, CullingStats& stats);
+
+	void gatherOccluders(SoftwareOcclusionCuller& culler);
+	void cullOccludedChunks(SoftwareOcclusionCuller& culler, std::vector<glm::ivec3>& visibleChunks);
 	//void uploadChunkToGPU(Chunk& chunk);
 	//void createTextureImage(unsigned char* data, ImageResources& image);
 	//void draw(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, uint16_t currentFrame);
@@ -82,6 +108,11 @@ public:
 
 	int getSurfaceZ(glm::vec3 pos);
 	void setBlock(int x, int y, int z, int blockType);
+
+	const TextureAtlas& getAtlas() const { return atlas; }
+
+	MeshingStats getMeshingStats();
+	void resetMeshingStats();
 	
 	//void cleanup();
 
@@ -95,6 +126,8 @@ public:
 	glm::ivec3 playerChunk = { 0,0,0 };
 	int renderDistance = 16;
 
+	std::atomic<bool> profileMeshing{ false };
+
 private:
 	//VkDevice device;
 
@@ -123,11 +156,15 @@ private:
 
 	void GreedyMesher(const Chunk& chunk, std::vector<Vertex>& verts, std::vector<uint32_t>& indices);
 	void Mesher(const Chunk& chunk, std::vector<Vertex>& verts, std::vector<uint32_t>& indices);
-
-	void createChunkBuffers(Chunk& chunk);
-	void destroyChunkBuffers(Chunk& chunk);
+	void meshVoxels(const Chunk& chunk, int yBegin, int yEnd, std::vector<Vertex>& verts, std::vector<uint32_t>& indices);
+	void meshColumns(const Chunk& chunk, const Chunk* const neighbors[4], int yBegin, int yEnd, std::vector<Vertex>& verts, std::vector<uint32_t>& indices);
+	glm::vec4 getBlockUV(uint8_t block) const;
 
 	std::unique_ptr<Chunk> generateChunk(const glm::ivec3& pos);
+	void computeChunkHeights(Chunk& chunk);
+
+	// the quadtree box follows the chunk's surface height, chunkMutex has to be held
+	void refreshChunkBounds(const glm::ivec3& pos, const Chunk& chunk);
 
 	std::atomic<bool> chunkBuilderActive;
 	ThreadSafeQueue<glm::ivec3> reqChunks;
@@ -135,8 +172,13 @@ private:
 	std::unordered_map<glm::ivec3, std::unique_ptr<Chunk>, IVec3Hash, IVec3Equal> chunks;
 	std::unordered_map<glm::ivec3, std::unique_ptr<Chunk>, IVec3Hash, IVec3Equal> stagingChunks;
 	std::mutex chunkMutex;
+
+	// cleared chunks whose GPU meshes the caller of takeMeshUpdates has not released yet, guarded by chunkMutex
+	std::vector<glm::ivec3> removedChunks;
 	std::mutex stagingMutex;
 
+	ChunkQuadtree chunkTree;
+
 	std::thread ChunkGenerator;
 	void chunkBuilderLoop();
 	ThreadSafeQueue<glm::ivec3> generatedQueue;
@@ -146,5 +188,8 @@ private:
 	void chunkMesherLoop();
 	ThreadSafeQueue<MeshJob> meshedChunks;
 
+	MeshingStats meshingStats;
+	std::mutex meshingStatsMutex;
+
 	void requestChunk(const glm::ivec3& pos);
 };
\ No newline at end of file
@@ -89,7 +89,7 @@ private:
     Signboard board;
 
     ModelManager modelManager;
-    //World world{ appHandles };
+    World world;
     Camera camera{ glm::vec3(0.0f, 60.0f, 0.0f), (float)appContext.swapChainExtent.width / appContext.swapChainExtent.width };
     TransformController transformController;
 
@@ -122,29 +122,25 @@ private:
     void init() {
         generateRenderMethods();
         sensor.start();
+        board.setWorld(&world);
     }
 
     void mainloop() {
-        while (!glfwWindowShouldClose(window.window)) {
-            glfwPollEvents();
+        while (board.isOpen()) {
+            board.pollEvents();
             modelManager.update();
             handleInputs();
             buildUI();
-            if (octo.beginFrame()) {
-                octo.drawFrame();
-                octo.endFrame();
-            }
-            //world.captureGenratedChunks();
+            board.drawFrame(camera.getViewMatrix(), camera.getProjectionMatrix());
             //listenSensor();
         }
-        vkDeviceWaitIdle(appHandles.device);
-
     }
 
     void dinit() {
         if (sceneRenderState.saveModelData) {
             modelManager.saveModelMeta();
         }
+        board.setWorld(nullptr);
         vkDestroyPipelineLayout(appHandles.device, pipelineLayout, nullptr);
     }
 
@@ -294,6 +290,17 @@ private:
         ImGui::Text("FPS: %.1f", ImGui::GetIO().Framerate);
         ImGui::Text("Chunk Count: %d", world.getChunkCount());
 
+        MeshingStats meshing = world.getMeshingStats();
+        ImGui::Text("Meshing: %.3f ms/chunk, sections column %u / voxel %u", meshing.chunks ? meshing.meshingMs / meshing.chunks : 0.0, meshing.columnSections, meshing.voxelSections);
+
+        bool profileMeshing = world.profileMeshing;
+        if (ImGui::Checkbox("Profile meshing", &profileMeshing)) {
+            world.profileMeshing = profileMeshing;
+            world.resetMeshingStats();
+        }
+        if (meshing.profiledChunks && meshing.profiledMeshingMs > 0.0)
+            ImGui::Text("Meshing speedup: %.2fx (%u chunks)", meshing.profiledVoxelMs / meshing.profiledMeshingMs, meshing.profiledChunks);
+
         if (drawMode == DrawMode::curvyWorld) {
             ImGui::DragFloat("World curvature", &world.renderState.worldCurvature, 0.01f, -1.0f, 1.0f);
         }
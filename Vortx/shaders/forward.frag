@@ -0,0 +1,45 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+struct GPUMaterial {
+    vec4 baseColor;
+    float metallic;
+    float roughness;
+    uint albedoTex;
+    uint normalTex;
+};
+
+layout(set = 0, binding = 0) uniform ViewState {
+    mat4 view;
+    mat4 proj;
+    mat4 viewProj;
+    vec3 cameraPos;
+} viewState;
+
+layout(std430, set = 2, binding = 0) readonly buffer Materials { GPUMaterial materials[]; };
+
+layout(set = 3, binding = 0) uniform texture2D textures[];
+layout(set = 3, binding = 1) uniform sampler samplers[];
+
+layout(location = 0) in vec3 fragColor;
+layout(location = 1) in vec3 fragNormal;
+layout(location = 2) in vec2 fragTexCoord;
+layout(location = 3) in vec3 fragPos;
+layout(location = 4) in vec3 fragTangent;
+layout(location = 5) in vec3 fragBitTangent;
+layout(location = 6) flat in uint fragMaterial;
+
+layout(location = 0) out vec4 outColor;
+
+void main(){
+    GPUMaterial material = materials[fragMaterial];
+
+    // sampler slot 0 is the default sampler ResourceAPI creates before any other
+    vec4 albedo = texture(sampler2D(textures[nonuniformEXT(material.albedoTex)], samplers[0]), fragTexCoord);
+
+    vec3 N = normalize(fragNormal);
+    vec3 L = normalize(vec3(0.4, 1.0, 0.3));
+    float diffuse = max(dot(N, L), 0.0) * 0.8 + 0.2;
+
+    outColor = vec4(albedo.rgb * material.baseColor.rgb * fragColor * diffuse, albedo.a * material.baseColor.a);
+}
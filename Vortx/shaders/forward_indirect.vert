@@ -0,0 +1,53 @@
+#version 450
+
+struct GPUObject {
+    mat4 model;
+    uint materialIndex;
+    uint meshIndex;
+    uint _pad0;
+    uint _pad1;
+};
+
+layout(set = 0, binding = 0) uniform ViewState {
+    mat4 view;
+    mat4 proj;
+    mat4 viewProj;
+    vec3 cameraPos;
+} viewState;
+
+// the culling shader writes one command per visible object with its index as firstInstance
+layout(std430, set = 1, binding = 0) readonly buffer Objects { GPUObject objects[]; };
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inNormal;
+layout(location = 2) in vec3 inColor;
+layout(location = 3) in vec2 inTexCoord;
+layout(location = 4) in vec4 inTangent;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec3 fragNormal;
+layout(location = 2) out vec2 fragTexCoord;
+layout(location = 3) out vec3 fragPos;
+layout(location = 4) out vec3 fragTangent;
+layout(location = 5) out vec3 fragBitTangent;
+layout(location = 6) flat out uint fragMaterial;
+
+void main(){
+    GPUObject object = objects[gl_InstanceIndex];
+
+    vec4 worldPos = object.model * vec4(inPosition, 1.0);
+    gl_Position = viewState.viewProj * worldPos;
+
+    mat3 normalMatrix = transpose(inverse(mat3(object.model)));
+    vec3 N = normalize(normalMatrix * inNormal);
+    vec3 T = normalize(normalMatrix * inTangent.xyz);
+    vec3 B = cross(N, T) * inTangent.w;
+
+    fragColor = inColor;
+    fragNormal = N;
+    fragTangent = T;
+    fragBitTangent = B;
+    fragTexCoord = inTexCoord;
+    fragPos = worldPos.xyz;
+    fragMaterial = object.materialIndex;
+}
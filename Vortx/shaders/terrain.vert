@@ -0,0 +1,40 @@
+#version 450
+
+layout(set = 0, binding = 0) uniform ViewState {
+    mat4 view;
+    mat4 proj;
+    mat4 viewProj;
+    vec3 cameraPos;
+} viewState;
+
+// chunks are meshed in world space and are not objects, firstInstance only numbers the draw within the frame's
+// chunk list, so nothing here reads the object buffer
+layout(push_constant) uniform TerrainConstants {
+    uint materialIndex;
+} terrain;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inNormal;
+layout(location = 2) in vec3 inColor;
+layout(location = 3) in vec2 inTexCoord;
+layout(location = 4) in vec4 inTangent;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec3 fragNormal;
+layout(location = 2) out vec2 fragTexCoord;
+layout(location = 3) out vec3 fragPos;
+layout(location = 4) out vec3 fragTangent;
+layout(location = 5) out vec3 fragBitTangent;
+layout(location = 6) flat out uint fragMaterial;
+
+void main(){
+    gl_Position = viewState.viewProj * vec4(inPosition, 1.0);
+
+    fragColor = inColor;
+    fragNormal = inNormal;
+    fragTangent = inTangent.xyz;
+    fragBitTangent = cross(inNormal, inTangent.xyz) * inTangent.w;
+    fragTexCoord = inTexCoord;
+    fragPos = inPosition;
+    fragMaterial = terrain.materialIndex;
+}